@@ -9,6 +9,7 @@ if %ERRORLEVEL% NEQ 0 exit 1
 
 xcopy "build\release\*.dll" "dist\SKSE\Plugins\" /I /Y
 xcopy "build\release\*.pdb" "dist\SKSE\Plugins\" /I /Y
+if exist "build\release\*.hlsl" xcopy "build\release\*.hlsl" "dist\SKSE\Plugins\" /I /Y
 
 xcopy "package" "dist" /I /Y /E
 
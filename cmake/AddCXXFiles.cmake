@@ -36,6 +36,9 @@ function(add_cxx_files TARGET)
 		"src/*.cxx"
 	)
 
+	# Compiled once into the FSR4_Core library instead
+	list(FILTER SOURCE_FILES EXCLUDE REGEX "/src/Core/")
+
 	source_group(TREE ${CMAKE_CURRENT_SOURCE_DIR}/src
 		PREFIX "Source Files"
 		FILES ${SOURCE_FILES})
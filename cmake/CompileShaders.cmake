@@ -0,0 +1,43 @@
+# Compiles HLSL to DXBC at build time and embeds the bytecode in the plugin as a C array.
+# The sources live in src/Shaders and are not packaged; a copy placed in Data/SKSE/Plugins/ or
+# Data/SKSE/Plugins/FSR4_Skyrim/ is only an optional override for people editing the shader.
+find_program(
+	FXC_EXECUTABLE fxc
+	HINTS
+	"$ENV{WindowsSdkVerBinPath}/x64"
+	"$ENV{WindowsSdkDir}/bin/$ENV{WindowsSDKVersion}/x64"
+)
+
+set(EMBEDDED_SHADER_DIR "${CMAKE_CURRENT_BINARY_DIR}/shaders")
+
+if(NOT FXC_EXECUTABLE)
+	message(WARNING "fxc not found, shaders will only be compiled at runtime from the loose .hlsl files copied next to the DLL")
+	target_compile_definitions(${PROJECT_NAME} PRIVATE FSR4_NO_EMBEDDED_SHADERS)
+endif()
+
+target_include_directories(${PROJECT_NAME} PRIVATE "${EMBEDDED_SHADER_DIR}")
+
+# Generates shaders/<NAME>.h declaring g_<NAME>, same flags as the runtime compile path
+# Without fxc the source is copied next to the DLL instead, which is a searched override location
+function(add_embedded_shader TARGET SOURCE ENTRY PROFILE NAME)
+	if(NOT FXC_EXECUTABLE)
+		add_custom_command(
+			TARGET ${TARGET} POST_BUILD
+			COMMAND ${CMAKE_COMMAND} -E copy_if_different "${SOURCE}" "$<TARGET_FILE_DIR:${TARGET}>"
+			VERBATIM
+		)
+		return()
+	endif()
+
+	set(OUTPUT "${EMBEDDED_SHADER_DIR}/${NAME}.h")
+	add_custom_command(
+		OUTPUT "${OUTPUT}"
+		COMMAND ${CMAKE_COMMAND} -E make_directory "${EMBEDDED_SHADER_DIR}"
+		COMMAND "${FXC_EXECUTABLE}" /nologo /Ges /O3 /Qstrip_reflect /Qstrip_debug
+			/T ${PROFILE} /E ${ENTRY} /Vn g_${NAME} /Fh "${OUTPUT}" "${SOURCE}"
+		MAIN_DEPENDENCY "${SOURCE}"
+		COMMENT "Compiling ${NAME} (${PROFILE})"
+		VERBATIM
+	)
+	target_sources(${TARGET} PRIVATE "${OUTPUT}")
+endfunction()
@@ -6,7 +6,7 @@
 
 #include <detours/Detours.h>
 
-#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/base_sink.h>
 #ifndef NDEBUG
 #	include <spdlog/sinks/msvc_sink.h>
 #endif
@@ -19,6 +19,10 @@
 
 #include <ENB/ENBSeriesAPI.h>
 
+#include "Core/AsyncLog.h"
+#include "Core/LogLimiter.h"
+
+// The log file is written asynchronously: this asks the writer thread to flush and returns right away
 #define LOG_FLUSH() spdlog::default_logger()->flush()
 
 using namespace std::literals;
@@ -91,8 +95,49 @@ namespace logger = SKSE::log;
 namespace util
 {
 	using SKSE::stl::report_and_fail;
+
+	template <class... Args>
+	void LogRateLimited(LogRateLimiter& a_limiter, spdlog::level::level_enum a_level, spdlog::format_string_t<Args...> a_fmt, Args&&... a_args)
+	{
+		uint64_t suppressed = 0;
+		if (!spdlog::default_logger_raw()->should_log(a_level) || !a_limiter.Allow(suppressed))
+			return;
+		if (suppressed)
+			spdlog::log(a_level, "{} ({} similar messages suppressed)", spdlog::fmt_lib::format(a_fmt, std::forward<Args>(a_args)...), suppressed);
+		else
+			spdlog::log(a_level, a_fmt, std::forward<Args>(a_args)...);
+	}
+
+	template <class... Args>
+	void LogDeduplicated(LogDeduplicator& a_deduplicator, spdlog::level::level_enum a_level, spdlog::format_string_t<Args...> a_fmt, Args&&... a_args)
+	{
+		if (!spdlog::default_logger_raw()->should_log(a_level))
+			return;
+		auto message = spdlog::fmt_lib::format(a_fmt, std::forward<Args>(a_args)...);
+		uint64_t repeats = 0;
+		if (!a_deduplicator.Submit(std::hash<std::string>{}(message), repeats))
+			return;
+		if (repeats)
+			spdlog::log(a_level, "(previous message repeated {} more times)", repeats);
+		spdlog::log(a_level, "{}", message);
+	}
 }
 
+// Hot path logging, in place of hand-rolled static counters. a_level is an spdlog level (info, warn, err).
+// The first a_burst calls of a site log, then at most one per a_interval
+#define LOG_RATE_LIMITED(a_level, a_burst, a_interval, ...) \
+	do { \
+		static LogRateLimiter s_logLimiter{ a_burst, a_interval }; \
+		util::LogRateLimited(s_logLimiter, spdlog::level::a_level, __VA_ARGS__); \
+	} while (false)
+
+// Logs a site's message only when it differs from the previous one
+#define LOG_DEDUPLICATED(a_level, ...) \
+	do { \
+		static LogDeduplicator s_logDeduplicator; \
+		util::LogDeduplicated(s_logDeduplicator, spdlog::level::a_level, __VA_ARGS__); \
+	} while (false)
+
 #define DLLEXPORT __declspec(dllexport)
 
 #define LOG_FLUSH() spdlog::default_logger()->flush()
@@ -101,6 +146,39 @@ namespace util
 
 bool Load();
 
+// Formats on the calling thread and hands the line to an AsyncLogWriter; the file is written by the
+// writer thread. Critical messages are written synchronously before the call returns.
+class AsyncFileSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+	explicit AsyncFileSink(const std::filesystem::path& a_path) :
+		writer(a_path) {}
+
+	AsyncLogWriter writer;
+
+protected:
+	void sink_it_(const spdlog::details::log_msg& a_msg) override
+	{
+		spdlog::memory_buf_t formatted;
+		formatter_->format(a_msg, formatted);
+		writer.Push({ formatted.data(), formatted.size() });
+		if (a_msg.level >= spdlog::level::critical)
+			writer.Drain();
+	}
+
+	void flush_() override { writer.RequestFlush(); }
+};
+
+inline std::shared_ptr<AsyncFileSink> g_logSink;
+inline LPTOP_LEVEL_EXCEPTION_FILTER g_previousExceptionFilter = nullptr;
+
+inline LONG WINAPI FlushLogOnCrash(EXCEPTION_POINTERS* a_exception)
+{
+	if (g_logSink)
+		g_logSink->writer.Drain();
+	return g_previousExceptionFilter ? g_previousExceptionFilter(a_exception) : EXCEPTION_CONTINUE_SEARCH;
+}
+
 void InitializeLog()
 {
 	auto path = logger::log_directory();
@@ -109,7 +187,7 @@ void InitializeLog()
 	}
 
 	*path /= std::format("{}.log"sv, Plugin::NAME);
-	auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(path->string(), true);
+	g_logSink = std::make_shared<AsyncFileSink>(*path);
 
 #ifndef NDEBUG
 	const auto level = spdlog::level::trace;
@@ -117,12 +195,15 @@ void InitializeLog()
 	const auto level = spdlog::level::info;
 #endif
 
-	auto log = std::make_shared<spdlog::logger>("global log"s, std::move(sink));
+	// Callers format and queue without locking against the file; a full queue drops lines instead of
+	// stalling the render thread. Only critical messages and crashes wait for the file.
+	auto log = std::make_shared<spdlog::logger>("global log"s, g_logSink);
 	log->set_level(level);
-	log->flush_on(spdlog::level::info);
 
 	spdlog::set_default_logger(std::move(log));
 	spdlog::set_pattern("%v"s);
+
+	g_previousExceptionFilter = SetUnhandledExceptionFilter(FlushLogOnCrash);
 }
 
 extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Load(const SKSE::LoadInterface* a_skse)
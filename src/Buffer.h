@@ -1,5 +1,9 @@
 #pragma once
 
+#include "Core/DirtyRangeTracker.h"
+#include "Core/ResourcePool.h"
+#include "Core/RingAllocator.h"
+
 namespace DX
 {
 	inline ID3D11Device* GetDevice()
@@ -56,6 +60,7 @@ D3D11_BUFFER_DESC ConstantBufferDesc(bool dynamic = false)
 	return ConstantBufferDesc(sizeof(T), dynamic);
 }
 
+// Separate buffer updated as a whole; ConstantBufferRing suits small per-dispatch data better
 class ConstantBuffer
 {
 public:
@@ -95,19 +100,137 @@ private:
 	D3D11_BUFFER_DESC desc;
 };
 
+// One large dynamic constant buffer shared by many small updates. Each Push writes behind the previous
+// one with MAP_WRITE_NO_OVERWRITE and is bound by offset through the D3D11.1 *SetConstantBuffers1
+// calls, so only a wrap orphans the buffer with MAP_WRITE_DISCARD. Without driver support for
+// offsets every Push discards and binds at offset 0, which behaves like ConstantBuffer::Update.
+class ConstantBufferRing
+{
+public:
+	struct Binding
+	{
+		ID3D11Buffer* buffer = nullptr;
+		UINT firstConstant = 0;  // In 16 byte constants
+		UINT numConstants = 0;
+	};
+
+	explicit ConstantBufferRing(uint32_t a_size = 64 * 1024)
+	{
+		auto device = DX::GetDevice();
+		if (!device)
+			return;
+
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+		if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+			offsetting = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+
+		if (auto ctx = DX::GetContext(); ctx && offsetting)
+			ctx->QueryInterface(IID_PPV_ARGS(context1.put()));
+		offsetting = context1 != nullptr;
+
+		// Without offsetting a single update has to fit, D3D11 caps a bound range at 4096 constants
+		uint32_t size = offsetting ? a_size : D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16;
+		auto desc = ConstantBufferDesc(size, true);
+		DX::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, resource.put()));
+		ring = RingAllocator(desc.ByteWidth);
+	}
+
+	bool SupportsOffsets() const { return offsetting; }
+	const RingAllocator::Stats& GetStats() const { return ring.GetStats(); }
+
+	// The range is never written again before the next wrap, and the wrap's discard keeps in-flight reads intact
+	Binding Push(void const* a_data, size_t a_size)
+	{
+		ID3D11DeviceContext* ctx = DX::GetContext();
+		if (!ctx || !resource)
+			return {};
+
+		RingAllocator::Allocation allocation;
+		if (!offsetting)
+			ring.Reset();
+		if (!ring.Allocate(a_size, allocation))
+			return {};
+
+		D3D11_MAPPED_SUBRESOURCE mapped_buffer{};
+		auto mapType = allocation.discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+		DX::ThrowIfFailed(ctx->Map(resource.get(), 0u, mapType, 0u, &mapped_buffer));
+		memcpy(static_cast<uint8_t*>(mapped_buffer.pData) + allocation.offset, a_data, a_size);
+		ctx->Unmap(resource.get(), 0);
+
+		return { resource.get(), UINT(allocation.offset / 16), UINT(allocation.size / 16) };
+	}
+
+	template <typename T>
+	Binding Push(T const& a_data)
+	{
+		return Push(&a_data, sizeof(T));
+	}
+
+	void BindCS(UINT a_slot, const Binding& a_binding) const
+	{
+		if (context1) {
+			context1->CSSetConstantBuffers1(a_slot, 1, &a_binding.buffer, &a_binding.firstConstant, &a_binding.numConstants);
+		} else if (auto ctx = DX::GetContext()) {
+			ctx->CSSetConstantBuffers(a_slot, 1, &a_binding.buffer);
+		}
+	}
+
+private:
+	winrt::com_ptr<ID3D11Buffer> resource;
+	winrt::com_ptr<ID3D11DeviceContext1> context1;  // Only when offsets are supported
+	RingAllocator ring;
+	bool offsetting = false;
+};
+
+// How StructuredBuffer gets CPU data to the GPU
+enum class UploadPath
+{
+	kUpdateSubresource,  // Default usage: one UpdateSubresource per dirty range
+	kMapDiscard,         // Dynamic: every upload rewrites the whole buffer
+	kMapNoOverwrite,     // Dynamic, several copies: each frame patches the oldest copy in place
+};
+
+// Writes go to a CPU copy and reach the GPU on Flush, limited to the ranges that changed. With
+// several copies the buffer streams: each Flush moves to the next copy, which the GPU last read that
+// many frames ago, and patches it with MAP_WRITE_NO_OVERWRITE. SRV() and UAV() follow the current copy.
 class StructuredBuffer
 {
 public:
-	StructuredBuffer(D3D11_BUFFER_DESC const& a_desc, UINT a_count) :
+	// a_copies above 1 needs a dynamic buffer and is clamped to 1 where NO_OVERWRITE is unsupported
+	StructuredBuffer(D3D11_BUFFER_DESC const& a_desc, UINT a_count, UINT a_copies = 1) :
 		desc(a_desc), count(a_count)
 	{
 		auto device = DX::GetDevice();
-		if (device)
+		if (!device)
+			return;
+
+		path = ChooseUploadPath(device, desc, a_copies);
+		if (path != UploadPath::kMapNoOverwrite)
+			a_copies = 1;
+
+		resources.resize(a_copies);
+		written.resize(a_copies);
+		for (auto& resource : resources)
 			DX::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, resource.put()));
+
+		shadow.resize(desc.ByteWidth);
+		dirty = DirtyRangeTracker(count, a_copies, 4);
 	}
 
-	ID3D11ShaderResourceView* SRV(size_t i = 0) const { return srvs[i].get(); }
-	ID3D11UnorderedAccessView* UAV(size_t i = 0) const { return uavs[i].get(); }
+	static UploadPath ChooseUploadPath(ID3D11Device* a_device, D3D11_BUFFER_DESC const& a_desc, UINT a_copies)
+	{
+		if (a_desc.Usage != D3D11_USAGE_DYNAMIC)
+			return UploadPath::kUpdateSubresource;
+
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+		bool noOverwrite = SUCCEEDED(a_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) && options.MapNoOverwriteOnDynamicBufferSRV;
+		return (a_copies > 1 && noOverwrite) ? UploadPath::kMapNoOverwrite : UploadPath::kMapDiscard;
+	}
+
+	ID3D11ShaderResourceView* SRV() const { return current < srvs.size() ? srvs[current].get() : nullptr; }
+	ID3D11UnorderedAccessView* UAV() const { return current < uavs.size() ? uavs[current].get() : nullptr; }
+	ID3D11Buffer* Resource() const { return resources.empty() ? nullptr : resources[current].get(); }
+	UploadPath GetUploadPath() const { return path; }
 
 	virtual void CreateSRV()
 	{
@@ -118,9 +241,11 @@ public:
 		srv_desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
 		srv_desc.Buffer.FirstElement = 0;
 		srv_desc.Buffer.NumElements = count;
-		winrt::com_ptr<ID3D11ShaderResourceView> srv;
-		DX::ThrowIfFailed(device->CreateShaderResourceView(resource.get(), &srv_desc, srv.put()));
-		srvs.push_back(srv);
+		for (auto& resource : resources) {
+			winrt::com_ptr<ID3D11ShaderResourceView> srv;
+			DX::ThrowIfFailed(device->CreateShaderResourceView(resource.get(), &srv_desc, srv.put()));
+			srvs.push_back(srv);
+		}
 	}
 
 	virtual void CreateUAV()
@@ -133,32 +258,88 @@ public:
 		uav_desc.Buffer.Flags = 0;
 		uav_desc.Buffer.FirstElement = 0;
 		uav_desc.Buffer.NumElements = count;
-		winrt::com_ptr<ID3D11UnorderedAccessView> uav;
-		DX::ThrowIfFailed(device->CreateUnorderedAccessView(resource.get(), &uav_desc, uav.put()));
-		uavs.push_back(uav);
+		for (auto& resource : resources) {
+			winrt::com_ptr<ID3D11UnorderedAccessView> uav;
+			DX::ThrowIfFailed(device->CreateUnorderedAccessView(resource.get(), &uav_desc, uav.put()));
+			uavs.push_back(uav);
+		}
+	}
+
+	// Stages a_elementCount elements starting at a_firstElement, uploaded by the next Flush
+	void Write(void const* src_data, UINT a_firstElement, UINT a_elementCount)
+	{
+		UINT stride = desc.StructureByteStride;
+		if (!stride || a_firstElement >= count)
+			return;
+		a_elementCount = std::min(a_elementCount, count - a_firstElement);
+		memcpy(shadow.data() + size_t(a_firstElement) * stride, src_data, size_t(a_elementCount) * stride);
+		dirty.Mark(a_firstElement, a_elementCount);
 	}
 
-	void Update(void const* src_data, [[maybe_unused]] size_t data_size)
+	void Flush()
 	{
 		ID3D11DeviceContext* ctx = DX::GetContext();
-		if (!ctx) return;
-		D3D11_MAPPED_SUBRESOURCE mapped_buffer{};
-		DX::ThrowIfFailed(ctx->Map(resource.get(), 0u, D3D11_MAP_WRITE_DISCARD, 0u, &mapped_buffer));
-		memcpy(mapped_buffer.pData, src_data, desc.ByteWidth);
-		ctx->Unmap(resource.get(), 0);
+		if (!ctx || resources.empty())
+			return;
+
+		if (path == UploadPath::kMapNoOverwrite)
+			current = (current + 1) % (UINT)resources.size();
+		if (!dirty.IsDirty(current))
+			return;
+
+		UINT stride = desc.StructureByteStride;
+		auto resource = resources[current].get();
+		bool whole = dirty.IsFullyDirty(current) || !written[current];
+		auto ranges = dirty.Take(current);
+
+		if (path == UploadPath::kUpdateSubresource) {
+			for (auto& range : ranges) {
+				D3D11_BOX box{ range.begin * stride, 0, 0, range.end * stride, 1, 1 };
+				ctx->UpdateSubresource(resource, 0, &box, shadow.data() + box.left, 0, 0);
+			}
+		} else {
+			// Discard maps return fresh memory, so they always rewrite everything
+			bool discard = path == UploadPath::kMapDiscard || whole;
+			D3D11_MAPPED_SUBRESOURCE mapped_buffer{};
+			DX::ThrowIfFailed(ctx->Map(resource, 0u, discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0u, &mapped_buffer));
+			auto destination = static_cast<uint8_t*>(mapped_buffer.pData);
+			if (discard) {
+				memcpy(destination, shadow.data(), shadow.size());
+			} else {
+				for (auto& range : ranges)
+					memcpy(destination + size_t(range.begin) * stride, shadow.data() + size_t(range.begin) * stride, size_t(range.Count()) * stride);
+			}
+			ctx->Unmap(resource, 0);
+		}
+		written[current] = true;
+	}
+
+	// Replaces the start of the buffer, at most ByteWidth bytes
+	void Update(void const* src_data, size_t data_size)
+	{
+		UINT stride = desc.StructureByteStride;
+		if (!stride)
+			return;
+		Write(src_data, 0, (UINT)(std::min<size_t>(data_size, desc.ByteWidth) / stride));
+		Flush();
 	}
 	template <typename T>
 	void UpdateList(T const& src_data, std::int64_t count)
 	{
 		Update(&src_data, sizeof(T) * count);
 	}
-	std::vector<winrt::com_ptr<ID3D11ShaderResourceView>> srvs;
+	std::vector<winrt::com_ptr<ID3D11ShaderResourceView>> srvs;  // One per copy
 	std::vector<winrt::com_ptr<ID3D11UnorderedAccessView>> uavs;
 
 private:
-	winrt::com_ptr<ID3D11Buffer> resource;
+	std::vector<winrt::com_ptr<ID3D11Buffer>> resources;
+	std::vector<uint8_t> shadow;
+	DirtyRangeTracker dirty;
+	std::vector<bool> written;  // Per copy, the first upload always rewrites it whole
 	D3D11_BUFFER_DESC desc;
 	UINT count;
+	UINT current = 0;
+	UploadPath path = UploadPath::kUpdateSubresource;
 };
 
 class Buffer
@@ -229,6 +410,12 @@ public:
 	winrt::com_ptr<ID3D11RenderTargetView> rtv;
 };
 
+// Pool key for a texture description, a_flags being whatever its creation flags derive from
+inline TextureKey MakeTextureKey(D3D11_TEXTURE2D_DESC const& a_desc, uint32_t a_flags, bool a_shared = false)
+{
+	return { a_desc.Width, a_desc.Height, (uint32_t)a_desc.Format, a_flags, a_desc.MipLevels, a_shared };
+}
+
 class Texture2D
 {
 public:
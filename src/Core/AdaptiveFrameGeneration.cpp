@@ -0,0 +1,109 @@
+#include "AdaptiveFrameGeneration.h"
+
+#include <algorithm>
+#include <cmath>
+
+AdaptiveFrameGeneration::Decision AdaptiveFrameGeneration::Update(float a_frameMs, float a_refreshHz, double a_timeSeconds)
+{
+	Decision decision = last;
+	decision.changed = false;
+	decision.reset = false;
+
+	// Hitches would hold the average down long enough to switch frame generation off
+	if (!(a_frameMs > 0.0f) || a_frameMs > config.maxFrameMs) {
+		last = decision;
+		return decision;
+	}
+
+	if (startSeconds < 0.0) {
+		startSeconds = a_timeSeconds;
+		stateSinceSeconds = a_timeSeconds;
+		smoothedMs = a_frameMs;
+	} else {
+		// Weighted by frame duration so the time constant does not depend on the frame rate
+		float alpha = config.smoothingSeconds > 0.0f ? 1.0f - std::exp(-a_frameMs / (config.smoothingSeconds * 1000.0f)) : 1.0f;
+		smoothedMs += (a_frameMs - smoothedMs) * alpha;
+	}
+	decision.baseFps = 1000.0f / smoothedMs;
+
+	if (a_timeSeconds - startSeconds < config.startupSeconds) {
+		decision.reason = Reason::kStartup;
+		last = decision;
+		return decision;
+	}
+
+	// The band to stay in is wider than the band to enter
+	float lowFps = config.minBaseFps + (last.enabled ? 0.0f : config.enableMarginFps);
+	float highRatio = config.headroomRatio - (last.enabled ? 0.0f : config.headroomHysteresis);
+
+	if (decision.baseFps < lowFps)
+		decision.reason = Reason::kBaseTooLow;
+	else if (a_refreshHz > 0.0f && decision.baseFps > a_refreshHz * highRatio)
+		decision.reason = Reason::kNoHeadroom;
+	else
+		decision.reason = Reason::kInRange;
+
+	bool desired = decision.reason == Reason::kInRange;
+	if (desired != last.enabled) {
+		if (conditionSinceSeconds < 0.0)
+			conditionSinceSeconds = a_timeSeconds;
+
+		if (a_timeSeconds - conditionSinceSeconds >= config.sustainSeconds && a_timeSeconds - stateSinceSeconds >= config.minDwellSeconds) {
+			decision.enabled = desired;
+			decision.changed = true;
+			decision.reset = desired;
+			stateSinceSeconds = a_timeSeconds;
+			conditionSinceSeconds = -1.0;
+		}
+	} else {
+		conditionSinceSeconds = -1.0;
+	}
+
+	last = decision;
+	return decision;
+}
+
+void AdaptiveFrameGeneration::Reset()
+{
+	last = {};
+	smoothedMs = 0.0f;
+	startSeconds = -1.0;
+	stateSinceSeconds = 0.0;
+	conditionSinceSeconds = -1.0;
+}
+
+const char* AdaptiveFrameGeneration::ReasonName(Reason a_reason)
+{
+	switch (a_reason) {
+	case Reason::kStartup:
+		return "startup";
+	case Reason::kInRange:
+		return "in range";
+	case Reason::kBaseTooLow:
+		return "base frame rate too low";
+	case Reason::kNoHeadroom:
+		return "no refresh headroom";
+	default:
+		return "unknown";
+	}
+}
+
+AdaptiveFrameGenerationSimulation SimulateAdaptiveFrameGeneration(const AdaptiveFrameGeneration::Config& a_config, std::span<const float> a_frameMs, float a_refreshHz)
+{
+	AdaptiveFrameGeneration policy(a_config);
+	AdaptiveFrameGenerationSimulation result;
+
+	double time = 0.0;
+	for (float frameMs : a_frameMs) {
+		double seconds = std::max(frameMs, 0.0f) / 1000.0;
+		time += seconds;
+
+		auto decision = policy.Update(frameMs, a_refreshHz, time);
+		if (decision.changed)
+			result.transitions++;
+		if (decision.enabled)
+			result.enabledSeconds += seconds;
+		result.totalSeconds += seconds;
+	}
+	return result;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// Automatic frame generation: on while the base frame rate is high enough for good interpolation and
+// low enough that the generated frames still fit under the refresh rate, off otherwise (below about
+// 40 fps artifacts and latency get bad, above half the refresh rate frame generation only adds latency).
+// The base frame time is smoothed over time and each edge has a hysteresis band. A switch needs the
+// condition to hold for a while and the current state to have lasted a minimum dwell time.
+class AdaptiveFrameGeneration
+{
+public:
+	enum class Reason : uint8_t
+	{
+		kStartup,      // Not enough samples yet, frame generation stays off
+		kInRange,
+		kBaseTooLow,
+		kNoHeadroom,   // Generated frames would go past the refresh rate
+	};
+
+	struct Config
+	{
+		float minBaseFps = 40.0f;          // Off below this
+		float enableMarginFps = 5.0f;      // On again only above minBaseFps plus this
+		float headroomRatio = 0.5f;        // Of the refresh rate: off above, generated frames would not be shown
+		float headroomHysteresis = 0.05f;  // On again only below headroomRatio minus this
+		float smoothingSeconds = 0.5f;     // Time constant of the frame time average
+		float sustainSeconds = 0.5f;       // A switch condition has to hold this long
+		float minDwellSeconds = 2.0f;      // Minimum time in a state before switching again
+		float maxFrameMs = 250.0f;         // Longer frames are hitches (loading, alt-tab) and are ignored
+		float startupSeconds = 1.0f;       // Averaging before the first decision
+	};
+
+	struct Decision
+	{
+		bool enabled = false;
+		bool changed = false;
+		bool reset = false;  // Switched on: history from before is stale
+		float baseFps = 0.0f;
+		Reason reason = Reason::kStartup;
+	};
+
+	AdaptiveFrameGeneration() = default;
+	explicit AdaptiveFrameGeneration(const Config& a_config) :
+		config(a_config) {}
+
+	// Once per real (not generated) frame. a_refreshHz of 0 disables the headroom limit.
+	Decision Update(float a_frameMs, float a_refreshHz, double a_timeSeconds);
+	void Reset();
+
+	const Config& GetConfig() const { return config; }
+	const Decision& GetLast() const { return last; }
+	static const char* ReasonName(Reason a_reason);
+
+private:
+	Config config;
+	Decision last;
+	float smoothedMs = 0.0f;
+	double startSeconds = -1.0;
+	double stateSinceSeconds = 0.0;
+	double conditionSinceSeconds = -1.0;  // When the current switch condition started holding
+};
+
+// Offline evaluation against a frame time trace
+struct AdaptiveFrameGenerationSimulation
+{
+	uint32_t transitions = 0;
+	double enabledSeconds = 0.0;
+	double totalSeconds = 0.0;
+
+	double EnabledFraction() const { return totalSeconds > 0.0 ? enabledSeconds / totalSeconds : 0.0; }
+};
+
+// Each sample is the duration of one real frame
+AdaptiveFrameGenerationSimulation SimulateAdaptiveFrameGeneration(const AdaptiveFrameGeneration::Config& a_config, std::span<const float> a_frameMs, float a_refreshHz);
@@ -0,0 +1,120 @@
+#include "AsyncLog.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+LogQueue::LogQueue(size_t a_capacity)
+{
+	auto capacity = std::bit_ceil(std::max<size_t>(a_capacity, 2));
+	slots = std::make_unique<Slot[]>(capacity);
+	mask = capacity - 1;
+	for (uint64_t i = 0; i < capacity; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool LogQueue::TryPush(std::string_view a_line)
+{
+	// A slot is free for position p when its sequence equals p and readable once it is p + 1
+	auto position = head.load(std::memory_order_relaxed);
+	Slot* slot;
+	for (;;) {
+		slot = &slots[position & mask];
+		auto sequence = slot->sequence.load(std::memory_order_acquire);
+		auto difference = int64_t(sequence - position);
+		if (difference == 0) {
+			if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		} else if (difference < 0) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		} else {
+			position = head.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->length = uint32_t(std::min(a_line.size(), kSlotSize));
+	std::memcpy(slot->text, a_line.data(), slot->length);
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool LogQueue::TryPop(std::string& a_line)
+{
+	auto position = tail.load(std::memory_order_relaxed);
+	auto& slot = slots[position & mask];
+	if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+		return false;
+
+	a_line.assign(slot.text, slot.length);
+	slot.sequence.store(position + mask + 1, std::memory_order_release);
+	tail.store(position + 1, std::memory_order_relaxed);
+	return true;
+}
+
+AsyncLogWriter::AsyncLogWriter(const std::filesystem::path& a_path, size_t a_capacity) :
+	queue(a_capacity)
+{
+#ifdef _WIN32
+	file = _wfopen(a_path.c_str(), L"wb");
+#else
+	file = std::fopen(a_path.c_str(), "wb");
+#endif
+	if (file)
+		writer = std::thread(&AsyncLogWriter::Run, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	stopping.store(true);
+	if (writer.joinable())
+		writer.join();
+	if (file) {
+		Drain();
+		std::fclose(file);
+	}
+}
+
+bool AsyncLogWriter::Drain(std::chrono::milliseconds a_timeout)
+{
+	if (!file || !fileLock.try_lock_for(a_timeout))
+		return false;
+	WriteQueued();
+	std::fflush(file);
+	fileLock.unlock();
+	return true;
+}
+
+void AsyncLogWriter::Run()
+{
+	auto lastFlush = std::chrono::steady_clock::now();
+	while (!stopping.load()) {
+		{
+			std::lock_guard guard(fileLock);
+			WriteQueued();
+
+			// Flush when asked and at least once a second, never per line
+			auto now = std::chrono::steady_clock::now();
+			if (flushRequested.exchange(false, std::memory_order_relaxed) || now - lastFlush > std::chrono::seconds(1)) {
+				std::fflush(file);
+				lastFlush = now;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+}
+
+void AsyncLogWriter::WriteQueued()
+{
+	while (queue.TryPop(line)) {
+		if (line.empty() || line.back() != '\n')
+			line.push_back('\n');  // Truncated
+		std::fwrite(line.data(), 1, line.size(), file);
+	}
+
+	auto drops = queue.Dropped();
+	if (drops != reportedDrops) {
+		std::fprintf(file, "[Log] Queue full, %llu lines dropped\n", (unsigned long long)(drops - reportedDrops));
+		reportedDrops = drops;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Bounded multi-producer, single-consumer queue of formatted log lines. Producers never lock or wait:
+// when the queue is full the new line is dropped and counted. Lines longer than a slot are truncated.
+class LogQueue
+{
+public:
+	static constexpr size_t kSlotSize = 512;
+
+	explicit LogQueue(size_t a_capacity = 2048);  // Rounded up to a power of two
+
+	bool TryPush(std::string_view a_line);
+	// Only one thread at a time may pop
+	bool TryPop(std::string& a_line);
+
+	uint64_t Dropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence{ 0 };
+		uint32_t length = 0;
+		char text[kSlotSize];
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	uint64_t mask = 0;
+	alignas(64) std::atomic<uint64_t> head{ 0 };  // Next slot producers claim
+	alignas(64) std::atomic<uint64_t> tail{ 0 };  // Next slot the consumer reads
+	std::atomic<uint64_t> dropped{ 0 };
+};
+
+// Writes queued lines to a file from its own thread, which polls instead of being woken so a log call
+// costs the producer no system call. Drain() writes everything synchronously, for fatal errors and
+// crash handlers; it gives up after a_timeout if the writer thread holds the file (crashed mid-write).
+class AsyncLogWriter
+{
+public:
+	explicit AsyncLogWriter(const std::filesystem::path& a_path, size_t a_capacity = 2048);
+	~AsyncLogWriter();
+
+	AsyncLogWriter(const AsyncLogWriter&) = delete;
+	AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+	bool IsOpen() const { return file != nullptr; }
+
+	bool Push(std::string_view a_line) { return queue.TryPush(a_line); }
+	void RequestFlush() { flushRequested.store(true, std::memory_order_relaxed); }
+	bool Drain(std::chrono::milliseconds a_timeout = std::chrono::milliseconds(200));
+
+	uint64_t Dropped() const { return queue.Dropped(); }
+
+private:
+	void Run();
+	void WriteQueued();  // Caller holds fileLock
+
+	LogQueue queue;
+	std::timed_mutex fileLock;
+	std::FILE* file = nullptr;
+	std::string line;
+	uint64_t reportedDrops = 0;
+	std::atomic<bool> flushRequested{ false };
+	std::atomic<bool> stopping{ false };
+	std::thread writer;
+};
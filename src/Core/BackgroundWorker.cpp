@@ -0,0 +1,108 @@
+#include "BackgroundWorker.h"
+
+namespace
+{
+	double Milliseconds(BackgroundWorker::Clock::duration a_duration)
+	{
+		return std::chrono::duration<double, std::milli>(a_duration).count();
+	}
+}
+
+bool BackgroundWorker::Job::IsFinished() const
+{
+	auto current = GetStatus();
+	return current == Status::kSucceeded || current == Status::kFailed;
+}
+
+void BackgroundWorker::Job::Wait() const
+{
+	std::unique_lock guard(lock);
+	done.wait(guard, [this]() { return IsFinished(); });
+}
+
+double BackgroundWorker::Job::QueuedMs() const
+{
+	return Milliseconds(started - submitted);
+}
+
+double BackgroundWorker::Job::RunMs() const
+{
+	return Milliseconds(finished - started);
+}
+
+void BackgroundWorker::Job::Finish(bool a_succeeded)
+{
+	finished = Clock::now();
+	{
+		std::lock_guard guard(lock);
+		status.store(a_succeeded ? Status::kSucceeded : Status::kFailed, std::memory_order_release);
+	}
+	done.notify_all();
+}
+
+BackgroundWorker::JobPtr BackgroundWorker::Submit(std::string a_name, std::function<bool()> a_work)
+{
+	auto job = std::make_shared<Job>();
+	job->name = std::move(a_name);
+	job->work = std::move(a_work);
+	job->submitted = Clock::now();
+
+	{
+		std::lock_guard guard(lock);
+		queue.push_back(job);
+		if (!thread.joinable()) {
+			stopping = false;
+			thread = std::thread(&BackgroundWorker::Run, this);
+		}
+	}
+	wake.notify_one();
+	return job;
+}
+
+void BackgroundWorker::Stop()
+{
+	{
+		std::lock_guard guard(lock);
+		if (!thread.joinable())
+			return;
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+bool BackgroundWorker::IsIdle() const
+{
+	std::lock_guard guard(lock);
+	return queue.empty() && !running;
+}
+
+void BackgroundWorker::Run()
+{
+	for (;;) {
+		JobPtr job;
+		{
+			std::unique_lock guard(lock);
+			wake.wait(guard, [this]() { return stopping || !queue.empty(); });
+			if (queue.empty())
+				return;
+			job = std::move(queue.front());
+			queue.pop_front();
+			running = true;
+		}
+
+		job->started = Clock::now();
+		job->status.store(Status::kRunning, std::memory_order_relaxed);
+		bool succeeded = false;
+		try {
+			succeeded = job->work && job->work();
+		} catch (...) {
+			succeeded = false;
+		}
+		job->work = nullptr;
+		job->Finish(succeeded);
+
+		std::lock_guard guard(lock);
+		running = false;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Runs jobs one at a time on a single thread, in submission order, so slow initialisation (FFX context
+// creation) happens while the render thread keeps going. A job's status is published with release
+// semantics after the job ran: whatever the job wrote is visible to a thread that observed it finished.
+class BackgroundWorker
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Status : uint8_t
+	{
+		kQueued,
+		kRunning,
+		kSucceeded,
+		kFailed
+	};
+
+	class Job
+	{
+	public:
+		Status GetStatus() const { return status.load(std::memory_order_acquire); }
+		bool IsFinished() const;
+		void Wait() const;
+
+		const std::string& GetName() const { return name; }
+		// Valid once finished
+		double QueuedMs() const;  // Submission until a worker picked it up
+		double RunMs() const;
+
+	private:
+		friend class BackgroundWorker;
+
+		void Finish(bool a_succeeded);
+
+		std::string name;
+		std::function<bool()> work;
+		std::atomic<Status> status{ Status::kQueued };
+		Clock::time_point submitted;
+		Clock::time_point started;
+		Clock::time_point finished;
+		mutable std::mutex lock;
+		mutable std::condition_variable done;
+	};
+
+	using JobPtr = std::shared_ptr<Job>;
+
+	BackgroundWorker() = default;
+	~BackgroundWorker() { Stop(); }
+
+	BackgroundWorker(const BackgroundWorker&) = delete;
+	BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+	// Starts the thread on first use. a_work returns false on failure; exceptions count as failure.
+	JobPtr Submit(std::string a_name, std::function<bool()> a_work);
+
+	// Runs what is queued, then joins the thread. Submit starts it again.
+	void Stop();
+
+	bool IsIdle() const;
+
+private:
+	void Run();
+
+	mutable std::mutex lock;
+	std::condition_variable wake;
+	std::deque<JobPtr> queue;
+	bool running = false;  // A job was taken from the queue and has not finished
+	bool stopping = false;
+	std::thread thread;
+};
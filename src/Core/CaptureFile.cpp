@@ -0,0 +1,392 @@
+#include "CaptureFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace Capture
+{
+	static_assert(sizeof(FileHeader) == 16);
+	static_assert(sizeof(ChunkHeader) == 16);
+	static_assert(sizeof(FrameInfo) == 96);
+	static_assert(sizeof(PlaneHeader) == 48);
+
+	namespace
+	{
+		constexpr uint64_t AlignUp(uint64_t a_value)
+		{
+			return (a_value + kDataAlignment - 1) & ~(kDataAlignment - 1);
+		}
+
+		// Control byte below 128: that many plus one literal bytes follow. From 128: the next byte
+		// repeats (control - 125) times, 3 to 130.
+		constexpr size_t kMaxLiteral = 128;
+		constexpr size_t kMinRun = 3;
+		constexpr size_t kMaxRun = 130;
+	}
+
+	bool Encode(std::span<const uint8_t> a_raw, uint32_t a_rowBytes, std::vector<uint8_t>& a_encoded)
+	{
+		a_encoded.clear();
+		if (a_rowBytes == 0 || a_raw.empty() || a_raw.size() % a_rowBytes)
+			return false;
+
+		// Not worth a decode for less than an eighth saved
+		const size_t limit = a_raw.size() - a_raw.size() / 8;
+		const size_t size = a_raw.size();
+		auto delta = [&](size_t i) -> uint8_t {
+			return i < a_rowBytes ? a_raw[i] : uint8_t(a_raw[i] ^ a_raw[i - a_rowBytes]);
+		};
+
+		size_t literalStart = 0;
+		size_t literalCount = 0;
+		auto flushLiterals = [&]() {
+			while (literalCount) {
+				auto count = std::min(literalCount, kMaxLiteral);
+				a_encoded.push_back(uint8_t(count - 1));
+				for (size_t i = 0; i < count; i++)
+					a_encoded.push_back(delta(literalStart + i));
+				literalStart += count;
+				literalCount -= count;
+			}
+		};
+
+		size_t i = 0;
+		while (i < size) {
+			auto value = delta(i);
+			size_t run = 1;
+			while (i + run < size && run < kMaxRun && delta(i + run) == value)
+				run++;
+
+			if (run >= kMinRun) {
+				flushLiterals();
+				a_encoded.push_back(uint8_t(run + 125));
+				a_encoded.push_back(value);
+				i += run;
+				literalStart = i;
+			} else {
+				literalCount += run;
+				i += run;
+			}
+			if (a_encoded.size() >= limit)
+				return false;
+		}
+		flushLiterals();
+		return a_encoded.size() < limit;
+	}
+
+	bool Decode(Codec a_codec, std::span<const uint8_t> a_stored, uint32_t a_rowBytes, std::span<uint8_t> a_raw)
+	{
+		if (a_codec == Codec::kRaw) {
+			if (a_stored.size() != a_raw.size())
+				return false;
+			std::memcpy(a_raw.data(), a_stored.data(), a_raw.size());
+			return true;
+		}
+		if (a_codec != Codec::kRowDeltaRle || a_rowBytes == 0 || a_raw.size() % a_rowBytes)
+			return false;
+
+		size_t in = 0;
+		size_t out = 0;
+		while (in < a_stored.size()) {
+			uint8_t control = a_stored[in++];
+			if (control < 128) {
+				size_t count = size_t(control) + 1;
+				if (in + count > a_stored.size() || out + count > a_raw.size())
+					return false;
+				std::memcpy(a_raw.data() + out, a_stored.data() + in, count);
+				in += count;
+				out += count;
+			} else {
+				size_t count = size_t(control) - 125;
+				if (in >= a_stored.size() || out + count > a_raw.size())
+					return false;
+				std::memset(a_raw.data() + out, a_stored[in++], count);
+				out += count;
+			}
+		}
+		if (out != a_raw.size())
+			return false;
+
+		// Undo the row delta top to bottom, each row against the already restored one above
+		for (size_t i = a_rowBytes; i < a_raw.size(); i++)
+			a_raw[i] ^= a_raw[i - a_rowBytes];
+		return true;
+	}
+
+	bool Writer::Open(const std::filesystem::path& a_path)
+	{
+		Close();
+#ifdef _WIN32
+		file = _wfopen(a_path.c_str(), L"wb");
+#else
+		file = std::fopen(a_path.c_str(), "wb");
+#endif
+		if (!file)
+			return false;
+		std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+		FileHeader header{};
+		std::memcpy(header.magic, kMagic, sizeof(kMagic));
+		header.version = kVersion;
+		frames = 0;
+		bytes = 0;
+		rawBytes = 0;
+
+		// Chunks start aligned, so aligned offsets within a chunk are aligned in the file and the mapping
+		uint8_t padding[kDataAlignment - sizeof(FileHeader)]{};
+		if (!Write(&header, sizeof(header)) || !Write(padding, sizeof(padding))) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	bool Writer::WriteFrame(const FrameInfo& a_info, std::span<const PlaneInput> a_planes, bool a_compress)
+	{
+		if (!file)
+			return false;
+
+		struct Pending
+		{
+			PlaneHeader header;
+			const PlaneInput* input;
+			size_t encodedOffset;
+		};
+		std::vector<Pending> pending;
+		pending.reserve(a_planes.size());
+		encoded.clear();
+
+		uint64_t offset = AlignUp(sizeof(ChunkHeader) + sizeof(FrameInfo) + a_planes.size() * sizeof(PlaneHeader));
+		for (auto& input : a_planes) {
+			PlaneHeader header{};
+			header.plane = input.plane;
+			header.format = input.format;
+			header.width = input.width;
+			header.height = input.height;
+			header.rowBytes = input.rowBytes;
+			header.codec = Codec::kRaw;
+			header.rawBytes = uint64_t(input.rowBytes) * input.height;
+			header.storedBytes = header.rawBytes;
+			header.offset = offset;
+
+			size_t encodedOffset = encoded.size();
+			if (a_compress && header.rawBytes) {
+				std::span<const uint8_t> raw(input.data, size_t(header.rawBytes));
+				if (input.rowPitch != input.rowBytes) {
+					packed.resize(size_t(header.rawBytes));
+					for (uint32_t row = 0; row < input.height; row++)
+						std::memcpy(packed.data() + size_t(row) * input.rowBytes, input.data + size_t(row) * input.rowPitch, input.rowBytes);
+					raw = packed;
+				}
+				if (Encode(raw, input.rowBytes, scratch)) {
+					header.codec = Codec::kRowDeltaRle;
+					header.storedBytes = scratch.size();
+					encoded.insert(encoded.end(), scratch.begin(), scratch.end());
+				}
+			}
+
+			pending.push_back({ header, &input, encodedOffset });
+			offset = AlignUp(offset + header.storedBytes);
+		}
+
+		FrameInfo info = a_info;
+		info.planeCount = uint32_t(a_planes.size());
+		ChunkHeader chunk{ kFrameChunk, 0, offset - sizeof(ChunkHeader) };
+
+		if (!Write(&chunk, sizeof(chunk)) || !Write(&info, sizeof(info)))
+			return false;
+		for (auto& plane : pending) {
+			if (!Write(&plane.header, sizeof(PlaneHeader)))
+				return false;
+		}
+
+		static const uint8_t zeros[kDataAlignment]{};
+		uint64_t position = sizeof(ChunkHeader) + sizeof(FrameInfo) + pending.size() * sizeof(PlaneHeader);
+		for (auto& plane : pending) {
+			if (!Write(zeros, size_t(plane.header.offset - position)))
+				return false;
+
+			if (plane.header.codec == Codec::kRowDeltaRle) {
+				if (!Write(encoded.data() + plane.encodedOffset, size_t(plane.header.storedBytes)))
+					return false;
+			} else {
+				auto& input = *plane.input;
+				for (uint32_t row = 0; row < input.height; row++) {
+					if (!Write(input.data + size_t(row) * input.rowPitch, input.rowBytes))
+						return false;
+				}
+			}
+			position = plane.header.offset + plane.header.storedBytes;
+			rawBytes += plane.header.rawBytes;
+		}
+		if (!Write(zeros, size_t(offset - position)))
+			return false;
+
+		frames++;
+		return true;
+	}
+
+	void Writer::Close()
+	{
+		if (file) {
+			std::fclose(file);
+			file = nullptr;
+		}
+	}
+
+	bool Writer::Write(const void* a_data, size_t a_size)
+	{
+		if (a_size && std::fwrite(a_data, 1, a_size, file) != a_size)
+			return false;
+		bytes += a_size;
+		return true;
+	}
+
+	bool MappedFile::Open(const std::filesystem::path& a_path)
+	{
+		Close();
+#ifdef _WIN32
+		HANDLE handle = CreateFileW(a_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+		fileHandle = handle;
+
+		LARGE_INTEGER length{};
+		if (!GetFileSizeEx(handle, &length) || length.QuadPart == 0) {
+			Close();
+			return false;
+		}
+		mappingHandle = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle) {
+			Close();
+			return false;
+		}
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (!data) {
+			Close();
+			return false;
+		}
+		size = size_t(length.QuadPart);
+#else
+		int descriptor = ::open(a_path.c_str(), O_RDONLY);
+		if (descriptor < 0)
+			return false;
+
+		struct stat status{};
+		if (::fstat(descriptor, &status) != 0 || status.st_size == 0) {
+			::close(descriptor);
+			return false;
+		}
+		void* view = ::mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+		::close(descriptor);  // The mapping keeps the file open
+		if (view == MAP_FAILED)
+			return false;
+		data = static_cast<const uint8_t*>(view);
+		size = size_t(status.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (data)
+			UnmapViewOfFile(data);
+		if (mappingHandle)
+			CloseHandle(mappingHandle);
+		if (fileHandle)
+			CloseHandle(fileHandle);
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+#else
+		if (data)
+			::munmap(const_cast<uint8_t*>(data), size);
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	const PlaneView* FrameView::Find(Plane a_plane) const
+	{
+		for (auto& plane : planes) {
+			if (plane.header->plane == a_plane)
+				return &plane;
+		}
+		return nullptr;
+	}
+
+	bool Reader::Open(const std::filesystem::path& a_path, std::string* a_error)
+	{
+		auto fail = [&](const char* a_message) {
+			if (a_error)
+				*a_error = a_message;
+			frames.clear();
+			mapping.Close();
+			return false;
+		};
+
+		frames.clear();
+		if (!mapping.Open(a_path))
+			return fail("cannot map file");
+
+		auto file = mapping.Data();
+		if (file.size() < kDataAlignment)
+			return fail("file too small");
+		auto header = reinterpret_cast<const FileHeader*>(file.data());
+		if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0)
+			return fail("not a capture file");
+		if (header->version != kVersion)
+			return fail("unsupported version");
+
+		// A capture cut short ends in a partial chunk; keep the frames before it
+		uint64_t position = kDataAlignment;
+		while (position + sizeof(ChunkHeader) <= file.size()) {
+			auto chunk = reinterpret_cast<const ChunkHeader*>(file.data() + position);
+			uint64_t chunkSize = sizeof(ChunkHeader) + chunk->size;
+			if (chunk->size > file.size() - position - sizeof(ChunkHeader))
+				break;
+
+			if (chunk->type == kFrameChunk && chunk->size >= sizeof(FrameInfo)) {
+				auto base = file.data() + position;
+				FrameView frame;
+				frame.info = reinterpret_cast<const FrameInfo*>(base + sizeof(ChunkHeader));
+
+				uint64_t headerEnd = sizeof(ChunkHeader) + sizeof(FrameInfo) + uint64_t(frame.info->planeCount) * sizeof(PlaneHeader);
+				if (headerEnd > chunkSize)
+					return fail("corrupt frame chunk");
+
+				auto planes = reinterpret_cast<const PlaneHeader*>(base + sizeof(ChunkHeader) + sizeof(FrameInfo));
+				for (uint32_t i = 0; i < frame.info->planeCount; i++) {
+					auto& plane = planes[i];
+					bool valid = plane.offset >= headerEnd && plane.offset <= chunkSize && plane.storedBytes <= chunkSize - plane.offset &&
+					             plane.rawBytes == uint64_t(plane.rowBytes) * plane.height &&
+					             (plane.codec == Codec::kRowDeltaRle || (plane.codec == Codec::kRaw && plane.storedBytes == plane.rawBytes));
+					if (!valid)
+						return fail("corrupt plane header");
+					frame.planes.push_back({ &plane, { base + plane.offset, size_t(plane.storedBytes) } });
+				}
+				frames.push_back(std::move(frame));
+			}
+			position += AlignUp(chunkSize);
+		}
+		return true;
+	}
+
+	bool Reader::ReadPlane(const PlaneView& a_plane, std::span<uint8_t> a_raw)
+	{
+		if (!a_plane.header || a_raw.size() != a_plane.header->rawBytes)
+			return false;
+		return Decode(a_plane.header->codec, a_plane.stored, a_plane.header->rowBytes, a_raw);
+	}
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+// Frame capture files: the inputs of the AA and FG passes for a run of frames, for offline tuning and
+// replay. A file is a header followed by chunks; every frame is one chunk holding its camera values
+// and one or more planes (color, depth, motion vectors), each stored raw or compressed. Plane data
+// starts 64-byte aligned, so a reader mapping the file reads raw planes in place without copying.
+// All values are little endian.
+namespace Capture
+{
+	static_assert(std::endian::native == std::endian::little);
+
+	inline constexpr char kMagic[8] = { 'F', 'S', 'R', '4', 'C', 'A', 'P', '\0' };
+	inline constexpr uint32_t kVersion = 1;
+	inline constexpr uint32_t kFrameChunk = 0x4D415246;  // "FRAM"
+	inline constexpr uint64_t kDataAlignment = 64;
+
+	enum class Plane : uint32_t
+	{
+		kColor,  // HUD-less scene color
+		kDepth,
+		kMotionVectors,
+	};
+
+	enum class Codec : uint32_t
+	{
+		kRaw,
+		kRowDeltaRle,  // Rows XORed with the row above, then run-length coded; flat regions collapse
+	};
+
+	struct FileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+	};
+
+	struct ChunkHeader
+	{
+		uint32_t type;
+		uint32_t reserved;
+		uint64_t size;  // Payload bytes after this header, padded to kDataAlignment
+	};
+
+	// Same values as FrameContext, which stays independent of the file layout
+	struct FrameInfo
+	{
+		uint64_t frameID;
+		uint32_t width;
+		uint32_t height;
+		float deltaTimeMs;
+		float cameraNear;
+		float cameraFar;
+		float fovVerticalRad;
+		float jitterX;
+		float jitterY;
+		float cameraPosition[3];
+		float cameraRight[3];
+		float cameraForward[3];
+		float cameraUp[3];
+		uint32_t flags;  // kSceneCut
+		uint32_t planeCount;
+	};
+	inline constexpr uint32_t kSceneCut = 1;
+
+	struct PlaneHeader
+	{
+		Plane plane;
+		uint32_t format;    // DXGI_FORMAT of the source texture
+		uint32_t width;
+		uint32_t height;
+		uint32_t rowBytes;  // Tightly packed, no pitch padding
+		Codec codec;
+		uint64_t offset;    // From the chunk header, aligned
+		uint64_t storedBytes;
+		uint64_t rawBytes;
+	};
+
+	// Returns false when a_raw is not a whole number of rows or the output would not save an eighth
+	bool Encode(std::span<const uint8_t> a_raw, uint32_t a_rowBytes, std::vector<uint8_t>& a_encoded);
+	bool Decode(Codec a_codec, std::span<const uint8_t> a_stored, uint32_t a_rowBytes, std::span<uint8_t> a_raw);
+
+	struct PlaneInput
+	{
+		Plane plane;
+		uint32_t format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t rowBytes;
+		uint32_t rowPitch;  // Source stride, at least rowBytes (readback buffers pad rows)
+		const uint8_t* data;
+	};
+
+	class Writer
+	{
+	public:
+		Writer() = default;
+		~Writer() { Close(); }
+
+		Writer(const Writer&) = delete;
+		Writer& operator=(const Writer&) = delete;
+
+		bool Open(const std::filesystem::path& a_path);
+		// a_compress tries kRowDeltaRle per plane and keeps it only where it saves space
+		bool WriteFrame(const FrameInfo& a_info, std::span<const PlaneInput> a_planes, bool a_compress = true);
+		void Close();
+
+		bool IsOpen() const { return file != nullptr; }
+		uint32_t FramesWritten() const { return frames; }
+		uint64_t BytesWritten() const { return bytes; }
+		uint64_t RawBytes() const { return rawBytes; }
+
+	private:
+		bool Write(const void* a_data, size_t a_size);
+
+		std::FILE* file = nullptr;
+		uint32_t frames = 0;
+		uint64_t bytes = 0;
+		uint64_t rawBytes = 0;
+		std::vector<uint8_t> packed;   // Plane without row padding
+		std::vector<uint8_t> scratch;  // One encoded plane
+		std::vector<uint8_t> encoded;  // All encoded planes of the frame
+	};
+
+	// Read-only mapping of a whole file
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::filesystem::path& a_path);
+		void Close();
+
+		std::span<const uint8_t> Data() const { return { data, size }; }
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#endif
+	};
+
+	struct PlaneView
+	{
+		const PlaneHeader* header = nullptr;
+		std::span<const uint8_t> stored;  // Points into the mapping; the pixels themselves for kRaw
+	};
+
+	struct FrameView
+	{
+		const FrameInfo* info = nullptr;
+		std::vector<PlaneView> planes;
+
+		const PlaneView* Find(Plane a_plane) const;
+	};
+
+	// Indexes the frames of a mapped capture; frames and planes are views into the mapping
+	class Reader
+	{
+	public:
+		bool Open(const std::filesystem::path& a_path, std::string* a_error = nullptr);
+
+		size_t FrameCount() const { return frames.size(); }
+		const FrameView& GetFrame(size_t a_index) const { return frames[a_index]; }
+
+		// Decodes into a_raw (header->rawBytes long); raw planes are copied
+		static bool ReadPlane(const PlaneView& a_plane, std::span<uint8_t> a_raw);
+
+	private:
+		MappedFile mapping;
+		std::vector<FrameView> frames;
+	};
+}
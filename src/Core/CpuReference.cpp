@@ -0,0 +1,341 @@
+#include "CpuReferenceKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace CpuReference
+{
+	namespace
+	{
+		std::atomic<int> forcedIsa{ -1 };
+		std::atomic<uint32_t> threadCount{ 0 };
+
+		Isa DetectIsa()
+		{
+			if (Kernels::GetAvx2Table())
+				return Isa::kAvx2;
+			if (Kernels::GetNeonTable())
+				return Isa::kNeon;
+			return Isa::kScalar;
+		}
+
+		uint32_t Clamp(int64_t a_value, uint32_t a_size)
+		{
+			return uint32_t(std::clamp<int64_t>(a_value, 0, int64_t(a_size) - 1));
+		}
+	}
+
+	Isa GetIsa()
+	{
+		int forced = forcedIsa.load(std::memory_order_relaxed);
+		return forced < 0 ? DetectIsa() : Isa(forced);
+	}
+
+	void ForceIsa(Isa a_isa)
+	{
+		bool supported = a_isa == Isa::kScalar || (a_isa == Isa::kAvx2 && Kernels::GetAvx2Table()) || (a_isa == Isa::kNeon && Kernels::GetNeonTable());
+		forcedIsa.store(int(supported ? a_isa : DetectIsa()), std::memory_order_relaxed);
+	}
+
+	const char* IsaName(Isa a_isa)
+	{
+		switch (a_isa) {
+		case Isa::kAvx2:
+			return "AVX2";
+		case Isa::kNeon:
+			return "NEON";
+		default:
+			return "scalar";
+		}
+	}
+
+	void SetThreadCount(uint32_t a_threads)
+	{
+		threadCount.store(a_threads, std::memory_order_relaxed);
+	}
+
+	void HalfToFloat(std::span<const uint16_t> a_half, std::span<float> a_float)
+	{
+		Kernels::GetTable().halfToFloat(a_half.data(), a_float.data(), std::min(a_half.size(), a_float.size()));
+	}
+
+	void LinearizeDepth(Image<const float> a_depth, Image<float> a_linear, const DepthConvention& a_convention)
+	{
+		if (a_depth.width != a_linear.width || a_depth.height != a_linear.height)
+			return;
+
+		// Non-inverted depth d is 1 - d inverted; infinite is the limit of far to infinity
+		float n = a_convention.cameraNear;
+		float f = a_convention.cameraFar;
+		float a = a_convention.infinite ? n : n * f;
+		float b = a_convention.infinite ? 0.0f : n;
+		float c = a_convention.infinite ? 1.0f : f - n;
+		Kernels::LinearizeCoefficients coefficients = a_convention.inverted ? Kernels::LinearizeCoefficients{ a, b, c } : Kernels::LinearizeCoefficients{ a, b + c, -c };
+
+		auto& table = Kernels::GetTable();
+		Kernels::ForEachBand(a_depth.height, [&](uint32_t a_begin, uint32_t a_end, uint32_t) {
+			for (uint32_t y = a_begin; y < a_end; y++)
+				table.linearize(a_depth.Row(y), a_linear.Row(y), a_depth.width, coefficients);
+		});
+	}
+
+	void DilateMotionVectors(Image<const float> a_depth, Image<const Vec2> a_motionVectors, Image<Vec2> a_dilated, bool a_inverted)
+	{
+		uint32_t width = a_depth.width;
+		uint32_t height = a_depth.height;
+		if (a_motionVectors.width != width || a_motionVectors.height != height || a_dilated.width != width || a_dilated.height != height)
+			return;
+
+		auto& table = Kernels::GetTable();
+		Kernels::ForEachBand(height, [&](uint32_t a_begin, uint32_t a_end, uint32_t) {
+			std::vector<uint8_t> nearest(width);
+			for (uint32_t y = a_begin; y < a_end; y++) {
+				uint32_t above = Clamp(int64_t(y) - 1, height);
+				uint32_t below = Clamp(int64_t(y) + 1, height);
+				const float* rows[3] = { a_depth.Row(above), a_depth.Row(y), a_depth.Row(below) };
+				table.nearestDepth(rows, width, 0, width, a_inverted, nearest.data());
+
+				const Vec2* motionVectors[3] = { a_motionVectors.Row(above), a_motionVectors.Row(y), a_motionVectors.Row(below) };
+				auto out = a_dilated.Row(y);
+				for (uint32_t x = 0; x < width; x++) {
+					uint32_t column = x + nearest[x] % 3;  // x + dx + 1
+					column = column ? std::min(column - 1, width - 1) : 0;
+					out[x] = motionVectors[nearest[x] / 3][column];
+				}
+			}
+		});
+	}
+
+	ReprojectionStats Reproject(const ReprojectionInputs& a_inputs, const ReprojectionParams& a_params, Image<float> a_error, Image<uint8_t> a_mask)
+	{
+		uint32_t width = a_inputs.luma.width;
+		uint32_t height = a_inputs.luma.height;
+		auto sameSize = [&](auto& a_image) { return a_image.width == width && a_image.height == height; };
+		if (!sameSize(a_inputs.linearDepth) || !sameSize(a_inputs.motionVectors) || !sameSize(a_inputs.previousLuma) || !sameSize(a_inputs.previousLinearDepth))
+			return {};
+		bool writeError = a_error.data && sameSize(a_error);
+		bool writeMask = a_mask.data && sameSize(a_mask);
+
+		// Summed per band in band order, so the result does not depend on the thread count
+		std::vector<Kernels::RowStats> bands((height + Kernels::kBandRows - 1) / Kernels::kBandRows);
+		auto& table = Kernels::GetTable();
+		Kernels::ForEachBand(height, [&](uint32_t a_begin, uint32_t a_end, uint32_t a_band) {
+			for (uint32_t y = a_begin; y < a_end; y++) {
+				Kernels::ReprojectRow row{ &a_inputs, &a_params, 1.0f - a_params.disocclusionThreshold, y, 0, width,
+					writeError ? a_error.Row(y) : nullptr, writeMask ? a_mask.Row(y) : nullptr };
+				table.reproject(row, bands[a_band]);
+			}
+		});
+
+		ReprojectionStats stats;
+		double errorSum = 0.0;
+		for (auto& band : bands) {
+			errorSum += band.errorSum;
+			stats.maxError = std::max(stats.maxError, band.maxError);
+			stats.validPixels += band.valid;
+			stats.disoccludedPixels += band.disoccluded;
+			stats.offscreenPixels += band.offscreen;
+		}
+		if (stats.validPixels)
+			stats.meanError = errorSum / double(stats.validPixels);
+		return stats;
+	}
+
+	namespace Kernels
+	{
+		const Table& GetTable()
+		{
+			switch (GetIsa()) {
+			case Isa::kAvx2:
+				return *GetAvx2Table();
+			case Isa::kNeon:
+				return *GetNeonTable();
+			default:
+				return kScalar;
+			}
+		}
+
+		void ForEachBand(uint32_t a_rows, const std::function<void(uint32_t, uint32_t, uint32_t)>& a_work)
+		{
+			uint32_t bands = (a_rows + kBandRows - 1) / kBandRows;
+			uint32_t threads = threadCount.load(std::memory_order_relaxed);
+			if (threads == 0)
+				threads = std::max(1u, std::thread::hardware_concurrency());
+			threads = std::min(threads, bands);
+
+			std::atomic<uint32_t> next{ 0 };
+			auto run = [&]() {
+				for (uint32_t band; (band = next.fetch_add(1)) < bands;)
+					a_work(band * kBandRows, std::min(a_rows, (band + 1) * kBandRows), band);
+			};
+
+			std::vector<std::thread> workers;
+			for (uint32_t i = 1; i < threads; i++)
+				workers.emplace_back(run);
+			run();
+			for (auto& worker : workers)
+				worker.join();
+		}
+
+		void HalfToFloatScalar(const uint16_t* a_half, float* a_float, size_t a_count)
+		{
+			for (size_t i = 0; i < a_count; i++) {
+				uint32_t half = a_half[i];
+				uint32_t sign = (half & 0x8000u) << 16;
+				uint32_t exponent = (half >> 10) & 0x1f;
+				uint32_t mantissa = half & 0x3ff;
+
+				uint32_t bits;
+				if (exponent == 0x1f) {
+					bits = sign | 0x7f800000u | (mantissa << 13);
+				} else if (exponent) {
+					bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+				} else if (mantissa) {
+					// Subnormal half, normal float
+					exponent = 113;
+					while (!(mantissa & 0x400)) {
+						mantissa <<= 1;
+						exponent--;
+					}
+					bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+				} else {
+					bits = sign;
+				}
+				a_float[i] = std::bit_cast<float>(bits);
+			}
+		}
+
+		void LinearizeScalar(const float* a_depth, float* a_linear, size_t a_count, const LinearizeCoefficients& a_coefficients)
+		{
+			for (size_t i = 0; i < a_count; i++)
+				a_linear[i] = a_coefficients.a / (a_coefficients.p + a_coefficients.q * a_depth[i]);
+		}
+
+		void NearestDepthScalar(const float* const a_rows[3], uint32_t a_width, uint32_t a_begin, uint32_t a_end, bool a_inverted, uint8_t* a_index)
+		{
+			for (uint32_t x = a_begin; x < a_end; x++) {
+				uint32_t columns[3] = { x ? x - 1 : 0, x, std::min(x + 1, a_width - 1) };
+				float best = a_rows[1][x];
+				uint8_t bestIndex = 4;
+				for (uint8_t index : kNeighbourOrder) {
+					float depth = a_rows[index / 3][columns[index % 3]];
+					if (a_inverted ? depth > best : depth < best) {
+						best = depth;
+						bestIndex = index;
+					}
+				}
+				a_index[x] = bestIndex;
+			}
+		}
+
+		void ReprojectScalar(const ReprojectRow& a_row, RowStats& a_stats)
+		{
+			auto& inputs = *a_row.inputs;
+			auto& params = *a_row.params;
+			uint32_t width = inputs.luma.width;
+			uint32_t height = inputs.luma.height;
+			float fy = float(a_row.y) + 0.5f;
+
+			auto luma = inputs.luma.Row(a_row.y);
+			auto depth = inputs.linearDepth.Row(a_row.y);
+			auto motionVectors = inputs.motionVectors.Row(a_row.y);
+			float rowError = 0.0f;
+
+			for (uint32_t x = a_row.begin; x < a_row.end; x++) {
+				float px = float(x) + 0.5f + motionVectors[x].x * params.motionVectorScaleX - params.jitterDeltaX;
+				float py = fy + motionVectors[x].y * params.motionVectorScaleY - params.jitterDeltaY;
+
+				uint8_t mask = kOffscreen;
+				float error = 0.0f;
+				if (px >= 0.0f && px < float(width) && py >= 0.0f && py < float(height)) {
+					float sx = px - 0.5f;
+					float sy = py - 0.5f;
+					float x0f = std::floor(sx);
+					float y0f = std::floor(sy);
+					float wx = sx - x0f;
+					float wy = sy - y0f;
+					uint32_t x0 = Clamp(int64_t(x0f), width);
+					uint32_t x1 = Clamp(int64_t(x0f) + 1, width);
+					const float* lumaRows[2] = { inputs.previousLuma.Row(Clamp(int64_t(y0f), height)), inputs.previousLuma.Row(Clamp(int64_t(y0f) + 1, height)) };
+					const float* depthRows[2] = { inputs.previousLinearDepth.Row(Clamp(int64_t(y0f), height)), inputs.previousLinearDepth.Row(Clamp(int64_t(y0f) + 1, height)) };
+
+					// Farthest of the four: only a pixel every neighbour used to cover counts as disoccluded
+					float previousDepth = std::max(std::max(depthRows[0][x0], depthRows[0][x1]), std::max(depthRows[1][x0], depthRows[1][x1]));
+					if (previousDepth < depth[x] * a_row.keep) {
+						mask = kDisoccluded;
+					} else {
+						float top = lumaRows[0][x0] * (1.0f - wx) + lumaRows[0][x1] * wx;
+						float bottom = lumaRows[1][x0] * (1.0f - wx) + lumaRows[1][x1] * wx;
+						float previous = top * (1.0f - wy) + bottom * wy;
+						mask = kValid;
+						error = std::fabs(luma[x] - previous);
+					}
+				}
+
+				switch (mask) {
+				case kValid:
+					a_stats.valid++;
+					rowError += error;
+					a_stats.maxError = std::max(a_stats.maxError, error);
+					break;
+				case kDisoccluded:
+					a_stats.disoccluded++;
+					break;
+				default:
+					a_stats.offscreen++;
+					break;
+				}
+				if (a_row.error)
+					a_row.error[x] = error;
+				if (a_row.mask)
+					a_row.mask[x] = mask;
+			}
+			a_stats.errorSum += rowError;
+		}
+
+		double SquaredErrorScalar(const float* a_a, const float* a_b, size_t a_count)
+		{
+			float sum = 0.0f;
+			for (size_t i = 0; i < a_count; i++) {
+				float difference = a_a[i] - a_b[i];
+				sum += difference * difference;
+			}
+			return sum;
+		}
+
+		double TemporalErrorScalar(const float* a_test, const float* a_testPrevious, const float* a_reference, const float* a_referencePrevious, size_t a_count)
+		{
+			float sum = 0.0f;
+			for (size_t i = 0; i < a_count; i++)
+				sum += std::fabs((a_test[i] - a_testPrevious[i]) - (a_reference[i] - a_referencePrevious[i]));
+			return sum;
+		}
+
+		void SsimRowScalar(const float* a_a, size_t a_strideA, const float* a_b, size_t a_strideB, uint32_t a_width, SsimSums& a_sums)
+		{
+			for (uint32_t x = 0; x + kSsimWindow <= a_width; x += kSsimStep) {
+				float sumA = 0.0f, sumB = 0.0f, sumAA = 0.0f, sumBB = 0.0f, sumAB = 0.0f;
+				for (uint32_t y = 0; y < kSsimWindow; y++) {
+					auto rowA = a_a + y * a_strideA + x;
+					auto rowB = a_b + y * a_strideB + x;
+					for (uint32_t i = 0; i < kSsimWindow; i++) {
+						sumA += rowA[i];
+						sumB += rowB[i];
+						sumAA += rowA[i] * rowA[i];
+						sumBB += rowB[i] * rowB[i];
+						sumAB += rowA[i] * rowB[i];
+					}
+				}
+				a_sums.ssim += SsimFromSums(sumA, sumB, sumAA, sumBB, sumAB);
+				a_sums.windows++;
+			}
+		}
+
+		const Table kScalar = { HalfToFloatScalar, LinearizeScalar, NearestDepthScalar, ReprojectScalar, SquaredErrorScalar, TemporalErrorScalar, SsimRowScalar };
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// CPU versions of the transforms FSR applies to our inputs, run on captured frames to check what it is
+// given: motion vector scale and jitter cancellation, inverted infinite depth, MV dilation by the nearest
+// depth in 3x3, and the reprojection error and disocclusions those produce against the next frame.
+// The scalar code is the reference. AVX2 (x86-64) and NEON (AArch64) versions are picked at run time and
+// must match it; images are split into bands of rows processed on several threads.
+namespace CpuReference
+{
+	enum class Isa : uint8_t
+	{
+		kScalar,
+		kAvx2,
+		kNeon
+	};
+
+	// Best supported by this CPU, unless forced
+	Isa GetIsa();
+	// Falls back to the best supported one when a_isa is not; for comparisons and benchmarks
+	void ForceIsa(Isa a_isa);
+	const char* IsaName(Isa a_isa);
+
+	// 0 uses every hardware thread
+	void SetThreadCount(uint32_t a_threads);
+
+	template <class T>
+	struct Image
+	{
+		T* data = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		size_t stride = 0;  // In elements
+
+		T* Row(uint32_t a_y) const { return data + a_y * stride; }
+	};
+
+	struct Vec2
+	{
+		float x;
+		float y;
+	};
+
+	// FFX_UPSCALE_ENABLE_DEPTH_INVERTED and _INFINITE, as the plugin creates its contexts
+	struct DepthConvention
+	{
+		bool inverted = true;
+		bool infinite = true;
+		float cameraNear = 0.1f;
+		float cameraFar = 100000.0f;  // Ignored when infinite
+	};
+
+	// Capture planes are half floats (depth R16, motion vectors R16G16) or floats
+	void HalfToFloat(std::span<const uint16_t> a_half, std::span<float> a_float);
+
+	// View-space distance per pixel
+	void LinearizeDepth(Image<const float> a_depth, Image<float> a_linear, const DepthConvention& a_convention);
+
+	// Every pixel takes the motion vector of its nearest neighbour in 3x3 (largest depth when inverted),
+	// keeping thin foreground edges moving with the foreground. Border pixels use the pixels that exist.
+	void DilateMotionVectors(Image<const float> a_depth, Image<const Vec2> a_motionVectors, Image<Vec2> a_dilated, bool a_inverted);
+
+	struct ReprojectionParams
+	{
+		// motionVectorScale as dispatched (width, height): the previous position of a pixel is
+		// position + mv * scale - jitterDelta, in pixels
+		float motionVectorScaleX = 0.0f;
+		float motionVectorScaleY = 0.0f;
+		// Jitter the motion vectors still contain (jitter cancellation), zero if they contain none
+		float jitterDeltaX = 0.0f;
+		float jitterDeltaY = 0.0f;
+		// A pixel counts as disoccluded when all four previous pixels around its reprojected position
+		// were closer than its own linear depth by this fraction
+		float disocclusionThreshold = 0.05f;
+	};
+
+	enum MaskValue : uint8_t
+	{
+		kValid = 0,
+		kDisoccluded = 1,
+		kOffscreen = 2
+	};
+
+	struct ReprojectionStats
+	{
+		double meanError = 0.0;  // Over valid pixels
+		float maxError = 0.0f;
+		uint64_t validPixels = 0;
+		uint64_t disoccludedPixels = 0;
+		uint64_t offscreenPixels = 0;
+	};
+
+	struct ReprojectionInputs
+	{
+		Image<const float> luma;              // Frame being checked
+		Image<const float> linearDepth;
+		Image<const Vec2> motionVectors;      // Usually dilated
+		Image<const float> previousLuma;      // Frame before it, same size
+		Image<const float> previousLinearDepth;
+	};
+
+	// Warps the previous frame by the motion vectors and compares it with this one. a_error (absolute
+	// luma difference, 0 where not valid) and a_mask are optional; pass empty images to skip them.
+	ReprojectionStats Reproject(const ReprojectionInputs& a_inputs, const ReprojectionParams& a_params, Image<float> a_error = {}, Image<uint8_t> a_mask = {});
+}
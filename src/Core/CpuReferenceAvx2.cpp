@@ -0,0 +1,289 @@
+#include "CpuReferenceKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#	include <algorithm>
+#	include <bit>
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	endif
+
+// Only the kernels are compiled for AVX2, so nothing inlined from other headers ends up needing it.
+// FMA stays off: fused multiply-adds would round differently from the scalar reference.
+#	if defined(__GNUC__) || defined(__clang__)
+#		define CPU_REFERENCE_AVX2 __attribute__((target("avx2,f16c")))
+#	else
+#		define CPU_REFERENCE_AVX2
+#	endif
+
+namespace CpuReference::Kernels
+{
+	namespace
+	{
+		bool Avx2Supported()
+		{
+#	if defined(__GNUC__) || defined(__clang__)
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#	else
+			int info[4];
+			__cpuid(info, 1);
+			bool f16c = info[2] & (1 << 29);
+			bool osxsave = info[2] & (1 << 27);
+			if (!f16c || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return info[1] & (1 << 5);
+#	endif
+		}
+
+		CPU_REFERENCE_AVX2 void HalfToFloatAvx2(const uint16_t* a_half, float* a_float, size_t a_count)
+		{
+			size_t i = 0;
+			for (; i + 8 <= a_count; i += 8)
+				_mm256_storeu_ps(a_float + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a_half + i))));
+			HalfToFloatScalar(a_half + i, a_float + i, a_count - i);
+		}
+
+		CPU_REFERENCE_AVX2 void LinearizeAvx2(const float* a_depth, float* a_linear, size_t a_count, const LinearizeCoefficients& a_coefficients)
+		{
+			__m256 a = _mm256_set1_ps(a_coefficients.a);
+			__m256 p = _mm256_set1_ps(a_coefficients.p);
+			__m256 q = _mm256_set1_ps(a_coefficients.q);
+			size_t i = 0;
+			for (; i + 8 <= a_count; i += 8) {
+				__m256 depth = _mm256_loadu_ps(a_depth + i);
+				_mm256_storeu_ps(a_linear + i, _mm256_div_ps(a, _mm256_add_ps(p, _mm256_mul_ps(q, depth))));
+			}
+			LinearizeScalar(a_depth + i, a_linear + i, a_count - i, a_coefficients);
+		}
+
+		CPU_REFERENCE_AVX2 void NearestDepthAvx2(const float* const a_rows[3], uint32_t a_width, uint32_t a_begin, uint32_t a_end, bool a_inverted, uint8_t* a_index)
+		{
+			// The first and last columns clamp their neighbours, the rest load them directly
+			uint32_t x = std::max(a_begin, 1u);
+			NearestDepthScalar(a_rows, a_width, a_begin, std::min(x, a_end), a_inverted, a_index);
+
+			alignas(32) int32_t indices[8];
+			for (; x + 8 <= a_end && x + 8 < a_width; x += 8) {
+				__m256 best = _mm256_loadu_ps(a_rows[1] + x);
+				__m256i bestIndex = _mm256_set1_epi32(4);
+				for (uint8_t index : kNeighbourOrder) {
+					__m256 depth = _mm256_loadu_ps(a_rows[index / 3] + x + index % 3 - 1);
+					__m256 nearer = a_inverted ? _mm256_cmp_ps(depth, best, _CMP_GT_OQ) : _mm256_cmp_ps(depth, best, _CMP_LT_OQ);
+					best = _mm256_blendv_ps(best, depth, nearer);
+					bestIndex = _mm256_blendv_epi8(bestIndex, _mm256_set1_epi32(index), _mm256_castps_si256(nearer));
+				}
+				_mm256_store_si256(reinterpret_cast<__m256i*>(indices), bestIndex);
+				for (int lane = 0; lane < 8; lane++)
+					a_index[x + lane] = uint8_t(indices[lane]);
+			}
+			NearestDepthScalar(a_rows, a_width, x, a_end, a_inverted, a_index);
+		}
+
+		CPU_REFERENCE_AVX2 __m256 LoadX(const Vec2* a_pairs, __m256* a_y)
+		{
+			// x0 y0 x1 y1 x2 y2 x3 y3 | x4 y4 ... to x0..x7 and y0..y7
+			__m256 low = _mm256_loadu_ps(&a_pairs[0].x);
+			__m256 high = _mm256_loadu_ps(&a_pairs[4].x);
+			__m256 xs = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+			__m256 ys = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+			*a_y = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(ys), _MM_SHUFFLE(3, 1, 2, 0)));
+			return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(xs), _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		CPU_REFERENCE_AVX2 void ReprojectAvx2(const ReprojectRow& a_row, RowStats& a_stats)
+		{
+			auto& inputs = *a_row.inputs;
+			auto& params = *a_row.params;
+			uint32_t width = inputs.luma.width;
+			uint32_t height = inputs.luma.height;
+
+			auto luma = inputs.luma.Row(a_row.y);
+			auto depth = inputs.linearDepth.Row(a_row.y);
+			auto motionVectors = inputs.motionVectors.Row(a_row.y);
+
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 widthF = _mm256_set1_ps(float(width));
+			const __m256 heightF = _mm256_set1_ps(float(height));
+			const __m256 scaleX = _mm256_set1_ps(params.motionVectorScaleX);
+			const __m256 scaleY = _mm256_set1_ps(params.motionVectorScaleY);
+			const __m256 jitterX = _mm256_set1_ps(params.jitterDeltaX);
+			const __m256 jitterY = _mm256_set1_ps(params.jitterDeltaY);
+			const __m256 keep = _mm256_set1_ps(a_row.keep);
+			const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+			const __m256i lastX = _mm256_set1_epi32(int32_t(width) - 1);
+			const __m256i lastY = _mm256_set1_epi32(int32_t(height) - 1);
+			const __m256i zeroI = _mm256_setzero_si256();
+			const __m256i lumaStride = _mm256_set1_epi32(int32_t(inputs.previousLuma.stride));
+			const __m256i depthStride = _mm256_set1_epi32(int32_t(inputs.previousLinearDepth.stride));
+			const __m256 fy = _mm256_set1_ps(float(a_row.y) + 0.5f);
+			const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+
+			__m256 errorSum = zero;
+			__m256 errorMax = zero;
+			alignas(32) int32_t masks[8];
+
+			uint32_t x = a_row.begin;
+			for (; x + 8 <= a_row.end; x += 8) {
+				__m256 mvY;
+				__m256 mvX = LoadX(motionVectors + x, &mvY);
+				__m256 px = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(float(x)), laneOffsets), _mm256_mul_ps(mvX, scaleX)), jitterX);
+				__m256 py = _mm256_sub_ps(_mm256_add_ps(fy, _mm256_mul_ps(mvY, scaleY)), jitterY);
+
+				// Ordered compares, so NaN positions are offscreen like in the scalar code
+				__m256 onscreen = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(px, zero, _CMP_GE_OQ), _mm256_cmp_ps(px, widthF, _CMP_LT_OQ)),
+					_mm256_and_ps(_mm256_cmp_ps(py, zero, _CMP_GE_OQ), _mm256_cmp_ps(py, heightF, _CMP_LT_OQ)));
+
+				__m256 sx = _mm256_sub_ps(px, half);
+				__m256 sy = _mm256_sub_ps(py, half);
+				__m256 x0f = _mm256_floor_ps(sx);
+				__m256 y0f = _mm256_floor_ps(sy);
+				__m256 wx = _mm256_sub_ps(sx, x0f);
+				__m256 wy = _mm256_sub_ps(sy, y0f);
+				// Off screen lanes convert to anything; the clamp keeps their gathers inside the image
+				__m256i x0i = _mm256_cvttps_epi32(_mm256_blendv_ps(zero, x0f, onscreen));
+				__m256i y0i = _mm256_cvttps_epi32(_mm256_blendv_ps(zero, y0f, onscreen));
+				__m256i x0 = _mm256_min_epi32(_mm256_max_epi32(x0i, zeroI), lastX);
+				__m256i x1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(x0i, _mm256_set1_epi32(1)), zeroI), lastX);
+				__m256i y0 = _mm256_min_epi32(_mm256_max_epi32(y0i, zeroI), lastY);
+				__m256i y1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(y0i, _mm256_set1_epi32(1)), zeroI), lastY);
+
+				__m256i depthRow0 = _mm256_mullo_epi32(y0, depthStride);
+				__m256i depthRow1 = _mm256_mullo_epi32(y1, depthStride);
+				__m256 z00 = _mm256_i32gather_ps(inputs.previousLinearDepth.data, _mm256_add_epi32(depthRow0, x0), 4);
+				__m256 z10 = _mm256_i32gather_ps(inputs.previousLinearDepth.data, _mm256_add_epi32(depthRow0, x1), 4);
+				__m256 z01 = _mm256_i32gather_ps(inputs.previousLinearDepth.data, _mm256_add_epi32(depthRow1, x0), 4);
+				__m256 z11 = _mm256_i32gather_ps(inputs.previousLinearDepth.data, _mm256_add_epi32(depthRow1, x1), 4);
+				__m256 previousDepth = _mm256_max_ps(_mm256_max_ps(z00, z10), _mm256_max_ps(z01, z11));
+				__m256 disoccluded = _mm256_and_ps(onscreen, _mm256_cmp_ps(previousDepth, _mm256_mul_ps(_mm256_loadu_ps(depth + x), keep), _CMP_LT_OQ));
+				__m256 valid = _mm256_andnot_ps(disoccluded, onscreen);
+
+				__m256i lumaRow0 = _mm256_mullo_epi32(y0, lumaStride);
+				__m256i lumaRow1 = _mm256_mullo_epi32(y1, lumaStride);
+				__m256 l00 = _mm256_i32gather_ps(inputs.previousLuma.data, _mm256_add_epi32(lumaRow0, x0), 4);
+				__m256 l10 = _mm256_i32gather_ps(inputs.previousLuma.data, _mm256_add_epi32(lumaRow0, x1), 4);
+				__m256 l01 = _mm256_i32gather_ps(inputs.previousLuma.data, _mm256_add_epi32(lumaRow1, x0), 4);
+				__m256 l11 = _mm256_i32gather_ps(inputs.previousLuma.data, _mm256_add_epi32(lumaRow1, x1), 4);
+				__m256 gx = _mm256_sub_ps(one, wx);
+				__m256 gy = _mm256_sub_ps(one, wy);
+				__m256 top = _mm256_add_ps(_mm256_mul_ps(l00, gx), _mm256_mul_ps(l10, wx));
+				__m256 bottom = _mm256_add_ps(_mm256_mul_ps(l01, gx), _mm256_mul_ps(l11, wx));
+				__m256 previous = _mm256_add_ps(_mm256_mul_ps(top, gy), _mm256_mul_ps(bottom, wy));
+				__m256 error = _mm256_and_ps(valid, _mm256_and_ps(absMask, _mm256_sub_ps(_mm256_loadu_ps(luma + x), previous)));
+
+				errorSum = _mm256_add_ps(errorSum, error);
+				errorMax = _mm256_max_ps(errorMax, error);
+
+				int validBits = _mm256_movemask_ps(valid);
+				int disoccludedBits = _mm256_movemask_ps(disoccluded);
+				a_stats.valid += std::popcount(uint32_t(validBits));
+				a_stats.disoccluded += std::popcount(uint32_t(disoccludedBits));
+				a_stats.offscreen += 8 - std::popcount(uint32_t(_mm256_movemask_ps(onscreen)));
+
+				if (a_row.error)
+					_mm256_storeu_ps(a_row.error + x, error);
+				if (a_row.mask) {
+					// kOffscreen, kDisoccluded or kValid
+					__m256i mask = _mm256_blendv_epi8(_mm256_set1_epi32(kOffscreen), _mm256_set1_epi32(kDisoccluded), _mm256_castps_si256(disoccluded));
+					mask = _mm256_andnot_si256(_mm256_castps_si256(valid), mask);
+					_mm256_store_si256(reinterpret_cast<__m256i*>(masks), mask);
+					for (int lane = 0; lane < 8; lane++)
+						a_row.mask[x + lane] = uint8_t(masks[lane]);
+				}
+			}
+
+			alignas(32) float lanes[8];
+			_mm256_store_ps(lanes, errorSum);
+			double sum = 0.0;
+			for (float lane : lanes)
+				sum += lane;
+			_mm256_store_ps(lanes, errorMax);
+			for (float lane : lanes)
+				a_stats.maxError = std::max(a_stats.maxError, lane);
+			a_stats.errorSum += sum;
+
+			ReprojectRow rest = a_row;
+			rest.begin = x;
+			ReprojectScalar(rest, a_stats);
+		}
+
+		CPU_REFERENCE_AVX2 float HorizontalSum(__m256 a_value)
+		{
+			__m128 sum = _mm_add_ps(_mm256_castps256_ps128(a_value), _mm256_extractf128_ps(a_value, 1));
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+			return _mm_cvtss_f32(sum);
+		}
+
+		CPU_REFERENCE_AVX2 double SquaredErrorAvx2(const float* a_a, const float* a_b, size_t a_count)
+		{
+			__m256 sum = _mm256_setzero_ps();
+			size_t i = 0;
+			for (; i + 8 <= a_count; i += 8) {
+				__m256 difference = _mm256_sub_ps(_mm256_loadu_ps(a_a + i), _mm256_loadu_ps(a_b + i));
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(difference, difference));
+			}
+			return double(HorizontalSum(sum)) + SquaredErrorScalar(a_a + i, a_b + i, a_count - i);
+		}
+
+		CPU_REFERENCE_AVX2 double TemporalErrorAvx2(const float* a_test, const float* a_testPrevious, const float* a_reference, const float* a_referencePrevious, size_t a_count)
+		{
+			const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+			__m256 sum = _mm256_setzero_ps();
+			size_t i = 0;
+			for (; i + 8 <= a_count; i += 8) {
+				__m256 test = _mm256_sub_ps(_mm256_loadu_ps(a_test + i), _mm256_loadu_ps(a_testPrevious + i));
+				__m256 reference = _mm256_sub_ps(_mm256_loadu_ps(a_reference + i), _mm256_loadu_ps(a_referencePrevious + i));
+				sum = _mm256_add_ps(sum, _mm256_and_ps(absMask, _mm256_sub_ps(test, reference)));
+			}
+			return double(HorizontalSum(sum)) + TemporalErrorScalar(a_test + i, a_testPrevious + i, a_reference + i, a_referencePrevious + i, a_count - i);
+		}
+
+		CPU_REFERENCE_AVX2 void SsimRowAvx2(const float* a_a, size_t a_strideA, const float* a_b, size_t a_strideB, uint32_t a_width, SsimSums& a_sums)
+		{
+			// One window row is one register
+			for (uint32_t x = 0; x + kSsimWindow <= a_width; x += kSsimStep) {
+				__m256 sumA = _mm256_setzero_ps();
+				__m256 sumB = _mm256_setzero_ps();
+				__m256 sumAA = _mm256_setzero_ps();
+				__m256 sumBB = _mm256_setzero_ps();
+				__m256 sumAB = _mm256_setzero_ps();
+				for (uint32_t y = 0; y < kSsimWindow; y++) {
+					__m256 a = _mm256_loadu_ps(a_a + y * a_strideA + x);
+					__m256 b = _mm256_loadu_ps(a_b + y * a_strideB + x);
+					sumA = _mm256_add_ps(sumA, a);
+					sumB = _mm256_add_ps(sumB, b);
+					sumAA = _mm256_add_ps(sumAA, _mm256_mul_ps(a, a));
+					sumBB = _mm256_add_ps(sumBB, _mm256_mul_ps(b, b));
+					sumAB = _mm256_add_ps(sumAB, _mm256_mul_ps(a, b));
+				}
+				a_sums.ssim += SsimFromSums(HorizontalSum(sumA), HorizontalSum(sumB), HorizontalSum(sumAA), HorizontalSum(sumBB), HorizontalSum(sumAB));
+				a_sums.windows++;
+			}
+		}
+
+		const Table kAvx2Table = { HalfToFloatAvx2, LinearizeAvx2, NearestDepthAvx2, ReprojectAvx2, SquaredErrorAvx2, TemporalErrorAvx2, SsimRowAvx2 };
+	}
+
+	const Table* GetAvx2Table()
+	{
+		static const bool supported = Avx2Supported();
+		return supported ? &kAvx2Table : nullptr;
+	}
+}
+
+#else
+
+namespace CpuReference::Kernels
+{
+	const Table* GetAvx2Table()
+	{
+		return nullptr;
+	}
+}
+
+#endif
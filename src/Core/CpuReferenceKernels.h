@@ -0,0 +1,103 @@
+#pragma once
+
+#include <functional>
+
+#include "CpuReference.h"
+
+// Row kernels behind CpuReference, one table per instruction set. The SIMD versions handle the bulk
+// of a row and call the scalar ones for the remainder. Results must match the scalar kernels exactly,
+// except where sums are accumulated in a different order.
+namespace CpuReference::Kernels
+{
+	// Depth to view distance as a / (p + q * depth), covering inverted and infinite projections
+	struct LinearizeCoefficients
+	{
+		float a;
+		float p;
+		float q;
+	};
+
+	struct ReprojectRow
+	{
+		const ReprojectionInputs* inputs;
+		const ReprojectionParams* params;
+		float keep;  // 1 - disocclusionThreshold
+		uint32_t y;
+		uint32_t begin;
+		uint32_t end;
+		float* error;    // Null to skip
+		uint8_t* mask;   // Null to skip
+	};
+
+	struct RowStats
+	{
+		double errorSum = 0.0;
+		float maxError = 0.0f;
+		uint64_t valid = 0;
+		uint64_t disoccluded = 0;
+		uint64_t offscreen = 0;
+	};
+
+	// SSIM over 8x8 windows every 4 pixels, window sums accumulated in float
+	struct SsimSums
+	{
+		double ssim = 0.0;
+		uint64_t windows = 0;
+	};
+
+	inline constexpr uint32_t kSsimWindow = 8;
+	inline constexpr uint32_t kSsimStep = 4;
+
+	// Standard constants for a dynamic range of 1
+	inline double SsimFromSums(float a_sumA, float a_sumB, float a_sumAA, float a_sumBB, float a_sumAB)
+	{
+		constexpr double kCount = double(kSsimWindow * kSsimWindow);
+		constexpr double kC1 = 0.01 * 0.01;
+		constexpr double kC2 = 0.03 * 0.03;
+		double meanA = a_sumA / kCount;
+		double meanB = a_sumB / kCount;
+		double varianceA = a_sumAA / kCount - meanA * meanA;
+		double varianceB = a_sumBB / kCount - meanB * meanB;
+		double covariance = a_sumAB / kCount - meanA * meanB;
+		return ((2.0 * meanA * meanB + kC1) * (2.0 * covariance + kC2)) / ((meanA * meanA + meanB * meanB + kC1) * (varianceA + varianceB + kC2));
+	}
+
+	// Neighbour index of the nearest depth, (dy + 1) * 3 + (dx + 1); rows are y - 1, y, y + 1 clamped
+	using NearestDepthFn = void (*)(const float* const a_rows[3], uint32_t a_width, uint32_t a_begin, uint32_t a_end, bool a_inverted, uint8_t* a_index);
+
+	struct Table
+	{
+		void (*halfToFloat)(const uint16_t* a_half, float* a_float, size_t a_count);
+		void (*linearize)(const float* a_depth, float* a_linear, size_t a_count, const LinearizeCoefficients& a_coefficients);
+		NearestDepthFn nearestDepth;
+		void (*reproject)(const ReprojectRow& a_row, RowStats& a_stats);
+		double (*squaredError)(const float* a_a, const float* a_b, size_t a_count);
+		// Sum of |(test - testPrevious) - (reference - referencePrevious)|
+		double (*temporalError)(const float* a_test, const float* a_testPrevious, const float* a_reference, const float* a_referencePrevious, size_t a_count);
+		// Windows at x = 0, kSsimStep, ... of the 8 rows starting at a_a and a_b
+		void (*ssimRow)(const float* a_a, size_t a_strideA, const float* a_b, size_t a_strideB, uint32_t a_width, SsimSums& a_sums);
+	};
+
+	void HalfToFloatScalar(const uint16_t* a_half, float* a_float, size_t a_count);
+	void LinearizeScalar(const float* a_depth, float* a_linear, size_t a_count, const LinearizeCoefficients& a_coefficients);
+	void NearestDepthScalar(const float* const a_rows[3], uint32_t a_width, uint32_t a_begin, uint32_t a_end, bool a_inverted, uint8_t* a_index);
+	void ReprojectScalar(const ReprojectRow& a_row, RowStats& a_stats);
+	double SquaredErrorScalar(const float* a_a, const float* a_b, size_t a_count);
+	double TemporalErrorScalar(const float* a_test, const float* a_testPrevious, const float* a_reference, const float* a_referencePrevious, size_t a_count);
+	void SsimRowScalar(const float* a_a, size_t a_strideA, const float* a_b, size_t a_strideB, uint32_t a_width, SsimSums& a_sums);
+
+	extern const Table kScalar;
+	// Null when not compiled in or not supported by this CPU
+	const Table* GetAvx2Table();
+	const Table* GetNeonTable();
+	// The one GetIsa() selects
+	const Table& GetTable();
+
+	// Splits a_rows into bands of kBandRows handed out to the threads in turn; a_work gets the band
+	// index for per-band results
+	inline constexpr uint32_t kBandRows = 32;
+	void ForEachBand(uint32_t a_rows, const std::function<void(uint32_t, uint32_t, uint32_t)>& a_work);
+
+	// Candidate order shared by all versions, so ties resolve the same way: centre first
+	inline constexpr uint8_t kNeighbourOrder[9] = { 4, 0, 1, 2, 3, 5, 6, 7, 8 };
+}
@@ -0,0 +1,124 @@
+#include "CpuReferenceKernels.h"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#	include <algorithm>
+#	include <arm_neon.h>
+
+namespace CpuReference::Kernels
+{
+	namespace
+	{
+		void HalfToFloatNeon(const uint16_t* a_half, float* a_float, size_t a_count)
+		{
+			size_t i = 0;
+			for (; i + 4 <= a_count; i += 4)
+				vst1q_f32(a_float + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(a_half + i))));
+			HalfToFloatScalar(a_half + i, a_float + i, a_count - i);
+		}
+
+		void LinearizeNeon(const float* a_depth, float* a_linear, size_t a_count, const LinearizeCoefficients& a_coefficients)
+		{
+			float32x4_t a = vdupq_n_f32(a_coefficients.a);
+			float32x4_t p = vdupq_n_f32(a_coefficients.p);
+			float32x4_t q = vdupq_n_f32(a_coefficients.q);
+			size_t i = 0;
+			for (; i + 4 <= a_count; i += 4) {
+				float32x4_t depth = vld1q_f32(a_depth + i);
+				vst1q_f32(a_linear + i, vdivq_f32(a, vaddq_f32(p, vmulq_f32(q, depth))));
+			}
+			LinearizeScalar(a_depth + i, a_linear + i, a_count - i, a_coefficients);
+		}
+
+		void NearestDepthNeon(const float* const a_rows[3], uint32_t a_width, uint32_t a_begin, uint32_t a_end, bool a_inverted, uint8_t* a_index)
+		{
+			uint32_t x = std::max(a_begin, 1u);
+			NearestDepthScalar(a_rows, a_width, a_begin, std::min(x, a_end), a_inverted, a_index);
+
+			for (; x + 4 <= a_end && x + 4 < a_width; x += 4) {
+				float32x4_t best = vld1q_f32(a_rows[1] + x);
+				uint32x4_t bestIndex = vdupq_n_u32(4);
+				for (uint8_t index : kNeighbourOrder) {
+					float32x4_t depth = vld1q_f32(a_rows[index / 3] + x + index % 3 - 1);
+					uint32x4_t nearer = a_inverted ? vcgtq_f32(depth, best) : vcltq_f32(depth, best);
+					best = vbslq_f32(nearer, depth, best);
+					bestIndex = vbslq_u32(nearer, vdupq_n_u32(index), bestIndex);
+				}
+				a_index[x] = uint8_t(vgetq_lane_u32(bestIndex, 0));
+				a_index[x + 1] = uint8_t(vgetq_lane_u32(bestIndex, 1));
+				a_index[x + 2] = uint8_t(vgetq_lane_u32(bestIndex, 2));
+				a_index[x + 3] = uint8_t(vgetq_lane_u32(bestIndex, 3));
+			}
+			NearestDepthScalar(a_rows, a_width, x, a_end, a_inverted, a_index);
+		}
+
+		double SquaredErrorNeon(const float* a_a, const float* a_b, size_t a_count)
+		{
+			float32x4_t sum = vdupq_n_f32(0.0f);
+			size_t i = 0;
+			for (; i + 4 <= a_count; i += 4) {
+				float32x4_t difference = vsubq_f32(vld1q_f32(a_a + i), vld1q_f32(a_b + i));
+				sum = vaddq_f32(sum, vmulq_f32(difference, difference));
+			}
+			return double(vaddvq_f32(sum)) + SquaredErrorScalar(a_a + i, a_b + i, a_count - i);
+		}
+
+		double TemporalErrorNeon(const float* a_test, const float* a_testPrevious, const float* a_reference, const float* a_referencePrevious, size_t a_count)
+		{
+			float32x4_t sum = vdupq_n_f32(0.0f);
+			size_t i = 0;
+			for (; i + 4 <= a_count; i += 4) {
+				float32x4_t test = vsubq_f32(vld1q_f32(a_test + i), vld1q_f32(a_testPrevious + i));
+				float32x4_t reference = vsubq_f32(vld1q_f32(a_reference + i), vld1q_f32(a_referencePrevious + i));
+				sum = vaddq_f32(sum, vabdq_f32(test, reference));
+			}
+			return double(vaddvq_f32(sum)) + TemporalErrorScalar(a_test + i, a_testPrevious + i, a_reference + i, a_referencePrevious + i, a_count - i);
+		}
+
+		void SsimRowNeon(const float* a_a, size_t a_strideA, const float* a_b, size_t a_strideB, uint32_t a_width, SsimSums& a_sums)
+		{
+			for (uint32_t x = 0; x + kSsimWindow <= a_width; x += kSsimStep) {
+				float32x4_t sumA = vdupq_n_f32(0.0f);
+				float32x4_t sumB = sumA;
+				float32x4_t sumAA = sumA;
+				float32x4_t sumBB = sumA;
+				float32x4_t sumAB = sumA;
+				for (uint32_t y = 0; y < kSsimWindow; y++) {
+					auto rowA = a_a + y * a_strideA + x;
+					auto rowB = a_b + y * a_strideB + x;
+					for (uint32_t half = 0; half < kSsimWindow; half += 4) {
+						float32x4_t a = vld1q_f32(rowA + half);
+						float32x4_t b = vld1q_f32(rowB + half);
+						sumA = vaddq_f32(sumA, a);
+						sumB = vaddq_f32(sumB, b);
+						sumAA = vaddq_f32(sumAA, vmulq_f32(a, a));
+						sumBB = vaddq_f32(sumBB, vmulq_f32(b, b));
+						sumAB = vaddq_f32(sumAB, vmulq_f32(a, b));
+					}
+				}
+				a_sums.ssim += SsimFromSums(vaddvq_f32(sumA), vaddvq_f32(sumB), vaddvq_f32(sumAA), vaddvq_f32(sumBB), vaddvq_f32(sumAB));
+				a_sums.windows++;
+			}
+		}
+
+		// NEON has no gather; the bilinear fetches of the reprojection stay scalar
+		const Table kNeonTable = { HalfToFloatNeon, LinearizeNeon, NearestDepthNeon, ReprojectScalar, SquaredErrorNeon, TemporalErrorNeon, SsimRowNeon };
+	}
+
+	const Table* GetNeonTable()
+	{
+		return &kNeonTable;
+	}
+}
+
+#else
+
+namespace CpuReference::Kernels
+{
+	const Table* GetNeonTable()
+	{
+		return nullptr;
+	}
+}
+
+#endif
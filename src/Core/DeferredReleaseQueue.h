@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+
+// Holds objects the GPU may still reference and frees them once a timeline fence reached the value
+// recorded at enqueue time. Drained opportunistically (once per Present), so releasing resources never
+// needs a pipeline flush. Not thread-safe, use it from the render thread.
+//
+// FenceQuery must provide: uint64_t CompletedValue() const
+template <class FenceQuery>
+class DeferredReleaseQueue
+{
+public:
+	struct Metrics
+	{
+		size_t depth = 0;           // Entries waiting for their fence
+		uint64_t bytesPending = 0;  // Estimated memory held by those entries
+		size_t peakDepth = 0;
+		uint64_t peakBytesPending = 0;
+		uint64_t released = 0;  // Total entries freed
+		uint64_t bytesReleased = 0;
+	};
+
+	explicit DeferredReleaseQueue(FenceQuery a_fence = {}) :
+		fence(std::move(a_fence)) {}
+
+	~DeferredReleaseQueue() { ReleaseAll(); }
+
+	DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+	DeferredReleaseQueue& operator=(const DeferredReleaseQueue&) = delete;
+
+	// Frees a_release once the fence reaches a_fenceValue
+	void Enqueue(uint64_t a_fenceValue, std::function<void()> a_release, uint64_t a_bytes = 0)
+	{
+		Entry entry{ a_fenceValue, a_bytes, std::move(a_release) };
+		// Values normally arrive in order; keep the queue sorted if one does not
+		auto position = std::upper_bound(entries.begin(), entries.end(), a_fenceValue, [](uint64_t a_value, const Entry& a_entry) {
+			return a_value < a_entry.fenceValue;
+		});
+		entries.insert(position, std::move(entry));
+
+		metrics.depth = entries.size();
+		metrics.bytesPending += a_bytes;
+		metrics.peakDepth = std::max(metrics.peakDepth, metrics.depth);
+		metrics.peakBytesPending = std::max(metrics.peakBytesPending, metrics.bytesPending);
+	}
+
+	template <class T>
+	void EnqueueDelete(uint64_t a_fenceValue, T* a_object, uint64_t a_bytes = 0)
+	{
+		if (a_object)
+			Enqueue(a_fenceValue, [a_object]() { delete a_object; }, a_bytes);
+	}
+
+	// Frees every entry whose fence value was reached, returns how many were freed
+	size_t Drain()
+	{
+		if (entries.empty())
+			return 0;
+		return ReleaseUpTo(fence.CompletedValue());
+	}
+
+	// Frees everything regardless of the fence. Only valid once the GPU is idle.
+	size_t ReleaseAll() { return ReleaseUpTo(UINT64_MAX); }
+
+	const Metrics& GetMetrics() const { return metrics; }
+	bool IsEmpty() const { return entries.empty(); }
+
+	FenceQuery& GetFence() { return fence; }
+
+private:
+	struct Entry
+	{
+		uint64_t fenceValue;
+		uint64_t bytes;
+		std::function<void()> release;
+	};
+
+	size_t ReleaseUpTo(uint64_t a_completed)
+	{
+		size_t count = 0;
+		while (!entries.empty() && entries.front().fenceValue <= a_completed) {
+			// Pop first, a release callback may enqueue more
+			Entry entry = std::move(entries.front());
+			entries.pop_front();
+			if (entry.release)
+				entry.release();
+			metrics.bytesPending -= entry.bytes;
+			metrics.bytesReleased += entry.bytes;
+			metrics.released++;
+			count++;
+		}
+		metrics.depth = entries.size();
+		return count;
+	}
+
+	FenceQuery fence;
+	std::deque<Entry> entries;
+	Metrics metrics;
+};
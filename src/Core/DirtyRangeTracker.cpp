@@ -0,0 +1,69 @@
+#include "DirtyRangeTracker.h"
+
+#include <algorithm>
+
+DirtyRangeTracker::DirtyRangeTracker(uint32_t a_size, uint32_t a_copies, uint32_t a_mergeGap) :
+	size(a_size), mergeGap(a_mergeGap), copies(std::max(a_copies, 1u))
+{
+}
+
+void DirtyRangeTracker::Mark(uint32_t a_begin, uint32_t a_count)
+{
+	if (a_begin >= size || a_count == 0)
+		return;
+
+	Range range{ a_begin, a_begin + std::min(a_count, size - a_begin) };
+	for (auto& ranges : copies)
+		Insert(ranges, range, mergeGap);
+}
+
+void DirtyRangeTracker::MarkAll()
+{
+	for (auto& ranges : copies) {
+		ranges.clear();
+		if (size)
+			ranges.push_back({ 0, size });
+	}
+}
+
+bool DirtyRangeTracker::IsFullyDirty(uint32_t a_copy) const
+{
+	auto& ranges = copies[a_copy];
+	return ranges.size() == 1 && ranges[0].begin == 0 && ranges[0].end == size;
+}
+
+uint32_t DirtyRangeTracker::DirtyCount(uint32_t a_copy) const
+{
+	uint32_t count = 0;
+	for (auto& range : copies[a_copy])
+		count += range.Count();
+	return count;
+}
+
+std::vector<DirtyRangeTracker::Range> DirtyRangeTracker::Take(uint32_t a_copy)
+{
+	std::vector<Range> taken;
+	taken.swap(copies[a_copy]);
+	return taken;
+}
+
+void DirtyRangeTracker::Insert(std::vector<Range>& a_ranges, Range a_range, uint32_t a_mergeGap)
+{
+	// First range that could touch the new one, then absorb everything up to its end
+	auto first = std::lower_bound(a_ranges.begin(), a_ranges.end(), a_range, [a_mergeGap](const Range& a_existing, const Range& a_new) {
+		return uint64_t(a_existing.end) + a_mergeGap < a_new.begin;
+	});
+	auto last = first;
+	while (last != a_ranges.end() && last->begin <= uint64_t(a_range.end) + a_mergeGap) {
+		a_range.begin = std::min(a_range.begin, last->begin);
+		a_range.end = std::max(a_range.end, last->end);
+		++last;
+	}
+	first = a_ranges.erase(first, last);
+	a_ranges.insert(first, a_range);
+
+	if (a_ranges.size() > kMaxRanges) {
+		Range bounds{ a_ranges.front().begin, a_ranges.back().end };
+		a_ranges.assign(1, bounds);
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tracks which elements of a CPU side copy changed and still have to reach each of a_copies GPU copies.
+// A change is marked for every copy; uploading one copy takes and clears only its own ranges, so a
+// buffer streamed through N copies uploads exactly what changed since that copy was last written.
+// Ranges are kept sorted and merged, and collapse into their bounding range past kMaxRanges.
+class DirtyRangeTracker
+{
+public:
+	static constexpr size_t kMaxRanges = 16;
+
+	struct Range
+	{
+		uint32_t begin = 0;
+		uint32_t end = 0;  // Exclusive
+
+		uint32_t Count() const { return end - begin; }
+		bool operator==(const Range&) const = default;
+	};
+
+	DirtyRangeTracker() = default;
+	// Ranges closer than a_mergeGap elements are merged; uploading a few clean elements is cheaper than another call
+	DirtyRangeTracker(uint32_t a_size, uint32_t a_copies, uint32_t a_mergeGap = 0);
+
+	// Clamped to the tracked size
+	void Mark(uint32_t a_begin, uint32_t a_count);
+	void MarkAll();
+
+	bool IsDirty(uint32_t a_copy) const { return !copies[a_copy].empty(); }
+	bool IsFullyDirty(uint32_t a_copy) const;
+	uint32_t DirtyCount(uint32_t a_copy) const;
+	const std::vector<Range>& Peek(uint32_t a_copy) const { return copies[a_copy]; }
+
+	// Returns the ranges a copy is missing and marks it up to date
+	std::vector<Range> Take(uint32_t a_copy);
+
+	uint32_t GetSize() const { return size; }
+	uint32_t GetCopyCount() const { return (uint32_t)copies.size(); }
+
+private:
+	static void Insert(std::vector<Range>& a_ranges, Range a_range, uint32_t a_mergeGap);
+
+	uint32_t size = 0;
+	uint32_t mergeGap = 0;
+	std::vector<std::vector<Range>> copies;
+};
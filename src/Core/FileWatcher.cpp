@@ -0,0 +1,147 @@
+#include "FileWatcher.h"
+
+#if defined(_WIN32)
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <Windows.h>
+#elif defined(__linux__)
+#	include <poll.h>
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	// How often the worker wakes up to check for Stop() while no change arrives
+	constexpr int kWakeIntervalMs = 250;
+}
+
+FileWatcher::Stamp FileWatcher::ReadStamp(const std::filesystem::path& a_file)
+{
+	Stamp stamp;
+	std::error_code ec;
+	if (!std::filesystem::exists(a_file, ec) || ec)
+		return stamp;
+	stamp.writeTime = std::filesystem::last_write_time(a_file, ec);
+	if (ec)
+		return stamp;
+	stamp.size = std::filesystem::file_size(a_file, ec);
+	if (ec)
+		return stamp;
+	stamp.exists = true;
+	return stamp;
+}
+
+bool FileWatcher::Start(const std::filesystem::path& a_file, Callback a_onChanged, std::chrono::milliseconds a_debounce)
+{
+	if (running.load())
+		return false;
+
+	file = a_file;
+	onChanged = std::move(a_onChanged);
+	debounce = a_debounce;
+	IgnoreCurrentState();
+
+	auto directory = file.parent_path();
+	if (directory.empty())
+		directory = ".";
+
+#if defined(_WIN32)
+	HANDLE handle = FindFirstChangeNotificationW(directory.wstring().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+	notifyHandle = handle == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<intptr_t>(handle);
+#elif defined(__linux__)
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd >= 0 && inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MODIFY) < 0) {
+		close(fd);
+		fd = -1;
+	}
+	notifyHandle = fd;
+#endif
+
+	stopRequested.store(false);
+	running.store(true);
+	worker = std::thread(&FileWatcher::Run, this);
+	return true;
+}
+
+void FileWatcher::Stop()
+{
+	if (!running.load())
+		return;
+
+	stopRequested.store(true);
+	if (worker.joinable())
+		worker.join();
+
+	if (notifyHandle != -1) {
+#if defined(_WIN32)
+		FindCloseChangeNotification(reinterpret_cast<HANDLE>(notifyHandle));
+#elif defined(__linux__)
+		close((int)notifyHandle);
+#endif
+		notifyHandle = -1;
+	}
+	running.store(false);
+}
+
+void FileWatcher::IgnoreCurrentState()
+{
+	auto stamp = ReadStamp(file);
+	std::lock_guard lock(stampLock);
+	lastStamp = stamp;
+}
+
+bool FileWatcher::WaitForChange()
+{
+	if (notifyHandle == -1) {
+		// Polling fallback: every wake-up is a candidate, CheckAndNotify filters by stamp
+		std::this_thread::sleep_for(std::chrono::milliseconds(kWakeIntervalMs * 2));
+		return true;
+	}
+
+#if defined(_WIN32)
+	auto handle = reinterpret_cast<HANDLE>(notifyHandle);
+	if (WaitForSingleObject(handle, kWakeIntervalMs) != WAIT_OBJECT_0)
+		return false;
+	FindNextChangeNotification(handle);
+	return true;
+#elif defined(__linux__)
+	pollfd pfd{ (int)notifyHandle, POLLIN, 0 };
+	if (poll(&pfd, 1, kWakeIntervalMs) <= 0 || !(pfd.revents & POLLIN))
+		return false;
+	// Drain all queued events, the stamp comparison decides whether our file changed
+	alignas(inotify_event) char buffer[4096];
+	while (read((int)notifyHandle, buffer, sizeof(buffer)) > 0) {}
+	return true;
+#else
+	return true;
+#endif
+}
+
+void FileWatcher::CheckAndNotify()
+{
+	auto stamp = ReadStamp(file);
+	{
+		std::lock_guard lock(stampLock);
+		if (stamp == lastStamp)
+			return;
+		lastStamp = stamp;
+	}
+	// A deleted file is remembered but does not trigger a reload
+	if (stamp.exists && onChanged)
+		onChanged();
+}
+
+void FileWatcher::Run()
+{
+	while (!stopRequested.load()) {
+		if (!WaitForChange())
+			continue;
+		// Let the writer finish before looking at the file
+		std::this_thread::sleep_for(debounce);
+		if (stopRequested.load())
+			break;
+		CheckAndNotify();
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Watches a single file on a background thread and invokes a callback after it changed.
+// Uses directory change notifications (FindFirstChangeNotification on Windows, inotify on Linux)
+// and falls back to polling elsewhere. Changes are debounced and confirmed against the file's
+// size and write time, so editors that save in several steps trigger one reload.
+class FileWatcher
+{
+public:
+	using Callback = std::function<void()>;
+
+	FileWatcher() = default;
+	~FileWatcher() { Stop(); }
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	bool Start(const std::filesystem::path& a_file, Callback a_onChanged, std::chrono::milliseconds a_debounce = std::chrono::milliseconds(200));
+	void Stop();
+
+	bool IsRunning() const { return running.load(); }
+
+	// Records the file's current state as already seen, e.g. after the plugin wrote it itself
+	void IgnoreCurrentState();
+
+private:
+	struct Stamp
+	{
+		std::filesystem::file_time_type writeTime{};
+		uintmax_t size = 0;
+		bool exists = false;
+
+		bool operator==(const Stamp&) const = default;
+	};
+
+	static Stamp ReadStamp(const std::filesystem::path& a_file);
+
+	void Run();
+	bool WaitForChange();  // Returns false when stopping
+	void CheckAndNotify();
+
+	std::filesystem::path file;
+	Callback onChanged;
+	std::chrono::milliseconds debounce{ 200 };
+
+	std::mutex stampLock;
+	Stamp lastStamp;
+
+	std::atomic<bool> running{ false };
+	std::atomic<bool> stopRequested{ false };
+	std::thread worker;
+
+	// Platform notification handle (directory change handle or inotify fd)
+	intptr_t notifyHandle = -1;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SeqLockSlot.h"
+
+// Per-frame values shared by the AA pass (ReplaceTAA -> DispatchAASync) and FG prepare (Present).
+// Captured once at Main_UpdateJitter so every stage of a frame sees identical, already clamped values.
+struct FrameContext
+{
+	// Raw values as read from the game, before any clamping
+	struct Inputs
+	{
+		uint64_t frameID = 0;
+		float deltaTimeSeconds = 0.0f;
+		float cameraNear = 0.0f;
+		float cameraFar = 0.0f;
+		float fovVerticalRad = 0.0f;
+		float projectionPosScaleX = 0.0f;
+		float projectionPosScaleY = 0.0f;
+		uint32_t width = 0;
+		uint32_t height = 0;
+
+		bool hasCamera = false;
+		float cameraPosition[3] = {};
+		float cameraRight[3] = {};
+		float cameraForward[3] = {};
+		float cameraUp[3] = {};
+	};
+
+	static constexpr float kDefaultDeltaTimeMs = 16.6f;
+	static constexpr float kDefaultCameraNear = 0.1f;
+	static constexpr float kDefaultCameraFar = 100000.0f;
+
+	uint64_t frameID = 0;  // FSR frame ID this snapshot was captured for, 0 if never captured
+	float deltaTimeMs = kDefaultDeltaTimeMs;
+	float cameraNear = kDefaultCameraNear;
+	float cameraFar = kDefaultCameraFar;
+	float fovVerticalRad = 0.0f;
+	float jitterX = 0.0f;  // Pixel-space jitter offset in FSR convention
+	float jitterY = 0.0f;
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	// Camera pose, defaults to identity orientation looking forward (+Y in Skyrim) at the origin
+	bool hasCamera = false;
+	float cameraPosition[3] = { 0.0f, 0.0f, 0.0f };
+	float cameraRight[3] = { 1.0f, 0.0f, 0.0f };
+	float cameraForward[3] = { 0.0f, 1.0f, 0.0f };
+	float cameraUp[3] = { 0.0f, 0.0f, 1.0f };
+
+	// Set by the SceneCutDetector when history from the previous frame must be discarded
+	bool sceneCut = false;
+
+	// Set by the StaticFrameDetector: the image has not changed, so the frame reuses the previous AA
+	// output and skips the copies and the FG prepare
+	bool staticFrame = false;
+	uint32_t jitterPhase = 0;
+
+	bool IsValid() const { return frameID != 0 && width != 0 && height != 0; }
+
+	static FrameContext Make(const Inputs& a_in)
+	{
+		FrameContext ctx;
+		ctx.frameID = a_in.frameID;
+		ctx.width = a_in.width;
+		ctx.height = a_in.height;
+
+		// Invalid deltaTime (<= 0) indicates game pause/loading, fall back to 60fps
+		ctx.deltaTimeMs = a_in.deltaTimeSeconds * 1000.0f;
+		if (!(ctx.deltaTimeMs > 0.0f))
+			ctx.deltaTimeMs = kDefaultDeltaTimeMs;
+
+		ctx.cameraNear = a_in.cameraNear;
+		ctx.cameraFar = a_in.cameraFar;
+		if (!(ctx.cameraNear > 0.0f))
+			ctx.cameraNear = kDefaultCameraNear;
+		if (!(ctx.cameraFar > ctx.cameraNear))
+			ctx.cameraFar = kDefaultCameraFar;
+
+		ctx.fovVerticalRad = a_in.fovVerticalRad > 0.0f ? a_in.fovVerticalRad : 0.0f;
+
+		// projectionPosScale is the NDC offset written by UpdateJitter, convert back to pixels
+		ctx.jitterX = a_in.projectionPosScaleX * (float)a_in.width / 2.0f;
+		ctx.jitterY = a_in.projectionPosScaleY * (float)a_in.height / 2.0f;
+
+		if (a_in.hasCamera) {
+			ctx.hasCamera = true;
+			for (int i = 0; i < 3; i++) {
+				ctx.cameraPosition[i] = a_in.cameraPosition[i];
+				ctx.cameraRight[i] = a_in.cameraRight[i];
+				ctx.cameraForward[i] = a_in.cameraForward[i];
+				ctx.cameraUp[i] = a_in.cameraUp[i];
+			}
+		}
+		return ctx;
+	}
+};
+
+using FrameContextSlot = SeqLockSlot<FrameContext>;
@@ -0,0 +1,58 @@
+#include "FrameCostRecorder.h"
+
+#include <algorithm>
+
+const FrameCostRecorder::Report& FrameCostRecorder::EndFrame()
+{
+	last = {};
+	last.frame = frames++;
+	for (size_t i = 0; i < kCounterCount; i++) {
+		auto count = current[i].exchange(0, std::memory_order_relaxed);
+		last.counts[i] = count;
+		peak[i] = std::max(peak[i], count);
+		if (budget[i] != kUnlimited && count > budget[i])
+			last.overBudget |= 1u << i;
+	}
+	if (last.overBudget)
+		framesOverBudget++;
+	return last;
+}
+
+const char* FrameCostRecorder::Name(Counter a_counter)
+{
+	switch (a_counter) {
+	case Counter::kCopy11:
+		return "copy11";
+	case Counter::kCopy12:
+		return "copy12";
+	case Counter::kDispatch11:
+		return "dispatch11";
+	case Counter::kFfxDispatch:
+		return "ffxDispatch";
+	case Counter::kBarrier12:
+		return "barrier12";
+	case Counter::kExecute12:
+		return "execute12";
+	case Counter::kQueueWait:
+		return "queueWait";
+	case Counter::kCpuWait:
+		return "cpuWait";
+	default:
+		return "unknown";
+	}
+}
+
+std::string FrameCostRecorder::Describe(const Report& a_report) const
+{
+	std::string text;
+	for (size_t i = 0; i < kCounterCount; i++) {
+		if (!(a_report.overBudget & (1u << i)))
+			continue;
+		if (!text.empty())
+			text += ", ";
+		text += Name(Counter(i));
+		text += ' ';
+		text += std::to_string(a_report.counts[i]) + "/" + std::to_string(budget[i]);
+	}
+	return text;
+}
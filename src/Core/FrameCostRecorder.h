@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Counts the copies, dispatches, barriers and waits the plugin records per presented frame and checks
+// them against budgets, so a change that adds a full-screen copy or a blocking wait shows up in the
+// log rather than only as lost frame time. Add() is a relaxed atomic increment; EndFrame() runs once
+// per Present on the render thread.
+class FrameCostRecorder
+{
+public:
+	enum class Counter : uint8_t
+	{
+		kCopy11,          // D3D11 full resource copies
+		kCopy12,          // D3D12 full resource copies
+		kDispatch11,      // Plugin compute dispatches on D3D11
+		kFfxDispatch,     // AA and FG prepare dispatches
+		kBarrier12,       // ResourceBarrier calls
+		kExecute12,       // ExecuteCommandLists calls
+		kQueueWait,       // GPU side waits between D3D11 and D3D12, the CPU keeps going
+		kCpuWait,         // The render thread blocks
+		kCount
+	};
+
+	static constexpr size_t kCounterCount = size_t(Counter::kCount);
+	static constexpr uint32_t kUnlimited = UINT32_MAX;
+
+	using Counts = std::array<uint32_t, kCounterCount>;
+
+	// What a frame with AA and frame generation records today
+	static constexpr Counts kDefaultBudget = {
+		4,  // HUDLess and motion vector copies in, AA result copied back, tile hash readback
+		1,  // Shared back buffer to the swap chain
+		2,  // Depth copy, tile hash
+		2,  // AA, FG prepare
+		3,  // Back buffer copy in and out, AA output
+		2,  // AA, Present
+		4,  // Both directions around the AA dispatch and around Present
+		0,
+	};
+
+	struct Report
+	{
+		uint64_t frame = 0;
+		Counts counts{};
+		uint32_t overBudget = 0;  // Bit per Counter
+	};
+
+	void Add(Counter a_counter, uint32_t a_amount = 1) { current[size_t(a_counter)].fetch_add(a_amount, std::memory_order_relaxed); }
+
+	// Closes the frame and starts the next one
+	const Report& EndFrame();
+
+	void SetBudget(const Counts& a_budget) { budget = a_budget; }
+	const Counts& GetBudget() const { return budget; }
+	const Report& GetLastFrame() const { return last; }
+	const Counts& GetPeak() const { return peak; }
+	uint64_t FramesOverBudget() const { return framesOverBudget; }
+
+	static const char* Name(Counter a_counter);
+	std::string Describe(const Report& a_report) const;  // Counters over budget, "copy11 4/3, cpuWait 1/0"
+
+private:
+	std::array<std::atomic<uint32_t>, kCounterCount> current{};
+	Counts budget = kDefaultBudget;
+	Counts peak{};
+	Report last;
+	uint64_t frames = 0;
+	uint64_t framesOverBudget = 0;
+};
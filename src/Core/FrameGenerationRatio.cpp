@@ -0,0 +1,46 @@
+#include "FrameGenerationRatio.h"
+
+#include <algorithm>
+
+uint32_t FrameGenerationRatio::Fit(float a_baseFps, float a_refreshHz, float a_fill, uint32_t a_maxGenerated)
+{
+	uint32_t maxGenerated = std::max(a_maxGenerated, 1u);
+	if (!(a_baseFps > 0.0f) || !(a_refreshHz > 0.0f))
+		return 1;
+
+	uint32_t generated = 1;
+	while (generated < maxGenerated && a_baseFps * float(generated + 2) <= a_refreshHz * a_fill)
+		generated++;
+	return generated;
+}
+
+uint32_t FrameGenerationRatio::Update(uint32_t a_requested, uint32_t a_supported, float a_baseFps, float a_refreshHz, double a_timeSeconds)
+{
+	uint32_t supported = std::clamp(a_supported, 1u, kMaxGeneratedFrames);
+
+	// A fixed ratio applies at once, only limited by the backend
+	if (a_requested != 0) {
+		generatedFrames = std::min(a_requested, supported);
+		changedSeconds = -1.0;
+		return generatedFrames;
+	}
+
+	generatedFrames = std::min(generatedFrames, supported);
+
+	uint32_t target = Fit(a_baseFps, a_refreshHz, config.refreshFill, supported);
+	if (target > generatedFrames)
+		target = std::max(Fit(a_baseFps, a_refreshHz, config.refreshFill - config.raiseHeadroom, supported), generatedFrames);
+
+	bool dwelled = changedSeconds < 0.0 || a_timeSeconds - changedSeconds >= config.minDwellSeconds;
+	if (target != generatedFrames && dwelled) {
+		generatedFrames = target;
+		changedSeconds = a_timeSeconds;
+	}
+	return generatedFrames;
+}
+
+void FrameGenerationRatio::Reset()
+{
+	generatedFrames = 1;
+	changedSeconds = -1.0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// How many frames are generated per real frame: 1 is 2x output, 3 is 4x. In auto mode the ratio is the
+// largest one whose output still fits under the refresh rate at the measured base frame rate, so a
+// 240 Hz panel at 70 fps base gets 3x instead of leaving half its refresh unused. Going up needs extra
+// headroom and every change has a minimum dwell time, going down is only held back by the dwell time.
+class FrameGenerationRatio
+{
+public:
+	static constexpr uint32_t kMaxGeneratedFrames = 3;
+
+	struct Config
+	{
+		float refreshFill = 0.95f;     // Share of the refresh rate the output may use
+		float raiseHeadroom = 0.1f;    // A higher ratio needs this much of the refresh rate to spare
+		float minDwellSeconds = 2.0f;
+	};
+
+	FrameGenerationRatio() = default;
+	explicit FrameGenerationRatio(const Config& a_config) :
+		config(a_config) {}
+
+	// a_requested is 0 for auto or a fixed number of generated frames, a_supported what the frame
+	// generation backend can present. a_baseFps or a_refreshHz of 0 (not measured yet) keep 2x.
+	uint32_t Update(uint32_t a_requested, uint32_t a_supported, float a_baseFps, float a_refreshHz, double a_timeSeconds);
+	void Reset();
+
+	uint32_t GetGeneratedFrames() const { return generatedFrames; }
+	const Config& GetConfig() const { return config; }
+
+	// Largest number of generated frames, at least 1, with a_baseFps * (n + 1) <= a_refreshHz * a_fill
+	static uint32_t Fit(float a_baseFps, float a_refreshHz, float a_fill, uint32_t a_maxGenerated);
+
+	// Real frame rate the limiter targets so that the output with a_generatedFrames matches a_outputHz
+	static double LimiterFrameRate(double a_outputHz, uint32_t a_generatedFrames) { return a_outputHz / double(a_generatedFrames + 1); }
+
+private:
+	Config config;
+	uint32_t generatedFrames = 1;
+	double changedSeconds = -1.0;
+};
@@ -0,0 +1,141 @@
+#include "HeapPlanner.h"
+
+#include <algorithm>
+#include <numeric>
+
+uint64_t HeapPlanner::AlignUp(uint64_t a_value, uint64_t a_alignment)
+{
+	if (a_alignment <= 1)
+		return a_value;
+	return (a_value + a_alignment - 1) & ~(a_alignment - 1);
+}
+
+bool HeapPlanner::LifetimesOverlap(const Request& a_a, const Request& a_b)
+{
+	return a_a.firstUse <= a_b.lastUse && a_b.firstUse <= a_a.lastUse;
+}
+
+uint64_t HeapPlanner::Plan::TotalBytes() const
+{
+	return std::accumulate(heapSizes.begin(), heapSizes.end(), uint64_t(0));
+}
+
+HeapPlanner::Plan HeapPlanner::Build(std::span<const Request> a_requests) const
+{
+	Plan plan;
+	plan.placements.resize(a_requests.size());
+
+	// Largest first keeps the heaps dense
+	std::vector<uint32_t> order;
+	for (uint32_t i = 0; i < (uint32_t)a_requests.size(); i++) {
+		if (a_requests[i].IsUsed()) {
+			order.push_back(i);
+			plan.requestedBytes += AlignUp(a_requests[i].size, a_requests[i].alignment);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a_l, uint32_t a_r) {
+		return a_requests[a_l].size > a_requests[a_r].size;
+	});
+
+	std::vector<std::vector<uint32_t>> heapContents;
+
+	for (uint32_t index : order) {
+		const auto& request = a_requests[index];
+		auto& placement = plan.placements[index];
+
+		for (uint32_t heap = 0; heap < (uint32_t)heapContents.size() && placement.heap == kUnused; heap++) {
+			// Ranges in this heap that must not be touched
+			std::vector<std::pair<uint64_t, uint64_t>> blocked;
+			for (uint32_t other : heapContents[heap]) {
+				if (!allowAliasing || LifetimesOverlap(request, a_requests[other])) {
+					uint64_t begin = plan.placements[other].offset;
+					blocked.push_back({ begin, begin + a_requests[other].size });
+				}
+			}
+			std::sort(blocked.begin(), blocked.end());
+
+			// First fit: try the start of the heap, then the end of every blocked range
+			uint64_t limit = std::max(maxHeapSize, plan.heapSizes[heap]);
+			uint64_t offset = 0;
+			for (const auto& range : blocked) {
+				if (offset + request.size <= range.first)
+					break;
+				offset = std::max(offset, AlignUp(range.second, request.alignment));
+			}
+			if (offset + request.size > limit)
+				continue;
+
+			placement.heap = heap;
+			placement.offset = offset;
+			heapContents[heap].push_back(index);
+			plan.heapSizes[heap] = std::max(plan.heapSizes[heap], offset + request.size);
+		}
+
+		if (placement.heap == kUnused) {
+			placement.heap = (uint32_t)heapContents.size();
+			placement.offset = 0;
+			heapContents.push_back({ index });
+			plan.heapSizes.push_back(request.size);
+		}
+	}
+
+	// Heaps are allocated in whole alignment units
+	for (auto& size : plan.heapSizes)
+		size = AlignUp(size, kDefaultAlignment);
+
+	// Record the last earlier user of shared memory so callers can place aliasing barriers
+	for (uint32_t index : order) {
+		auto& placement = plan.placements[index];
+		for (uint32_t other : heapContents[placement.heap]) {
+			if (other == index || LifetimesOverlap(a_requests[index], a_requests[other]))
+				continue;
+			uint64_t otherBegin = plan.placements[other].offset;
+			bool sharesMemory = placement.offset < otherBegin + a_requests[other].size && otherBegin < placement.offset + a_requests[index].size;
+			if (sharesMemory && a_requests[other].lastUse < a_requests[index].firstUse) {
+				if (placement.aliasOf < 0 || a_requests[placement.aliasOf].lastUse < a_requests[other].lastUse)
+					placement.aliasOf = (int32_t)other;
+			}
+		}
+	}
+
+	return plan;
+}
+
+bool HeapPlanner::Validate(std::span<const Request> a_requests, const Plan& a_plan, std::string* a_error)
+{
+	auto fail = [a_error](std::string a_message) {
+		if (a_error)
+			*a_error = std::move(a_message);
+		return false;
+	};
+
+	if (a_plan.placements.size() != a_requests.size())
+		return fail("placement count does not match request count");
+
+	for (size_t i = 0; i < a_requests.size(); i++) {
+		const auto& request = a_requests[i];
+		const auto& placement = a_plan.placements[i];
+		if (!request.IsUsed()) {
+			if (placement.heap != kUnused)
+				return fail(request.name + " is unused but placed");
+			continue;
+		}
+		if (placement.heap >= a_plan.heapSizes.size())
+			return fail(request.name + " has no heap");
+		if (AlignUp(placement.offset, request.alignment) != placement.offset)
+			return fail(request.name + " is misaligned");
+		if (placement.offset + request.size > a_plan.heapSizes[placement.heap])
+			return fail(request.name + " exceeds its heap");
+
+		for (size_t j = i + 1; j < a_requests.size(); j++) {
+			const auto& other = a_requests[j];
+			const auto& otherPlacement = a_plan.placements[j];
+			if (!other.IsUsed() || otherPlacement.heap != placement.heap || !LifetimesOverlap(request, other))
+				continue;
+			bool sharesMemory = placement.offset < otherPlacement.offset + other.size && otherPlacement.offset < placement.offset + request.size;
+			if (sharesMemory)
+				return fail(request.name + " and " + other.name + " are alive together but share memory");
+		}
+	}
+	return true;
+}
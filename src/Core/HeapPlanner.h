@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Places resources into heaps at aligned offsets. Resources whose lifetimes (inclusive ranges of pass
+// indices within a frame) do not overlap may share memory. Pure bookkeeping, no graphics API calls.
+struct HeapPlanner
+{
+	static constexpr uint64_t kDefaultAlignment = 64 * 1024;  // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+	static constexpr uint32_t kUnused = UINT32_MAX;
+
+	struct Request
+	{
+		std::string name;
+		uint64_t size = 0;
+		uint64_t alignment = kDefaultAlignment;  // Power of two
+		uint32_t firstUse = 0;                   // First pass that writes or reads the resource
+		uint32_t lastUse = 0;                    // Last pass, inclusive
+
+		bool IsUsed() const { return size != 0 && firstUse != kUnused; }
+	};
+
+	struct Placement
+	{
+		uint32_t heap = kUnused;  // kUnused when the request needs no memory
+		uint64_t offset = 0;
+		int32_t aliasOf = -1;  // A request sharing part of this memory earlier in the frame, -1 if none
+	};
+
+	struct Plan
+	{
+		std::vector<Placement> placements;  // Same order as the requests
+		std::vector<uint64_t> heapSizes;
+		uint64_t requestedBytes = 0;  // Sum of aligned sizes without aliasing
+
+		uint64_t TotalBytes() const;
+		uint64_t SavedBytes() const { return requestedBytes - TotalBytes(); }
+	};
+
+	uint64_t maxHeapSize = 256ull * 1024 * 1024;  // Larger requests get a heap of their own
+	bool allowAliasing = true;
+
+	Plan Build(std::span<const Request> a_requests) const;
+
+	// Checks alignment, heap bounds and that resources alive at the same time never share memory
+	static bool Validate(std::span<const Request> a_requests, const Plan& a_plan, std::string* a_error = nullptr);
+
+	static bool LifetimesOverlap(const Request& a_a, const Request& a_b);
+	static uint64_t AlignUp(uint64_t a_value, uint64_t a_alignment);
+};
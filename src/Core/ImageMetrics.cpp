@@ -0,0 +1,486 @@
+#include "ImageMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#include "CpuReferenceKernels.h"
+
+namespace ImageMetrics
+{
+	namespace
+	{
+		// DXGI_FORMAT values; Core does not include the Windows headers
+		enum Format : uint32_t
+		{
+			kR32G32B32A32Float = 2,
+			kR16G16B16A16Float = 10,
+			kR10G10B10A2Unorm = 24,
+			kR11G11B10Float = 26,
+			kR8G8B8A8Unorm = 28,
+			kR8G8B8A8UnormSrgb = 29,
+			kR32Float = 41,
+			kR16Float = 54,
+			kR8Unorm = 61,
+			kB8G8R8A8Unorm = 87,
+			kB8G8R8A8UnormSrgb = 91,
+		};
+
+		constexpr float kLumaR = 0.2126f;
+		constexpr float kLumaG = 0.7152f;
+		constexpr float kLumaB = 0.0722f;
+
+		uint32_t BytesPerPixel(uint32_t a_format)
+		{
+			switch (a_format) {
+			case kR32G32B32A32Float:
+				return 16;
+			case kR16G16B16A16Float:
+				return 8;
+			case kR10G10B10A2Unorm:
+			case kR11G11B10Float:
+			case kR8G8B8A8Unorm:
+			case kR8G8B8A8UnormSrgb:
+			case kR32Float:
+			case kB8G8R8A8Unorm:
+			case kB8G8R8A8UnormSrgb:
+				return 4;
+			case kR16Float:
+				return 2;
+			case kR8Unorm:
+				return 1;
+			default:
+				return 0;
+			}
+		}
+
+		// Unsigned 11 and 10-bit floats: 5 exponent bits, no sign
+		float SmallFloat(uint32_t a_bits, uint32_t a_mantissaBits)
+		{
+			uint32_t mantissa = a_bits & ((1u << a_mantissaBits) - 1);
+			uint32_t exponent = a_bits >> a_mantissaBits;
+			float fraction = float(mantissa) / float(1u << a_mantissaBits);
+			if (exponent == 0)
+				return std::ldexp(fraction, -14);
+			if (exponent == 31)
+				return mantissa ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+			return std::ldexp(1.0f + fraction, int(exponent) - 15);
+		}
+
+		bool Comparable(Image<const float> a_a, Image<const float> a_b)
+		{
+			return a_a.width == a_b.width && a_a.height == a_b.height && a_a.width && a_a.height;
+		}
+
+		// Luma of one frame of both captures; lives in the batch until its metrics are computed
+		struct DecodedFrame
+		{
+			uint64_t frameID = 0;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			std::vector<float> test;
+			std::vector<float> reference;
+			std::vector<uint8_t> scratch;
+			std::string error;
+
+			Image<const float> Test() const { return { test.data(), width, height, width }; }
+			Image<const float> Reference() const { return { reference.data(), width, height, width }; }
+		};
+
+		bool DecodePlane(const Capture::FrameView& a_frame, Capture::Plane a_plane, std::vector<uint8_t>& a_scratch, std::vector<float>& a_luma, const char* a_which, DecodedFrame& a_decoded)
+		{
+			auto plane = a_frame.Find(a_plane);
+			if (!plane) {
+				a_decoded.error = std::string(a_which) + " frame has no such plane";
+				return false;
+			}
+			auto& header = *plane->header;
+			if (a_decoded.width == 0) {
+				a_decoded.width = header.width;
+				a_decoded.height = header.height;
+			} else if (header.width != a_decoded.width || header.height != a_decoded.height) {
+				a_decoded.error = "frame sizes differ";
+				return false;
+			}
+
+			// Raw planes are read straight from the mapping
+			std::span<const uint8_t> pixels = plane->stored;
+			if (header.codec != Capture::Codec::kRaw) {
+				a_scratch.resize(size_t(header.rawBytes));
+				if (!Capture::Reader::ReadPlane(*plane, a_scratch)) {
+					a_decoded.error = std::string(a_which) + " plane does not decode";
+					return false;
+				}
+				pixels = a_scratch;
+			}
+
+			a_luma.resize(size_t(header.width) * header.height);
+			if (!ToLuma(header.format, pixels, header.rowBytes, { a_luma.data(), header.width, header.height, header.width })) {
+				a_decoded.error = std::string(a_which) + " plane format " + std::to_string(header.format) + " is not supported";
+				return false;
+			}
+			return true;
+		}
+
+		float At(Image<const float> a_image, int a_x, int a_y)
+		{
+			a_x = std::clamp(a_x, 0, int(a_image.width) - 1);
+			a_y = std::clamp(a_y, 0, int(a_image.height) - 1);
+			return a_image.Row(uint32_t(a_y))[a_x];
+		}
+
+		// Separable 1-4-6-4-1 binomial, close to a Gaussian of one pixel: detail below what the eye resolves
+		// at a normal viewing distance is averaged out before the difference is taken
+		void Blur(Image<const float> a_image, std::vector<float>& a_blurred)
+		{
+			constexpr float kWeights[5] = { 1.0f / 16, 4.0f / 16, 6.0f / 16, 4.0f / 16, 1.0f / 16 };
+			std::vector<float> rows(size_t(a_image.width) * a_image.height);
+			for (uint32_t y = 0; y < a_image.height; y++) {
+				for (uint32_t x = 0; x < a_image.width; x++) {
+					float sum = 0.0f;
+					for (int i = 0; i < 5; i++)
+						sum += kWeights[i] * At(a_image, int(x) + i - 2, int(y));
+					rows[size_t(y) * a_image.width + x] = sum;
+				}
+			}
+
+			Image<const float> horizontal{ rows.data(), a_image.width, a_image.height, a_image.width };
+			a_blurred.resize(rows.size());
+			for (uint32_t y = 0; y < a_image.height; y++) {
+				for (uint32_t x = 0; x < a_image.width; x++) {
+					float sum = 0.0f;
+					for (int i = 0; i < 5; i++)
+						sum += kWeights[i] * At(horizontal, int(x), int(y) + i - 2);
+					a_blurred[size_t(y) * a_image.width + x] = sum;
+				}
+			}
+		}
+
+		// Sobel gradient and Laplacian magnitudes, both scaled to [0, 1] for luma in [0, 1]
+		void Features(Image<const float> a_image, int a_x, int a_y, float& a_edge, float& a_point)
+		{
+			float p[3][3];
+			for (int j = 0; j < 3; j++) {
+				for (int i = 0; i < 3; i++)
+					p[j][i] = At(a_image, a_x + i - 1, a_y + j - 1);
+			}
+			float gx = (p[0][2] + 2.0f * p[1][2] + p[2][2]) - (p[0][0] + 2.0f * p[1][0] + p[2][0]);
+			float gy = (p[2][0] + 2.0f * p[2][1] + p[2][2]) - (p[0][0] + 2.0f * p[0][1] + p[0][2]);
+			float laplacian = p[0][1] + p[1][0] + p[1][2] + p[2][1] - 4.0f * p[1][1];
+			a_edge = std::min(std::sqrt(gx * gx + gy * gy) / 4.0f, 1.0f);
+			a_point = std::min(std::abs(laplacian) / 4.0f, 1.0f);
+		}
+
+		bool Within(double a_value, double a_limit, bool a_minimum)
+		{
+			if (a_limit == 0.0 || std::isnan(a_value))
+				return true;
+			return a_minimum ? a_value >= a_limit : a_value <= a_limit;
+		}
+	}
+
+	double MeanSquaredError(Image<const float> a_test, Image<const float> a_reference)
+	{
+		if (!Comparable(a_test, a_reference))
+			return std::numeric_limits<double>::quiet_NaN();
+
+		std::vector<double> bands((a_test.height + CpuReference::Kernels::kBandRows - 1) / CpuReference::Kernels::kBandRows);
+		auto& table = CpuReference::Kernels::GetTable();
+		CpuReference::Kernels::ForEachBand(a_test.height, [&](uint32_t a_begin, uint32_t a_end, uint32_t a_band) {
+			for (uint32_t y = a_begin; y < a_end; y++)
+				bands[a_band] += table.squaredError(a_test.Row(y), a_reference.Row(y), a_test.width);
+		});
+
+		double sum = 0.0;
+		for (double band : bands)
+			sum += band;
+		return sum / (double(a_test.width) * a_test.height);
+	}
+
+	double Psnr(double a_meanSquaredError)
+	{
+		if (a_meanSquaredError <= 0.0)
+			return std::numeric_limits<double>::infinity();
+		return -10.0 * std::log10(a_meanSquaredError);
+	}
+
+	double Ssim(Image<const float> a_test, Image<const float> a_reference)
+	{
+		using CpuReference::Kernels::kSsimStep;
+		using CpuReference::Kernels::kSsimWindow;
+		if (!Comparable(a_test, a_reference) || a_test.width < kSsimWindow || a_test.height < kSsimWindow)
+			return std::numeric_limits<double>::quiet_NaN();
+
+		// Window rows at y = 0, kSsimStep, ... split into bands
+		uint32_t windowRows = (a_test.height - kSsimWindow) / kSsimStep + 1;
+		std::vector<CpuReference::Kernels::SsimSums> bands((windowRows + CpuReference::Kernels::kBandRows - 1) / CpuReference::Kernels::kBandRows);
+		auto& table = CpuReference::Kernels::GetTable();
+		CpuReference::Kernels::ForEachBand(windowRows, [&](uint32_t a_begin, uint32_t a_end, uint32_t a_band) {
+			for (uint32_t row = a_begin; row < a_end; row++)
+				table.ssimRow(a_test.Row(row * kSsimStep), a_test.stride, a_reference.Row(row * kSsimStep), a_reference.stride, a_test.width, bands[a_band]);
+		});
+
+		double sum = 0.0;
+		uint64_t windows = 0;
+		for (auto& band : bands) {
+			sum += band.ssim;
+			windows += band.windows;
+		}
+		return sum / double(windows);
+	}
+
+	double Flicker(Image<const float> a_test, Image<const float> a_testPrevious, Image<const float> a_reference, Image<const float> a_referencePrevious)
+	{
+		if (!Comparable(a_test, a_testPrevious) || !Comparable(a_test, a_reference) || !Comparable(a_test, a_referencePrevious))
+			return std::numeric_limits<double>::quiet_NaN();
+
+		std::vector<double> bands((a_test.height + CpuReference::Kernels::kBandRows - 1) / CpuReference::Kernels::kBandRows);
+		auto& table = CpuReference::Kernels::GetTable();
+		CpuReference::Kernels::ForEachBand(a_test.height, [&](uint32_t a_begin, uint32_t a_end, uint32_t a_band) {
+			for (uint32_t y = a_begin; y < a_end; y++)
+				bands[a_band] += table.temporalError(a_test.Row(y), a_testPrevious.Row(y), a_reference.Row(y), a_referencePrevious.Row(y), a_test.width);
+		});
+
+		double sum = 0.0;
+		for (double band : bands)
+			sum += band;
+		return sum / (double(a_test.width) * a_test.height);
+	}
+
+	double Flip(Image<const float> a_test, Image<const float> a_reference)
+	{
+		if (!Comparable(a_test, a_reference) || a_test.width < 3 || a_test.height < 3)
+			return std::numeric_limits<double>::quiet_NaN();
+
+		std::vector<float> testBlurred;
+		std::vector<float> referenceBlurred;
+		Blur(a_test, testBlurred);
+		Blur(a_reference, referenceBlurred);
+
+		std::vector<double> bands((a_test.height + CpuReference::Kernels::kBandRows - 1) / CpuReference::Kernels::kBandRows);
+		CpuReference::Kernels::ForEachBand(a_test.height, [&](uint32_t a_begin, uint32_t a_end, uint32_t a_band) {
+			for (uint32_t y = a_begin; y < a_end; y++) {
+				for (uint32_t x = 0; x < a_test.width; x++) {
+					size_t index = size_t(y) * a_test.width + x;
+					// FLIP compresses the colour difference with an exponent of 0.7
+					float color = std::pow(std::min(std::abs(testBlurred[index] - referenceBlurred[index]), 1.0f), 0.7f);
+
+					float testEdge, testPoint, referenceEdge, referencePoint;
+					Features(a_test, int(x), int(y), testEdge, testPoint);
+					Features(a_reference, int(x), int(y), referenceEdge, referencePoint);
+					float feature = std::sqrt(std::max(std::abs(testEdge - referenceEdge), std::abs(testPoint - referencePoint)) / std::sqrt(2.0f));
+
+					bands[a_band] += std::pow(color, 1.0f - feature);
+				}
+			}
+		});
+
+		double sum = 0.0;
+		for (double band : bands)
+			sum += band;
+		return sum / (double(a_test.width) * a_test.height);
+	}
+
+	bool ToLuma(uint32_t a_format, std::span<const uint8_t> a_pixels, uint32_t a_rowBytes, Image<float> a_luma)
+	{
+		uint32_t bytesPerPixel = BytesPerPixel(a_format);
+		if (!bytesPerPixel || a_rowBytes < a_luma.width * bytesPerPixel || a_pixels.size() < size_t(a_rowBytes) * a_luma.height)
+			return false;
+
+		std::vector<float> halves;
+		for (uint32_t y = 0; y < a_luma.height; y++) {
+			const uint8_t* row = a_pixels.data() + size_t(y) * a_rowBytes;
+			float* out = a_luma.Row(y);
+			for (uint32_t x = 0; x < a_luma.width; x++) {
+				const uint8_t* pixel = row + size_t(x) * bytesPerPixel;
+				uint32_t packed = 0;
+				std::memcpy(&packed, pixel, std::min(bytesPerPixel, 4u));
+				switch (a_format) {
+				case kR8G8B8A8Unorm:
+				case kR8G8B8A8UnormSrgb:
+					out[x] = (kLumaR * pixel[0] + kLumaG * pixel[1] + kLumaB * pixel[2]) / 255.0f;
+					break;
+				case kB8G8R8A8Unorm:
+				case kB8G8R8A8UnormSrgb:
+					out[x] = (kLumaR * pixel[2] + kLumaG * pixel[1] + kLumaB * pixel[0]) / 255.0f;
+					break;
+				case kR10G10B10A2Unorm:
+					out[x] = (kLumaR * float(packed & 0x3ff) + kLumaG * float((packed >> 10) & 0x3ff) + kLumaB * float((packed >> 20) & 0x3ff)) / 1023.0f;
+					break;
+				case kR11G11B10Float:
+					out[x] = kLumaR * SmallFloat(packed & 0x7ff, 6) + kLumaG * SmallFloat((packed >> 11) & 0x7ff, 6) + kLumaB * SmallFloat(packed >> 22, 5);
+					break;
+				case kR32G32B32A32Float:
+				{
+					float rgb[3];
+					std::memcpy(rgb, pixel, sizeof(rgb));
+					out[x] = kLumaR * rgb[0] + kLumaG * rgb[1] + kLumaB * rgb[2];
+					break;
+				}
+				case kR32Float:
+					std::memcpy(&out[x], pixel, sizeof(float));
+					break;
+				case kR8Unorm:
+					out[x] = pixel[0] / 255.0f;
+					break;
+				default:
+					break;  // Half formats below, a row at a time
+				}
+			}
+
+			if (a_format == kR16G16B16A16Float || a_format == kR16Float) {
+				uint32_t channels = bytesPerPixel / 2;
+				halves.resize(size_t(a_luma.width) * channels);
+				CpuReference::HalfToFloat({ reinterpret_cast<const uint16_t*>(row), halves.size() }, halves);
+				for (uint32_t x = 0; x < a_luma.width; x++) {
+					const float* pixel = halves.data() + size_t(x) * channels;
+					out[x] = channels == 1 ? pixel[0] : kLumaR * pixel[0] + kLumaG * pixel[1] + kLumaB * pixel[2];
+				}
+			}
+		}
+		return true;
+	}
+
+	Report CompareCaptures(const std::filesystem::path& a_test, const std::filesystem::path& a_reference, const Thresholds& a_thresholds, Capture::Plane a_plane)
+	{
+		Report report;
+		Capture::Reader test;
+		Capture::Reader reference;
+		std::string error;
+		if (!test.Open(a_test, &error)) {
+			report.error = a_test.string() + ": " + error;
+			return report;
+		}
+		if (!reference.Open(a_reference, &error)) {
+			report.error = a_reference.string() + ": " + error;
+			return report;
+		}
+		if (test.FrameCount() != reference.FrameCount()) {
+			report.error = "frame counts differ (" + std::to_string(test.FrameCount()) + " and " + std::to_string(reference.FrameCount()) + ")";
+			return report;
+		}
+		if (test.FrameCount() == 0) {
+			report.error = "no frames";
+			return report;
+		}
+
+		// Frames are decoded a batch at a time, one thread each; the metrics of a frame split it into bands.
+		// The last frame of a batch is kept for the flicker of the next one.
+		size_t batch = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+		std::vector<DecodedFrame> frames(batch);
+		DecodedFrame previous;
+		bool hasPrevious = false;
+
+		double squaredErrorSum = 0.0;
+		double ssimSum = 0.0;
+		double flickerSum = 0.0;
+		size_t flickerCount = 0;
+		double flipSum = 0.0;
+		report.minPsnr = std::numeric_limits<double>::infinity();
+		report.minSsim = std::numeric_limits<double>::infinity();
+
+		for (size_t start = 0; start < test.FrameCount(); start += batch) {
+			size_t count = std::min(batch, test.FrameCount() - start);
+			auto decode = [&](size_t a_slot) {
+				auto& frame = frames[a_slot];
+				auto& testFrame = test.GetFrame(start + a_slot);
+				frame.frameID = testFrame.info->frameID;
+				frame.width = 0;
+				frame.height = 0;
+				frame.error.clear();
+				DecodePlane(testFrame, a_plane, frame.scratch, frame.test, "test", frame) &&
+					DecodePlane(reference.GetFrame(start + a_slot), a_plane, frame.scratch, frame.reference, "reference", frame);
+			};
+
+			std::vector<std::thread> workers;
+			for (size_t slot = 1; slot < count; slot++)
+				workers.emplace_back(decode, slot);
+			decode(0);
+			for (auto& worker : workers)
+				worker.join();
+
+			for (size_t slot = 0; slot < count; slot++) {
+				auto& frame = frames[slot];
+				if (!frame.error.empty()) {
+					report.error = "frame " + std::to_string(start + slot) + ": " + frame.error;
+					report.passed = false;
+					return report;
+				}
+
+				FrameResult result;
+				result.frameID = frame.frameID;
+				double meanSquaredError = MeanSquaredError(frame.Test(), frame.Reference());
+				result.psnr = Psnr(meanSquaredError);
+				result.ssim = Ssim(frame.Test(), frame.Reference());
+				result.flicker = hasPrevious && previous.width == frame.width && previous.height == frame.height ?
+				                     Flicker(frame.Test(), previous.Test(), frame.Reference(), previous.Reference()) :
+				                     std::numeric_limits<double>::quiet_NaN();
+				result.flip = Flip(frame.Test(), frame.Reference());
+				result.passed = Within(result.psnr, a_thresholds.minPsnr, true) && Within(result.ssim, a_thresholds.minSsim, true) &&
+				                Within(result.flicker, a_thresholds.maxFlicker, false) && Within(result.flip, a_thresholds.maxFlip, false);
+
+				squaredErrorSum += meanSquaredError;
+				report.minPsnr = std::min(report.minPsnr, result.psnr);
+				if (!std::isnan(result.ssim)) {
+					ssimSum += result.ssim;
+					report.minSsim = std::min(report.minSsim, result.ssim);
+				}
+				if (!std::isnan(result.flicker)) {
+					flickerSum += result.flicker;
+					flickerCount++;
+					report.maxFlicker = std::max(report.maxFlicker, result.flicker);
+				}
+				if (!std::isnan(result.flip)) {
+					flipSum += result.flip;
+					report.maxFlip = std::max(report.maxFlip, result.flip);
+				}
+				if (!result.passed)
+					report.failedFrames++;
+				report.frames.push_back(result);
+			}
+
+			std::swap(previous, frames[count - 1]);
+			hasPrevious = true;
+		}
+
+		double frameCount = double(report.frames.size());
+		report.psnr = Psnr(squaredErrorSum / frameCount);
+		report.meanSsim = ssimSum / frameCount;
+		report.meanFlicker = flickerCount ? flickerSum / double(flickerCount) : 0.0;
+		report.meanFlip = flipSum / frameCount;
+		report.passed = report.failedFrames == 0;
+		return report;
+	}
+
+	std::string Summarize(const Report& a_report)
+	{
+		if (!a_report.error.empty())
+			return "FAIL: " + a_report.error + "\n";
+
+		char line[256];
+		std::string text;
+		std::snprintf(line, sizeof(line), "%zu frames, PSNR %.2f dB (min %.2f), SSIM %.4f (min %.4f), flicker %.5f (max %.5f), FLIP %.4f (max %.4f)\n",
+			a_report.frames.size(), a_report.psnr, a_report.minPsnr, a_report.meanSsim, a_report.minSsim, a_report.meanFlicker, a_report.maxFlicker,
+			a_report.meanFlip, a_report.maxFlip);
+		text += line;
+
+		size_t listed = 0;
+		for (auto& frame : a_report.frames) {
+			if (frame.passed)
+				continue;
+			if (listed++ == 10) {
+				text += "  ...\n";
+				break;
+			}
+			std::snprintf(line, sizeof(line), "  frame %llu: PSNR %.2f dB, SSIM %.4f, flicker %.5f, FLIP %.4f\n",
+				(unsigned long long)frame.frameID, frame.psnr, frame.ssim, frame.flicker, frame.flip);
+			text += line;
+		}
+
+		text += a_report.passed ? "PASS\n" : "FAIL: " + std::to_string(a_report.failedFrames) + " frames over the limits\n";
+		return text;
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "CaptureFile.h"
+#include "CpuReference.h"
+
+// Image quality of a captured sequence against a reference capture, so changes to sharpness, the jitter
+// sequence or the reset heuristics can be judged by numbers and gated, not only by eye. Metrics run on
+// luma as stored (sRGB encoded for 8-bit formats) with a peak of 1, on the CpuReference kernels.
+namespace ImageMetrics
+{
+	using CpuReference::Image;
+
+	double MeanSquaredError(Image<const float> a_test, Image<const float> a_reference);
+	// Infinite for identical images
+	double Psnr(double a_meanSquaredError);
+	// Mean over 8x8 windows every 4 pixels; NaN for images smaller than one window
+	double Ssim(Image<const float> a_test, Image<const float> a_reference);
+	// Mean |test change - reference change| between consecutive frames: shimmer the reference does not have
+	double Flicker(Image<const float> a_test, Image<const float> a_testPrevious, Image<const float> a_reference, Image<const float> a_referencePrevious);
+	// Mean per-pixel error in [0, 1] after the FLIP recipe, reduced to luma: a blurred difference stands in for
+	// the contrast sensitivity filtered colour term and is raised to 1 - edge and point difference, so errors
+	// on structure weigh more than the same change in a flat area. NaN below 3x3.
+	double Flip(Image<const float> a_test, Image<const float> a_reference);
+
+	// Rec. 709 luma of tightly packed rows; false for a DXGI format it does not know
+	bool ToLuma(uint32_t a_format, std::span<const uint8_t> a_pixels, uint32_t a_rowBytes, Image<float> a_luma);
+
+	// A frame fails when any metric is past its limit; zero disables a limit
+	struct Thresholds
+	{
+		double minPsnr = 30.0;
+		double minSsim = 0.9;
+		double maxFlicker = 0.02;
+		double maxFlip = 0.1;
+	};
+
+	struct FrameResult
+	{
+		uint64_t frameID = 0;
+		double psnr = 0.0;
+		double ssim = 0.0;
+		double flicker = 0.0;  // NaN for the first frame
+		double flip = 0.0;
+		bool passed = false;
+	};
+
+	struct Report
+	{
+		std::vector<FrameResult> frames;
+		double psnr = 0.0;  // Of the mean squared error over all frames
+		double minPsnr = 0.0;
+		double meanSsim = 0.0;
+		double minSsim = 0.0;
+		double meanFlicker = 0.0;
+		double maxFlicker = 0.0;
+		double meanFlip = 0.0;
+		double maxFlip = 0.0;
+		uint32_t failedFrames = 0;
+		bool passed = false;
+		std::string error;  // Files unreadable or not comparable; passed is false
+	};
+
+	// Frames are matched by index and must have the same size. Memory stays bounded however long the
+	// sequences are: a few frames are decoded at a time, in parallel, and the files are mapped.
+	Report CompareCaptures(const std::filesystem::path& a_test, const std::filesystem::path& a_reference, const Thresholds& a_thresholds = {}, Capture::Plane a_plane = Capture::Plane::kColor);
+
+	// A few lines for a CI log
+	std::string Summarize(const Report& a_report);
+}
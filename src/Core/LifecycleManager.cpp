@@ -0,0 +1,159 @@
+#include "LifecycleManager.h"
+
+LifecycleManager::FeatureID LifecycleManager::Register(std::string a_name, Callbacks a_callbacks)
+{
+	Feature feature;
+	feature.name = std::move(a_name);
+	feature.callbacks = std::move(a_callbacks);
+	features.push_back(std::move(feature));
+	return (FeatureID)(features.size() - 1);
+}
+
+void LifecycleManager::SetDesired(FeatureID a_id, bool a_desired)
+{
+	auto& feature = features[a_id];
+	if (feature.desired == a_desired)
+		return;
+	feature.desired = a_desired;
+	// Toggling off clears a failure so the next enable tries again
+	if (!a_desired && feature.state == State::kFailed)
+		Transition(a_id, State::kDestroyed);
+}
+
+void LifecycleManager::RequestRecreate(FeatureID a_id)
+{
+	auto& feature = features[a_id];
+	if (feature.state == State::kFailed)
+		Transition(a_id, State::kDestroyed);
+	else if (feature.state == State::kLive || feature.state == State::kCreating)
+		feature.recreate = true;
+}
+
+void LifecycleManager::Tick(uint64_t a_submittedFence, uint64_t a_completedFence)
+{
+	for (FeatureID id = 0; id < (FeatureID)features.size(); id++) {
+		auto& feature = features[id];
+
+		// Cannot be cancelled; a feature switched off meanwhile is retired once it is live
+		if (!FinishCreate(id, false))
+			continue;
+
+		if (feature.state == State::kLive && (!feature.desired || feature.recreate)) {
+			if (feature.callbacks.retire)
+				feature.callbacks.retire();
+			feature.retireFence = a_submittedFence;
+			feature.framesRetiring = 0;
+			feature.recreate = false;
+			Transition(id, State::kRetiring);
+			continue;
+		}
+
+		if (feature.state == State::kRetiring) {
+			feature.framesRetiring++;
+			if (a_completedFence < feature.retireFence || feature.framesRetiring < retireFrames)
+				continue;
+			if (feature.callbacks.destroy)
+				feature.callbacks.destroy();
+			Transition(id, State::kDestroyed);
+		}
+
+		if (feature.state == State::kDestroyed && feature.desired)
+			StartCreate(id);
+	}
+}
+
+void LifecycleManager::RecreateNow(FeatureID a_id)
+{
+	auto& feature = features[a_id];
+	FinishCreate(a_id, true);
+	if (feature.state == State::kLive && feature.callbacks.retire)
+		feature.callbacks.retire();
+	if ((feature.state == State::kLive || feature.state == State::kRetiring) && feature.callbacks.destroy)
+		feature.callbacks.destroy();
+	feature.recreate = false;
+	Transition(a_id, State::kDestroyed);
+
+	if (feature.desired)
+		StartCreate(a_id);
+}
+
+void LifecycleManager::DestroyAllNow()
+{
+	for (FeatureID id = 0; id < (FeatureID)features.size(); id++) {
+		auto& feature = features[id];
+		FinishCreate(id, true);
+		if (feature.state == State::kLive && feature.callbacks.retire)
+			feature.callbacks.retire();
+		if ((feature.state == State::kLive || feature.state == State::kRetiring) && feature.callbacks.destroy)
+			feature.callbacks.destroy();
+		feature.recreate = false;
+		if (feature.state != State::kDestroyed)
+			Transition(id, State::kDestroyed);
+	}
+}
+
+bool LifecycleManager::IsSettled() const
+{
+	for (const auto& feature : features) {
+		if (feature.state == State::kRetiring || feature.state == State::kCreating || feature.recreate)
+			return false;
+		if (feature.desired != (feature.state == State::kLive || feature.state == State::kFailed))
+			return false;
+	}
+	return true;
+}
+
+const char* LifecycleManager::StateName(State a_state)
+{
+	switch (a_state) {
+	case State::kDestroyed:
+		return "Destroyed";
+	case State::kCreating:
+		return "Creating";
+	case State::kLive:
+		return "Live";
+	case State::kRetiring:
+		return "Retiring";
+	case State::kFailed:
+		return "Failed";
+	}
+	return "Unknown";
+}
+
+void LifecycleManager::StartCreate(FeatureID a_id)
+{
+	auto& callbacks = features[a_id].callbacks;
+	bool created = !callbacks.create || callbacks.create();
+	if (!created)
+		Transition(a_id, State::kFailed);
+	else
+		Transition(a_id, callbacks.poll ? State::kCreating : State::kLive);
+}
+
+bool LifecycleManager::FinishCreate(FeatureID a_id, bool a_wait)
+{
+	auto& feature = features[a_id];
+	if (feature.state != State::kCreating)
+		return true;
+
+	switch (feature.callbacks.poll(a_wait)) {
+	case Progress::kPending:
+		return false;
+	case Progress::kDone:
+		Transition(a_id, State::kLive);
+		break;
+	case Progress::kFailed:
+		feature.recreate = false;
+		Transition(a_id, State::kFailed);
+		break;
+	}
+	return true;
+}
+
+void LifecycleManager::Transition(FeatureID a_id, State a_state)
+{
+	auto previous = features[a_id].state;
+	features[a_id].state = a_state;
+	if (onTransition && previous != a_state)
+		onTransition(a_id, previous, a_state);
+}
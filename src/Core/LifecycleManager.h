@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Creates, retires and destroys GPU-backed features (FFX contexts, shared textures) while the game runs.
+// Destruction is deferred: a retired feature is destroyed only after the GPU fence passed the value
+// recorded at retirement and a few more frames were presented, so toggling never blocks the render thread.
+// Creation may also be asynchronous: a feature with a poll callback stays kCreating until the work
+// it started elsewhere finished, and is unpublished until then.
+// Not thread-safe, drive it from the render thread.
+class LifecycleManager
+{
+public:
+	enum class State : uint8_t
+	{
+		kDestroyed,
+		kCreating,  // Asynchronous creation started, waiting for it to finish
+		kLive,
+		kRetiring,  // Unpublished, waiting for the GPU before destroy
+		kFailed     // Creation failed, retried after the feature is toggled or recreated
+	};
+
+	enum class Progress : uint8_t
+	{
+		kPending,
+		kDone,  // Published, the feature is live
+		kFailed
+	};
+
+	struct Callbacks
+	{
+		std::function<bool()> create;   // Build and publish the feature, false on failure
+		std::function<void()> retire;   // Stop using the feature; its objects must stay alive for in-flight GPU work
+		std::function<void()> destroy;  // Free the objects, the GPU no longer references them
+		// Optional. When set, create only starts the work and this reports (and publishes) the result.
+		// a_wait blocks until the work finished.
+		std::function<Progress(bool a_wait)> poll;
+	};
+
+	using FeatureID = uint32_t;
+	using TransitionCallback = std::function<void(FeatureID, State, State)>;
+
+	explicit LifecycleManager(uint32_t a_retireFrames = 3) :
+		retireFrames(a_retireFrames) {}
+
+	FeatureID Register(std::string a_name, Callbacks a_callbacks);
+
+	void SetDesired(FeatureID a_id, bool a_desired);
+	// Retire and create again, e.g. after creation flags changed. The new instance is only created
+	// once the old one is destroyed, so both never exist at the same time.
+	void RequestRecreate(FeatureID a_id);
+
+	// Once per frame after the frame's work was submitted. a_submittedFence is the last value signalled
+	// on the queue, a_completedFence the value the GPU has reached. Never waits.
+	void Tick(uint64_t a_submittedFence, uint64_t a_completedFence);
+
+	// Destroys the feature immediately and creates it again if it is wanted. Only valid while the GPU
+	// is idle, e.g. inside ResizeBuffers after the queues were drained. Waits for a pending creation
+	// to finish, but does not wait for the new one.
+	void RecreateNow(FeatureID a_id);
+
+	// Destroys everything immediately, waiting for pending creations. Only valid once the GPU is idle
+	// (shutdown, device removal).
+	void DestroyAllNow();
+
+	State GetState(FeatureID a_id) const { return features[a_id].state; }
+	bool IsLive(FeatureID a_id) const { return features[a_id].state == State::kLive; }
+	bool IsCreating(FeatureID a_id) const { return features[a_id].state == State::kCreating; }
+	bool IsDesired(FeatureID a_id) const { return features[a_id].desired; }
+	const std::string& GetName(FeatureID a_id) const { return features[a_id].name; }
+
+	// True when every feature reached the state it was asked for
+	bool IsSettled() const;
+
+	static const char* StateName(State a_state);
+
+	TransitionCallback onTransition;
+
+private:
+	struct Feature
+	{
+		std::string name;
+		Callbacks callbacks;
+		State state = State::kDestroyed;
+		bool desired = false;
+		bool recreate = false;
+		uint64_t retireFence = 0;
+		uint32_t framesRetiring = 0;
+	};
+
+	void Transition(FeatureID a_id, State a_state);
+	void StartCreate(FeatureID a_id);
+	// False while a pending creation has not finished
+	bool FinishCreate(FeatureID a_id, bool a_wait);
+
+	std::vector<Feature> features;
+	uint32_t retireFrames;
+};
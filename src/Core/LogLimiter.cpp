@@ -0,0 +1,35 @@
+#include "LogLimiter.h"
+
+bool LogRateLimiter::Allow(Clock::time_point a_now, uint64_t& a_suppressed)
+{
+	auto call = calls.fetch_add(1, std::memory_order_relaxed) + 1;
+	auto now = a_now.time_since_epoch().count();
+
+	if (call > burst) {
+		// One caller per interval wins the exchange, the rest are dropped
+		auto next = nextAllowed.load(std::memory_order_relaxed);
+		if (now < next || !nextAllowed.compare_exchange_strong(next, now + interval, std::memory_order_relaxed))
+			return false;
+	} else {
+		nextAllowed.store(now + interval, std::memory_order_relaxed);
+	}
+
+	auto previous = emittedAt.exchange(call, std::memory_order_relaxed);
+	a_suppressed = call > previous + 1 ? call - previous - 1 : 0;
+	return true;
+}
+
+bool LogDeduplicator::Submit(uint64_t a_hash, uint64_t& a_repeats)
+{
+	std::lock_guard guard(lock);
+	if (any && a_hash == lastHash) {
+		repeats++;
+		return false;
+	}
+
+	a_repeats = repeats;
+	lastHash = a_hash;
+	repeats = 0;
+	any = true;
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Throttles one log site: the first a_burst calls pass, afterwards at most one per a_interval. A call
+// that passes reports how many were dropped since the previous one. Lock-free, a static per call site.
+class LogRateLimiter
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	LogRateLimiter(uint32_t a_burst, Clock::duration a_interval) :
+		burst(a_burst), interval(a_interval.count()) {}
+
+	bool Allow(uint64_t& a_suppressed) { return Allow(Clock::now(), a_suppressed); }
+	bool Allow(Clock::time_point a_now, uint64_t& a_suppressed);
+
+private:
+	const uint64_t burst;
+	const Clock::rep interval;
+	std::atomic<uint64_t> calls{ 0 };
+	std::atomic<uint64_t> emittedAt{ 0 };  // Value of calls at the last emission
+	std::atomic<Clock::rep> nextAllowed{ 0 };
+};
+
+// Collapses consecutive identical messages of one log site. Only a change of message passes; it
+// reports how often the previous one repeated, so the log still shows the count.
+class LogDeduplicator
+{
+public:
+	bool Submit(uint64_t a_hash, uint64_t& a_repeats);
+
+private:
+	std::mutex lock;
+	uint64_t lastHash = 0;
+	uint64_t repeats = 0;
+	bool any = false;
+};
@@ -0,0 +1,61 @@
+#include "PowerSaveController.h"
+
+#include <algorithm>
+
+PowerSaveController::Decision PowerSaveController::Update(const Sample& a_sample)
+{
+	pausedFrames = a_sample.enabled && a_sample.paused ? pausedFrames + 1 : 0;
+
+	Decision decision;
+	if (pausedFrames >= std::max(config.enterFrames, 1u)) {
+		decision.state = State::kPowerSave;
+		decision.bypassFrameGeneration = true;
+		if (!a_sample.loading && config.frameRateCap > 0.0f)
+			decision.frameRateCap = config.frameRateCap;
+	}
+
+	if (decision.state != last.state) {
+		if (decision.state == State::kPowerSave)
+			stats.entries++;
+		else
+			decision.reset = true;
+	}
+	if (decision.state == State::kPowerSave)
+		stats.powerSaveFrames++;
+
+	// A new cap starts counting from the next frame
+	if (decision.frameRateCap != last.frameRateCap)
+		nextFrameSeconds = -1.0;
+
+	last = decision;
+	return decision;
+}
+
+double PowerSaveController::Throttle(double a_timeSeconds)
+{
+	if (last.frameRateCap <= 0.0f)
+		return 0.0;
+
+	double interval = 1.0 / double(last.frameRateCap);
+
+	// First frame under the cap, or more than a frame late: pace from now instead of catching up
+	if (nextFrameSeconds < 0.0 || a_timeSeconds > nextFrameSeconds + interval)
+		nextFrameSeconds = a_timeSeconds;
+
+	double wait = std::max(nextFrameSeconds - a_timeSeconds, 0.0);
+	nextFrameSeconds = std::max(nextFrameSeconds, a_timeSeconds) + interval;
+	stats.throttledSeconds += wait;
+	return wait;
+}
+
+const char* PowerSaveController::StateName(State a_state)
+{
+	switch (a_state) {
+	case State::kActive:
+		return "active";
+	case State::kPowerSave:
+		return "power save";
+	default:
+		return "unknown";
+	}
+}
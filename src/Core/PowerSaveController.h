@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+// Saves power while the game is paused behind a menu: frame generation is bypassed (the image is
+// mostly static and interpolation only delays the cursor) and the frame rate is optionally capped.
+// The pause flag flickers while menus open, so power saving starts after a few paused frames; it ends
+// on the first unpaused frame, which asks for a history reset.
+class PowerSaveController
+{
+public:
+	enum class State : uint8_t
+	{
+		kActive,
+		kPowerSave,
+	};
+
+	struct Config
+	{
+		uint32_t enterFrames = 3;     // Consecutive paused frames before saving power
+		float frameRateCap = 60.0f;   // While saving power, 0 for no cap
+	};
+
+	// One per presented frame
+	struct Sample
+	{
+		bool enabled = true;   // User setting
+		bool paused = false;   // A menu pauses the game
+		bool loading = false;  // Loading screens are never throttled, the game loads on the same thread
+		double timeSeconds = 0.0;
+	};
+
+	struct Decision
+	{
+		State state = State::kActive;
+		bool bypassFrameGeneration = false;
+		bool reset = false;         // First frame after power saving
+		float frameRateCap = 0.0f;  // 0 when frames are not throttled
+	};
+
+	struct Stats
+	{
+		uint64_t powerSaveFrames = 0;
+		uint64_t entries = 0;
+		double throttledSeconds = 0.0;  // Total time Throttle asked to wait
+	};
+
+	PowerSaveController() = default;
+	explicit PowerSaveController(const Config& a_config) :
+		config(a_config) {}
+
+	Decision Update(const Sample& a_sample);
+
+	// Seconds to wait after presenting at a_timeSeconds to stay under the cap of the last decision
+	double Throttle(double a_timeSeconds);
+
+	void SetConfig(const Config& a_config) { config = a_config; }
+	const Config& GetConfig() const { return config; }
+	State GetState() const { return last.state; }
+	const Stats& GetStats() const { return stats; }
+	static const char* StateName(State a_state);
+
+private:
+	Config config;
+	Decision last;
+	uint32_t pausedFrames = 0;
+	double nextFrameSeconds = -1.0;  // Earliest time the next throttled frame may be presented
+	Stats stats;
+};
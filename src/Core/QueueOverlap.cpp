@@ -0,0 +1,72 @@
+#include "QueueOverlap.h"
+
+#include <algorithm>
+#include <cmath>
+
+QueueOverlapResult SimulateQueueOverlap(std::span<const QueuePass> a_passes, double a_contention)
+{
+	QueueOverlapResult result;
+	result.startMs.resize(a_passes.size());
+	result.endMs.resize(a_passes.size());
+
+	double queueFree[2] = { 0.0, 0.0 };
+	for (size_t i = 0; i < a_passes.size(); i++) {
+		const auto& pass = a_passes[i];
+		double ms = std::max(pass.ms, 0.0);
+		result.serialMs += ms;
+
+		// Forward or self references cannot be waited on and are ignored
+		auto queue = size_t(pass.queue);
+		double start = queueFree[queue];
+		if (pass.waitFor >= 0 && size_t(pass.waitFor) < i)
+			start = std::max(start, result.endMs[size_t(pass.waitFor)]);
+
+		result.startMs[i] = start;
+		result.endMs[i] = start + ms;
+		queueFree[queue] = result.endMs[i];
+		result.idealMs = std::max(result.idealMs, result.endMs[i]);
+	}
+
+	// Passes on one queue never overlap each other, so pairwise graphics/compute intersections add up
+	for (size_t i = 0; i < a_passes.size(); i++) {
+		if (a_passes[i].queue != GpuQueue::kGraphics)
+			continue;
+		for (size_t j = 0; j < a_passes.size(); j++) {
+			if (a_passes[j].queue != GpuQueue::kCompute)
+				continue;
+			double begin = std::max(result.startMs[i], result.startMs[j]);
+			double end = std::min(result.endMs[i], result.endMs[j]);
+			if (end > begin)
+				result.overlapMs += end - begin;
+		}
+	}
+
+	double contention = std::clamp(a_contention, 0.0, 1.0);
+	result.asyncMs = std::min(result.idealMs + result.overlapMs * contention, result.serialMs);
+	return result;
+}
+
+QueueTimingWindow::QueueTimingWindow(std::span<const QueuePass> a_passes, uint32_t a_frames) :
+	averages(a_passes.begin(), a_passes.end()), sums(a_passes.size(), 0.0), counts(a_passes.size(), 0), frames(std::max(a_frames, 1u))
+{}
+
+bool QueueTimingWindow::Add(std::span<const double> a_ms)
+{
+	for (size_t i = 0; i < sums.size() && i < a_ms.size(); i++) {
+		if (std::isnan(a_ms[i]))
+			continue;
+		sums[i] += a_ms[i];
+		counts[i]++;
+	}
+	if (++added < frames)
+		return false;
+
+	// A pass that ran on some frames only is averaged over those
+	for (size_t i = 0; i < sums.size(); i++) {
+		averages[i].ms = counts[i] ? sums[i] / counts[i] : 0.0;
+		sums[i] = 0.0;
+		counts[i] = 0;
+	}
+	added = 0;
+	return true;
+}
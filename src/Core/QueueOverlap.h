@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Predicts what moving passes to an async compute queue gains, from per-pass GPU timings measured with
+// everything on one queue. Passes run in submission order per queue; a pass may wait on an earlier pass
+// on the other queue through a fence. Both queues share the shader units, so time where they overlap is
+// stretched by the contention factor (0 is perfect overlap, 1 is no gain at all).
+enum class GpuQueue : uint8_t
+{
+	kGraphics,
+	kCompute,
+};
+
+struct QueuePass
+{
+	const char* name = "";
+	GpuQueue queue = GpuQueue::kGraphics;
+	double ms = 0.0;
+	int32_t waitFor = -1;  // Index of an earlier pass this one waits for, -1 for none
+};
+
+struct QueueOverlapResult
+{
+	double serialMs = 0.0;    // Everything on the graphics queue
+	double idealMs = 0.0;     // Async with free overlap
+	double overlapMs = 0.0;   // Time both queues are busy
+	double asyncMs = 0.0;     // Predicted, with contention
+	std::vector<double> startMs;
+	std::vector<double> endMs;
+
+	double GainMs() const { return serialMs - asyncMs; }
+};
+
+QueueOverlapResult SimulateQueueOverlap(std::span<const QueuePass> a_passes, double a_contention = 0.3);
+
+// Averages per-pass GPU times measured with timestamps over a window of frames, for SimulateQueueOverlap.
+// The pass list (names, queues, waits) is fixed; only the times change from frame to frame.
+class QueueTimingWindow
+{
+public:
+	explicit QueueTimingWindow(std::span<const QueuePass> a_passes, uint32_t a_frames = 300);
+
+	// One frame's times in pass order, NaN for a pass that did not run. True when this frame completed a
+	// window; GetAverages() then holds its averages until the next window completes.
+	bool Add(std::span<const double> a_ms);
+
+	std::span<const QueuePass> GetAverages() const { return averages; }
+	uint32_t GetFrames() const { return frames; }
+
+private:
+	std::vector<QueuePass> averages;
+	std::vector<double> sums;
+	std::vector<uint32_t> counts;
+	uint32_t frames;
+	uint32_t added = 0;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Read-copy-update cell for small configuration structs.
+// Readers get an immutable snapshot with a single atomic load (wait-free). Writers copy the current
+// snapshot, modify the copy and swap it in; writers are serialised by an internal mutex.
+// Old snapshots are reclaimed once the reader thread reports a quiescent state, i.e. a point where
+// it holds no snapshot pointers (once per frame on the render thread).
+// Threads other than the quiescing reader must use Copy() instead of Read().
+template <class T>
+class RcuSnapshot
+{
+public:
+	explicit RcuSnapshot(const T& a_initial = T{}) :
+		current(new T(a_initial)) {}
+
+	~RcuSnapshot()
+	{
+		delete current.load();
+		for (auto& entry : retired)
+			delete entry.snapshot;
+	}
+
+	RcuSnapshot(const RcuSnapshot&) = delete;
+	RcuSnapshot& operator=(const RcuSnapshot&) = delete;
+
+	// Reader thread only. The pointer stays valid until that thread's next Quiesce().
+	const T* Read() const { return current.load(std::memory_order_acquire); }
+
+	// Any thread
+	T Copy() const
+	{
+		std::lock_guard lock(writerLock);
+		return *current.load(std::memory_order_acquire);
+	}
+
+	void Publish(const T& a_value)
+	{
+		std::lock_guard lock(writerLock);
+		PublishLocked(a_value);
+	}
+
+	// Applies a_mutator to a copy of the current snapshot and publishes the result
+	template <class F>
+	void Update(F&& a_mutator)
+	{
+		std::lock_guard lock(writerLock);
+		T copy = *current.load(std::memory_order_acquire);
+		a_mutator(copy);
+		PublishLocked(copy);
+	}
+
+	// Reader thread: declares that no pointer returned by Read() is still in use. Frees what that made
+	// safe right away instead of at the next Publish; skipped (never blocks) while a writer is active.
+	void Quiesce()
+	{
+		quiescentEpoch.store(epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+
+		std::unique_lock lock(writerLock, std::try_to_lock);
+		if (lock.owns_lock())
+			Reclaim();
+	}
+
+	// Snapshots waiting for the reader to quiesce, for diagnostics
+	size_t PendingReclaim() const
+	{
+		std::lock_guard lock(writerLock);
+		return retired.size();
+	}
+
+private:
+	struct Retired
+	{
+		T* snapshot;
+		uint64_t epoch;
+	};
+
+	void PublishLocked(const T& a_value)
+	{
+		T* previous = current.exchange(new T(a_value), std::memory_order_seq_cst);
+		uint64_t retireEpoch = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+		retired.push_back({ previous, retireEpoch });
+		Reclaim();
+	}
+
+	void Reclaim()
+	{
+		const uint64_t safeEpoch = quiescentEpoch.load(std::memory_order_seq_cst);
+		std::erase_if(retired, [safeEpoch](const Retired& a_entry) {
+			if (a_entry.epoch > safeEpoch)
+				return false;
+			delete a_entry.snapshot;
+			return true;
+		});
+	}
+
+	std::atomic<T*> current;
+	std::atomic<uint64_t> epoch{ 0 };
+	std::atomic<uint64_t> quiescentEpoch{ 0 };
+
+	mutable std::mutex writerLock;
+	std::vector<Retired> retired;
+};
@@ -0,0 +1,59 @@
+#include "ResizePlanner.h"
+
+namespace
+{
+	double Area(const ResizePlanner::Extent& a_extent)
+	{
+		return double(a_extent.width) * double(a_extent.height);
+	}
+}
+
+ResizePlanner::Plan ResizePlanner::Build(const Current& a_current, const Target& a_target) const
+{
+	Plan plan;
+
+	// Minimised window: keep everything, the next real resize decides
+	if (a_target.display.IsEmpty())
+		return plan;
+
+	// The game copies the fake back buffer into the real one, both must match exactly
+	if (!a_current.interop.IsEmpty())
+		plan.recreateInterop = a_current.interop != a_target.display || a_current.interopFormat != a_target.format;
+
+	// Shared textures are copy destinations of game render targets and must match them
+	if (!a_current.sharedResources.IsEmpty())
+		plan.recreateSharedResources = a_current.sharedResources != a_target.render;
+
+	// FSR accepts any render size up to the maximum it was created with
+	if (!a_current.upscaleMaxRender.IsEmpty()) {
+		bool grows = !a_current.upscaleMaxRender.Fits(a_target.render) || !a_current.upscaleMaxOutput.Fits(a_target.display);
+		bool shrinks = Area(a_target.render) < Area(a_current.upscaleMaxRender) * shrinkAreaRatio;
+		plan.recreateUpscale = grows || shrinks;
+	}
+
+	// Frame generation allocates its internal targets at display size and back buffer format
+	if (!a_current.frameGenDisplay.IsEmpty())
+		plan.recreateFrameGeneration = a_current.frameGenDisplay != a_target.display || a_current.frameGenFormat != a_target.format;
+
+	return plan;
+}
+
+std::string ResizePlanner::Plan::Describe() const
+{
+	if (IsEmpty())
+		return "nothing";
+
+	std::string result;
+	auto append = [&result](bool a_flag, const char* a_name) {
+		if (!a_flag)
+			return;
+		if (!result.empty())
+			result += ", ";
+		result += a_name;
+	};
+	append(recreateInterop, "interop back buffer");
+	append(recreateSharedResources, "shared resources");
+	append(recreateUpscale, "upscale context");
+	append(recreateFrameGeneration, "frame generation context");
+	return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Decides which size dependent objects have to be rebuilt after the swap chain was resized.
+// Everything whose dimensions still fit is kept, so a same-size ResizeBuffers (fullscreen toggle,
+// format-only change) does not throw away FSR history or reallocate VRAM.
+struct ResizePlanner
+{
+	struct Extent
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+
+		bool IsEmpty() const { return width == 0 || height == 0; }
+		bool Fits(const Extent& a_other) const { return a_other.width <= width && a_other.height <= height; }
+		bool operator==(const Extent&) const = default;
+	};
+
+	// Sizes the live objects were created with, empty when the object does not exist
+	struct Current
+	{
+		Extent interop;  // Wrapped fake back buffer handed to the game
+		uint32_t interopFormat = 0;
+		Extent sharedResources;   // HUDLess/upscaled/depth/motion vector textures (render size)
+		Extent upscaleMaxRender;  // maxRenderSize of the upscale context
+		Extent upscaleMaxOutput;  // maxUpscaleSize of the upscale context
+		Extent frameGenDisplay;   // displaySize of the frame generation context
+		uint32_t frameGenFormat = 0;
+	};
+
+	struct Target
+	{
+		Extent display;
+		uint32_t format = 0;  // DXGI_FORMAT of the back buffer
+		Extent render;        // Native AA: same as display
+	};
+
+	struct Plan
+	{
+		bool recreateInterop = false;
+		bool recreateSharedResources = false;
+		bool recreateUpscale = false;
+		bool recreateFrameGeneration = false;
+
+		bool IsEmpty() const { return !recreateInterop && !recreateSharedResources && !recreateUpscale && !recreateFrameGeneration; }
+		std::string Describe() const;
+	};
+
+	// Upscale contexts are only rebuilt to shrink when the new size needs less than this fraction of
+	// the allocated area; growing always rebuilds
+	float shrinkAreaRatio = 0.5f;
+
+	Plan Build(const Current& a_current, const Target& a_target) const;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Describes what makes two textures interchangeable. flags holds whatever decides the creation flags:
+// bind flags for plain D3D11 textures, the declared ResourceUsage for shared ones.
+struct TextureKey
+{
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t format = 0;
+	uint32_t flags = 0;
+	uint32_t mipLevels = 1;
+	bool shared = false;
+
+	bool operator==(const TextureKey&) const = default;
+
+	struct Hash
+	{
+		size_t operator()(const TextureKey& a_key) const
+		{
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for (uint64_t value : { a_key.width, a_key.height, a_key.format, a_key.flags, a_key.mipLevels, uint32_t(a_key.shared) })
+				hash = (hash ^ value) * 0x100000001b3ull;
+			return size_t(hash);
+		}
+	};
+};
+
+// Keeps released resources for reuse by the next request with an equal key. Idle resources are
+// evicted least recently released first once their total size exceeds the capacity; the evict
+// callback decides how they are freed. Not thread-safe, owned by the render thread.
+// The destructor drops what is left without the callback, which may need objects already destroyed
+// at static destruction; owners Clear() explicitly while those are alive.
+template <class Key, class T, class KeyHash = std::hash<Key>>
+class ResourcePool
+{
+public:
+	using Evict = std::function<void(T)>;
+
+	struct Stats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	ResourcePool() = default;
+	ResourcePool(uint64_t a_capacity, Evict a_evict) :
+		capacity(a_capacity), evict(std::move(a_evict)) {}
+
+	~ResourcePool() = default;
+
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	// Most recently released match, or nothing when the caller has to create one
+	std::optional<T> Acquire(const Key& a_key)
+	{
+		auto found = byKey.find(a_key);
+		if (found == byKey.end() || found->second.empty()) {
+			stats.misses++;
+			return std::nullopt;
+		}
+
+		auto entry = found->second.back();
+		found->second.pop_back();
+		if (found->second.empty())
+			byKey.erase(found);
+
+		T resource = std::move(entry->resource);
+		idleBytes -= entry->bytes;
+		lru.erase(entry);
+		stats.hits++;
+		return resource;
+	}
+
+	void Release(const Key& a_key, T a_resource, uint64_t a_bytes)
+	{
+		lru.push_front({ a_key, std::move(a_resource), a_bytes });
+		byKey[a_key].push_back(lru.begin());
+		idleBytes += a_bytes;
+		Trim(capacity);
+	}
+
+	// Evicts until the idle resources fit in a_bytes
+	void Trim(uint64_t a_bytes)
+	{
+		while (idleBytes > a_bytes && !lru.empty())
+			EvictOldest();
+	}
+
+	void Clear()
+	{
+		while (!lru.empty())
+			EvictOldest();
+	}
+
+	void SetCapacity(uint64_t a_capacity)
+	{
+		capacity = a_capacity;
+		Trim(capacity);
+	}
+
+	uint64_t GetCapacity() const { return capacity; }
+	uint64_t IdleBytes() const { return idleBytes; }
+	size_t IdleCount() const { return lru.size(); }
+	const Stats& GetStats() const { return stats; }
+
+private:
+	void EvictOldest()
+	{
+		auto entry = std::prev(lru.end());
+		auto& entries = byKey[entry->key];
+		std::erase(entries, entry);
+		if (entries.empty())
+			byKey.erase(entry->key);
+
+		idleBytes -= entry->bytes;
+		T resource = std::move(entry->resource);
+		lru.erase(entry);
+		stats.evictions++;
+		if (evict)
+			evict(std::move(resource));
+	}
+
+	struct Entry
+	{
+		Key key;
+		T resource;
+		uint64_t bytes = 0;
+	};
+
+	using EntryList = std::list<Entry>;
+
+	uint64_t capacity = 0;
+	uint64_t idleBytes = 0;
+	Evict evict;
+	EntryList lru;  // Most recently released first
+	std::unordered_map<Key, std::vector<typename EntryList::iterator>, KeyHash> byKey;
+	Stats stats;
+};
@@ -0,0 +1,50 @@
+#include "ResourceUsage.h"
+
+namespace
+{
+	struct Row
+	{
+		uint32_t usage;
+		const char* name;
+		ResourceUsage::Flags flags;
+	};
+
+	constexpr Row kTable[] = {
+		{ ResourceUsage::kCopy11, "Copy11", {} },
+		{ ResourceUsage::kShaderRead11, "ShaderRead11", { ResourceUsage::kBindShaderResource11, 0 } },
+		{ ResourceUsage::kShaderWrite11, "ShaderWrite11", { ResourceUsage::kBindUnorderedAccess11, ResourceUsage::kAllowUnorderedAccess12 } },
+		{ ResourceUsage::kRenderTarget11, "RenderTarget11", { ResourceUsage::kBindRenderTarget11, ResourceUsage::kAllowRenderTarget12 } },
+		{ ResourceUsage::kCopy12, "Copy12", {} },
+		{ ResourceUsage::kShaderRead12, "ShaderRead12", {} },
+		{ ResourceUsage::kShaderWrite12, "ShaderWrite12", { ResourceUsage::kBindUnorderedAccess11, ResourceUsage::kAllowUnorderedAccess12 } },
+		{ ResourceUsage::kRenderTarget12, "RenderTarget12", { ResourceUsage::kBindRenderTarget11, ResourceUsage::kAllowRenderTarget12 } },
+	};
+}
+
+ResourceUsage::Flags ResourceUsage::Derive(uint32_t a_usage, bool a_simultaneousAccess)
+{
+	// Without DENY_SHADER_RESOURCE (depth only) D3D12 textures are always readable, and so is the D3D11 side
+	Flags flags{ kBindShaderResource11, 0 };
+	for (const auto& row : kTable) {
+		if (a_usage & row.usage) {
+			flags.bind11 |= row.flags.bind11;
+			flags.resource12 |= row.flags.resource12;
+		}
+	}
+	if (a_simultaneousAccess)
+		flags.resource12 |= kAllowSimultaneousAccess12;
+	return flags;
+}
+
+std::string ResourceUsage::Describe(uint32_t a_usage)
+{
+	std::string result;
+	for (const auto& row : kTable) {
+		if (!(a_usage & row.usage))
+			continue;
+		if (!result.empty())
+			result += "|";
+		result += row.name;
+	}
+	return result.empty() ? "None" : result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Declared uses of a texture shared between D3D11 and D3D12, and the creation flags they need.
+// A D3D11 texture opened from a D3D12 handle inherits its bind flags from the D3D12 resource flags,
+// so every D3D11 use that needs a view also needs the matching D3D12 flag. Reads and copies need no
+// flags at all, which leaves the driver free to pick a better layout.
+struct ResourceUsage
+{
+	enum : uint32_t
+	{
+		kNone = 0,
+		kCopy11 = 1 << 0,  // D3D11 copy source or destination
+		kShaderRead11 = 1 << 1,
+		kShaderWrite11 = 1 << 2,
+		kRenderTarget11 = 1 << 3,  // Also needed to clear
+		kCopy12 = 1 << 4,
+		kShaderRead12 = 1 << 5,
+		kShaderWrite12 = 1 << 6,
+		kRenderTarget12 = 1 << 7,
+	};
+
+	// Same values as D3D11_BIND_FLAG and D3D12_RESOURCE_FLAGS, checked where the real enums are visible
+	enum : uint32_t
+	{
+		kBindShaderResource11 = 0x8,
+		kBindRenderTarget11 = 0x20,
+		kBindUnorderedAccess11 = 0x80,
+	};
+	enum : uint32_t
+	{
+		kAllowRenderTarget12 = 0x1,
+		kAllowUnorderedAccess12 = 0x4,
+		kAllowSimultaneousAccess12 = 0x20,
+	};
+
+	struct Flags
+	{
+		uint32_t bind11 = 0;      // D3D11 bind flags the opened texture ends up with
+		uint32_t resource12 = 0;  // D3D12 resource flags to create it with
+
+		bool operator==(const Flags&) const = default;
+	};
+
+	// Shared textures are accessed by both APIs without barriers and always allow simultaneous access
+	static Flags Derive(uint32_t a_usage, bool a_simultaneousAccess = true);
+	static bool WritesFromShader(uint32_t a_usage) { return a_usage & (kShaderWrite11 | kShaderWrite12); }
+	static std::string Describe(uint32_t a_usage);
+};
@@ -0,0 +1,42 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(uint64_t a_capacity, uint64_t a_alignment) :
+	alignment(a_alignment)
+{
+	// Whole aligned blocks only, so every offset stays aligned
+	capacity = a_capacity & ~(alignment - 1);
+}
+
+bool RingAllocator::Allocate(uint64_t a_size, Allocation& a_allocation)
+{
+	if (a_size == 0)
+		return false;
+
+	uint64_t size = (a_size + alignment - 1) & ~(alignment - 1);
+	if (size > capacity)
+		return false;
+
+	bool discard = fresh;
+	if (head + size > capacity) {
+		stats.wasted += capacity - head;
+		stats.wraps++;
+		head = 0;
+		discard = true;
+	}
+
+	a_allocation.offset = head;
+	a_allocation.size = size;
+	a_allocation.discard = discard;
+
+	head += size;
+	fresh = false;
+	stats.allocations++;
+	stats.bytes += size;
+	return true;
+}
+
+void RingAllocator::Reset()
+{
+	head = 0;
+	fresh = true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// Suballocates a fixed size buffer front to back for data written once and read by the GPU shortly
+// after, such as per-dispatch constants. Allocations never overlap data handed out since the last
+// wrap; a wrap starts over at offset 0 and is reported so the caller can orphan the old contents
+// (D3D11 MAP_WRITE_DISCARD) instead of waiting on the GPU. Pure bookkeeping, no graphics API calls.
+class RingAllocator
+{
+public:
+	static constexpr uint64_t kConstantBufferAlignment = 256;  // 16 constants, the D3D11.1 offset granularity
+
+	struct Allocation
+	{
+		uint64_t offset = 0;
+		uint64_t size = 0;     // Rounded up to the alignment
+		bool discard = false;  // First allocation after creation or a wrap
+	};
+
+	struct Stats
+	{
+		uint64_t allocations = 0;
+		uint64_t wraps = 0;
+		uint64_t bytes = 0;    // Aligned bytes handed out
+		uint64_t wasted = 0;   // Tail bytes skipped on wraps
+	};
+
+	RingAllocator() = default;
+	explicit RingAllocator(uint64_t a_capacity, uint64_t a_alignment = kConstantBufferAlignment);
+
+	// Fails only for an empty request or one larger than the whole buffer
+	bool Allocate(uint64_t a_size, Allocation& a_allocation);
+
+	// Next allocation discards, e.g. after the buffer was recreated
+	void Reset();
+
+	uint64_t GetCapacity() const { return capacity; }
+	uint64_t GetAlignment() const { return alignment; }
+	uint64_t GetHead() const { return head; }
+	const Stats& GetStats() const { return stats; }
+
+private:
+	uint64_t capacity = 0;
+	uint64_t alignment = kConstantBufferAlignment;  // Power of two
+	uint64_t head = 0;
+	bool fresh = true;
+	Stats stats;
+};
@@ -0,0 +1,148 @@
+#include "SceneCutDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	float Dot(const float a[3], const float b[3])
+	{
+		return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	}
+
+	// Angle of the relative rotation R_prev^T * R_cur, from its trace
+	float RotationAngle(const SceneCutDetector::Sample& a_prev, const SceneCutDetector::Sample& a_cur)
+	{
+		float trace = Dot(a_prev.right, a_cur.right) + Dot(a_prev.forward, a_cur.forward) + Dot(a_prev.up, a_cur.up);
+		float cosAngle = std::clamp((trace - 1.0f) * 0.5f, -1.0f, 1.0f);
+		return std::acos(cosAngle);
+	}
+}
+
+void SceneCutDetector::Reset()
+{
+	hasPrevious = false;
+	armed = true;
+	framesSinceCut = UINT32_MAX;
+	averageDeltaTimeMs = 0.0f;
+	previousHistogramBins = 0;
+}
+
+SceneCutDetector::Decision SceneCutDetector::Update(const Sample& a_sample)
+{
+	Decision decision;
+
+	float signals[5] = {};
+	const Reason reasons[5] = { kTranslation, kRotation, kFov, kDeltaTime, kDepthHistogram };
+
+	if (hasPrevious && a_sample.hasCamera && previous.hasCamera) {
+		float dx = a_sample.position[0] - previous.position[0];
+		float dy = a_sample.position[1] - previous.position[1];
+		float dz = a_sample.position[2] - previous.position[2];
+		signals[0] = std::sqrt(dx * dx + dy * dy + dz * dz) / config.translationUnits;
+		signals[1] = RotationAngle(previous, a_sample) / config.rotationRadians;
+	}
+
+	if (hasPrevious && a_sample.fovVerticalRad > 0.0f && previous.fovVerticalRad > 0.0f)
+		signals[2] = std::abs(a_sample.fovVerticalRad - previous.fovVerticalRad) / config.fovRadians;
+
+	// A frame far longer than usual means loading or a stall; the previous image is likely unrelated
+	if (averageDeltaTimeMs > 0.0f && a_sample.deltaTimeMs >= config.deltaTimeMinMs)
+		signals[3] = a_sample.deltaTimeMs / (averageDeltaTimeMs * config.deltaTimeRatio);
+
+	// Normalise histogram so the distance does not depend on resolution
+	const uint32_t bins = (uint32_t)std::min<size_t>(a_sample.depthHistogram.size(), kMaxHistogramBins);
+	float histogram[kMaxHistogramBins] = {};
+	if (bins) {
+		uint64_t total = 0;
+		for (uint32_t i = 0; i < bins; i++)
+			total += a_sample.depthHistogram[i];
+		if (total) {
+			for (uint32_t i = 0; i < bins; i++)
+				histogram[i] = float(a_sample.depthHistogram[i]) / float(total);
+			if (previousHistogramBins == bins) {
+				float distance = 0.0f;
+				for (uint32_t i = 0; i < bins; i++)
+					distance += std::abs(histogram[i] - previousHistogram[i]);
+				signals[4] = distance / config.histogramDistance;
+			}
+		}
+	}
+
+	// Fuse: strongest signal plus a fraction of the others, so several moderate signals can add up
+	float strongest = 0.0f;
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < 5; i++) {
+		strongest = std::max(strongest, signals[i]);
+		sum += signals[i];
+		if (signals[i] >= 1.0f)
+			decision.reasons |= reasons[i];
+	}
+	decision.score = strongest + config.secondarySignalWeight * (sum - strongest);
+
+	// Hysteresis
+	if (framesSinceCut != UINT32_MAX)
+		framesSinceCut++;
+	if (!armed && decision.score < config.releaseScore && framesSinceCut >= config.cooldownFrames)
+		armed = true;
+	if (armed && decision.score >= config.enterScore) {
+		decision.cut = true;
+		armed = false;
+		framesSinceCut = 0;
+	}
+
+	// Running average of frame time, anomalies excluded so a loading screen does not skew it
+	if (a_sample.deltaTimeMs > 0.0f && signals[3] < 1.0f)
+		averageDeltaTimeMs = averageDeltaTimeMs > 0.0f ? averageDeltaTimeMs * 0.9f + a_sample.deltaTimeMs * 0.1f : a_sample.deltaTimeMs;
+
+	previous = a_sample;
+	previous.depthHistogram = {};
+	if (bins) {
+		std::copy_n(histogram, bins, previousHistogram);
+		previousHistogramBins = bins;
+	} else {
+		previousHistogramBins = 0;
+	}
+	hasPrevious = true;
+
+	return decision;
+}
+
+SceneCutEvaluation EvaluateSceneCuts(const SceneCutDetector::Config& a_config, std::span<const SceneCutLabelledSample> a_trace, uint32_t a_toleranceFrames)
+{
+	SceneCutEvaluation result;
+	SceneCutDetector detector(a_config);
+
+	// Frames remaining in which a detection still matches the last labelled cut
+	uint32_t pendingWindow = 0;
+	bool pendingMatched = true;
+
+	for (const auto& entry : a_trace) {
+		if (entry.isCut) {
+			if (!pendingMatched)
+				result.falseNegatives++;
+			pendingWindow = a_toleranceFrames + 1;
+			pendingMatched = false;
+		}
+
+		bool detected = detector.Update(entry.sample).cut;
+		if (detected) {
+			if (pendingWindow && !pendingMatched) {
+				result.truePositives++;
+				pendingMatched = true;
+			} else {
+				result.falsePositives++;
+			}
+		}
+
+		if (pendingWindow)
+			pendingWindow--;
+		if (!pendingWindow && !pendingMatched) {
+			result.falseNegatives++;
+			pendingMatched = true;
+		}
+	}
+	if (!pendingMatched)
+		result.falseNegatives++;
+	return result;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// Decides when FSR history must be reset because the image is no longer temporally related to the
+// previous frame (fast travel, kill-cams, cell loads, camera snaps).
+// Several cheap per-frame signals are normalised so that 1.0 alone is enough for a cut, then fused.
+// A cut re-arms only after the score dropped below a release threshold and a cooldown elapsed,
+// so a multi-frame transition only resets once.
+class SceneCutDetector
+{
+public:
+	enum Reason : uint32_t
+	{
+		kNone = 0,
+		kTranslation = 1 << 0,
+		kRotation = 1 << 1,
+		kFov = 1 << 2,
+		kDeltaTime = 1 << 3,
+		kDepthHistogram = 1 << 4,
+	};
+
+	struct Config
+	{
+		float translationUnits = 1000.0f;   // ~14 m, the old camera jump rule
+		float rotationRadians = 0.785398f;  // 45 degrees in one frame
+		float fovRadians = 0.174533f;       // 10 degrees in one frame
+		float deltaTimeRatio = 4.0f;        // frame took this many times longer than the running average
+		float deltaTimeMinMs = 100.0f;      // ...and at least this long (ignores small hitches)
+		float histogramDistance = 0.6f;     // L1 distance of normalised histograms, range [0, 2]
+		float secondarySignalWeight = 0.5f; // contribution of the non-dominant signals to the fused score
+		float enterScore = 1.0f;
+		float releaseScore = 0.5f;
+		uint32_t cooldownFrames = 4;
+	};
+
+	struct Sample
+	{
+		bool hasCamera = false;
+		float position[3] = {};
+		float right[3] = {};
+		float forward[3] = {};
+		float up[3] = {};
+		float fovVerticalRad = 0.0f;
+		float deltaTimeMs = 0.0f;
+
+		// Optional low resolution depth histogram, ignored if empty.
+		// Must have the same bin count every frame for the signal to be used.
+		std::span<const uint32_t> depthHistogram;
+	};
+
+	struct Decision
+	{
+		bool cut = false;
+		float score = 0.0f;
+		uint32_t reasons = kNone;  // Signals that individually reached their threshold
+	};
+
+	SceneCutDetector() = default;
+	explicit SceneCutDetector(const Config& a_config) :
+		config(a_config) {}
+
+	Decision Update(const Sample& a_sample);
+	void Reset();
+
+	const Config& GetConfig() const { return config; }
+
+private:
+	static constexpr uint32_t kMaxHistogramBins = 64;
+
+	Config config;
+
+	bool hasPrevious = false;
+	bool armed = true;
+	uint32_t framesSinceCut = UINT32_MAX;
+	float averageDeltaTimeMs = 0.0f;
+
+	Sample previous;
+	float previousHistogram[kMaxHistogramBins] = {};
+	uint32_t previousHistogramBins = 0;
+};
+
+// Offline evaluation against a labelled camera trace
+struct SceneCutLabelledSample
+{
+	SceneCutDetector::Sample sample;
+	bool isCut = false;
+};
+
+struct SceneCutEvaluation
+{
+	uint32_t truePositives = 0;
+	uint32_t falsePositives = 0;
+	uint32_t falseNegatives = 0;
+
+	float Precision() const { return truePositives + falsePositives ? float(truePositives) / float(truePositives + falsePositives) : 1.0f; }
+	float Recall() const { return truePositives + falseNegatives ? float(truePositives) / float(truePositives + falseNegatives) : 1.0f; }
+};
+
+// A detection within a_toleranceFrames after a labelled cut counts as a hit
+SceneCutEvaluation EvaluateSceneCuts(const SceneCutDetector::Config& a_config, std::span<const SceneCutLabelledSample> a_trace, uint32_t a_toleranceFrames = 1);
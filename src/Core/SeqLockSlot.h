@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer, multi-reader publication slot (seqlock).
+// The writer never blocks; readers retry only if they raced a Publish().
+// The payload is stored as relaxed atomic words so concurrent copies are well defined.
+template <class T>
+class SeqLockSlot
+{
+	static_assert(std::is_trivially_copyable_v<T>, "SeqLockSlot requires a trivially copyable payload");
+
+public:
+	SeqLockSlot() { Publish(T{}); }
+
+	// Must only ever be called from one thread at a time
+	void Publish(const T& a_value)
+	{
+		std::array<uint64_t, kWords> staging{};
+		std::memcpy(staging.data(), &a_value, sizeof(T));
+
+		const uint64_t seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < kWords; i++)
+			words[i].store(staging[i], std::memory_order_relaxed);
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	T Read() const
+	{
+		std::array<uint64_t, kWords> staging{};
+		for (;;) {
+			const uint64_t before = sequence.load(std::memory_order_acquire);
+			if (before & 1)
+				continue;
+			for (size_t i = 0; i < kWords; i++)
+				staging[i] = words[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence.load(std::memory_order_relaxed) == before)
+				break;
+		}
+		T value;
+		std::memcpy(static_cast<void*>(&value), staging.data(), sizeof(T));
+		return value;
+	}
+
+	// Number of completed publications
+	uint64_t Version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+	static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	std::atomic<uint64_t> sequence{ 0 };
+	std::array<std::atomic<uint64_t>, kWords> words{};
+};
@@ -0,0 +1,130 @@
+#include "ShaderCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace
+{
+	constexpr char kMagic[4] = { 'F', 'S', 'C', '1' };
+
+	template <class T>
+	void Write(std::vector<uint8_t>& a_out, T a_value)
+	{
+		for (size_t i = 0; i < sizeof(T); i++)
+			a_out.push_back(uint8_t(uint64_t(a_value) >> (8 * i)));
+	}
+
+	template <class T>
+	T Read(const uint8_t* a_in)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < sizeof(T); i++)
+			value |= uint64_t(a_in[i]) << (8 * i);
+		return T(value);
+	}
+
+	// Length prefixed, so ("ab", "c") and ("a", "bc") hash differently
+	uint64_t HashField(std::string_view a_field, uint64_t a_seed)
+	{
+		uint8_t length[8];
+		for (size_t i = 0; i < 8; i++)
+			length[i] = uint8_t(uint64_t(a_field.size()) >> (8 * i));
+		return ShaderCache::Hash(a_field, ShaderCache::Hash(length, a_seed));
+	}
+}
+
+uint64_t ShaderCache::Hash(std::span<const uint8_t> a_data, uint64_t a_seed)
+{
+	uint64_t hash = a_seed;
+	for (uint8_t byte : a_data) {
+		hash ^= byte;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+uint64_t ShaderCache::Hash(std::string_view a_data, uint64_t a_seed)
+{
+	return Hash(std::span(reinterpret_cast<const uint8_t*>(a_data.data()), a_data.size()), a_seed);
+}
+
+uint64_t ShaderCache::ComputeKey(const KeyInputs& a_inputs)
+{
+	uint8_t numbers[12];
+	for (size_t i = 0; i < 4; i++) {
+		numbers[i] = uint8_t(a_inputs.flags >> (8 * i));
+		numbers[4 + i] = uint8_t(a_inputs.compilerVersion >> (8 * i));
+		numbers[8 + i] = uint8_t(kVersion >> (8 * i));
+	}
+
+	uint64_t key = Hash(numbers);
+	key = HashField(a_inputs.entry, key);
+	key = HashField(a_inputs.profile, key);
+	return HashField(a_inputs.source, key);
+}
+
+std::vector<uint8_t> ShaderCache::Serialize(uint64_t a_key, std::span<const uint8_t> a_bytecode)
+{
+	// Sized up front: GCC 12 at -O2 misreads a range insert into the freshly reserved vector as an overflow
+	std::vector<uint8_t> file(sizeof(kMagic));
+	file.reserve(kHeaderSize + a_bytecode.size());
+	std::memcpy(file.data(), kMagic, sizeof(kMagic));
+	Write(file, kVersion);
+	Write(file, a_key);
+	Write(file, uint64_t(a_bytecode.size()));
+	Write(file, Hash(a_bytecode));
+	file.insert(file.end(), a_bytecode.begin(), a_bytecode.end());
+	return file;
+}
+
+bool ShaderCache::Deserialize(std::span<const uint8_t> a_file, uint64_t a_key, std::vector<uint8_t>& a_bytecode)
+{
+	if (a_file.size() < kHeaderSize || std::memcmp(a_file.data(), kMagic, sizeof(kMagic)) != 0)
+		return false;
+
+	const uint8_t* header = a_file.data() + sizeof(kMagic);
+	if (Read<uint32_t>(header) != kVersion || Read<uint64_t>(header + 4) != a_key)
+		return false;
+
+	auto size = Read<uint64_t>(header + 12);
+	auto hash = Read<uint64_t>(header + 20);
+	auto body = a_file.subspan(kHeaderSize);
+	if (size == 0 || body.size() != size || Hash(body) != hash)
+		return false;
+
+	a_bytecode.assign(body.begin(), body.end());
+	return true;
+}
+
+bool ShaderCache::Load(const std::filesystem::path& a_path, uint64_t a_key, std::vector<uint8_t>& a_bytecode)
+{
+	std::ifstream stream(a_path, std::ios::binary);
+	if (!stream)
+		return false;
+	std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return Deserialize(file, a_key, a_bytecode);
+}
+
+bool ShaderCache::Store(const std::filesystem::path& a_path, uint64_t a_key, std::span<const uint8_t> a_bytecode)
+{
+	std::error_code error;
+	if (a_path.has_parent_path())
+		std::filesystem::create_directories(a_path.parent_path(), error);
+
+	auto temporary = a_path;
+	temporary += ".tmp";
+	{
+		auto file = Serialize(a_key, a_bytecode);
+		std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+		if (!stream.write(reinterpret_cast<const char*>(file.data()), std::streamsize(file.size())))
+			return false;
+	}
+
+	std::filesystem::rename(temporary, a_path, error);
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// On-disk cache for compiled shader bytecode. An entry is keyed by a hash of everything that affects
+// the compiler output; a file with another key, a bad checksum or a truncated body counts as a miss.
+//
+// File layout, little endian: "FSC1", u32 version, u64 key, u64 bytecode size, u64 bytecode hash, bytecode
+struct ShaderCache
+{
+	static constexpr uint32_t kVersion = 1;
+	static constexpr size_t kHeaderSize = 4 + 4 + 8 + 8 + 8;
+
+	struct KeyInputs
+	{
+		std::string_view source;  // Exact bytes handed to the compiler
+		std::string_view entry;
+		std::string_view profile;
+		uint32_t flags = 0;
+		uint32_t compilerVersion = 0;
+	};
+
+	// 64-bit FNV-1a, a_seed chains several inputs
+	static constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+	static uint64_t Hash(std::span<const uint8_t> a_data, uint64_t a_seed = kHashSeed);
+	static uint64_t Hash(std::string_view a_data, uint64_t a_seed = kHashSeed);
+
+	static uint64_t ComputeKey(const KeyInputs& a_inputs);
+
+	static std::vector<uint8_t> Serialize(uint64_t a_key, std::span<const uint8_t> a_bytecode);
+	static bool Deserialize(std::span<const uint8_t> a_file, uint64_t a_key, std::vector<uint8_t>& a_bytecode);
+
+	static bool Load(const std::filesystem::path& a_path, uint64_t a_key, std::vector<uint8_t>& a_bytecode);
+	// Writes a temporary file and renames it, so a crash never leaves a half written entry
+	static bool Store(const std::filesystem::path& a_path, uint64_t a_key, std::span<const uint8_t> a_bytecode);
+};
@@ -0,0 +1,158 @@
+#include "StaticFrameDetector.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+	// lowbias32, the same integer mix the shader uses
+	uint32_t Mix(uint32_t a_value)
+	{
+		a_value ^= a_value >> 16;
+		a_value *= 0x7feb352du;
+		a_value ^= a_value >> 15;
+		a_value *= 0x846ca68bu;
+		a_value ^= a_value >> 16;
+		return a_value;
+	}
+}
+
+float StaticFrameDetector::Tile::Motion() const
+{
+	return std::bit_cast<float>(motionBits);
+}
+
+uint32_t StaticFrameDetector::HashTexel(uint32_t a_x, uint32_t a_y, const float a_rgb[3])
+{
+	uint32_t hash = Mix(a_x | (a_y << 16));
+	for (int channel = 0; channel < 3; channel++)
+		hash = Mix(hash ^ std::bit_cast<uint32_t>(a_rgb[channel]));
+	return hash;
+}
+
+void StaticFrameDetector::HashTiles(CpuReference::Image<const float> a_color, CpuReference::Image<const CpuReference::Vec2> a_motionVectors,
+	float a_motionScaleX, float a_motionScaleY, std::vector<Tile>& a_tiles)
+{
+	uint32_t tilesX = TileCount(a_color.width);
+	uint32_t tilesY = TileCount(a_color.height);
+	a_tiles.assign(size_t(tilesX) * tilesY, Tile{});
+
+	// Texel hashes are summed, so the order the GPU threads add them in does not matter
+	std::vector<float> motion(a_tiles.size(), 0.0f);
+	for (uint32_t y = 0; y < a_color.height; y++) {
+		const float* color = a_color.Row(y);
+		const CpuReference::Vec2* motionVectors = a_motionVectors.data ? a_motionVectors.Row(y) : nullptr;
+		size_t tileRow = size_t(y / kTileSize) * tilesX;
+		for (uint32_t x = 0; x < a_color.width; x++) {
+			size_t tile = tileRow + x / kTileSize;
+			a_tiles[tile].hash += HashTexel(x, y, color + size_t(x) * 4);
+			if (motionVectors) {
+				float motionX = motionVectors[x].x * a_motionScaleX;
+				float motionY = motionVectors[x].y * a_motionScaleY;
+				motion[tile] = std::max(motion[tile], std::sqrt(motionX * motionX + motionY * motionY));
+			}
+		}
+	}
+
+	for (size_t tile = 0; tile < a_tiles.size(); tile++)
+		a_tiles[tile].motionBits = std::bit_cast<uint32_t>(motion[tile]);
+}
+
+bool StaticFrameDetector::BeginFrame(uint64_t a_frameID, const Camera& a_camera, bool a_invalidate)
+{
+	currentFrameID = a_frameID;
+
+	// Anything rendered from here on has to confirm the static state again
+	if (a_invalidate || (hasCamera && !(a_camera == camera))) {
+		isStatic = false;
+		matchedFrames = 0;
+		invalidatedFrameID = a_frameID;
+	}
+	camera = a_camera;
+	hasCamera = true;
+
+	if (!isStatic)
+		return false;
+
+	// Results still in flight may hold a change; stay static again once one confirms
+	if (lastResultFrameID == UINT64_MAX || a_frameID - lastResultFrameID > config.maxResultLatency) {
+		stats.staleFrames++;
+		return false;
+	}
+	stats.staticFrames++;
+	return true;
+}
+
+void StaticFrameDetector::AddTiles(uint64_t a_frameID, uint32_t a_phase, uint32_t a_tilesX, uint32_t a_tilesY, std::span<const Tile> a_tiles)
+{
+	bool ordered = lastResultFrameID == UINT64_MAX || a_frameID > lastResultFrameID;
+	if (a_frameID < invalidatedFrameID || !ordered || a_tiles.size() != size_t(a_tilesX) * a_tilesY || a_tiles.empty()) {
+		stats.droppedResults++;
+		return;
+	}
+
+	uint32_t phases = jitterPhases;
+	if (a_tilesX != tilesX || a_tilesY != tilesY || history.size() != phases) {
+		tilesX = a_tilesX;
+		tilesY = a_tilesY;
+		history.assign(phases, {});
+		historyValid.assign(phases, false);
+		isStatic = false;
+		matchedFrames = 0;
+	}
+
+	// A skipped readback leaves a gap the previous matches cannot vouch for
+	if (lastResultFrameID == UINT64_MAX || a_frameID != lastResultFrameID + 1)
+		matchedFrames = 0;
+	lastResultFrameID = a_frameID;
+
+	uint32_t phase = a_phase % phases;
+	bool matched = false;
+	if (historyValid[phase]) {
+		stats.comparedFrames++;
+		uint32_t changedTiles = 0;
+		bool moving = false;
+		auto& previous = history[phase];
+		for (size_t tile = 0; tile < a_tiles.size(); tile++) {
+			changedTiles += a_tiles[tile].hash != previous[tile].hash;
+			moving |= !(a_tiles[tile].Motion() <= config.maxMotionPixels);  // NaN counts as moving
+		}
+		matched = changedTiles <= config.maxChangedTiles && !moving;
+	}
+
+	history[phase].assign(a_tiles.begin(), a_tiles.end());
+	historyValid[phase] = true;
+
+	if (!matched) {
+		matchedFrames = 0;
+		isStatic = false;
+		return;
+	}
+
+	matchedFrames++;
+	if (matchedFrames >= phases * std::max(config.confirmCycles, 1u))
+		isStatic = true;
+}
+
+void StaticFrameDetector::SetJitterPhases(uint32_t a_phases)
+{
+	a_phases = std::max(a_phases, 1u);
+	if (a_phases == jitterPhases)
+		return;
+	jitterPhases = a_phases;
+	Reset();
+}
+
+void StaticFrameDetector::Reset()
+{
+	isStatic = false;
+	invalidatedFrameID = currentFrameID;
+	hasCamera = false;
+	history.clear();
+	historyValid.clear();
+	tilesX = 0;
+	tilesY = 0;
+	lastResultFrameID = UINT64_MAX;
+	matchedFrames = 0;
+}
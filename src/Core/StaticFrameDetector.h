@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "CpuReference.h"
+
+// Detects runs of frames that do not change (menus, the map, dialogue, paused screens) so AA and the
+// frame generation prepare can be skipped and the previous output shown again.
+// The GPU reduces every 32x32 tile of the pre-AA color to a hash of its bits and the largest motion
+// vector, read back a few frames later. Jittered frames only repeat once per jitter cycle, so each
+// frame is compared with the one a cycle earlier, and a full cycle of matches enters the static state.
+// Camera movement and explicit invalidations leave it at once, the late hashes only confirm: a static
+// frame needs a matching result at most maxResultLatency frames old, so a change shows that late at most.
+class StaticFrameDetector
+{
+public:
+	static constexpr uint32_t kTileSize = 32;
+
+	// Layout of the GPU buffer: uint2 per tile, row by row
+	struct Tile
+	{
+		uint32_t hash = 0;
+		uint32_t motionBits = 0;  // Float bits of the largest motion in pixels, non-negative so they order like integers
+
+		float Motion() const;
+		bool operator==(const Tile&) const = default;
+	};
+
+	struct Config
+	{
+		uint32_t confirmCycles = 1;      // Matching jitter cycles before frames count as static
+		uint32_t maxResultLatency = 3;   // Frames the newest result may lag behind, the readback ring depth
+		uint32_t maxChangedTiles = 0;    // Tiles whose hash may differ, e.g. a blinking cursor
+		float maxMotionPixels = 0.01f;   // Any tile moving further is not static
+	};
+
+	struct Camera
+	{
+		bool hasCamera = false;
+		float position[3] = {};
+		float right[3] = {};
+		float forward[3] = {};
+		float up[3] = {};
+
+		bool operator==(const Camera&) const = default;
+	};
+
+	struct Stats
+	{
+		uint64_t staticFrames = 0;    // Frames BeginFrame allowed to reuse the previous output
+		uint64_t staleFrames = 0;     // Static, but no recent enough result to confirm it
+		uint64_t comparedFrames = 0;  // Tile results compared with the previous cycle
+		uint64_t droppedResults = 0;  // Results out of order, too old or of a different size
+	};
+
+	StaticFrameDetector() = default;
+	explicit StaticFrameDetector(const Config& a_config) :
+		config(a_config) {}
+
+	// Start of a frame, before anything is skipped. True when the frame may reuse the previous output.
+	// a_invalidate covers changes the hashes cannot see in time: settings, scene cuts, new resources.
+	bool BeginFrame(uint64_t a_frameID, const Camera& a_camera, bool a_invalidate);
+
+	// Tile results of frame a_frameID, rendered with jitter phase a_phase
+	void AddTiles(uint64_t a_frameID, uint32_t a_phase, uint32_t a_tilesX, uint32_t a_tilesY, std::span<const Tile> a_tiles);
+
+	bool IsStatic() const { return isStatic; }
+	void Reset();
+
+	// Phase count of the upscaler's jitter sequence; a new count starts over
+	void SetJitterPhases(uint32_t a_phases);
+	uint32_t GetJitterPhases() const { return jitterPhases; }
+
+	const Config& GetConfig() const { return config; }
+	const Stats& GetStats() const { return stats; }
+
+	static uint32_t TileCount(uint32_t a_pixels) { return (a_pixels + kTileSize - 1) / kTileSize; }
+
+	// CPU reference of TileHashCS.hlsl. a_color has four floats per pixel, of which alpha is ignored; an
+	// empty a_motionVectors reads as zero like an unbound SRV. Hashes match the GPU bit for bit, motion
+	// up to the rounding of length().
+	static void HashTiles(CpuReference::Image<const float> a_color, CpuReference::Image<const CpuReference::Vec2> a_motionVectors,
+		float a_motionScaleX, float a_motionScaleY, std::vector<Tile>& a_tiles);
+	static uint32_t HashTexel(uint32_t a_x, uint32_t a_y, const float a_rgb[3]);
+
+private:
+	Config config;
+	uint32_t jitterPhases = 8;
+
+	bool isStatic = false;
+	uint64_t currentFrameID = 0;
+	uint64_t invalidatedFrameID = 0;  // Results of earlier frames no longer count
+	Camera camera;
+	bool hasCamera = false;
+
+	// Previous cycle's tiles per jitter phase
+	std::vector<std::vector<Tile>> history;
+	std::vector<bool> historyValid;
+	uint32_t tilesX = 0;
+	uint32_t tilesY = 0;
+	uint64_t lastResultFrameID = UINT64_MAX;
+	uint32_t matchedFrames = 0;
+
+	Stats stats;
+};
@@ -0,0 +1,131 @@
+#include "VramBudget.h"
+
+void VramBudget::Track(const void* a_key, std::string a_category, uint64_t a_bytes)
+{
+	if (!a_key)
+		return;
+
+	std::lock_guard guard(lock);
+	auto& allocation = allocations[a_key];
+	pluginBytes -= allocation.bytes;
+	allocation = { std::move(a_category), a_bytes };
+	pluginBytes += a_bytes;
+}
+
+void VramBudget::Untrack(const void* a_key)
+{
+	std::lock_guard guard(lock);
+	auto it = allocations.find(a_key);
+	if (it == allocations.end())
+		return;
+	pluginBytes -= it->second.bytes;
+	allocations.erase(it);
+}
+
+uint64_t VramBudget::PluginBytes() const
+{
+	std::lock_guard guard(lock);
+	return pluginBytes;
+}
+
+uint64_t VramBudget::CategoryBytes(const std::string& a_category) const
+{
+	std::lock_guard guard(lock);
+	uint64_t bytes = 0;
+	for (const auto& [key, allocation] : allocations) {
+		if (allocation.category == a_category)
+			bytes += allocation.bytes;
+	}
+	return bytes;
+}
+
+bool VramBudget::Update()
+{
+	Sample sample;
+	if (!provider || !provider->Query(sample) || sample.budget == 0)
+		return false;
+
+	Report report;
+	{
+		std::lock_guard guard(lock);
+		lastReport.sample = sample;
+		lastReport.pluginBytes = pluginBytes;
+		lastReport.level = level;
+		lastReport.valid = true;
+		report = lastReport;
+	}
+
+	double budget = double(sample.budget);
+	bool pressured = double(sample.usage) >= budget * config.enterPressure;
+
+	if (pressured) {
+		relaxedSamples = 0;
+		if (level == Level::kNoFrameGeneration || ++pressuredSamples < config.escalateSamples)
+			return false;
+		pressuredSamples = 0;
+		auto next = Level(uint8_t(level) + 1);
+		bytesBeforeLevel[size_t(next)] = report.pluginBytes;
+		SetLevel(next, report);
+		return true;
+	}
+
+	pressuredSamples = 0;
+	if (level == Level::kNormal)
+		return false;
+
+	// Stepping back allocates again what the current level released
+	uint64_t before = bytesBeforeLevel[size_t(level)];
+	uint64_t restored = before > report.pluginBytes ? before - report.pluginBytes : 0;
+	bool fits = double(sample.usage + restored) <= budget * config.exitPressure;
+	if (!fits) {
+		relaxedSamples = 0;
+		return false;
+	}
+	if (++relaxedSamples < config.recoverSamples)
+		return false;
+
+	relaxedSamples = 0;
+	SetLevel(Level(uint8_t(level) - 1), report);
+	return true;
+}
+
+void VramBudget::Reset()
+{
+	pressuredSamples = relaxedSamples = 0;
+	if (level != Level::kNormal)
+		SetLevel(Level::kNormal, GetReport());
+}
+
+VramBudget::Report VramBudget::GetReport() const
+{
+	std::lock_guard guard(lock);
+	return lastReport;
+}
+
+void VramBudget::SetLevel(Level a_level, const Report& a_report)
+{
+	auto from = level;
+	level = a_level;
+	{
+		std::lock_guard guard(lock);
+		lastReport.level = a_level;
+	}
+	if (onLevelChange)
+		onLevelChange(from, a_level, a_report);
+}
+
+const char* VramBudget::LevelName(Level a_level)
+{
+	switch (a_level) {
+	case Level::kNormal:
+		return "Normal";
+	case Level::kCompactFormats:
+		return "Compact Formats";
+	case Level::kNoUpscaledBuffer:
+		return "No AA Output";
+	case Level::kNoFrameGeneration:
+		return "No Frame Generation";
+	default:
+		return "Unknown";
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Tracks the plugin's own GPU allocations against the budget the OS grants the process and steps
+// through downgrade levels when the budget runs out. Sampled periodically (not every frame); a level
+// is only left again once usage plus what the level saved fits comfortably, so it does not oscillate.
+// The budget comes from a Provider: QueryVideoMemoryInfo in the plugin, any scripted source elsewhere.
+class VramBudget
+{
+public:
+	struct Sample
+	{
+		uint64_t budget = 0;  // What the OS lets the process use before it starts paging
+		uint64_t usage = 0;   // Whole process, game included
+	};
+
+	class Provider
+	{
+	public:
+		virtual ~Provider() = default;
+		virtual bool Query(Sample& a_sample) = 0;
+	};
+
+	// Each level includes the ones before it
+	enum class Level : uint8_t
+	{
+		kNormal,
+		kCompactFormats,     // Smaller formats for the shared textures
+		kNoUpscaledBuffer,   // Native AA off, which drops the AA output texture and the upscale context
+		kNoFrameGeneration,  // Frame generation context and its textures released
+		kCount
+	};
+
+	struct Config
+	{
+		float enterPressure = 0.95f;   // usage / budget at or above which a sample counts as pressure
+		float exitPressure = 0.85f;    // usage / budget, with the level's savings added back, to step back up
+		uint32_t escalateSamples = 3;  // Consecutive pressured samples before stepping down a level
+		uint32_t recoverSamples = 30;  // Consecutive relaxed samples before stepping back up
+	};
+
+	struct Report
+	{
+		Sample sample;
+		uint64_t pluginBytes = 0;
+		Level level = Level::kNormal;
+		bool valid = false;  // A sample was taken
+	};
+
+	using LevelCallback = std::function<void(Level, Level, const Report&)>;
+
+	VramBudget() = default;
+	explicit VramBudget(const Config& a_config) :
+		config(a_config) {}
+
+	void SetProvider(Provider* a_provider) { provider = a_provider; }
+	bool HasProvider() const { return provider != nullptr; }
+
+	// Allocation accounting, keyed by the owning object. Tracking a key again replaces its size.
+	void Track(const void* a_key, std::string a_category, uint64_t a_bytes);
+	void Untrack(const void* a_key);
+	uint64_t PluginBytes() const;
+	uint64_t CategoryBytes(const std::string& a_category) const;
+
+	// Takes a sample and moves at most one level. Returns true when the level changed.
+	bool Update();
+
+	// Drops back to kNormal, e.g. when the policy is switched off
+	void Reset();
+
+	Level GetLevel() const { return level; }
+	Report GetReport() const;
+
+	static const char* LevelName(Level a_level);
+
+	LevelCallback onLevelChange;
+
+private:
+	struct Allocation
+	{
+		std::string category;
+		uint64_t bytes;
+	};
+
+	void SetLevel(Level a_level, const Report& a_report);
+
+	Config config;
+	Provider* provider = nullptr;
+
+	mutable std::mutex lock;  // Accounting and the report are read by the UI
+	std::unordered_map<const void*, Allocation> allocations;
+	uint64_t pluginBytes = 0;
+	Report lastReport;
+
+	Level level = Level::kNormal;
+	uint32_t pressuredSamples = 0;
+	uint32_t relaxedSamples = 0;
+	// Plugin bytes right before each level was entered; the difference to now is what stepping back costs
+	uint64_t bytesBeforeLevel[size_t(Level::kCount)] = {};
+};
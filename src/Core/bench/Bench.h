@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Minimal benchmark registry. A BENCHMARK body calls State::Run with the operation to time; Run takes
+// a number of samples of a_batch calls each and Main.cpp reports the median and p99 time per call.
+namespace Bench
+{
+	class State
+	{
+	public:
+		explicit State(uint32_t a_samples) :
+			samples(a_samples) {}
+
+		template <class F>
+		void Run(F&& a_operation, uint32_t a_batch = 64)
+		{
+			using Clock = std::chrono::steady_clock;
+			batch = std::max(a_batch, 1u);
+			nanoseconds.clear();
+			nanoseconds.reserve(samples);
+			for (uint32_t sample = 0; sample < samples; sample++) {
+				auto start = Clock::now();
+				for (uint32_t i = 0; i < batch; i++)
+					a_operation();
+				auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+				nanoseconds.push_back(elapsed / batch);
+			}
+		}
+
+		// Per call, in nanoseconds
+		double Percentile(double a_fraction) const
+		{
+			if (nanoseconds.empty())
+				return 0.0;
+			auto sorted = nanoseconds;
+			std::sort(sorted.begin(), sorted.end());
+			size_t index = std::min(sorted.size() - 1, (size_t)(a_fraction * (double)(sorted.size() - 1) + 0.5));
+			return sorted[index];
+		}
+
+		uint32_t Samples() const { return samples; }
+		uint32_t Batch() const { return batch; }
+
+	private:
+		uint32_t samples;
+		uint32_t batch = 1;
+		std::vector<double> nanoseconds;
+	};
+
+	struct Case
+	{
+		const char* name;
+		void (*run)(State&);
+	};
+
+	inline std::vector<Case>& Registry()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* a_name, void (*a_run)(State&)) { Registry().push_back({ a_name, a_run }); }
+	};
+
+	// Keeps the compiler from discarding a result that is otherwise unused
+	template <class T>
+	inline void Keep(const T& a_value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&a_value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &a_value;
+#endif
+	}
+}
+
+#define BENCH_CAT_IMPL(a, b) a##b
+#define BENCH_CAT(a, b) BENCH_CAT_IMPL(a, b)
+
+#define BENCHMARK_IMPL(a_name, a_id)                                                  \
+	static void a_id(Bench::State& state);                                            \
+	static const Bench::Registrar BENCH_CAT(a_id, Registrar)(a_name, &a_id);          \
+	static void a_id([[maybe_unused]] Bench::State& state)
+
+#define BENCHMARK(a_name) BENCHMARK_IMPL(a_name, BENCH_CAT(Benchmark, __LINE__))
@@ -0,0 +1,76 @@
+#include "Bench.h"
+
+#include "Core/CpuReference.h"
+
+#include <type_traits>
+#include <vector>
+
+using namespace CpuReference;
+
+namespace
+{
+	constexpr uint32_t kWidth = 640;
+	constexpr uint32_t kHeight = 360;
+
+	struct Frame
+	{
+		Frame() :
+			luma(kWidth * kHeight, 0.5f), depth(kWidth * kHeight, 10.0f), motionVectors(kWidth * kHeight, Vec2{ 0.001f, -0.002f }), error(kWidth * kHeight), mask(kWidth * kHeight)
+		{
+			for (size_t i = 0; i < luma.size(); i++)
+				luma[i] = float(i % 97) / 97.0f;
+		}
+
+		template <class T>
+		static Image<T> View(std::vector<std::remove_const_t<T>>& a_pixels)
+		{
+			return { a_pixels.data(), kWidth, kHeight, kWidth };
+		}
+
+		std::vector<float> luma, depth;
+		std::vector<Vec2> motionVectors;
+		std::vector<float> error;
+		std::vector<uint8_t> mask;
+	};
+
+	// Detected before anything was forced
+	Isa BestIsa()
+	{
+		static const Isa best = GetIsa();
+		return best;
+	}
+
+	void ReprojectFrame(Bench::State& a_state, Isa a_isa, uint32_t a_threads)
+	{
+		BestIsa();
+		ForceIsa(a_isa);
+		SetThreadCount(a_threads);
+		Frame frame;
+		ReprojectionInputs inputs{ Frame::View<const float>(frame.luma), Frame::View<const float>(frame.depth), Frame::View<const Vec2>(frame.motionVectors), Frame::View<const float>(frame.luma), Frame::View<const float>(frame.depth) };
+		ReprojectionParams params;
+		params.motionVectorScaleX = float(kWidth);
+		params.motionVectorScaleY = float(kHeight);
+		a_state.Run([&]() {
+			auto stats = Reproject(inputs, params, Frame::View<float>(frame.error), Frame::View<uint8_t>(frame.mask));
+			Bench::Keep(stats);
+		}, 1);
+		ForceIsa(BestIsa());
+		SetThreadCount(0);
+	}
+}
+
+// One 640x360 frame; the SIMD and threaded rows show what the dispatch buys over the reference
+BENCHMARK("CpuReference Reproject scalar, 1 thread")
+{
+	ReprojectFrame(state, Isa::kScalar, 1);
+}
+
+BENCHMARK("CpuReference Reproject best ISA, 1 thread")
+{
+	ReprojectFrame(state, BestIsa(), 1);
+}
+
+BENCHMARK("CpuReference Reproject best ISA, all threads")
+{
+	ReprojectFrame(state, BestIsa(), 0);
+}
@@ -0,0 +1,66 @@
+#include "Bench.h"
+
+#include "Core/FrameContext.h"
+#include "Core/ResizePlanner.h"
+#include "Core/SceneCutDetector.h"
+
+#include <cmath>
+
+BENCHMARK("FrameContextSlot Publish")
+{
+	FrameContextSlot slot;
+	FrameContext ctx;
+	state.Run([&]() {
+		ctx.frameID++;
+		slot.Publish(ctx);
+	});
+	Bench::Keep(slot.Version());
+}
+
+BENCHMARK("FrameContextSlot Read")
+{
+	FrameContextSlot slot;
+	state.Run([&]() {
+		auto ctx = slot.Read();
+		Bench::Keep(ctx);
+	});
+}
+
+BENCHMARK("SceneCutDetector Update with histogram")
+{
+	SceneCutDetector detector;
+	uint32_t histogram[64] = {};
+	SceneCutDetector::Sample sample;
+	sample.hasCamera = true;
+	sample.forward[1] = 1.0f;
+	sample.right[0] = 1.0f;
+	sample.up[2] = 1.0f;
+	sample.fovVerticalRad = 1.2f;
+	sample.deltaTimeMs = 16.6f;
+	sample.depthHistogram = histogram;
+
+	uint32_t frame = 0;
+	state.Run([&]() {
+		frame++;
+		sample.position[0] = (float)frame;
+		histogram[frame & 63]++;
+		auto decision = detector.Update(sample);
+		Bench::Keep(decision);
+	});
+}
+
+BENCHMARK("ResizePlanner Build")
+{
+	ResizePlanner planner;
+	ResizePlanner::Current current;
+	current.interop = { 1920, 1080 };
+	current.sharedResources = { 1920, 1080 };
+	current.upscaleMaxRender = { 1920, 1080 };
+	current.upscaleMaxOutput = { 1920, 1080 };
+	ResizePlanner::Target target{ { 1920, 1080 }, 24, { 1920, 1080 } };
+	state.Run([&]() {
+		target.display.width ^= 1;
+		auto plan = planner.Build(current, target);
+		Bench::Keep(plan);
+	});
+}
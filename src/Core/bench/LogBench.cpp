@@ -0,0 +1,40 @@
+#include "Bench.h"
+
+#include "Core/AsyncLog.h"
+#include "Core/LogLimiter.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// A hot-path log call that is throttled away must cost next to nothing
+BENCHMARK("LogRateLimiter Allow (suppressed)")
+{
+	LogRateLimiter limiter(1, 1h);
+	uint64_t suppressed = 0;
+	state.Run([&]() {
+		bool allowed = limiter.Allow(suppressed);
+		Bench::Keep(allowed);
+	});
+}
+
+// Per call latency of a producer while the writer thread drains the queue; p99 is the number to watch
+BENCHMARK("LogQueue TryPush with a draining consumer")
+{
+	LogQueue queue(4096);
+	std::atomic<bool> stop{ false };
+	std::thread consumer([&]() {
+		std::string line;
+		while (!stop.load(std::memory_order_relaxed))
+			queue.TryPop(line);
+	});
+
+	state.Run([&]() {
+		bool pushed = queue.TryPush("[FSR4] Frame 123456 over its command budget: copies 5/4");
+		Bench::Keep(pushed);
+	}, 1);
+
+	stop = true;
+	consumer.join();
+}
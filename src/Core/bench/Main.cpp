@@ -0,0 +1,35 @@
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstring>
+
+// Usage: FSR4_CoreBench [--quick] [name filter]. --quick takes few samples so CTest only checks that
+// every benchmark still runs; timings from it are not meaningful.
+int main(int argc, char** argv)
+{
+	uint32_t samples = 200;
+	const char* filter = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--quick") == 0)
+			samples = 3;
+		else
+			filter = argv[i];
+	}
+
+	std::printf("%-44s %12s %12s\n", "benchmark", "median ns", "p99 ns");
+	int run = 0;
+	for (const auto& benchmark : Bench::Registry()) {
+		if (filter && !std::strstr(benchmark.name, filter))
+			continue;
+		Bench::State state(samples);
+		benchmark.run(state);
+		std::printf("%-44s %12.1f %12.1f\n", benchmark.name, state.Percentile(0.5), state.Percentile(0.99));
+		run++;
+	}
+
+	if (run == 0) {
+		std::fprintf(stderr, "no benchmarks match %s\n", filter ? filter : "(all)");
+		return 1;
+	}
+	return 0;
+}
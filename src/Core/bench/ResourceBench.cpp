@@ -0,0 +1,13 @@
+#include "Bench.h"
+
+#include "Core/RingAllocator.h"
+
+BENCHMARK("RingAllocator Allocate")
+{
+	RingAllocator ring(64 * 1024);
+	RingAllocator::Allocation allocation;
+	state.Run([&]() {
+		ring.Allocate(192, allocation);
+		Bench::Keep(allocation);
+	});
+}
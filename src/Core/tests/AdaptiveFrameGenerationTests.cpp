@@ -0,0 +1,186 @@
+#include "Test.h"
+
+#include "Core/AdaptiveFrameGeneration.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using Reason = AdaptiveFrameGeneration::Reason;
+
+	constexpr float kRefreshHz = 144.0f;  // Stays on up to 72 fps base, turns on below 64.8
+
+	// Feeds frames at a_fps for a_seconds; records when the state last changed
+	struct Run
+	{
+		AdaptiveFrameGeneration::Decision Frames(float a_fps, double a_seconds, float a_refreshHz = kRefreshHz)
+		{
+			float frameMs = 1000.0f / a_fps;
+			double end = time + a_seconds;
+			while (time < end) {
+				time += frameMs / 1000.0;
+				last = policy.Update(frameMs, a_refreshHz, time);
+				if (last.changed) {
+					changes++;
+					changedAt = time;
+					resets += last.reset;
+				}
+			}
+			return last;
+		}
+
+		AdaptiveFrameGeneration policy;
+		AdaptiveFrameGeneration::Decision last;
+		double time = 0.0;
+		double changedAt = -1.0;
+		uint32_t changes = 0;
+		uint32_t resets = 0;
+	};
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "stays off during startup, then turns on after the dwell time")
+{
+	Run run;
+	auto startup = run.Frames(60.0f, 0.9);
+	CHECK(!startup.enabled);
+	CHECK(startup.reason == Reason::kStartup);
+	CHECK_NEAR(startup.baseFps, 60.0, 0.01);
+
+	// In range from one second on; the first state began with the first frame, two seconds of dwell
+	auto on = run.Frames(60.0f, 2.0);
+	CHECK(on.enabled);
+	CHECK(on.reason == Reason::kInRange);
+	CHECK(run.changes == 1);
+	CHECK(run.resets == 1);
+	CHECK_NEAR(run.changedAt, 2.0, 0.05);
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "the band to stay in is wider than the band to enter")
+{
+	Run run;
+	run.Frames(60.0f, 3.0);
+	REQUIRE(run.last.enabled);
+
+	// 42 fps is under the enable margin but above the minimum
+	CHECK(run.Frames(42.0f, 5.0).enabled);
+	CHECK(run.changes == 1);
+
+	auto low = run.Frames(35.0f, 5.0);
+	CHECK(!low.enabled);
+	CHECK(low.reason == Reason::kBaseTooLow);
+	CHECK(run.changes == 2);
+
+	// Back at 42 fps it stays off: switching on needs 45
+	CHECK(!run.Frames(42.0f, 5.0).enabled);
+	CHECK(run.Frames(47.0f, 5.0).enabled);
+	CHECK(run.changes == 3);
+
+	// The headroom edge: 68 fps stays on, and does not turn on from off
+	CHECK(run.Frames(68.0f, 5.0).enabled);
+	auto high = run.Frames(90.0f, 5.0);
+	CHECK(!high.enabled);
+	CHECK(high.reason == Reason::kNoHeadroom);
+	CHECK(!run.Frames(68.0f, 5.0).enabled);
+	CHECK(run.Frames(60.0f, 5.0).enabled);
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "a switch waits for the sustain and dwell times")
+{
+	Run run;
+	run.Frames(60.0f, 3.0);
+	REQUIRE(run.last.enabled);
+	double onAt = run.changedAt;
+
+	// Off right after switching on: not before two seconds in the on state
+	run.Frames(20.0f, 0.5);
+	CHECK(run.last.enabled);
+	run.Frames(20.0f, 3.0);
+	CHECK(!run.last.enabled);
+	CHECK(run.changedAt - onAt >= 2.0);
+
+	// A dip shorter than the sustain time does not switch
+	run.Frames(60.0f, 4.0);
+	REQUIRE(run.last.enabled);
+	uint32_t changes = run.changes;
+	run.Frames(20.0f, 0.2);
+	run.Frames(60.0f, 2.0);
+	CHECK(run.changes == changes);
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "hitches are ignored")
+{
+	Run run;
+	run.Frames(60.0f, 3.0);
+	REQUIRE(run.last.enabled);
+	float baseFps = run.last.baseFps;
+
+	for (float frameMs : { 1000.0f, 300.0f, 0.0f, -5.0f, NAN }) {
+		auto decision = run.policy.Update(frameMs, kRefreshHz, run.time += 0.3);
+		CHECK(decision.enabled);
+		CHECK(!decision.changed);
+		CHECK(decision.baseFps == baseFps);
+	}
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "no refresh rate means no headroom limit")
+{
+	Run run;
+	CHECK(run.Frames(200.0f, 3.0, 0.0f).enabled);
+	CHECK(!run.Frames(200.0f, 5.0).enabled);
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "reset starts over")
+{
+	Run run;
+	run.Frames(60.0f, 3.0);
+	REQUIRE(run.last.enabled);
+	run.policy.Reset();
+	CHECK(!run.policy.GetLast().enabled);
+	auto decision = run.policy.Update(16.6f, kRefreshHz, run.time + 0.1);
+	CHECK(!decision.enabled);
+	CHECK(decision.reason == Reason::kStartup);
+	CHECK(std::string(AdaptiveFrameGeneration::ReasonName(Reason::kNoHeadroom)) == "no refresh headroom");
+}
+
+TEST_CASE("AdaptiveFrameGeneration", "simulation over frame time traces")
+{
+	AdaptiveFrameGeneration::Config config;
+
+	std::vector<float> steady(600, 1000.0f / 60.0f);
+	auto on = SimulateAdaptiveFrameGeneration(config, steady, kRefreshHz);
+	CHECK(on.transitions == 1);
+	CHECK_NEAR(on.totalSeconds, 10.0, 1e-6);
+	CHECK_NEAR(on.EnabledFraction(), 0.8, 0.01);
+
+	std::vector<float> slow(300, 1000.0f / 30.0f);
+	auto off = SimulateAdaptiveFrameGeneration(config, slow, kRefreshHz);
+	CHECK(off.transitions == 0);
+	CHECK(off.EnabledFraction() == 0.0);
+
+	// Around the lower edge: 0.3 s at 37 fps, 0.3 s at 48 fps, with a hitch every few seconds
+	std::vector<float> noisy;
+	for (int cycle = 0; cycle < 100; cycle++) {
+		for (float fps : { 37.0f, 48.0f }) {
+			for (int frame = 0; frame < int(fps * 0.3f); frame++)
+				noisy.push_back(1000.0f / fps);
+		}
+		if (cycle % 10 == 0)
+			noisy.push_back(400.0f);
+	}
+	auto damped = SimulateAdaptiveFrameGeneration(config, noisy, kRefreshHz);
+
+	// Without smoothing, hysteresis, sustain and dwell it follows every swing
+	AdaptiveFrameGeneration::Config raw;
+	raw.enableMarginFps = 0.0f;
+	raw.headroomHysteresis = 0.0f;
+	raw.smoothingSeconds = 0.0f;
+	raw.sustainSeconds = 0.0f;
+	raw.minDwellSeconds = 0.0f;
+	auto undamped = SimulateAdaptiveFrameGeneration(raw, noisy, kRefreshHz);
+
+	CHECK(damped.transitions <= 2);
+	CHECK(undamped.transitions >= 150);
+	CHECK(SimulateAdaptiveFrameGeneration(config, {}, kRefreshHz).EnabledFraction() == 0.0);
+}
@@ -0,0 +1,50 @@
+#include "Test.h"
+
+#include "Core/BackgroundWorker.h"
+
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("BackgroundWorker", "jobs run in submission order and report status")
+{
+	BackgroundWorker worker;
+	std::vector<int> order;
+
+	auto first = worker.Submit("first", [&]() { order.push_back(1); return true; });
+	auto second = worker.Submit("second", [&]() { order.push_back(2); return false; });
+	auto third = worker.Submit("third", [&]() -> bool { throw std::runtime_error("boom"); });
+	third->Wait();
+
+	CHECK(first->GetStatus() == BackgroundWorker::Status::kSucceeded);
+	CHECK(second->GetStatus() == BackgroundWorker::Status::kFailed);
+	CHECK(third->GetStatus() == BackgroundWorker::Status::kFailed);
+	CHECK((order == std::vector<int>{ 1, 2 }));
+	CHECK(first->GetName() == "first");
+	CHECK(first->QueuedMs() >= 0.0);
+	CHECK(first->RunMs() >= 0.0);
+}
+
+TEST_CASE("BackgroundWorker", "a finished job's writes are visible")
+{
+	BackgroundWorker worker;
+	int value = 0;
+	auto job = worker.Submit("write", [&]() { value = 42; return true; });
+	while (!job->IsFinished()) {
+	}
+	CHECK(value == 42);
+}
+
+TEST_CASE("BackgroundWorker", "Stop drains the queue and Submit restarts")
+{
+	BackgroundWorker worker;
+	int ran = 0;
+	for (int i = 0; i < 16; i++)
+		worker.Submit("job", [&]() { ran++; return true; });
+	worker.Stop();
+	CHECK(ran == 16);
+	CHECK(worker.IsIdle());
+
+	auto job = worker.Submit("again", [&]() { ran++; return true; });
+	job->Wait();
+	CHECK(ran == 17);
+}
@@ -0,0 +1,255 @@
+#include "Test.h"
+
+#include "Core/CpuReference.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace CpuReference;
+
+namespace
+{
+	// Owns the pixels behind an Image view
+	template <class T>
+	struct Plane
+	{
+		Plane(uint32_t a_width, uint32_t a_height) :
+			pixels(size_t(a_width) * a_height), width(a_width), height(a_height) {}
+
+		Image<T> View() { return { pixels.data(), width, height, width }; }
+		Image<const T> ConstView() const { return { pixels.data(), width, height, width }; }
+		T& At(uint32_t a_x, uint32_t a_y) { return pixels[size_t(a_y) * width + a_x]; }
+
+		std::vector<T> pixels;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// Restores automatic ISA selection and threading when a test leaves
+	struct IsaScope
+	{
+		~IsaScope()
+		{
+			ForceIsa(DetectedIsa());
+			SetThreadCount(0);
+		}
+
+		static Isa DetectedIsa()
+		{
+			static const Isa detected = GetIsa();
+			return detected;
+		}
+	};
+
+	struct Scene
+	{
+		Scene(uint32_t a_width, uint32_t a_height, uint32_t a_seed) :
+			luma(a_width, a_height), previousLuma(a_width, a_height), depth(a_width, a_height), previousDepth(a_width, a_height), motionVectors(a_width, a_height)
+		{
+			std::mt19937 random(a_seed);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			std::uniform_real_distribution<float> motion(-0.01f, 0.01f);
+			for (uint32_t y = 0; y < a_height; y++) {
+				for (uint32_t x = 0; x < a_width; x++) {
+					luma.At(x, y) = unit(random);
+					previousLuma.At(x, y) = unit(random);
+					depth.At(x, y) = 1.0f + 100.0f * unit(random);
+					previousDepth.At(x, y) = 1.0f + 100.0f * unit(random);
+					motionVectors.At(x, y) = { motion(random), motion(random) };
+				}
+			}
+		}
+
+		ReprojectionInputs Inputs() const
+		{
+			return { luma.ConstView(), depth.ConstView(), motionVectors.ConstView(), previousLuma.ConstView(), previousDepth.ConstView() };
+		}
+
+		Plane<float> luma, previousLuma, depth, previousDepth;
+		Plane<Vec2> motionVectors;
+	};
+}
+
+TEST_CASE("CpuReference", "half to float covers normals, subnormals and specials")
+{
+	IsaScope scope;
+	const std::vector<uint16_t> half = { 0x3C00, 0xC000, 0x0000, 0x8000, 0x7C00, 0xFC00, 0x0001, 0x03FF, 0x3555, 0x7BFF, 0x7E00, 0x4600 };
+	std::vector<float> out(half.size());
+	HalfToFloat(half, out);
+
+	CHECK(out[0] == 1.0f);
+	CHECK(out[1] == -2.0f);
+	CHECK(out[2] == 0.0f && !std::signbit(out[2]));
+	CHECK(out[3] == 0.0f && std::signbit(out[3]));
+	CHECK(out[4] == std::numeric_limits<float>::infinity());
+	CHECK(out[5] == -std::numeric_limits<float>::infinity());
+	CHECK(out[6] == std::ldexp(1.0f, -24));
+	CHECK(out[7] == std::ldexp(1023.0f, -24));
+	CHECK_NEAR(out[8], 0.333251953f, 1e-9);
+	CHECK(out[9] == 65504.0f);
+	CHECK(std::isnan(out[10]));
+	CHECK(out[11] == 6.0f);
+}
+
+TEST_CASE("CpuReference", "linearized depth matches the projection")
+{
+	Plane<float> depth(4, 1);
+	depth.pixels = { 1.0f, 0.5f, 0.01f, 0.0f };
+	Plane<float> linear(4, 1);
+
+	// Inverted infinite: d = near / z
+	LinearizeDepth(depth.ConstView(), linear.View(), { true, true, 0.1f, 0.0f });
+	CHECK_NEAR(linear.pixels[0], 0.1f, 1e-6);
+	CHECK_NEAR(linear.pixels[1], 0.2f, 1e-6);
+	CHECK_NEAR(linear.pixels[2], 10.0f, 1e-4);
+	CHECK(std::isinf(linear.pixels[3]));
+
+	// Standard finite: 0 is the near plane, 1 the far plane
+	depth.pixels = { 0.0f, 1.0f, 0.0f, 1.0f };
+	LinearizeDepth(depth.ConstView(), linear.View(), { false, false, 0.5f, 1000.0f });
+	CHECK_NEAR(linear.pixels[0], 0.5f, 1e-5);
+	CHECK_NEAR(linear.pixels[1], 1000.0f, 1e-2);
+}
+
+TEST_CASE("CpuReference", "dilation takes the motion of the nearest neighbour")
+{
+	Plane<float> depth(5, 5);
+	Plane<Vec2> motionVectors(5, 5);
+	for (auto& value : depth.pixels)
+		value = 0.1f;
+	// One foreground pixel (largest inverted depth) moving differently from the background
+	depth.At(2, 2) = 0.9f;
+	motionVectors.At(2, 2) = { 1.0f, -1.0f };
+
+	Plane<Vec2> dilated(5, 5);
+	DilateMotionVectors(depth.ConstView(), motionVectors.ConstView(), dilated.View(), true);
+	for (uint32_t y = 0; y < 5; y++) {
+		for (uint32_t x = 0; x < 5; x++) {
+			bool neighbour = x >= 1 && x <= 3 && y >= 1 && y <= 3;
+			CHECK(dilated.At(x, y).x == (neighbour ? 1.0f : 0.0f));
+		}
+	}
+}
+
+TEST_CASE("CpuReference", "a correct integer shift reprojects without error")
+{
+	const uint32_t width = 40, height = 20;
+	Plane<float> luma(width, height), previousLuma(width, height), depth(width, height);
+	Plane<Vec2> motionVectors(width, height);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			previousLuma.At(x, y) = float(x * 7 + y * 13);
+			// The image moved 3 pixels right: the previous position is 3 pixels left
+			luma.At(x, y) = x >= 3 ? previousLuma.At(x - 3, y) : 0.0f;
+			depth.At(x, y) = 10.0f;
+			motionVectors.At(x, y) = { -3.0f / width, 0.0f };
+		}
+	}
+
+	ReprojectionParams params;
+	params.motionVectorScaleX = float(width);
+	params.motionVectorScaleY = float(height);
+	Plane<uint8_t> mask(width, height);
+	auto stats = Reproject({ luma.ConstView(), depth.ConstView(), motionVectors.ConstView(), previousLuma.ConstView(), depth.ConstView() }, params, {}, mask.View());
+
+	CHECK(stats.offscreenPixels == 3 * height);
+	CHECK(stats.validPixels == (width - 3) * height);
+	CHECK(stats.disoccludedPixels == 0);
+	CHECK(stats.maxError == 0.0f);
+	CHECK(mask.At(0, 5) == kOffscreen);
+	CHECK(mask.At(3, 5) == kValid);
+}
+
+TEST_CASE("CpuReference", "pixels behind former foreground are disoccluded")
+{
+	const uint32_t width = 16, height = 16;
+	Plane<float> luma(width, height), depth(width, height), previousDepth(width, height);
+	Plane<Vec2> motionVectors(width, height);
+	for (auto& value : depth.pixels)
+		value = 100.0f;
+	for (auto& value : previousDepth.pixels)
+		value = 100.0f;
+	// An object close to the camera covered the left half last frame
+	for (uint32_t y = 0; y < height; y++)
+		for (uint32_t x = 0; x < width / 2; x++)
+			previousDepth.At(x, y) = 2.0f;
+
+	ReprojectionParams params;
+	auto stats = Reproject({ luma.ConstView(), depth.ConstView(), motionVectors.ConstView(), luma.ConstView(), previousDepth.ConstView() }, params);
+	// The column next to the edge still touches a far pixel of the previous frame
+	CHECK(stats.disoccludedPixels == (width / 2 - 1) * height);
+	CHECK(stats.validPixels == (width / 2 + 1) * height);
+}
+
+TEST_CASE("CpuReference", "SIMD kernels and threading match the scalar reference")
+{
+	IsaScope scope;
+	auto best = IsaScope::DetectedIsa();
+	std::printf("  best ISA: %s\n", IsaName(best));
+
+	// Odd sizes exercise the vector tails and a partial last band
+	Scene scene(67, 45, 7);
+	ReprojectionParams params;
+	params.motionVectorScaleX = 67.0f;
+	params.motionVectorScaleY = -45.0f;
+	params.jitterDeltaX = 0.25f;
+	params.jitterDeltaY = -0.125f;
+
+	std::vector<uint16_t> half(1031);
+	for (size_t i = 0; i < half.size(); i++)
+		half[i] = uint16_t(i * 63);
+
+	struct Result
+	{
+		ReprojectionStats stats;
+		std::vector<float> error;
+		std::vector<uint8_t> mask;
+		std::vector<float> linear;
+		std::vector<Vec2> dilated;
+		std::vector<float> halfs;
+	};
+	auto run = [&](Isa a_isa, uint32_t a_threads) {
+		ForceIsa(a_isa);
+		SetThreadCount(a_threads);
+		Plane<float> error(67, 45), linear(67, 45);
+		Plane<uint8_t> mask(67, 45);
+		Plane<Vec2> dilated(67, 45);
+		Result result;
+		result.stats = Reproject(scene.Inputs(), params, error.View(), mask.View());
+		LinearizeDepth(scene.depth.ConstView(), linear.View(), {});
+		DilateMotionVectors(scene.depth.ConstView(), scene.motionVectors.ConstView(), dilated.View(), true);
+		result.halfs.resize(half.size());
+		HalfToFloat(half, result.halfs);
+		result.error = error.pixels;
+		result.mask = mask.pixels;
+		result.linear = linear.pixels;
+		result.dilated = dilated.pixels;
+		return result;
+	};
+
+	auto reference = run(Isa::kScalar, 1);
+	CHECK(reference.stats.validPixels + reference.stats.disoccludedPixels + reference.stats.offscreenPixels == 67 * 45);
+	CHECK(reference.stats.validPixels > 0);
+	CHECK(reference.stats.disoccludedPixels > 0);
+
+	for (auto [isa, threads] : { std::pair{ Isa::kScalar, 3u }, std::pair{ best, 1u }, std::pair{ best, 0u } }) {
+		auto other = run(isa, threads);
+		CHECK(other.mask == reference.mask);
+		CHECK(other.stats.validPixels == reference.stats.validPixels);
+		CHECK(other.stats.disoccludedPixels == reference.stats.disoccludedPixels);
+		CHECK_NEAR(other.stats.meanError, reference.stats.meanError, 1e-5);
+		CHECK_NEAR(other.stats.maxError, reference.stats.maxError, 1e-5);
+		for (size_t i = 0; i < reference.error.size(); i++)
+			CHECK_NEAR(other.error[i], reference.error[i], 1e-5);
+		for (size_t i = 0; i < reference.linear.size(); i++)
+			CHECK_NEAR(other.linear[i], reference.linear[i], std::abs(reference.linear[i]) * 1e-6);
+		for (size_t i = 0; i < reference.dilated.size(); i++)
+			CHECK(other.dilated[i].x == reference.dilated[i].x && other.dilated[i].y == reference.dilated[i].y);
+		// Bit exact, except that the hardware conversion quiets signalling NaNs
+		for (size_t i = 0; i < half.size(); i++)
+			CHECK(std::memcmp(&other.halfs[i], &reference.halfs[i], sizeof(float)) == 0 || (std::isnan(other.halfs[i]) && std::isnan(reference.halfs[i])));
+	}
+}
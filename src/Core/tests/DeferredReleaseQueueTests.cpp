@@ -0,0 +1,111 @@
+#include "Test.h"
+
+#include "Core/DeferredReleaseQueue.h"
+
+#include <vector>
+
+namespace
+{
+	// Stands in for an ID3D12Fence: the test advances the GPU timeline by hand
+	struct FakeFence
+	{
+		uint64_t completed = 0;
+		uint64_t CompletedValue() const { return completed; }
+	};
+
+	struct Counted
+	{
+		explicit Counted(int& a_live) :
+			live(a_live) { live++; }
+		~Counted() { live--; }
+		int& live;
+	};
+}
+
+TEST_CASE("DeferredReleaseQueue", "nothing is freed before its fence value")
+{
+	DeferredReleaseQueue<FakeFence> queue;
+	std::vector<int> freed;
+	queue.Enqueue(5, [&]() { freed.push_back(5); }, 100);
+	queue.Enqueue(6, [&]() { freed.push_back(6); }, 200);
+
+	queue.GetFence().completed = 4;
+	CHECK(queue.Drain() == 0);
+	CHECK(queue.GetMetrics().depth == 2);
+	CHECK(queue.GetMetrics().bytesPending == 300);
+
+	queue.GetFence().completed = 5;
+	CHECK(queue.Drain() == 1);
+	CHECK((freed == std::vector<int>{ 5 }));
+	CHECK(queue.GetMetrics().bytesPending == 200);
+
+	queue.GetFence().completed = 10;
+	CHECK(queue.Drain() == 1);
+	CHECK(queue.IsEmpty());
+	CHECK(queue.GetMetrics().released == 2);
+	CHECK(queue.GetMetrics().bytesReleased == 300);
+	CHECK(queue.GetMetrics().peakBytesPending == 300);
+	CHECK(queue.GetMetrics().peakDepth == 2);
+}
+
+TEST_CASE("DeferredReleaseQueue", "out of order values are kept sorted")
+{
+	DeferredReleaseQueue<FakeFence> queue;
+	std::vector<int> freed;
+	queue.Enqueue(9, [&]() { freed.push_back(9); });
+	queue.Enqueue(3, [&]() { freed.push_back(3); });
+	queue.Enqueue(6, [&]() { freed.push_back(6); });
+
+	queue.GetFence().completed = 6;
+	CHECK(queue.Drain() == 2);
+	CHECK((freed == std::vector<int>{ 3, 6 }));
+}
+
+TEST_CASE("DeferredReleaseQueue", "frame timeline keeps at most the frames in flight")
+{
+	// The CPU runs up to three frames ahead of the GPU, one texture retired per frame
+	DeferredReleaseQueue<FakeFence> queue;
+	int live = 0;
+	for (uint64_t frame = 1; frame <= 100; frame++) {
+		queue.EnqueueDelete(frame, new Counted(live), 1024);
+		queue.GetFence().completed = frame >= 3 ? frame - 3 : 0;
+		queue.Drain();
+		CHECK(queue.GetMetrics().depth <= 3);
+	}
+	CHECK(live == 3);
+	// Peaks right after an enqueue, before that frame's drain
+	CHECK(queue.GetMetrics().peakBytesPending == 4 * 1024);
+
+	queue.ReleaseAll();
+	CHECK(live == 0);
+	CHECK(queue.GetMetrics().bytesPending == 0);
+}
+
+TEST_CASE("DeferredReleaseQueue", "a release callback may enqueue more")
+{
+	DeferredReleaseQueue<FakeFence> queue;
+	int second = 0;
+	queue.Enqueue(1, [&]() { queue.Enqueue(2, [&]() { second++; }); });
+
+	queue.GetFence().completed = 1;
+	CHECK(queue.Drain() == 1);
+	CHECK(second == 0);
+	CHECK(!queue.IsEmpty());
+
+	queue.GetFence().completed = 2;
+	queue.Drain();
+	CHECK(second == 1);
+}
+
+TEST_CASE("DeferredReleaseQueue", "destruction frees what is left")
+{
+	int live = 0;
+	{
+		DeferredReleaseQueue<FakeFence> queue;
+		queue.EnqueueDelete(100, new Counted(live));
+		queue.EnqueueDelete<Counted>(100, nullptr);
+		CHECK(live == 1);
+		CHECK(queue.GetMetrics().depth == 1);
+	}
+	CHECK(live == 0);
+}
@@ -0,0 +1,102 @@
+#include "Test.h"
+
+#include "Core/DirtyRangeTracker.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	using Range = DirtyRangeTracker::Range;
+}
+
+TEST_CASE("DirtyRangeTracker", "marks are clamped, sorted and merged")
+{
+	DirtyRangeTracker tracker(100, 1);
+	tracker.Mark(50, 10);
+	tracker.Mark(10, 5);
+	tracker.Mark(15, 5);  // Touches [10, 15)
+	tracker.Mark(95, 50);
+	tracker.Mark(200, 1);
+	tracker.Mark(0, 0);
+
+	CHECK((tracker.Peek(0) == std::vector<Range>{ { 10, 20 }, { 50, 60 }, { 95, 100 } }));
+	CHECK(tracker.DirtyCount(0) == 25);
+	CHECK(!tracker.IsFullyDirty(0));
+
+	tracker.Mark(0, 100);
+	CHECK(tracker.IsFullyDirty(0));
+}
+
+TEST_CASE("DirtyRangeTracker", "merge gap joins nearby ranges")
+{
+	DirtyRangeTracker tracker(100, 1, 4);
+	tracker.Mark(10, 5);
+	tracker.Mark(19, 1);
+	tracker.Mark(30, 1);
+	CHECK((tracker.Peek(0) == std::vector<Range>{ { 10, 20 }, { 30, 31 } }));
+}
+
+TEST_CASE("DirtyRangeTracker", "collapses into the bounding range past the limit")
+{
+	DirtyRangeTracker tracker(1000, 1);
+	for (uint32_t i = 0; i <= DirtyRangeTracker::kMaxRanges; i++)
+		tracker.Mark(i * 10, 1);
+	CHECK((tracker.Peek(0) == std::vector<Range>{ { 0, DirtyRangeTracker::kMaxRanges * 10 + 1 } }));
+}
+
+TEST_CASE("DirtyRangeTracker", "each copy takes only what it is missing")
+{
+	// Streamed through three copies: a change reaches each copy when that copy is next written
+	DirtyRangeTracker tracker(64, 3);
+	tracker.MarkAll();
+	CHECK(tracker.IsFullyDirty(2));
+
+	CHECK((tracker.Take(0) == std::vector<Range>{ { 0, 64 } }));
+	CHECK(!tracker.IsDirty(0));
+
+	tracker.Mark(8, 8);
+	CHECK((tracker.Take(0) == std::vector<Range>{ { 8, 16 } }));
+	CHECK((tracker.Take(1) == std::vector<Range>{ { 0, 64 } }));
+
+	tracker.Mark(32, 1);
+	CHECK((tracker.Take(2) == std::vector<Range>{ { 0, 64 } }));
+	CHECK((tracker.Take(1) == std::vector<Range>{ { 32, 33 } }));
+	CHECK((tracker.Take(0) == std::vector<Range>{ { 32, 33 } }));
+	CHECK(!tracker.IsDirty(0) && !tracker.IsDirty(1) && !tracker.IsDirty(2));
+}
+
+TEST_CASE("DirtyRangeTracker", "random marks are always covered")
+{
+	std::mt19937 random(1234);
+	const uint32_t size = 500;
+	for (uint32_t gap : { 0u, 3u }) {
+		DirtyRangeTracker tracker(size, 2, gap);
+		// Marks since copy 1 was last taken, a subset of what either copy is missing
+		std::vector<bool> dirty(size, false);
+		for (int round = 0; round < 200; round++) {
+			uint32_t begin = random() % (size + 20);
+			uint32_t count = random() % 12;
+			tracker.Mark(begin, count);
+			for (uint32_t i = begin; i < begin + count && i < size; i++)
+				dirty[i] = true;
+
+			if (round % 25 == 24) {
+				std::vector<bool> covered(size, false);
+				uint32_t previousEnd = 0;
+				bool sorted = true;
+				for (const auto& range : tracker.Take(round % 2)) {
+					sorted = sorted && range.begin >= previousEnd && range.begin < range.end;
+					previousEnd = range.end;
+					for (uint32_t i = range.begin; i < range.end; i++)
+						covered[i] = true;
+				}
+				CHECK(sorted);
+				for (uint32_t i = 0; i < size; i++)
+					CHECK(!dirty[i] || covered[i]);
+				if (round % 2 == 1)
+					dirty.assign(size, false);
+			}
+		}
+	}
+}
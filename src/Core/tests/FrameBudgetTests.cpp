@@ -0,0 +1,259 @@
+#include "Test.h"
+
+#include "MockGpu.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// The frame paths below replay, call for call, what Upscaling::ReplaceTAA, FSR4SkyrimHandler::DispatchAASync,
+// DX12SwapChain::Present and FrameCapture::Record submit. A change to one of those that adds a copy,
+// barrier, wait or dispatch belongs here as well, and fails this suite when it breaks the budget.
+namespace
+{
+	struct FrameOptions
+	{
+		bool antiAliasing = true;     // Upscale context ready
+		bool frameGeneration = true;  // Prepare dispatched in Present
+		bool staticFrame = false;     // StaticFrameDetector reuses the last AA output
+		bool capture = false;         // FrameCapture records this frame
+		bool blockOnContext = false;  // PollContextCreation waits for the init worker
+	};
+
+	class Frames
+	{
+	public:
+		Frames() :
+			context(device), aaList(device), directList(device), directQueue(device, "direct") {}
+
+		const FrameCostRecorder::Report& Run(const FrameOptions& a_options)
+		{
+			if (a_options.blockOnContext)
+				device.Record(MockGpu::Api::kCpuWait, "context creation");
+			ReplaceTAA(a_options);
+			Present(a_options);
+			return device.EndFrame();
+		}
+
+		MockGpu::Device device;
+
+	private:
+		void ReplaceTAA(const FrameOptions& a_options)
+		{
+			// DispatchTileHash runs on every frame, static ones included
+			context.Dispatch("tile hash");
+			context.CopyResource(kTileReadback, kTileHashes);
+
+			if (a_options.staticFrame && aaOutputCurrent) {
+				context.CopyResource(kOutput, kUpscaled);
+				return;
+			}
+
+			context.CopyResource(kHUDLess, kInput);
+			context.CopyResource(kMotionVectors, kGameMotionVectors);
+			context.Dispatch("depth copy");
+
+			aaOutputCurrent = false;
+			if (a_options.antiAliasing) {
+				// SignalD3D11ToD3D12
+				context.Signal(fenceValue);
+				directQueue.Wait(fenceValue);
+				fenceValue++;
+
+				// DispatchAASync
+				aaList.Reset();
+				aaList.FfxDispatch("upscale");
+				aaList.ResourceBarrier(1);
+				aaList.Close();
+				directQueue.ExecuteCommandLists(aaList);
+				directQueue.Signal(fenceValue);
+
+				// WaitForD3D12Completion
+				context.Wait(fenceValue);
+				fenceValue++;
+
+				context.CopyResource(kOutput, kUpscaled);
+				aaOutputCurrent = true;
+			} else {
+				context.CopyResource(kOutput, kInput);
+			}
+		}
+
+		void Present(const FrameOptions& a_options)
+		{
+			context.Signal(fenceValue);
+			directQueue.Wait(fenceValue);
+			fenceValue++;
+
+			directList.Reset();
+			directList.ResourceBarrier(2);
+			directList.CopyResource(kSwapChainBuffer, kSharedBackBuffer);
+			directList.ResourceBarrier(2);
+
+			if (a_options.frameGeneration)
+				directList.FfxDispatch("frame generation prepare");
+
+			if (a_options.capture) {
+				for (auto plane : { kHUDLess, kDepth, kMotionVectors })
+					directList.CopyResource(kReadback, plane);
+			}
+
+			directList.Close();
+			directQueue.ExecuteCommandLists(directList);
+
+			directQueue.Signal(fenceValue);
+			context.Wait(fenceValue);
+			fenceValue++;
+		}
+
+		static constexpr MockGpu::Resource kInput{ "TAA input" };
+		static constexpr MockGpu::Resource kOutput{ "TAA output" };
+		static constexpr MockGpu::Resource kGameMotionVectors{ "game motion vectors" };
+		static constexpr MockGpu::Resource kHUDLess{ "HUDLess shared" };
+		static constexpr MockGpu::Resource kMotionVectors{ "motion vectors shared" };
+		static constexpr MockGpu::Resource kDepth{ "depth shared" };
+		static constexpr MockGpu::Resource kUpscaled{ "upscaled shared" };
+		static constexpr MockGpu::Resource kTileHashes{ "tile hashes" };
+		static constexpr MockGpu::Resource kTileReadback{ "tile hash readback" };
+		static constexpr MockGpu::Resource kSharedBackBuffer{ "shared back buffer" };
+		static constexpr MockGpu::Resource kSwapChainBuffer{ "swap chain buffer" };
+		static constexpr MockGpu::Resource kReadback{ "capture readback" };
+
+		MockGpu::DeviceContext11 context;
+		MockGpu::CommandList12 aaList;
+		MockGpu::CommandList12 directList;
+		MockGpu::CommandQueue12 directQueue;
+		uint64_t fenceValue = 1;
+		bool aaOutputCurrent = false;
+	};
+
+	// What CI prints when a frame goes over: the same text the plugin logs
+	bool WithinBudget(const MockGpu::Device& a_device, const FrameCostRecorder::Report& a_report)
+	{
+		if (a_report.overBudget)
+			std::fprintf(stderr, "  frame %llu over its command budget: %s\n", (unsigned long long)a_report.frame, a_device.cost.Describe(a_report).c_str());
+		for (auto& error : a_device.errors)
+			std::fprintf(stderr, "  %s\n", error.c_str());
+		return a_report.overBudget == 0 && a_device.errors.empty();
+	}
+
+	size_t IndexOf(const std::vector<MockGpu::Call>& a_calls, MockGpu::Api a_api, const char* a_what, size_t a_from = 0)
+	{
+		for (size_t i = a_from; i < a_calls.size(); i++) {
+			if (a_calls[i].api == a_api && (!a_what || a_calls[i].what == a_what))
+				return i;
+		}
+		return a_calls.size();
+	}
+}
+
+TEST_CASE("FrameBudget", "an AA and frame generation frame uses exactly the default budget")
+{
+	Frames frames;
+	auto& report = frames.Run({});
+	CHECK(WithinBudget(frames.device, report));
+	CHECK(report.counts == FrameCostRecorder::kDefaultBudget);
+}
+
+TEST_CASE("FrameBudget", "frame generation without AA and static frames stay within budget")
+{
+	Frames frames;
+	FrameOptions noAA;
+	noAA.antiAliasing = false;
+	auto& fallback = frames.Run(noAA);
+	CHECK(WithinBudget(frames.device, fallback));
+	CHECK(fallback.counts[size_t(FrameCostRecorder::Counter::kFfxDispatch)] == 1);
+
+	// The first static frame has no AA output to reuse yet
+	FrameOptions still;
+	still.staticFrame = true;
+	frames.Run(still);
+	auto& reused = frames.Run(still);
+	CHECK(WithinBudget(frames.device, reused));
+	CHECK(reused.counts[size_t(FrameCostRecorder::Counter::kCopy11)] == 2);
+	CHECK(reused.counts[size_t(FrameCostRecorder::Counter::kQueueWait)] == 2);
+	CHECK(reused.counts[size_t(FrameCostRecorder::Counter::kExecute12)] == 1);
+}
+
+TEST_CASE("FrameBudget", "a long mixed run never goes over")
+{
+	Frames frames;
+	for (int i = 0; i < 240; i++) {
+		FrameOptions options;
+		options.antiAliasing = i % 7 != 0;
+		options.frameGeneration = i % 5 != 0;
+		options.staticFrame = (i / 20) % 3 == 2;
+		frames.Run(options);
+	}
+	CHECK(frames.device.cost.FramesOverBudget() == 0);
+	CHECK(frames.device.errors.empty());
+	auto& peak = frames.device.cost.GetPeak();
+	auto& budget = frames.device.cost.GetBudget();
+	for (size_t i = 0; i < FrameCostRecorder::kCounterCount; i++)
+		CHECK(peak[i] <= budget[i]);
+}
+
+TEST_CASE("FrameBudget", "the AA result is copied back only after the D3D11 wait")
+{
+	Frames frames;
+	frames.Run({});
+	auto& calls = frames.device.frameCalls;
+
+	size_t dispatch = IndexOf(calls, MockGpu::Api::kFfxDispatch, "upscale");
+	size_t execute = IndexOf(calls, MockGpu::Api::kExecute12, nullptr, dispatch);
+	size_t wait = IndexOf(calls, MockGpu::Api::kWait11, nullptr, execute);
+	size_t copyBack = IndexOf(calls, MockGpu::Api::kCopy11, "upscaled shared -> TAA output");
+	REQUIRE(copyBack < calls.size());
+	CHECK(dispatch < execute);
+	CHECK(execute < wait);
+	CHECK(wait < copyBack);
+}
+
+TEST_CASE("FrameBudget", "an extra full screen copy or a blocking wait is flagged")
+{
+	Frames frames;
+	frames.Run({});
+
+	MockGpu::DeviceContext11 context(frames.device);
+	context.CopyResource({ "HUDLess shared" }, { "TAA input" });
+	auto& copied = frames.Run({});
+	CHECK(copied.overBudget == 1u << size_t(FrameCostRecorder::Counter::kCopy11));
+	CHECK(frames.device.cost.Describe(copied) == "copy11 5/4");
+
+	FrameOptions blocking;
+	blocking.blockOnContext = true;
+	auto& blocked = frames.Run(blocking);
+	CHECK(frames.device.cost.Describe(blocked) == "cpuWait 1/0");
+	CHECK(frames.device.cost.FramesOverBudget() == 2);
+}
+
+TEST_CASE("FrameBudget", "capture frames go over on readback copies only")
+{
+	Frames frames;
+	FrameOptions options;
+	options.capture = true;
+	auto& report = frames.Run(options);
+	CHECK(report.overBudget == 1u << size_t(FrameCostRecorder::Counter::kCopy12));
+	CHECK(frames.device.cost.Describe(report) == "copy12 4/1");
+	CHECK(frames.device.errors.empty());
+}
+
+TEST_CASE("FrameBudget", "fence misuse is reported")
+{
+	MockGpu::Device device;
+	MockGpu::DeviceContext11 context(device);
+	MockGpu::CommandQueue12 queue(device, "direct");
+	MockGpu::CommandList12 list(device);
+
+	context.Signal(2);
+	queue.Wait(3);
+	queue.Signal(2);
+	list.ResourceBarrier(1);
+	list.Reset();
+	queue.ExecuteCommandLists(list);
+
+	REQUIRE(device.errors.size() == 4);
+	CHECK(device.errors[0] == "wait for unsignalled fence value 3");
+	CHECK(device.errors[1] == "fence signalled backwards: 2 after 2");
+	CHECK(device.errors[2] == "ResourceBarrier on a closed command list");
+	CHECK(device.errors[3] == "executing an open command list on direct");
+}
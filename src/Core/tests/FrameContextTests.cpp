@@ -0,0 +1,93 @@
+#include "Test.h"
+
+#include "Core/FrameContext.h"
+
+#include <atomic>
+#include <thread>
+
+TEST_CASE("FrameContext", "Make falls back on invalid timing and clip planes")
+{
+	FrameContext::Inputs in;
+	in.frameID = 7;
+	in.width = 1920;
+	in.height = 1080;
+	in.deltaTimeSeconds = 0.0f;
+	in.cameraNear = -1.0f;
+	in.cameraFar = -2.0f;
+	in.fovVerticalRad = -0.5f;
+
+	auto ctx = FrameContext::Make(in);
+	CHECK(ctx.IsValid());
+	CHECK(ctx.deltaTimeMs == FrameContext::kDefaultDeltaTimeMs);
+	CHECK(ctx.cameraNear == FrameContext::kDefaultCameraNear);
+	CHECK(ctx.cameraFar == FrameContext::kDefaultCameraFar);
+	CHECK(ctx.fovVerticalRad == 0.0f);
+	CHECK(!ctx.hasCamera);
+	CHECK(ctx.cameraForward[1] == 1.0f);
+}
+
+TEST_CASE("FrameContext", "Make converts NDC jitter to pixels and copies the camera")
+{
+	FrameContext::Inputs in;
+	in.frameID = 1;
+	in.width = 1000;
+	in.height = 500;
+	in.deltaTimeSeconds = 0.02f;
+	in.cameraNear = 5.0f;
+	in.cameraFar = 1000.0f;
+	in.projectionPosScaleX = 0.001f;
+	in.projectionPosScaleY = -0.002f;
+	in.hasCamera = true;
+	in.cameraPosition[0] = 10.0f;
+	in.cameraForward[2] = 1.0f;
+
+	auto ctx = FrameContext::Make(in);
+	CHECK_NEAR(ctx.deltaTimeMs, 20.0f, 1e-4);
+	CHECK_NEAR(ctx.jitterX, 0.5f, 1e-5);
+	CHECK_NEAR(ctx.jitterY, -0.5f, 1e-5);
+	CHECK(ctx.cameraNear == 5.0f);
+	CHECK(ctx.cameraFar == 1000.0f);
+	CHECK(ctx.hasCamera);
+	CHECK(ctx.cameraPosition[0] == 10.0f);
+	CHECK(ctx.cameraForward[2] == 1.0f);
+}
+
+TEST_CASE("FrameContext", "default context is invalid")
+{
+	FrameContext ctx;
+	CHECK(!ctx.IsValid());
+}
+
+TEST_CASE("FrameContext", "seqlock readers never see a torn snapshot")
+{
+	FrameContextSlot slot;
+	CHECK(slot.Version() == 1);
+
+	std::atomic<bool> stop{ false };
+	std::atomic<int> torn{ 0 };
+	auto reader = [&]() {
+		while (!stop.load(std::memory_order_relaxed)) {
+			auto ctx = slot.Read();
+			// Every field of a published snapshot is derived from its frame ID
+			if (ctx.width != (uint32_t)ctx.frameID || ctx.height != (uint32_t)ctx.frameID * 2 || ctx.cameraPosition[2] != (float)ctx.frameID)
+				torn++;
+		}
+	};
+	std::thread readers[2] = { std::thread(reader), std::thread(reader) };
+
+	for (uint32_t frame = 1; frame <= 20000; frame++) {
+		FrameContext ctx;
+		ctx.frameID = frame;
+		ctx.width = frame;
+		ctx.height = frame * 2;
+		ctx.cameraPosition[2] = (float)frame;
+		slot.Publish(ctx);
+	}
+	stop = true;
+	for (auto& thread : readers)
+		thread.join();
+
+	CHECK(torn == 0);
+	CHECK(slot.Version() == 20001);
+	CHECK(slot.Read().frameID == 20000);
+}
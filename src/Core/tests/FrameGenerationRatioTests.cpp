@@ -0,0 +1,72 @@
+#include "Test.h"
+
+#include "Core/FrameGenerationRatio.h"
+
+namespace
+{
+	constexpr uint32_t kAuto = 0;
+	constexpr uint32_t kAll = FrameGenerationRatio::kMaxGeneratedFrames;
+}
+
+TEST_CASE("FrameGenerationRatio", "fit under the refresh rate")
+{
+	CHECK(FrameGenerationRatio::Fit(70.0f, 240.0f, 0.95f, 3) == 2);
+	CHECK(FrameGenerationRatio::Fit(55.0f, 240.0f, 0.95f, 3) == 3);
+	CHECK(FrameGenerationRatio::Fit(45.0f, 240.0f, 0.95f, 3) == 3);
+	CHECK(FrameGenerationRatio::Fit(100.0f, 144.0f, 0.95f, 3) == 1);
+	CHECK(FrameGenerationRatio::Fit(55.0f, 240.0f, 0.95f, 1) == 1);
+
+	// Not measured yet, or nonsense: 2x
+	CHECK(FrameGenerationRatio::Fit(0.0f, 240.0f, 0.95f, 3) == 1);
+	CHECK(FrameGenerationRatio::Fit(60.0f, 0.0f, 0.95f, 3) == 1);
+	CHECK(FrameGenerationRatio::Fit(60.0f, 240.0f, 0.95f, 0) == 1);
+
+	CHECK(FrameGenerationRatio::LimiterFrameRate(240.0, 1) == 120.0);
+	CHECK(FrameGenerationRatio::LimiterFrameRate(240.0, 3) == 60.0);
+}
+
+TEST_CASE("FrameGenerationRatio", "fixed ratios apply at once, limited by the backend")
+{
+	FrameGenerationRatio ratio;
+	CHECK(ratio.Update(3, kAll, 60.0f, 240.0f, 0.0) == 3);
+	CHECK(ratio.Update(2, kAll, 60.0f, 240.0f, 0.1) == 2);
+	CHECK(ratio.Update(3, 1, 60.0f, 240.0f, 0.2) == 1);
+	CHECK(ratio.Update(3, 0, 60.0f, 240.0f, 0.3) == 1);
+	CHECK(ratio.Update(9, 99, 60.0f, 240.0f, 0.4) == kAll);
+}
+
+TEST_CASE("FrameGenerationRatio", "auto raises with headroom and dwells")
+{
+	FrameGenerationRatio ratio;
+
+	// 70 fps on 240 Hz fits 3x output under 95%, but not under the 85% a raise needs
+	CHECK(ratio.Update(kAuto, kAll, 70.0f, 240.0f, 0.0) == 1);
+	CHECK(ratio.Update(kAuto, kAll, 70.0f, 240.0f, 10.0) == 1);
+
+	CHECK(ratio.Update(kAuto, kAll, 65.0f, 240.0f, 10.1) == 2);
+
+	// Held for the dwell time, then dropped once 3x no longer fits
+	CHECK(ratio.Update(kAuto, kAll, 100.0f, 240.0f, 11.0) == 2);
+	CHECK(ratio.Update(kAuto, kAll, 100.0f, 240.0f, 12.2) == 1);
+
+	// 56 fps keeps 4x once it is on, but does not raise to it: only raising needs the extra headroom
+	CHECK(ratio.Update(kAuto, kAll, 50.0f, 240.0f, 15.0) == 3);
+	CHECK(ratio.Update(kAuto, kAll, 56.0f, 240.0f, 20.0) == 3);
+	CHECK(ratio.Update(kAuto, kAll, 70.0f, 240.0f, 25.0) == 2);
+	CHECK(ratio.Update(kAuto, kAll, 56.0f, 240.0f, 30.0) == 2);
+	CHECK(ratio.GetGeneratedFrames() == 2);
+}
+
+TEST_CASE("FrameGenerationRatio", "auto is clamped by the backend and reset returns to 2x")
+{
+	FrameGenerationRatio ratio;
+	CHECK(ratio.Update(kAuto, 1, 40.0f, 240.0f, 0.0) == 1);
+	CHECK(ratio.Update(kAuto, 1, 40.0f, 240.0f, 10.0) == 1);
+
+	CHECK(ratio.Update(kAuto, kAll, 40.0f, 240.0f, 20.0) == 3);
+	CHECK(ratio.Update(kAuto, 2, 40.0f, 240.0f, 20.1) == 2);
+
+	ratio.Reset();
+	CHECK(ratio.GetGeneratedFrames() == 1);
+	CHECK(ratio.Update(kAuto, kAll, 0.0f, 240.0f, 20.2) == 1);
+}
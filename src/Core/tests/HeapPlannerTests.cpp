@@ -0,0 +1,138 @@
+#include "Test.h"
+
+#include "Core/HeapPlanner.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr uint64_t kMB = 1024 * 1024;
+	constexpr uint64_t kAlignment = HeapPlanner::kDefaultAlignment;
+
+	bool Valid(const std::vector<HeapPlanner::Request>& a_requests, const HeapPlanner::Plan& a_plan)
+	{
+		std::string error;
+		bool valid = HeapPlanner::Validate(a_requests, a_plan, &error);
+		if (!valid)
+			std::fprintf(stderr, "  %s\n", error.c_str());
+		return valid;
+	}
+}
+
+TEST_CASE("HeapPlanner", "alignment helpers and lifetimes")
+{
+	CHECK(HeapPlanner::AlignUp(0, kAlignment) == 0);
+	CHECK(HeapPlanner::AlignUp(1, kAlignment) == kAlignment);
+	CHECK(HeapPlanner::AlignUp(kAlignment, kAlignment) == kAlignment);
+	CHECK(HeapPlanner::AlignUp(77, 1) == 77);
+	CHECK(HeapPlanner::AlignUp(77, 0) == 77);
+
+	HeapPlanner::Request early{ "early", kMB, kAlignment, 0, 2 };
+	HeapPlanner::Request late{ "late", kMB, kAlignment, 3, 5 };
+	HeapPlanner::Request touching{ "touching", kMB, kAlignment, 2, 3 };
+	CHECK(!HeapPlanner::LifetimesOverlap(early, late));
+	CHECK(HeapPlanner::LifetimesOverlap(early, touching));  // Inclusive ends
+	CHECK(HeapPlanner::LifetimesOverlap(late, touching));
+}
+
+TEST_CASE("HeapPlanner", "disjoint lifetimes alias, overlapping ones do not")
+{
+	std::vector<HeapPlanner::Request> requests = {
+		{ "a", 8 * kMB, kAlignment, 0, 1 },
+		{ "b", 4 * kMB, kAlignment, 2, 3 },
+		{ "c", 2 * kMB, kAlignment, 1, 2 },
+	};
+	auto plan = HeapPlanner{}.Build(requests);
+	REQUIRE(Valid(requests, plan));
+	REQUIRE(plan.heapSizes.size() == 1);
+
+	// b reuses a's memory, c overlaps both and sits behind a
+	CHECK(plan.placements[1].offset == 0);
+	CHECK(plan.placements[1].aliasOf == 0);
+	CHECK(plan.placements[2].offset == 8 * kMB);
+	CHECK(plan.placements[0].aliasOf == -1);
+	CHECK(plan.placements[2].aliasOf == -1);
+	CHECK(plan.requestedBytes == 14 * kMB);
+	CHECK(plan.TotalBytes() == 10 * kMB);
+	CHECK(plan.SavedBytes() == 4 * kMB);
+
+	HeapPlanner noAliasing;
+	noAliasing.allowAliasing = false;
+	auto separate = noAliasing.Build(requests);
+	CHECK(Valid(requests, separate));
+	CHECK(separate.TotalBytes() == 14 * kMB);
+	for (auto& placement : separate.placements)
+		CHECK(placement.aliasOf == -1);
+}
+
+TEST_CASE("HeapPlanner", "odd sizes keep later offsets aligned")
+{
+	std::vector<HeapPlanner::Request> requests = {
+		{ "odd", kMB + 1, kAlignment, 0, 0 },
+		{ "small", 100, kAlignment, 0, 0 },
+		{ "msaa", 3 * kMB, 4 * kMB, 0, 0 },
+	};
+	auto plan = HeapPlanner{}.Build(requests);
+	REQUIRE(Valid(requests, plan));
+	for (size_t i = 0; i < requests.size(); i++)
+		CHECK(plan.placements[i].offset % requests[i].alignment == 0);
+	CHECK(plan.heapSizes[0] % kAlignment == 0);
+	CHECK(plan.requestedBytes == HeapPlanner::AlignUp(kMB + 1, kAlignment) + kAlignment + 4 * kMB);
+}
+
+TEST_CASE("HeapPlanner", "the size cap splits heaps and unused requests get none")
+{
+	HeapPlanner planner;
+	planner.maxHeapSize = 10 * kMB;
+	std::vector<HeapPlanner::Request> requests = {
+		{ "a", 6 * kMB, kAlignment, 0, 0 },
+		{ "b", 6 * kMB, kAlignment, 0, 0 },
+		{ "huge", 12 * kMB, kAlignment, 0, 0 },
+		{ "empty", 0, kAlignment, 0, 0 },
+		{ "off", 4 * kMB, kAlignment, HeapPlanner::kUnused, 0 },
+	};
+	auto plan = planner.Build(requests);
+	REQUIRE(Valid(requests, plan));
+	CHECK(plan.heapSizes.size() == 3);
+	CHECK(plan.placements[2].heap == 0);  // Largest first, in a heap of its own
+	CHECK(plan.heapSizes[0] == 12 * kMB);
+	CHECK(plan.placements[0].heap != plan.placements[1].heap);
+	CHECK(plan.placements[3].heap == HeapPlanner::kUnused);
+	CHECK(plan.placements[4].heap == HeapPlanner::kUnused);
+	CHECK(plan.requestedBytes == 24 * kMB);
+
+	CHECK(HeapPlanner{}.Build({}).heapSizes.empty());
+}
+
+TEST_CASE("HeapPlanner", "validate catches broken plans")
+{
+	std::vector<HeapPlanner::Request> requests = {
+		{ "a", 2 * kMB, kAlignment, 0, 1 },
+		{ "b", 2 * kMB, kAlignment, 1, 2 },
+	};
+	auto plan = HeapPlanner{}.Build(requests);
+	REQUIRE(Valid(requests, plan));
+
+	std::string error;
+	auto overlapping = plan;
+	overlapping.placements[1] = overlapping.placements[0];
+	CHECK(!HeapPlanner::Validate(requests, overlapping, &error));
+	CHECK(error == "a and b are alive together but share memory");
+
+	auto misaligned = plan;
+	misaligned.placements[1].offset += 256;
+	CHECK(!HeapPlanner::Validate(requests, misaligned, &error));
+	CHECK(error == "b is misaligned");
+
+	auto outside = plan;
+	outside.heapSizes[0] = kMB;
+	CHECK(!HeapPlanner::Validate(requests, outside, &error));
+	CHECK(error.ends_with("exceeds its heap"));
+
+	auto missing = plan;
+	missing.placements.pop_back();
+	CHECK(!HeapPlanner::Validate(requests, missing, &error));
+	CHECK(error == "placement count does not match request count");
+}
@@ -0,0 +1,243 @@
+#include "Test.h"
+
+#include "Core/ImageMetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	using CpuReference::Image;
+
+	constexpr uint32_t kWidth = 64;
+	constexpr uint32_t kHeight = 48;
+	constexpr uint32_t kFrames = 6;
+	constexpr uint32_t kR8G8B8A8Unorm = 28;
+	constexpr uint32_t kR32Float = 41;
+
+	enum class Variant
+	{
+		kReference,
+		kNoisy,    // A level or two of noise, different every frame
+		kShifted,  // The bright square drawn 6 pixels to the right
+	};
+
+	// Smooth waves scrolling a pixel per frame, with a bright square for edges
+	float Pattern(uint32_t a_x, uint32_t a_y, uint32_t a_frame, Variant a_variant)
+	{
+		uint32_t squareX = a_variant == Variant::kShifted ? 22 : 16;
+		if (a_x >= squareX && a_x < squareX + 16 && a_y >= 16 && a_y < 32)
+			return 0.9f;
+		return 0.5f + 0.25f * std::sin(float(a_x + a_frame) * 0.3f) * std::cos(float(a_y) * 0.2f);
+	}
+
+	// Deterministic noise in [-1, 1]
+	float Noise(uint32_t a_x, uint32_t a_y, uint32_t a_frame)
+	{
+		uint32_t hash = (a_x * 73856093u) ^ (a_y * 19349663u) ^ (a_frame * 83492791u);
+		hash ^= hash >> 13;
+		hash *= 0x5bd1e995u;
+		hash ^= hash >> 15;
+		return float(hash & 0xffff) / 32767.5f - 1.0f;
+	}
+
+	std::vector<float> Luma(uint32_t a_frame, Variant a_variant)
+	{
+		std::vector<float> luma(size_t(kWidth) * kHeight);
+		for (uint32_t y = 0; y < kHeight; y++) {
+			for (uint32_t x = 0; x < kWidth; x++) {
+				float value = Pattern(x, y, a_frame, a_variant);
+				if (a_variant == Variant::kNoisy)
+					value += 0.006f * Noise(x, y, a_frame);
+				luma[size_t(y) * kWidth + x] = value;
+			}
+		}
+		return luma;
+	}
+
+	Image<const float> View(const std::vector<float>& a_luma)
+	{
+		return { a_luma.data(), kWidth, kHeight, kWidth };
+	}
+
+	// Grey RGBA8 frames, so the comparison also goes through ToLuma
+	bool WriteCapture(const std::filesystem::path& a_path, Variant a_variant)
+	{
+		Capture::Writer writer;
+		if (!writer.Open(a_path))
+			return false;
+
+		std::vector<uint8_t> pixels(size_t(kWidth) * kHeight * 4);
+		for (uint32_t frame = 0; frame < kFrames; frame++) {
+			auto luma = Luma(frame, a_variant);
+			for (size_t i = 0; i < luma.size(); i++) {
+				auto level = uint8_t(std::lround(std::clamp(luma[i], 0.0f, 1.0f) * 255.0f));
+				pixels[i * 4 + 0] = level;
+				pixels[i * 4 + 1] = level;
+				pixels[i * 4 + 2] = level;
+				pixels[i * 4 + 3] = 255;
+			}
+
+			Capture::FrameInfo info{};
+			info.frameID = 100 + frame;
+			info.width = kWidth;
+			info.height = kHeight;
+			Capture::PlaneInput plane{ Capture::Plane::kColor, kR8G8B8A8Unorm, kWidth, kHeight, kWidth * 4, kWidth * 4, pixels.data() };
+			if (!writer.WriteFrame(info, { &plane, 1 }))
+				return false;
+		}
+		writer.Close();
+		return true;
+	}
+
+	struct TemporaryDirectory
+	{
+		TemporaryDirectory()
+		{
+			path = std::filesystem::temp_directory_path() / ("fsr4_metrics_" + std::to_string(std::rand()));
+			std::filesystem::create_directories(path);
+		}
+		~TemporaryDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(path, error);
+		}
+		std::filesystem::path path;
+	};
+}
+
+TEST_CASE("ImageMetrics", "identical images score perfectly")
+{
+	auto image = Luma(0, Variant::kReference);
+	CHECK(ImageMetrics::MeanSquaredError(View(image), View(image)) == 0.0);
+	CHECK(std::isinf(ImageMetrics::Psnr(0.0)));
+	CHECK_NEAR(ImageMetrics::Ssim(View(image), View(image)), 1.0, 1e-9);
+	CHECK(ImageMetrics::Flip(View(image), View(image)) == 0.0);
+
+	auto next = Luma(1, Variant::kReference);
+	CHECK(ImageMetrics::Flicker(View(next), View(image), View(next), View(image)) == 0.0);
+}
+
+TEST_CASE("ImageMetrics", "known error values")
+{
+	std::vector<float> zeros(size_t(kWidth) * kHeight, 0.0f);
+	std::vector<float> tenths(zeros.size(), 0.1f);
+	CHECK_NEAR(ImageMetrics::MeanSquaredError(View(tenths), View(zeros)), 0.01, 1e-7);
+	CHECK_NEAR(ImageMetrics::Psnr(0.01), 20.0, 1e-9);
+
+	// A uniform change has no structure: FLIP is the compressed colour difference alone
+	CHECK_NEAR(ImageMetrics::Flip(View(tenths), View(zeros)), std::pow(0.1, 0.7), 1e-5);
+
+	// Both sequences brighten by 0.1 in step, the test one flickers by 0.1 more
+	std::vector<float> fifths(zeros.size(), 0.2f);
+	CHECK_NEAR(ImageMetrics::Flicker(View(tenths), View(zeros), View(tenths), View(zeros)), 0.0, 1e-7);
+	CHECK_NEAR(ImageMetrics::Flicker(View(fifths), View(zeros), View(tenths), View(zeros)), 0.1, 1e-6);
+}
+
+TEST_CASE("ImageMetrics", "noise costs a little, moved structure a lot")
+{
+	auto reference = Luma(0, Variant::kReference);
+	auto noisy = Luma(0, Variant::kNoisy);
+	auto shifted = Luma(0, Variant::kShifted);
+
+	double noisyPsnr = ImageMetrics::Psnr(ImageMetrics::MeanSquaredError(View(noisy), View(reference)));
+	double shiftedPsnr = ImageMetrics::Psnr(ImageMetrics::MeanSquaredError(View(shifted), View(reference)));
+	CHECK(noisyPsnr > 45.0);
+	CHECK(shiftedPsnr < 25.0);
+
+	double noisySsim = ImageMetrics::Ssim(View(noisy), View(reference));
+	double shiftedSsim = ImageMetrics::Ssim(View(shifted), View(reference));
+	CHECK(noisySsim > 0.95);
+	CHECK(shiftedSsim < noisySsim);
+
+	double noisyFlip = ImageMetrics::Flip(View(noisy), View(reference));
+	double shiftedFlip = ImageMetrics::Flip(View(shifted), View(reference));
+	CHECK(noisyFlip > 0.0);
+	CHECK(noisyFlip < 0.1);
+	// The square's two moved edges are a few percent of the frame, but score far above the noise everywhere
+	CHECK(shiftedFlip > 5.0 * noisyFlip);
+}
+
+TEST_CASE("ImageMetrics", "images that cannot be compared give NaN")
+{
+	auto image = Luma(0, Variant::kReference);
+	Image<const float> smaller{ image.data(), kWidth / 2, kHeight, kWidth };
+	Image<const float> tiny{ image.data(), 2, 2, kWidth };
+	CHECK(std::isnan(ImageMetrics::MeanSquaredError(smaller, View(image))));
+	CHECK(std::isnan(ImageMetrics::Ssim(tiny, tiny)));
+	CHECK(std::isnan(ImageMetrics::Flip(tiny, tiny)));
+}
+
+TEST_CASE("ImageMetrics", "luma of packed formats")
+{
+	std::vector<float> luma(2);
+	Image<float> out{ luma.data(), 2, 1, 2 };
+
+	uint8_t rgba[8] = { 255, 0, 0, 255, 0, 255, 0, 255 };
+	REQUIRE(ImageMetrics::ToLuma(kR8G8B8A8Unorm, rgba, 8, out));
+	CHECK_NEAR(luma[0], 0.2126, 1e-6);
+	CHECK_NEAR(luma[1], 0.7152, 1e-6);
+
+	float depth[2] = { 0.25f, 0.75f };
+	REQUIRE(ImageMetrics::ToLuma(kR32Float, { reinterpret_cast<const uint8_t*>(depth), sizeof(depth) }, 8, out));
+	CHECK(luma[0] == 0.25f);
+	CHECK(luma[1] == 0.75f);
+
+	CHECK(!ImageMetrics::ToLuma(9999, rgba, 8, out));
+	CHECK(!ImageMetrics::ToLuma(kR8G8B8A8Unorm, rgba, 4, out));
+}
+
+TEST_CASE("ImageMetrics", "comparing synthetic captures")
+{
+	TemporaryDirectory directory;
+	auto reference = directory.path / "reference.fsrcap";
+	auto noisy = directory.path / "noisy.fsrcap";
+	auto shifted = directory.path / "shifted.fsrcap";
+	REQUIRE(WriteCapture(reference, Variant::kReference));
+	REQUIRE(WriteCapture(noisy, Variant::kNoisy));
+	REQUIRE(WriteCapture(shifted, Variant::kShifted));
+
+	auto same = ImageMetrics::CompareCaptures(reference, reference);
+	CHECK(same.passed);
+	CHECK(same.frames.size() == kFrames);
+	CHECK(std::isinf(same.psnr));
+	CHECK(same.maxFlip == 0.0);
+
+	auto passing = ImageMetrics::CompareCaptures(noisy, reference);
+	CHECK(passing.passed);
+	CHECK(passing.error.empty());
+	CHECK(passing.frames.front().frameID == 100);
+	CHECK(std::isnan(passing.frames.front().flicker));
+	CHECK(passing.maxFlicker > 0.0);
+	CHECK(passing.meanFlip > 0.0);
+	CHECK(ImageMetrics::Summarize(passing).ends_with("PASS\n"));
+
+	auto failing = ImageMetrics::CompareCaptures(shifted, reference);
+	CHECK(!failing.passed);
+	CHECK(failing.failedFrames == kFrames);
+	CHECK(ImageMetrics::Summarize(failing).ends_with("FAIL: 6 frames over the limits\n"));
+
+	// Zero disables a limit; with all of them off nothing fails
+	auto unlimited = ImageMetrics::CompareCaptures(shifted, reference, { 0.0, 0.0, 0.0, 0.0 });
+	CHECK(unlimited.passed);
+
+	auto missingPlane = ImageMetrics::CompareCaptures(noisy, reference, {}, Capture::Plane::kDepth);
+	CHECK(!missingPlane.passed);
+	CHECK(missingPlane.error == "frame 0: test frame has no such plane");
+
+	auto missingFile = ImageMetrics::CompareCaptures(directory.path / "missing.fsrcap", reference);
+	CHECK(!missingFile.passed);
+	CHECK(!missingFile.error.empty());
+}
+
+// Not an ImageMetrics case: writes the captures FSR4_CompareCaptures is run on by the tools tests
+TEST_CASE("CaptureFixtures", "write synthetic captures")
+{
+	REQUIRE(WriteCapture("reference.fsrcap", Variant::kReference));
+	REQUIRE(WriteCapture("noisy.fsrcap", Variant::kNoisy));
+	REQUIRE(WriteCapture("shifted.fsrcap", Variant::kShifted));
+}
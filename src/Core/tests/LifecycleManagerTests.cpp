@@ -0,0 +1,178 @@
+#include "Test.h"
+
+#include "Core/LifecycleManager.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Records the callbacks in call order
+	struct Feature
+	{
+		std::vector<std::string> calls;
+		bool createSucceeds = true;
+		LifecycleManager::Progress progress = LifecycleManager::Progress::kDone;
+
+		LifecycleManager::Callbacks Callbacks(bool a_async = false)
+		{
+			LifecycleManager::Callbacks callbacks;
+			callbacks.create = [this]() { calls.push_back("create"); return createSucceeds; };
+			callbacks.retire = [this]() { calls.push_back("retire"); };
+			callbacks.destroy = [this]() { calls.push_back("destroy"); };
+			if (a_async)
+				callbacks.poll = [this](bool a_wait) {
+					calls.push_back(a_wait ? "wait" : "poll");
+					return a_wait && progress == LifecycleManager::Progress::kPending ? LifecycleManager::Progress::kDone : progress;
+				};
+			return callbacks;
+		}
+	};
+
+	using State = LifecycleManager::State;
+}
+
+TEST_CASE("LifecycleManager", "destroy waits for the retire fence and frame count")
+{
+	Feature feature;
+	LifecycleManager manager(3);
+	auto id = manager.Register("fg", feature.Callbacks());
+
+	manager.SetDesired(id, true);
+	manager.Tick(1, 1);
+	CHECK(manager.IsLive(id));
+	CHECK(manager.IsSettled());
+
+	manager.SetDesired(id, false);
+	manager.Tick(10, 5);
+	CHECK(manager.GetState(id) == State::kRetiring);
+	CHECK(!manager.IsSettled());
+
+	// Three frames passed but the GPU has not reached the retire fence
+	for (int i = 0; i < 3; i++)
+		manager.Tick(11 + i, 9);
+	CHECK(manager.GetState(id) == State::kRetiring);
+
+	manager.Tick(14, 10);
+	CHECK(manager.GetState(id) == State::kDestroyed);
+	CHECK(manager.IsSettled());
+	CHECK((feature.calls == std::vector<std::string>{ "create", "retire", "destroy" }));
+}
+
+TEST_CASE("LifecycleManager", "fence passed early still waits the retire frames")
+{
+	Feature feature;
+	LifecycleManager manager(3);
+	auto id = manager.Register("aa", feature.Callbacks());
+	manager.SetDesired(id, true);
+	manager.Tick(1, 1);
+	manager.SetDesired(id, false);
+	manager.Tick(2, 2);
+	manager.Tick(3, 3);
+	manager.Tick(4, 4);
+	CHECK(manager.GetState(id) == State::kRetiring);
+	manager.Tick(5, 5);
+	CHECK(manager.GetState(id) == State::kDestroyed);
+}
+
+TEST_CASE("LifecycleManager", "recreate never overlaps the old and new instance")
+{
+	Feature feature;
+	LifecycleManager manager(1);
+	auto id = manager.Register("upscale", feature.Callbacks());
+	manager.SetDesired(id, true);
+	manager.Tick(1, 1);
+
+	manager.RequestRecreate(id);
+	manager.Tick(2, 1);
+	CHECK(manager.GetState(id) == State::kRetiring);
+	manager.Tick(3, 2);
+	CHECK(manager.IsLive(id));
+	CHECK((feature.calls == std::vector<std::string>{ "create", "retire", "destroy", "create" }));
+}
+
+TEST_CASE("LifecycleManager", "failed creation is retried after a toggle")
+{
+	Feature feature;
+	feature.createSucceeds = false;
+	LifecycleManager manager;
+	auto id = manager.Register("fg", feature.Callbacks());
+
+	manager.SetDesired(id, true);
+	manager.Tick(1, 1);
+	CHECK(manager.GetState(id) == State::kFailed);
+	manager.Tick(2, 2);
+	CHECK(feature.calls.size() == 1);
+	CHECK(manager.IsSettled());
+
+	feature.createSucceeds = true;
+	manager.SetDesired(id, false);
+	manager.SetDesired(id, true);
+	manager.Tick(3, 3);
+	CHECK(manager.IsLive(id));
+}
+
+TEST_CASE("LifecycleManager", "asynchronous creation stays unpublished until polled done")
+{
+	Feature feature;
+	feature.progress = LifecycleManager::Progress::kPending;
+	LifecycleManager manager;
+	auto id = manager.Register("fg", feature.Callbacks(true));
+
+	manager.SetDesired(id, true);
+	manager.Tick(1, 1);
+	CHECK(manager.IsCreating(id));
+
+	// Switched off while creating: cannot be cancelled, retired once live
+	manager.SetDesired(id, false);
+	manager.Tick(2, 2);
+	CHECK(manager.IsCreating(id));
+
+	feature.progress = LifecycleManager::Progress::kDone;
+	manager.Tick(3, 3);
+	CHECK(manager.GetState(id) == State::kRetiring);
+}
+
+TEST_CASE("LifecycleManager", "asynchronous failure and DestroyAllNow")
+{
+	Feature feature;
+	feature.progress = LifecycleManager::Progress::kFailed;
+	LifecycleManager manager;
+	auto failing = manager.Register("fails", feature.Callbacks(true));
+	manager.SetDesired(failing, true);
+	manager.Tick(1, 1);
+	manager.Tick(2, 2);
+	CHECK(manager.GetState(failing) == State::kFailed);
+
+	Feature pending;
+	pending.progress = LifecycleManager::Progress::kPending;
+	auto slow = manager.Register("slow", pending.Callbacks(true));
+	manager.SetDesired(slow, true);
+	manager.Tick(3, 3);
+	CHECK(manager.IsCreating(slow));
+
+	// Waits for the pending creation, then destroys it
+	manager.DestroyAllNow();
+	CHECK(manager.GetState(slow) == State::kDestroyed);
+	CHECK(pending.calls.back() == "destroy");
+}
+
+TEST_CASE("LifecycleManager", "transitions are reported")
+{
+	Feature feature;
+	LifecycleManager manager;
+	auto id = manager.Register("fg", feature.Callbacks());
+	std::vector<std::pair<State, State>> transitions;
+	manager.onTransition = [&](LifecycleManager::FeatureID a_id, State a_from, State a_to) {
+		CHECK(a_id == id);
+		transitions.push_back({ a_from, a_to });
+	};
+
+	manager.SetDesired(id, true);
+	manager.Tick(1, 1);
+	manager.RecreateNow(id);
+	CHECK(transitions.size() == 3);
+	CHECK(transitions[1].first == State::kLive);
+	CHECK(transitions[1].second == State::kDestroyed);
+	CHECK(transitions[2].second == State::kLive);
+}
@@ -0,0 +1,150 @@
+#include "Test.h"
+
+#include "Core/AsyncLog.h"
+#include "Core/LogLimiter.h"
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("Log", "rate limiter passes a burst, then one per interval")
+{
+	LogRateLimiter limiter(3, 1s);
+	LogRateLimiter::Clock::time_point start{};
+	uint64_t suppressed = 99;
+
+	for (int i = 0; i < 3; i++) {
+		CHECK(limiter.Allow(start, suppressed));
+		CHECK(suppressed == 0);
+	}
+	for (int i = 0; i < 10; i++)
+		CHECK(!limiter.Allow(start + 500ms, suppressed));
+
+	// The first call after the interval reports everything dropped since the last emission
+	CHECK(limiter.Allow(start + 1s, suppressed));
+	CHECK(suppressed == 10);
+	CHECK(!limiter.Allow(start + 1500ms, suppressed));
+	CHECK(limiter.Allow(start + 2s, suppressed));
+	CHECK(suppressed == 1);
+}
+
+TEST_CASE("Log", "rate limiter lets one of many racing threads through")
+{
+	LogRateLimiter limiter(0, 1h);
+	std::atomic<int> passed{ 0 };
+	auto caller = [&]() {
+		uint64_t suppressed = 0;
+		for (int i = 0; i < 1000; i++)
+			passed += limiter.Allow(LogRateLimiter::Clock::time_point{} + 1h, suppressed) ? 1 : 0;
+	};
+	std::thread threads[4] = { std::thread(caller), std::thread(caller), std::thread(caller), std::thread(caller) };
+	for (auto& thread : threads)
+		thread.join();
+	CHECK(passed == 1);
+}
+
+TEST_CASE("Log", "deduplicator passes only changes and counts repeats")
+{
+	LogDeduplicator dedup;
+	uint64_t repeats = 99;
+	CHECK(dedup.Submit(1, repeats));
+	CHECK(repeats == 0);
+	CHECK(!dedup.Submit(1, repeats));
+	CHECK(!dedup.Submit(1, repeats));
+	CHECK(dedup.Submit(2, repeats));
+	CHECK(repeats == 2);
+	CHECK(dedup.Submit(1, repeats));
+	CHECK(repeats == 0);
+}
+
+TEST_CASE("Log", "queue drops when full and truncates long lines")
+{
+	LogQueue queue(3);  // Rounded up to 4
+	for (int i = 0; i < 4; i++)
+		CHECK(queue.TryPush("line " + std::to_string(i)));
+	CHECK(!queue.TryPush("dropped"));
+	CHECK(queue.Dropped() == 1);
+
+	std::string line;
+	CHECK(queue.TryPop(line));
+	CHECK(line == "line 0");
+	CHECK(queue.TryPush(std::string(LogQueue::kSlotSize + 100, 'x')));
+	for (int i = 1; i < 4; i++) {
+		CHECK(queue.TryPop(line));
+		CHECK(line == "line " + std::to_string(i));
+	}
+	CHECK(queue.TryPop(line));
+	CHECK(line.size() == LogQueue::kSlotSize);
+	CHECK(!queue.TryPop(line));
+}
+
+TEST_CASE("Log", "queue delivers every line from concurrent producers once")
+{
+	LogQueue queue(256);
+	constexpr int kProducers = 4;
+	constexpr int kLines = 5000;
+	std::atomic<int> done{ 0 };
+
+	std::set<std::string> received;
+	std::thread consumer([&]() {
+		std::string line;
+		for (;;) {
+			// Read before draining, so nothing pushed before the last producer finished is missed
+			bool finished = done == kProducers;
+			while (queue.TryPop(line))
+				received.insert(line);
+			if (finished)
+				break;
+		}
+	});
+
+	std::vector<std::thread> producers;
+	uint64_t pushed[kProducers] = {};
+	for (int p = 0; p < kProducers; p++)
+		producers.emplace_back([&, p]() {
+			for (int i = 0; i < kLines; i++)
+				pushed[p] += queue.TryPush(std::to_string(p) + ":" + std::to_string(i)) ? 1 : 0;
+			done++;
+		});
+	for (auto& producer : producers)
+		producer.join();
+	consumer.join();
+
+	uint64_t total = 0;
+	for (auto count : pushed)
+		total += count;
+	CHECK(received.size() == total);
+	CHECK(total + queue.Dropped() == kProducers * kLines);
+}
+
+TEST_CASE("Log", "async writer writes every line to the file")
+{
+	auto path = std::filesystem::temp_directory_path() / "FSR4_CoreTests_AsyncLog.log";
+	{
+		AsyncLogWriter writer(path, 64);
+		REQUIRE(writer.IsOpen());
+		CHECK(writer.Push("first\n"));
+		CHECK(writer.Push("no newline"));
+		CHECK(writer.Drain());
+		for (int i = 0; i < 100; i++)
+			writer.Push("line\n");
+	}
+
+	std::ifstream file(path);
+	std::stringstream contents;
+	contents << file.rdbuf();
+	auto text = contents.str();
+	CHECK(text.rfind("first\nno newline\n", 0) == 0);
+	size_t lines = 0;
+	for (char c : text)
+		lines += c == '\n' ? 1 : 0;
+	// Lines dropped while the queue was full are reported instead
+	CHECK(lines >= 66);
+	file.close();
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
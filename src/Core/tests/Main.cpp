@@ -0,0 +1,47 @@
+#include "Test.h"
+
+#include <cstring>
+#include <exception>
+
+// Usage: FSR4_CoreTests [suite]. Without a suite every test case runs; --list prints the suites.
+int main(int argc, char** argv)
+{
+	const char* suite = argc > 1 ? argv[1] : nullptr;
+
+	if (suite && std::strcmp(suite, "--list") == 0) {
+		const char* previous = nullptr;
+		for (const auto& testCase : Test::Registry()) {
+			if (!previous || std::strcmp(previous, testCase.suite) != 0)
+				std::printf("%s\n", testCase.suite);
+			previous = testCase.suite;
+		}
+		return 0;
+	}
+
+	int run = 0;
+	int failed = 0;
+	for (const auto& testCase : Test::Registry()) {
+		if (suite && std::strcmp(suite, testCase.suite) != 0)
+			continue;
+
+		int before = Test::Failures();
+		try {
+			testCase.run();
+		} catch (const Test::RequireFailed&) {
+		} catch (const std::exception& e) {
+			Test::Fail(testCase.suite, 0, e.what());
+		}
+
+		bool passed = Test::Failures() == before;
+		std::printf("[%s] %s: %s\n", testCase.suite, testCase.name, passed ? "ok" : "FAILED");
+		run++;
+		failed += passed ? 0 : 1;
+	}
+
+	if (run == 0) {
+		std::fprintf(stderr, "no test cases for suite %s\n", suite ? suite : "(all)");
+		return 1;
+	}
+	std::printf("%d of %d test cases passed\n", run - failed, run);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "Core/FrameCostRecorder.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Recording stand-ins for the D3D11 context, the D3D12 command list, queues and the shared fence. Each
+// call is appended to a log and counted the way the plugin's CountCost calls count the real one, so a
+// frame path scripted against these runs headless and is checked against FrameCostRecorder's budget.
+namespace MockGpu
+{
+	enum class Api : uint8_t
+	{
+		kCopy11,
+		kDispatch11,
+		kSignal11,
+		kWait11,
+		kBarrier12,
+		kCopy12,
+		kExecute12,
+		kSignal12,
+		kWait12,
+		kFfxDispatch,
+		kCpuWait,
+	};
+
+	struct Call
+	{
+		Api api;
+		std::string what;
+		uint64_t value = 0;
+	};
+
+	struct Resource
+	{
+		const char* name;
+	};
+
+	// Owns the log, the cost recorder and the fence timeline shared by every mock object
+	class Device
+	{
+	public:
+		void Record(Api a_api, std::string a_what, uint64_t a_value = 0)
+		{
+			calls.push_back({ a_api, std::move(a_what), a_value });
+			switch (a_api) {
+			case Api::kCopy11:
+				cost.Add(FrameCostRecorder::Counter::kCopy11);
+				break;
+			case Api::kDispatch11:
+				cost.Add(FrameCostRecorder::Counter::kDispatch11);
+				break;
+			case Api::kWait11:
+			case Api::kWait12:
+				cost.Add(FrameCostRecorder::Counter::kQueueWait);
+				break;
+			case Api::kBarrier12:
+				cost.Add(FrameCostRecorder::Counter::kBarrier12);
+				break;
+			case Api::kCopy12:
+				cost.Add(FrameCostRecorder::Counter::kCopy12);
+				break;
+			case Api::kExecute12:
+				cost.Add(FrameCostRecorder::Counter::kExecute12);
+				break;
+			case Api::kFfxDispatch:
+				cost.Add(FrameCostRecorder::Counter::kFfxDispatch);
+				break;
+			case Api::kCpuWait:
+				cost.Add(FrameCostRecorder::Counter::kCpuWait);
+				break;
+			default:
+				break;
+			}
+		}
+
+		// A signal that does not move the fence forward would let a later wait pass early
+		void Signal(Api a_api, uint64_t a_value)
+		{
+			if (a_value <= signalled)
+				errors.push_back("fence signalled backwards: " + std::to_string(a_value) + " after " + std::to_string(signalled));
+			signalled = a_value > signalled ? a_value : signalled;
+			Record(a_api, "fence", a_value);
+		}
+
+		// Every wait in the plugin follows its signal; one that does not would hang the queue
+		void Wait(Api a_api, uint64_t a_value)
+		{
+			if (a_value > signalled)
+				errors.push_back("wait for unsignalled fence value " + std::to_string(a_value));
+			Record(a_api, "fence", a_value);
+		}
+
+		const FrameCostRecorder::Report& EndFrame()
+		{
+			frameCalls = std::move(calls);
+			calls.clear();
+			return cost.EndFrame();
+		}
+
+		FrameCostRecorder cost;
+		std::vector<Call> calls;
+		std::vector<Call> frameCalls;  // The calls of the frame EndFrame() closed
+		std::vector<std::string> errors;
+		uint64_t signalled = 0;
+	};
+
+	class DeviceContext11
+	{
+	public:
+		explicit DeviceContext11(Device& a_device) :
+			device(a_device) {}
+
+		void CopyResource(const Resource& a_dst, const Resource& a_src) { device.Record(Api::kCopy11, std::string(a_src.name) + " -> " + a_dst.name); }
+		void Dispatch(const char* a_shader) { device.Record(Api::kDispatch11, a_shader); }
+		void Signal(uint64_t a_value) { device.Signal(Api::kSignal11, a_value); }
+		void Wait(uint64_t a_value) { device.Wait(Api::kWait11, a_value); }
+
+	private:
+		Device& device;
+	};
+
+	class CommandList12
+	{
+	public:
+		explicit CommandList12(Device& a_device) :
+			device(a_device) {}
+
+		void Reset() { open = true; }
+		void Close() { open = false; }
+		bool IsOpen() const { return open; }
+
+		void ResourceBarrier(uint32_t a_count)
+		{
+			Require("ResourceBarrier");
+			device.Record(Api::kBarrier12, std::to_string(a_count) + " transitions");
+		}
+
+		void CopyResource(const Resource& a_dst, const Resource& a_src)
+		{
+			Require("CopyResource");
+			device.Record(Api::kCopy12, std::string(a_src.name) + " -> " + a_dst.name);
+		}
+
+		// ffxDispatch records into the command list it is given
+		void FfxDispatch(const char* a_effect)
+		{
+			Require("ffxDispatch");
+			device.Record(Api::kFfxDispatch, a_effect);
+		}
+
+	private:
+		void Require(const char* a_call)
+		{
+			if (!open)
+				device.errors.push_back(std::string(a_call) + " on a closed command list");
+		}
+
+		Device& device;
+		bool open = false;
+	};
+
+	class CommandQueue12
+	{
+	public:
+		CommandQueue12(Device& a_device, const char* a_name) :
+			device(a_device), name(a_name) {}
+
+		void ExecuteCommandLists(const CommandList12& a_list)
+		{
+			if (a_list.IsOpen())
+				device.errors.push_back(std::string("executing an open command list on ") + name);
+			device.Record(Api::kExecute12, name);
+		}
+
+		void Signal(uint64_t a_value) { device.Signal(Api::kSignal12, a_value); }
+		void Wait(uint64_t a_value) { device.Wait(Api::kWait12, a_value); }
+
+	private:
+		Device& device;
+		const char* name;
+	};
+}
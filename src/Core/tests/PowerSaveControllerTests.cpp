@@ -0,0 +1,109 @@
+#include "Test.h"
+
+#include "Core/PowerSaveController.h"
+
+#include <string>
+
+namespace
+{
+	PowerSaveController::Sample Paused(bool a_paused, bool a_loading = false, bool a_enabled = true)
+	{
+		PowerSaveController::Sample sample;
+		sample.enabled = a_enabled;
+		sample.paused = a_paused;
+		sample.loading = a_loading;
+		return sample;
+	}
+}
+
+TEST_CASE("PowerSaveController", "enters after a few paused frames and leaves at once")
+{
+	PowerSaveController controller;
+	CHECK(controller.Update(Paused(true)).state == PowerSaveController::State::kActive);
+	CHECK(controller.Update(Paused(true)).state == PowerSaveController::State::kActive);
+
+	auto entered = controller.Update(Paused(true));
+	CHECK(entered.state == PowerSaveController::State::kPowerSave);
+	CHECK(entered.bypassFrameGeneration);
+	CHECK(entered.frameRateCap == 60.0f);
+	CHECK(!entered.reset);
+
+	controller.Update(Paused(true));
+	auto left = controller.Update(Paused(false));
+	CHECK(left.state == PowerSaveController::State::kActive);
+	CHECK(!left.bypassFrameGeneration);
+	CHECK(left.reset);
+	CHECK(!controller.Update(Paused(false)).reset);
+
+	CHECK(controller.GetStats().entries == 1);
+	CHECK(controller.GetStats().powerSaveFrames == 2);
+}
+
+TEST_CASE("PowerSaveController", "a flickering pause flag does not enter")
+{
+	PowerSaveController controller;
+	for (int i = 0; i < 20; i++) {
+		CHECK(controller.Update(Paused(true)).state == PowerSaveController::State::kActive);
+		CHECK(controller.Update(Paused(true)).state == PowerSaveController::State::kActive);
+		CHECK(!controller.Update(Paused(false)).reset);
+	}
+	CHECK(controller.GetStats().entries == 0);
+}
+
+TEST_CASE("PowerSaveController", "disabled, loading and uncapped")
+{
+	PowerSaveController controller;
+	for (int i = 0; i < 10; i++)
+		CHECK(controller.Update(Paused(true, false, false)).state == PowerSaveController::State::kActive);
+
+	// Loading screens bypass frame generation but are never throttled
+	for (int i = 0; i < 3; i++)
+		controller.Update(Paused(true, true));
+	auto loading = controller.Update(Paused(true, true));
+	CHECK(loading.bypassFrameGeneration);
+	CHECK(loading.frameRateCap == 0.0f);
+	CHECK(controller.Throttle(1.0) == 0.0);
+
+	// Turning the setting off mid-pause leaves and resets
+	CHECK(controller.Update(Paused(true, false, false)).reset);
+
+	PowerSaveController::Config config;
+	config.frameRateCap = 0.0f;
+	config.enterFrames = 0;  // Treated as one
+	PowerSaveController uncapped(config);
+	auto decision = uncapped.Update(Paused(true));
+	CHECK(decision.state == PowerSaveController::State::kPowerSave);
+	CHECK(decision.frameRateCap == 0.0f);
+}
+
+TEST_CASE("PowerSaveController", "throttle paces presents to the cap")
+{
+	PowerSaveController::Config config;
+	config.enterFrames = 1;
+	config.frameRateCap = 50.0f;
+	PowerSaveController controller(config);
+	controller.Update(Paused(true));
+
+	// The first frame under the cap does not wait, the next ones fill the 20 ms interval
+	CHECK(controller.Throttle(1.000) == 0.0);
+	CHECK_NEAR(controller.Throttle(1.005), 0.015, 1e-9);
+	CHECK_NEAR(controller.Throttle(1.021), 0.019, 1e-9);
+
+	// A frame slower than the cap does not wait
+	CHECK(controller.Throttle(1.065) == 0.0);
+
+	// More than a frame late: pace from now instead of catching up with short frames
+	CHECK(controller.Throttle(1.500) == 0.0);
+	CHECK_NEAR(controller.Throttle(1.501), 0.019, 1e-9);
+	CHECK_NEAR(controller.GetStats().throttledSeconds, 0.053, 1e-9);
+
+	// Leaving power save drops the cap
+	controller.Update(Paused(false));
+	CHECK(controller.Throttle(1.502) == 0.0);
+}
+
+TEST_CASE("PowerSaveController", "state names")
+{
+	CHECK(std::string(PowerSaveController::StateName(PowerSaveController::State::kActive)) == "active");
+	CHECK(std::string(PowerSaveController::StateName(PowerSaveController::State::kPowerSave)) == "power save");
+}
@@ -0,0 +1,91 @@
+#include "Test.h"
+
+#include "Core/QueueOverlap.h"
+
+#include <cmath>
+#include <vector>
+
+TEST_CASE("QueueOverlap", "AA on the compute queue beside the scene")
+{
+	// The AA of this frame waits for the scene, frame generation and UI run on the graphics queue after it
+	QueuePass passes[] = {
+		{ "scene", GpuQueue::kGraphics, 8.0 },
+		{ "aa", GpuQueue::kCompute, 1.5, 0 },
+		{ "fg", GpuQueue::kGraphics, 2.0 },
+		{ "ui", GpuQueue::kGraphics, 1.0, 1 },
+	};
+	auto result = SimulateQueueOverlap(passes);
+	CHECK_NEAR(result.serialMs, 12.5, 1e-9);
+	CHECK_NEAR(result.idealMs, 11.0, 1e-9);
+	CHECK_NEAR(result.overlapMs, 1.5, 1e-9);
+	CHECK_NEAR(result.asyncMs, 11.45, 1e-9);
+	CHECK_NEAR(result.GainMs(), 1.05, 1e-9);
+	CHECK_NEAR(result.startMs[1], 8.0, 1e-9);
+	CHECK_NEAR(result.endMs[3], 11.0, 1e-9);
+}
+
+TEST_CASE("QueueOverlap", "a fence chain leaves nothing to overlap")
+{
+	// Present, then AA behind the D3D11 wait on it: what the plugin submits today
+	QueuePass chained[] = {
+		{ "present", GpuQueue::kGraphics, 1.2 },
+		{ "aa", GpuQueue::kCompute, 0.9, 0 },
+	};
+	auto result = SimulateQueueOverlap(chained);
+	CHECK(result.overlapMs == 0.0);
+	CHECK_NEAR(result.GainMs(), 0.0, 1e-12);
+
+	chained[1].waitFor = -1;
+	auto free = SimulateQueueOverlap(chained);
+	CHECK_NEAR(free.overlapMs, 0.9, 1e-9);
+	CHECK_NEAR(free.asyncMs, 1.2 + 0.9 * 0.3, 1e-9);
+}
+
+TEST_CASE("QueueOverlap", "contention, bad waits and negative times")
+{
+	QueuePass passes[] = {
+		{ "a", GpuQueue::kGraphics, 2.0, 1 },  // Forward reference, ignored
+		{ "b", GpuQueue::kCompute, 2.0, 1 },   // Self reference, ignored
+		{ "c", GpuQueue::kCompute, -1.0 },
+	};
+	auto perfect = SimulateQueueOverlap(passes, 0.0);
+	CHECK_NEAR(perfect.serialMs, 4.0, 1e-9);
+	CHECK_NEAR(perfect.asyncMs, 2.0, 1e-9);
+	CHECK(perfect.endMs[2] == perfect.startMs[2]);
+
+	// Full contention gains nothing, and past 1 it is clamped
+	CHECK_NEAR(SimulateQueueOverlap(passes, 1.0).asyncMs, 4.0, 1e-9);
+	CHECK_NEAR(SimulateQueueOverlap(passes, 5.0).asyncMs, 4.0, 1e-9);
+
+	CHECK(SimulateQueueOverlap({}).serialMs == 0.0);
+}
+
+TEST_CASE("QueueOverlap", "timing window averages measured frames")
+{
+	const QueuePass passes[] = {
+		{ "present", GpuQueue::kGraphics, 0.0 },
+		{ "aa", GpuQueue::kCompute, 0.0, 0 },
+	};
+	QueueTimingWindow window(passes, 4);
+	CHECK(window.GetFrames() == 4);
+
+	const double frames[4][2] = { { 1.0, 2.0 }, { 3.0, NAN }, { 1.0, 4.0 }, { 3.0, NAN } };
+	for (int i = 0; i < 3; i++)
+		CHECK(!window.Add(frames[i]));
+	CHECK(window.Add(frames[3]));
+
+	auto averages = window.GetAverages();
+	REQUIRE(averages.size() == 2);
+	CHECK_NEAR(averages[0].ms, 2.0, 1e-12);
+	CHECK_NEAR(averages[1].ms, 3.0, 1e-12);  // Over the frames AA ran on
+	CHECK(averages[1].waitFor == 0);
+	CHECK(averages[1].queue == GpuQueue::kCompute);
+
+	// The next window starts empty; a pass that never ran averages to zero
+	const double presentOnly[2] = { 5.0, NAN };
+	for (int i = 0; i < 3; i++)
+		CHECK(!window.Add(presentOnly));
+	CHECK(window.Add(presentOnly));
+	CHECK_NEAR(window.GetAverages()[0].ms, 5.0, 1e-12);
+	CHECK(window.GetAverages()[1].ms == 0.0);
+}
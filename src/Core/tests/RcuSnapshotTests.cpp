@@ -0,0 +1,112 @@
+#include "Test.h"
+
+#include "Core/RcuSnapshot.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Heap-backed so a snapshot freed while still read shows up as garbage (or under a sanitizer)
+	struct Settings
+	{
+		uint32_t version = 0;
+		uint32_t twice = 0;
+		std::vector<uint32_t> values = std::vector<uint32_t>(16, 0);
+
+		bool IsConsistent() const
+		{
+			if (twice != version * 2 || values.size() != 16)
+				return false;
+			for (auto value : values)
+				if (value != version)
+					return false;
+			return true;
+		}
+	};
+
+	void Bump(Settings& a_settings)
+	{
+		a_settings.version++;
+		a_settings.twice = a_settings.version * 2;
+		for (auto& value : a_settings.values)
+			value = a_settings.version;
+	}
+}
+
+TEST_CASE("RcuSnapshot", "snapshots outlive a publish until the reader quiesces")
+{
+	RcuSnapshot<Settings> cell;
+	const Settings* held = cell.Read();
+
+	cell.Update(Bump);
+	cell.Update(Bump);
+	CHECK(cell.PendingReclaim() == 2);
+	CHECK(held->version == 0);
+	CHECK(held->IsConsistent());
+	CHECK(cell.Read()->version == 2);
+
+	cell.Quiesce();
+	CHECK(cell.PendingReclaim() == 0);
+	CHECK(cell.Copy().version == 2);
+}
+
+TEST_CASE("RcuSnapshot", "a snapshot retired after the quiescent point is kept")
+{
+	RcuSnapshot<Settings> cell;
+	cell.Update(Bump);
+	cell.Quiesce();
+	cell.Update(Bump);
+	CHECK(cell.PendingReclaim() == 1);
+	cell.Quiesce();
+	CHECK(cell.PendingReclaim() == 0);
+}
+
+TEST_CASE("RcuSnapshot", "concurrent reloads never hand the reader a torn or freed snapshot")
+{
+	RcuSnapshot<Settings> cell;
+	std::atomic<bool> stop{ false };
+	std::atomic<uint32_t> published{ 0 };
+
+	// Two writers, like the UI and the INI file watcher
+	auto writer = [&]() {
+		for (int i = 0; i < 5000; i++) {
+			cell.Update(Bump);
+			published++;
+		}
+	};
+
+	uint32_t frames = 0;
+	uint32_t inconsistent = 0;
+	uint32_t wentBackwards = 0;
+	std::thread writers[2] = { std::thread(writer), std::thread(writer) };
+	std::thread reader([&]() {
+		uint32_t lastVersion = 0;
+		while (!stop.load(std::memory_order_relaxed)) {
+			// One "frame": several reads of the same pointer, then the quiescent point
+			const Settings* frame = cell.Read();
+			for (int i = 0; i < 4; i++)
+				inconsistent += frame->IsConsistent() ? 0 : 1;
+			wentBackwards += frame->version < lastVersion ? 1 : 0;
+			lastVersion = frame->version;
+			cell.Quiesce();
+			frames++;
+		}
+	});
+
+	for (auto& thread : writers)
+		thread.join();
+	stop = true;
+	reader.join();
+
+	CHECK(frames > 0);
+	CHECK(inconsistent == 0);
+	CHECK(wentBackwards == 0);
+	CHECK(published == 10000);
+	CHECK(cell.Copy().version == 10000);
+
+	// Nothing is left behind once the reader passes its next quiescent point
+	cell.Quiesce();
+	CHECK(cell.PendingReclaim() == 0);
+}
@@ -0,0 +1,73 @@
+#include "Test.h"
+
+#include "Core/ResizePlanner.h"
+
+namespace
+{
+	ResizePlanner::Current Live(uint32_t a_width, uint32_t a_height, uint32_t a_format)
+	{
+		ResizePlanner::Current current;
+		current.interop = { a_width, a_height };
+		current.interopFormat = a_format;
+		current.sharedResources = { a_width, a_height };
+		current.upscaleMaxRender = { a_width, a_height };
+		current.upscaleMaxOutput = { a_width, a_height };
+		current.frameGenDisplay = { a_width, a_height };
+		current.frameGenFormat = a_format;
+		return current;
+	}
+
+	ResizePlanner::Target Native(uint32_t a_width, uint32_t a_height, uint32_t a_format)
+	{
+		return { { a_width, a_height }, a_format, { a_width, a_height } };
+	}
+}
+
+TEST_CASE("ResizePlanner", "same size keeps everything")
+{
+	ResizePlanner planner;
+	auto plan = planner.Build(Live(1920, 1080, 24), Native(1920, 1080, 24));
+	CHECK(plan.IsEmpty());
+	CHECK(plan.Describe() == "nothing");
+}
+
+TEST_CASE("ResizePlanner", "minimised window keeps everything")
+{
+	ResizePlanner planner;
+	CHECK(planner.Build(Live(1920, 1080, 24), Native(0, 0, 24)).IsEmpty());
+}
+
+TEST_CASE("ResizePlanner", "format change rebuilds only format dependent objects")
+{
+	ResizePlanner planner;
+	auto plan = planner.Build(Live(1920, 1080, 24), Native(1920, 1080, 10));
+	CHECK(plan.recreateInterop);
+	CHECK(!plan.recreateSharedResources);
+	CHECK(!plan.recreateUpscale);
+	CHECK(plan.recreateFrameGeneration);
+	CHECK(plan.Describe() == "interop back buffer, frame generation context");
+}
+
+TEST_CASE("ResizePlanner", "growing rebuilds everything")
+{
+	ResizePlanner planner;
+	auto plan = planner.Build(Live(1920, 1080, 24), Native(2560, 1440, 24));
+	CHECK(plan.recreateInterop && plan.recreateSharedResources && plan.recreateUpscale && plan.recreateFrameGeneration);
+}
+
+TEST_CASE("ResizePlanner", "upscale context shrinks only past the area ratio")
+{
+	ResizePlanner planner;
+	auto slightly = planner.Build(Live(1920, 1080, 24), Native(1600, 900, 24));
+	CHECK(!slightly.recreateUpscale);
+	CHECK(slightly.recreateSharedResources);
+
+	auto far = planner.Build(Live(1920, 1080, 24), Native(1280, 720, 24));
+	CHECK(far.recreateUpscale);
+}
+
+TEST_CASE("ResizePlanner", "objects that do not exist are never rebuilt")
+{
+	ResizePlanner planner;
+	CHECK(planner.Build({}, Native(2560, 1440, 24)).IsEmpty());
+}
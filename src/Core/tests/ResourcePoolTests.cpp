@@ -0,0 +1,92 @@
+#include "Test.h"
+
+#include "Core/ResourcePool.h"
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+	using Pool = ResourcePool<TextureKey, int, TextureKey::Hash>;
+
+	const TextureKey kColor{ 1920, 1080, 28, 0x8, 1, true };
+	const TextureKey kDepth{ 1920, 1080, 41, 0x80, 1, true };
+}
+
+TEST_CASE("ResourcePool", "acquire returns an equal key only")
+{
+	std::vector<int> evicted;
+	Pool pool(1000, [&](int a_resource) { evicted.push_back(a_resource); });
+
+	CHECK(!pool.Acquire(kColor));
+	pool.Release(kColor, 1, 100);
+	CHECK(!pool.Acquire(kDepth));
+
+	auto smaller = kColor;
+	smaller.width = 1280;
+	CHECK(!pool.Acquire(smaller));
+	auto unshared = kColor;
+	unshared.shared = false;
+	CHECK(!pool.Acquire(unshared));
+
+	auto hit = pool.Acquire(kColor);
+	REQUIRE(hit.has_value());
+	CHECK(*hit == 1);
+	CHECK(pool.IdleCount() == 0);
+	CHECK(pool.IdleBytes() == 0);
+	CHECK(pool.GetStats().hits == 1);
+	CHECK(pool.GetStats().misses == 4);
+	CHECK(evicted.empty());
+}
+
+TEST_CASE("ResourcePool", "most recently released match is reused first")
+{
+	Pool pool(1000, nullptr);
+	pool.Release(kColor, 1, 100);
+	pool.Release(kColor, 2, 100);
+	CHECK(*pool.Acquire(kColor) == 2);
+	CHECK(*pool.Acquire(kColor) == 1);
+}
+
+TEST_CASE("ResourcePool", "capacity evicts least recently released first")
+{
+	std::vector<int> evicted;
+	Pool pool(250, [&](int a_resource) { evicted.push_back(a_resource); });
+	pool.Release(kColor, 1, 100);
+	pool.Release(kDepth, 2, 100);
+	pool.Release(kColor, 3, 100);
+
+	CHECK((evicted == std::vector<int>{ 1 }));
+	CHECK(pool.IdleBytes() == 200);
+	CHECK(*pool.Acquire(kColor) == 3);
+	CHECK(!pool.Acquire(kColor));
+
+	pool.SetCapacity(0);
+	CHECK((evicted == std::vector<int>{ 1, 2 }));
+	CHECK(pool.GetStats().evictions == 2);
+}
+
+TEST_CASE("ResourcePool", "Trim and Clear hand everything to the evict callback")
+{
+	auto live = std::make_shared<int>(0);
+	int evicted = 0;
+	{
+		ResourcePool<TextureKey, std::shared_ptr<int>, TextureKey::Hash> pool(1000, [&](std::shared_ptr<int>) { evicted++; });
+		pool.Release(kColor, live, 300);
+		pool.Release(kDepth, live, 300);
+		pool.Release(kColor, live, 300);
+		CHECK(live.use_count() == 4);
+		pool.Trim(600);
+		CHECK(live.use_count() == 3);
+		CHECK(pool.IdleCount() == 2);
+		pool.Clear();
+		CHECK(evicted == 3);
+		CHECK(pool.IdleCount() == 0);
+		CHECK(pool.IdleBytes() == 0);
+
+		pool.Release(kDepth, live, 300);
+	}
+	// The destructor drops what is left without calling back
+	CHECK(evicted == 3);
+	CHECK(live.use_count() == 1);
+}
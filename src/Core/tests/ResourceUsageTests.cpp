@@ -0,0 +1,50 @@
+#include "Test.h"
+
+#include "Core/ResourceUsage.h"
+
+namespace
+{
+	using Flags = ResourceUsage::Flags;
+
+	constexpr uint32_t kSimultaneous = ResourceUsage::kAllowSimultaneousAccess12;
+	constexpr uint32_t kSrv11 = ResourceUsage::kBindShaderResource11;
+}
+
+TEST_CASE("ResourceUsage", "copies and reads need no creation flags")
+{
+	CHECK((ResourceUsage::Derive(ResourceUsage::kNone) == Flags{ kSrv11, kSimultaneous }));
+	CHECK((ResourceUsage::Derive(ResourceUsage::kCopy11 | ResourceUsage::kCopy12 | ResourceUsage::kShaderRead11 | ResourceUsage::kShaderRead12) == Flags{ kSrv11, kSimultaneous }));
+	CHECK((ResourceUsage::Derive(ResourceUsage::kCopy11, false) == Flags{ kSrv11, 0 }));
+}
+
+TEST_CASE("ResourceUsage", "writes on either side need the flag on both")
+{
+	const Flags unordered{ kSrv11 | ResourceUsage::kBindUnorderedAccess11, ResourceUsage::kAllowUnorderedAccess12 | kSimultaneous };
+	CHECK(ResourceUsage::Derive(ResourceUsage::kShaderWrite11) == unordered);
+	CHECK(ResourceUsage::Derive(ResourceUsage::kShaderWrite12) == unordered);
+
+	const Flags renderTarget{ kSrv11 | ResourceUsage::kBindRenderTarget11, ResourceUsage::kAllowRenderTarget12 | kSimultaneous };
+	CHECK(ResourceUsage::Derive(ResourceUsage::kRenderTarget11) == renderTarget);
+	CHECK(ResourceUsage::Derive(ResourceUsage::kRenderTarget12) == renderTarget);
+}
+
+TEST_CASE("ResourceUsage", "the interop textures get exactly what they use")
+{
+	// Depth: written by the D3D11 copy shader, read by FFX
+	auto depth = ResourceUsage::Derive(ResourceUsage::kShaderWrite11 | ResourceUsage::kShaderRead12);
+	CHECK(depth.bind11 == (kSrv11 | ResourceUsage::kBindUnorderedAccess11));
+	CHECK(!(depth.resource12 & ResourceUsage::kAllowRenderTarget12));
+
+	// Motion vectors: rendered and copied in D3D11
+	auto motionVectors = ResourceUsage::Derive(ResourceUsage::kRenderTarget11 | ResourceUsage::kCopy11 | ResourceUsage::kShaderRead12);
+	CHECK(!(motionVectors.resource12 & ResourceUsage::kAllowUnorderedAccess12));
+	CHECK(motionVectors.resource12 & ResourceUsage::kAllowRenderTarget12);
+}
+
+TEST_CASE("ResourceUsage", "WritesFromShader and Describe")
+{
+	CHECK(ResourceUsage::WritesFromShader(ResourceUsage::kShaderWrite12));
+	CHECK(!ResourceUsage::WritesFromShader(ResourceUsage::kRenderTarget11 | ResourceUsage::kCopy11));
+	CHECK(ResourceUsage::Describe(ResourceUsage::kNone) == "None");
+	CHECK(ResourceUsage::Describe(ResourceUsage::kCopy11 | ResourceUsage::kShaderRead12) == "Copy11|ShaderRead12");
+}
@@ -0,0 +1,81 @@
+#include "Test.h"
+
+#include "Core/RingAllocator.h"
+
+#include <vector>
+
+TEST_CASE("RingAllocator", "allocations are aligned and front to back")
+{
+	RingAllocator ring(4096);
+	RingAllocator::Allocation first, second;
+	REQUIRE(ring.Allocate(100, first));
+	REQUIRE(ring.Allocate(300, second));
+
+	CHECK(first.offset == 0);
+	CHECK(first.size == 256);
+	CHECK(first.discard);
+	CHECK(second.offset == 256);
+	CHECK(second.size == 512);
+	CHECK(!second.discard);
+	CHECK(ring.GetHead() == 768);
+}
+
+TEST_CASE("RingAllocator", "capacity is trimmed to whole blocks")
+{
+	RingAllocator ring(1000);
+	CHECK(ring.GetCapacity() == 768);
+	RingAllocator::Allocation allocation;
+	CHECK(!ring.Allocate(0, allocation));
+	CHECK(!ring.Allocate(769, allocation));
+	CHECK(ring.Allocate(768, allocation));
+}
+
+TEST_CASE("RingAllocator", "a wrap discards and never overlaps live data")
+{
+	RingAllocator ring(1024);
+	RingAllocator::Allocation allocation;
+	ring.Allocate(256, allocation);
+	ring.Allocate(512, allocation);
+
+	// 256 bytes left, 512 requested: the tail is skipped
+	REQUIRE(ring.Allocate(512, allocation));
+	CHECK(allocation.offset == 0);
+	CHECK(allocation.discard);
+	CHECK(ring.GetStats().wraps == 1);
+	CHECK(ring.GetStats().wasted == 256);
+	CHECK(ring.GetStats().allocations == 3);
+	CHECK(ring.GetStats().bytes == 1280);
+}
+
+TEST_CASE("RingAllocator", "Reset discards on the next allocation")
+{
+	RingAllocator ring(1024);
+	RingAllocator::Allocation allocation;
+	ring.Allocate(256, allocation);
+	ring.Reset();
+	REQUIRE(ring.Allocate(256, allocation));
+	CHECK(allocation.offset == 0);
+	CHECK(allocation.discard);
+	CHECK(ring.GetStats().wraps == 0);
+}
+
+TEST_CASE("RingAllocator", "per-dispatch constants over many frames")
+{
+	// Three dispatches per frame, every range handed out between two discards is disjoint
+	RingAllocator ring(64 * 1024);
+	std::vector<RingAllocator::Allocation> sinceDiscard;
+	uint32_t overlaps = 0;
+	for (int dispatch = 0; dispatch < 3000; dispatch++) {
+		RingAllocator::Allocation allocation;
+		REQUIRE(ring.Allocate(48 + (dispatch % 5) * 100, allocation));
+		CHECK(allocation.offset % RingAllocator::kConstantBufferAlignment == 0);
+		CHECK(allocation.offset + allocation.size <= ring.GetCapacity());
+		if (allocation.discard)
+			sinceDiscard.clear();
+		for (const auto& live : sinceDiscard)
+			overlaps += allocation.offset < live.offset + live.size && live.offset < allocation.offset + allocation.size ? 1 : 0;
+		sinceDiscard.push_back(allocation);
+	}
+	CHECK(overlaps == 0);
+	CHECK(ring.GetStats().wraps > 0);
+}
@@ -0,0 +1,147 @@
+#include "Test.h"
+
+#include "Core/SceneCutDetector.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	SceneCutDetector::Sample Camera(float a_x, float a_yawRad, float a_fov = 1.2f, float a_deltaTimeMs = 16.6f)
+	{
+		SceneCutDetector::Sample sample;
+		sample.hasCamera = true;
+		sample.position[0] = a_x;
+		sample.right[0] = std::cos(a_yawRad);
+		sample.right[1] = -std::sin(a_yawRad);
+		sample.forward[0] = std::sin(a_yawRad);
+		sample.forward[1] = std::cos(a_yawRad);
+		sample.up[2] = 1.0f;
+		sample.fovVerticalRad = a_fov;
+		sample.deltaTimeMs = a_deltaTimeMs;
+		return sample;
+	}
+}
+
+TEST_CASE("SceneCutDetector", "smooth motion never cuts")
+{
+	SceneCutDetector detector;
+	for (int i = 0; i < 300; i++) {
+		auto decision = detector.Update(Camera(i * 5.0f, i * 0.01f));
+		CHECK(!decision.cut);
+		CHECK(decision.score < 0.5f);
+	}
+}
+
+TEST_CASE("SceneCutDetector", "each signal alone is enough")
+{
+	struct Case
+	{
+		SceneCutDetector::Sample jump;
+		uint32_t reason;
+	};
+	const Case cases[] = {
+		{ Camera(5000.0f, 0.0f), SceneCutDetector::kTranslation },
+		{ Camera(0.0f, 1.5f), SceneCutDetector::kRotation },
+		{ Camera(0.0f, 0.0f, 0.8f), SceneCutDetector::kFov },
+		{ Camera(0.0f, 0.0f, 1.2f, 500.0f), SceneCutDetector::kDeltaTime },
+	};
+
+	for (const auto& testCase : cases) {
+		SceneCutDetector detector;
+		for (int i = 0; i < 10; i++)
+			CHECK(!detector.Update(Camera(0.0f, 0.0f)).cut);
+		auto decision = detector.Update(testCase.jump);
+		CHECK(decision.cut);
+		CHECK((decision.reasons & testCase.reason) != 0);
+	}
+}
+
+TEST_CASE("SceneCutDetector", "depth histogram change cuts")
+{
+	SceneCutDetector detector;
+	const uint32_t nearHistogram[4] = { 100, 0, 0, 0 };
+	const uint32_t farHistogram[4] = { 0, 0, 0, 100 };
+
+	auto sample = Camera(0.0f, 0.0f);
+	sample.depthHistogram = nearHistogram;
+	CHECK(!detector.Update(sample).cut);
+	CHECK(!detector.Update(sample).cut);
+
+	sample.depthHistogram = farHistogram;
+	auto decision = detector.Update(sample);
+	CHECK(decision.cut);
+	CHECK(decision.reasons == SceneCutDetector::kDepthHistogram);
+}
+
+TEST_CASE("SceneCutDetector", "several moderate signals add up")
+{
+	SceneCutDetector detector;
+	detector.Update(Camera(0.0f, 0.0f));
+	// 0.7 of the translation threshold plus 0.7 of the rotation threshold
+	auto decision = detector.Update(Camera(700.0f, 0.55f));
+	CHECK(decision.reasons == SceneCutDetector::kNone);
+	CHECK(decision.cut);
+}
+
+TEST_CASE("SceneCutDetector", "a multi-frame transition resets once")
+{
+	SceneCutDetector detector;
+	detector.Update(Camera(0.0f, 0.0f));
+
+	int cuts = 0;
+	float x = 0.0f;
+	for (int i = 0; i < 5; i++) {
+		x += 3000.0f;
+		cuts += detector.Update(Camera(x, 0.0f)).cut ? 1 : 0;
+	}
+	CHECK(cuts == 1);
+}
+
+TEST_CASE("SceneCutDetector", "re-arms only after release and cooldown")
+{
+	SceneCutDetector detector;
+	detector.Update(Camera(0.0f, 0.0f));
+	CHECK(detector.Update(Camera(3000.0f, 0.0f)).cut);
+
+	// Score released right away, but still inside the four frame cooldown
+	CHECK(!detector.Update(Camera(3000.0f, 0.0f)).cut);
+	CHECK(!detector.Update(Camera(6000.0f, 0.0f)).cut);
+
+	CHECK(!detector.Update(Camera(6000.0f, 0.0f)).cut);
+	CHECK(!detector.Update(Camera(6000.0f, 0.0f)).cut);
+	CHECK(detector.Update(Camera(9000.0f, 0.0f)).cut);
+}
+
+TEST_CASE("SceneCutDetector", "Reset forgets the previous frame")
+{
+	SceneCutDetector detector;
+	detector.Update(Camera(0.0f, 0.0f));
+	detector.Reset();
+	CHECK(!detector.Update(Camera(9000.0f, 2.0f)).cut);
+}
+
+TEST_CASE("SceneCutDetector", "evaluation counts hits, misses and false alarms")
+{
+	std::vector<SceneCutLabelledSample> trace;
+	auto push = [&](float a_x, bool a_isCut) { trace.push_back({ Camera(a_x, 0.0f), a_isCut }); };
+
+	for (int i = 0; i < 10; i++)
+		push(0.0f, false);
+	push(5000.0f, true);  // Detected
+	for (int i = 0; i < 10; i++)
+		push(5000.0f, false);
+	push(5000.0f, true);  // Labelled but the camera did not move: missed
+	for (int i = 0; i < 10; i++)
+		push(5000.0f, false);
+	push(10000.0f, false);  // Unlabelled jump: false alarm
+	for (int i = 0; i < 10; i++)
+		push(10000.0f, false);
+
+	auto result = EvaluateSceneCuts({}, trace);
+	CHECK(result.truePositives == 1);
+	CHECK(result.falseNegatives == 1);
+	CHECK(result.falsePositives == 1);
+	CHECK_NEAR(result.Precision(), 0.5f, 1e-6);
+	CHECK_NEAR(result.Recall(), 0.5f, 1e-6);
+}
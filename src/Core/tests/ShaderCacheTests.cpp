@@ -0,0 +1,120 @@
+#include "Test.h"
+
+#include "Core/ShaderCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	const std::vector<uint8_t> kBytecode = { 0x44, 0x58, 0x42, 0x43, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+	std::filesystem::path TempPath(const char* a_name)
+	{
+		return std::filesystem::temp_directory_path() / "FSR4_CoreTests" / a_name;
+	}
+}
+
+TEST_CASE("ShaderCache", "FNV-1a matches the reference values")
+{
+	CHECK(ShaderCache::Hash(std::string_view("")) == 0xcbf29ce484222325ull);
+	CHECK(ShaderCache::Hash(std::string_view("a")) == 0xaf63dc4c8601ec8cull);
+	CHECK(ShaderCache::Hash(std::string_view("foobar")) == 0x85944171f73967e8ull);
+}
+
+TEST_CASE("ShaderCache", "every key input changes the key")
+{
+	ShaderCache::KeyInputs base{ "float4 main() : SV_Target { return 0; }", "main", "cs_5_0", 0, 47 };
+	auto key = ShaderCache::ComputeKey(base);
+	CHECK(ShaderCache::ComputeKey(base) == key);
+
+	auto changed = base;
+	changed.source = "float4 main() : SV_Target { return 1; }";
+	CHECK(ShaderCache::ComputeKey(changed) != key);
+	changed = base;
+	changed.entry = "main2";
+	CHECK(ShaderCache::ComputeKey(changed) != key);
+	changed = base;
+	changed.profile = "cs_5_1";
+	CHECK(ShaderCache::ComputeKey(changed) != key);
+	changed = base;
+	changed.flags = 1;
+	CHECK(ShaderCache::ComputeKey(changed) != key);
+	changed = base;
+	changed.compilerVersion = 48;
+	CHECK(ShaderCache::ComputeKey(changed) != key);
+
+	// Fields are length prefixed, moving bytes between them is a different key
+	ShaderCache::KeyInputs left{ "x", "ab", "c" };
+	ShaderCache::KeyInputs right{ "x", "a", "bc" };
+	CHECK(ShaderCache::ComputeKey(left) != ShaderCache::ComputeKey(right));
+}
+
+TEST_CASE("ShaderCache", "serialize round trip")
+{
+	auto file = ShaderCache::Serialize(42, kBytecode);
+	CHECK(file.size() == ShaderCache::kHeaderSize + kBytecode.size());
+	CHECK(file[0] == 'F' && file[1] == 'S' && file[2] == 'C' && file[3] == '1');
+
+	std::vector<uint8_t> bytecode;
+	CHECK(ShaderCache::Deserialize(file, 42, bytecode));
+	CHECK(bytecode == kBytecode);
+}
+
+TEST_CASE("ShaderCache", "corrupt, truncated or foreign entries are misses")
+{
+	auto file = ShaderCache::Serialize(42, kBytecode);
+	std::vector<uint8_t> bytecode;
+
+	CHECK(!ShaderCache::Deserialize(file, 43, bytecode));
+
+	auto corrupt = file;
+	corrupt.back() ^= 0xFF;
+	CHECK(!ShaderCache::Deserialize(corrupt, 42, bytecode));
+
+	auto badMagic = file;
+	badMagic[0] = 'X';
+	CHECK(!ShaderCache::Deserialize(badMagic, 42, bytecode));
+
+	auto badVersion = file;
+	badVersion[4]++;
+	CHECK(!ShaderCache::Deserialize(badVersion, 42, bytecode));
+
+	for (size_t size : { size_t(0), size_t(3), ShaderCache::kHeaderSize, file.size() - 1 }) {
+		std::vector<uint8_t> truncated(file.begin(), file.begin() + size);
+		CHECK(!ShaderCache::Deserialize(truncated, 42, bytecode));
+	}
+
+	auto trailing = file;
+	trailing.push_back(0);
+	CHECK(!ShaderCache::Deserialize(trailing, 42, bytecode));
+
+	// An empty body is never a valid entry
+	CHECK(!ShaderCache::Deserialize(ShaderCache::Serialize(42, {}), 42, bytecode));
+	CHECK(bytecode.empty());
+}
+
+TEST_CASE("ShaderCache", "store and load through the file system")
+{
+	auto path = TempPath("TileHashCS.cso");
+	std::error_code error;
+	std::filesystem::remove_all(path.parent_path(), error);
+
+	std::vector<uint8_t> bytecode;
+	CHECK(!ShaderCache::Load(path, 7, bytecode));
+
+	REQUIRE(ShaderCache::Store(path, 7, kBytecode));
+	CHECK(!std::filesystem::exists(path.string() + ".tmp"));
+	CHECK(ShaderCache::Load(path, 7, bytecode));
+	CHECK(bytecode == kBytecode);
+	CHECK(!ShaderCache::Load(path, 8, bytecode));
+
+	// Overwriting replaces the entry
+	std::vector<uint8_t> other = { 9, 9, 9 };
+	REQUIRE(ShaderCache::Store(path, 7, other));
+	CHECK(ShaderCache::Load(path, 7, bytecode));
+	CHECK(bytecode == other);
+
+	std::filesystem::remove_all(path.parent_path(), error);
+}
@@ -0,0 +1,256 @@
+#include "Test.h"
+
+#include "Core/StaticFrameDetector.h"
+
+#include <bit>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	using Tile = StaticFrameDetector::Tile;
+
+	constexpr uint32_t kTilesX = 4;
+	constexpr uint32_t kTilesY = 3;
+	constexpr uint32_t kPhases = 8;
+
+	// Jittered frames of the same image differ between phases and repeat a cycle later
+	std::vector<Tile> Tiles(uint32_t a_content, uint32_t a_phase, float a_motion = 0.0f)
+	{
+		std::vector<Tile> tiles(kTilesX * kTilesY);
+		for (uint32_t i = 0; i < tiles.size(); i++) {
+			tiles[i].hash = a_content * 1000003u + a_phase * 101u + i;
+			tiles[i].motionBits = std::bit_cast<uint32_t>(a_motion);
+		}
+		return tiles;
+	}
+
+	// Drives the detector the way Upscaling does: results arrive a few frames after their dispatch,
+	// a_stalled holds them back like a readback still in flight
+	struct Sequence
+	{
+		bool Frame(uint32_t a_content, bool a_invalidate = false, bool a_stalled = false)
+		{
+			while (!a_stalled && pending.size() >= kLatency) {
+				auto& [frameID, tiles] = pending.front();
+				detector.AddTiles(frameID, uint32_t(frameID % kPhases), kTilesX, kTilesY, tiles);
+				pending.pop_front();
+			}
+
+			bool reuse = detector.BeginFrame(frame, camera, a_invalidate);
+			pending.push_back({ frame, Tiles(a_content, uint32_t(frame % kPhases)) });
+			frame++;
+			return reuse;
+		}
+
+		// Frames until BeginFrame reports static, or 0 when it does not within a_limit
+		uint32_t FramesUntilStatic(uint32_t a_content, uint32_t a_limit = 64)
+		{
+			for (uint32_t i = 1; i <= a_limit; i++) {
+				if (Frame(a_content))
+					return i;
+			}
+			return 0;
+		}
+
+		static constexpr size_t kLatency = 3;
+
+		StaticFrameDetector detector;
+		StaticFrameDetector::Camera camera{ true, { 1.0f, 2.0f, 3.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		std::deque<std::pair<uint64_t, std::vector<Tile>>> pending;
+		uint64_t frame = 0;
+	};
+}
+
+TEST_CASE("StaticFrameDetector", "a repeated jitter cycle enters the static state")
+{
+	Sequence sequence;
+	// One cycle fills the history, the next confirms it, the readback adds its latency
+	uint32_t frames = sequence.FramesUntilStatic(7);
+	CHECK(frames == 2 * kPhases + 3);
+	CHECK(sequence.detector.IsStatic());
+	CHECK(sequence.detector.GetStats().staticFrames == 1);
+	CHECK(sequence.detector.GetStats().comparedFrames == kPhases);
+
+	for (int i = 0; i < 10; i++)
+		CHECK(sequence.Frame(7));
+	CHECK(sequence.detector.GetStats().staticFrames == 11);
+}
+
+TEST_CASE("StaticFrameDetector", "changing content never becomes static")
+{
+	Sequence sequence;
+	for (uint32_t i = 0; i < 64; i++)
+		CHECK(!sequence.Frame(i));
+}
+
+TEST_CASE("StaticFrameDetector", "a change while static ends the run once its hashes arrive")
+{
+	Sequence sequence;
+	REQUIRE(sequence.FramesUntilStatic(7) != 0);
+
+	// Frames up to the readback latency still reuse the output, the changed hashes then end the run
+	for (size_t i = 0; i < Sequence::kLatency; i++)
+		CHECK(sequence.Frame(8));
+	CHECK(!sequence.Frame(8));
+	CHECK(!sequence.detector.IsStatic());
+}
+
+TEST_CASE("StaticFrameDetector", "static frames need a recent result")
+{
+	Sequence sequence;
+	REQUIRE(sequence.FramesUntilStatic(7) != 0);
+	auto staticFrames = sequence.detector.GetStats().staticFrames;
+
+	// Readbacks still in flight: the newest result falls behind and the output is no longer reused
+	CHECK(!sequence.Frame(7, false, true));
+	CHECK(sequence.detector.IsStatic());
+	CHECK(sequence.detector.GetStats().staleFrames == 1);
+
+	// The late results match, so reuse resumes without another confirmation cycle
+	CHECK(sequence.Frame(7));
+	CHECK(sequence.detector.GetStats().staticFrames == staticFrames + 1);
+}
+
+TEST_CASE("StaticFrameDetector", "the jitter phase count follows the upscaler")
+{
+	Sequence sequence;
+	CHECK(sequence.detector.GetJitterPhases() == kPhases);
+	REQUIRE(sequence.FramesUntilStatic(7) != 0);
+
+	// Same count keeps the state, a new one starts over
+	sequence.detector.SetJitterPhases(kPhases);
+	CHECK(sequence.detector.IsStatic());
+	sequence.detector.SetJitterPhases(16);
+	CHECK(!sequence.detector.IsStatic());
+	CHECK(sequence.detector.GetJitterPhases() == 16);
+	sequence.detector.SetJitterPhases(0);
+	CHECK(sequence.detector.GetJitterPhases() == 1);
+}
+
+TEST_CASE("StaticFrameDetector", "camera movement and invalidation leave at once")
+{
+	Sequence sequence;
+	REQUIRE(sequence.FramesUntilStatic(7) != 0);
+	sequence.camera.position[0] += 0.5f;
+	CHECK(!sequence.Frame(7));
+
+	REQUIRE(sequence.FramesUntilStatic(7) != 0);
+	CHECK(!sequence.Frame(7, true));
+
+	// Results of frames rendered before the invalidation are dropped
+	auto& detector = sequence.detector;
+	auto dropped = detector.GetStats().droppedResults;
+	uint64_t invalidated = sequence.frame - 1;
+	auto tiles = Tiles(7, 0);
+	detector.AddTiles(invalidated - 1, 0, kTilesX, kTilesY, tiles);
+	CHECK(detector.GetStats().droppedResults == dropped + 1);
+}
+
+TEST_CASE("StaticFrameDetector", "motion above the limit is not static")
+{
+	StaticFrameDetector detector;
+	StaticFrameDetector::Camera camera;
+	for (uint64_t frame = 0; frame < 4 * kPhases; frame++) {
+		CHECK(!detector.BeginFrame(frame, camera, false));
+		auto tiles = Tiles(1, uint32_t(frame % kPhases), 0.5f);
+		detector.AddTiles(frame, uint32_t(frame % kPhases), kTilesX, kTilesY, tiles);
+	}
+	CHECK(!detector.IsStatic());
+
+	// NaN motion counts as moving
+	StaticFrameDetector nanDetector;
+	for (uint64_t frame = 0; frame < 4 * kPhases; frame++) {
+		auto tiles = Tiles(1, uint32_t(frame % kPhases), std::numeric_limits<float>::quiet_NaN());
+		nanDetector.AddTiles(frame, uint32_t(frame % kPhases), kTilesX, kTilesY, tiles);
+	}
+	CHECK(!nanDetector.IsStatic());
+}
+
+TEST_CASE("StaticFrameDetector", "changed tile tolerance")
+{
+	StaticFrameDetector::Config config;
+	config.maxChangedTiles = 1;
+	StaticFrameDetector detector(config);
+	for (uint64_t frame = 0; frame < 2 * kPhases; frame++) {
+		auto tiles = Tiles(1, uint32_t(frame % kPhases));
+		// A blinking cursor in one tile
+		tiles[5].hash += uint32_t(frame);
+		detector.AddTiles(frame, uint32_t(frame % kPhases), kTilesX, kTilesY, tiles);
+	}
+	CHECK(detector.IsStatic());
+}
+
+TEST_CASE("StaticFrameDetector", "gaps, reordering and size changes")
+{
+	StaticFrameDetector detector;
+	auto add = [&](uint64_t a_frame, uint32_t a_tilesX = kTilesX) {
+		auto tiles = Tiles(1, uint32_t(a_frame % kPhases));
+		tiles.resize(size_t(a_tilesX) * kTilesY);
+		detector.AddTiles(a_frame, uint32_t(a_frame % kPhases), a_tilesX, kTilesY, tiles);
+	};
+
+	for (uint64_t frame = 0; frame < 2 * kPhases - 1; frame++)
+		add(frame);
+	CHECK(!detector.IsStatic());
+
+	// A skipped readback restarts the count of matching frames
+	add(2 * kPhases);
+	CHECK(!detector.IsStatic());
+
+	auto dropped = detector.GetStats().droppedResults;
+	add(2 * kPhases);
+	CHECK(detector.GetStats().droppedResults == dropped + 1);
+
+	for (uint64_t frame = 2 * kPhases + 1; frame < 3 * kPhases + 1; frame++)
+		add(frame);
+	CHECK(detector.IsStatic());
+
+	// A new size starts over
+	add(3 * kPhases + 1, kTilesX + 1);
+	CHECK(!detector.IsStatic());
+
+	detector.Reset();
+	CHECK(!detector.IsStatic());
+}
+
+TEST_CASE("StaticFrameDetector", "tile hashes of the CPU reference")
+{
+	constexpr uint32_t kWidth = 70;
+	constexpr uint32_t kHeight = 40;
+	CHECK(StaticFrameDetector::TileCount(kWidth) == 3);
+	CHECK(StaticFrameDetector::TileCount(kHeight) == 2);
+
+	std::vector<float> color(size_t(kWidth) * kHeight * 4);
+	for (size_t i = 0; i < color.size(); i++)
+		color[i] = float(i % 97) / 97.0f;
+	CpuReference::Image<const float> image{ color.data(), kWidth, kHeight, size_t(kWidth) * 4 };
+
+	std::vector<Tile> first;
+	std::vector<Tile> second;
+	StaticFrameDetector::HashTiles(image, {}, 1.0f, 1.0f, first);
+	StaticFrameDetector::HashTiles(image, {}, 1.0f, 1.0f, second);
+	REQUIRE(first.size() == 6);
+	CHECK(first == second);
+	for (auto& tile : first)
+		CHECK(tile.Motion() == 0.0f);
+
+	// One texel in the last tile; alpha is not hashed
+	color[(size_t(35) * kWidth + 69) * 4 + 3] += 1.0f;
+	StaticFrameDetector::HashTiles(image, {}, 1.0f, 1.0f, second);
+	CHECK(first == second);
+	color[(size_t(35) * kWidth + 69) * 4 + 1] += 1.0f;
+	StaticFrameDetector::HashTiles(image, {}, 1.0f, 1.0f, second);
+	for (size_t tile = 0; tile < 5; tile++)
+		CHECK(first[tile] == second[tile]);
+	CHECK(first[5].hash != second[5].hash);
+
+	// Motion vectors in UV units, scaled to pixels
+	std::vector<CpuReference::Vec2> motion(size_t(kWidth) * kHeight, { 0.0f, 0.0f });
+	motion[size_t(3) * kWidth + 40] = { 0.03f, 0.04f };
+	StaticFrameDetector::HashTiles(image, { motion.data(), kWidth, kHeight, kWidth }, 100.0f, 100.0f, second);
+	CHECK_NEAR(second[1].Motion(), 5.0f, 1e-5);
+	CHECK(second[0].Motion() == 0.0f);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Minimal test registry. TEST_CASE registers a function under a suite name, CHECK records a failure and
+// keeps going, REQUIRE stops the test case. Main.cpp runs one suite (one CTest entry) or all of them.
+namespace Test
+{
+	struct Case
+	{
+		const char* suite;
+		const char* name;
+		void (*run)();
+	};
+
+	struct RequireFailed
+	{};
+
+	inline std::vector<Case>& Registry()
+	{
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	inline int& Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* a_suite, const char* a_name, void (*a_run)()) { Registry().push_back({ a_suite, a_name, a_run }); }
+	};
+
+	inline void Fail(const char* a_file, int a_line, const char* a_expression)
+	{
+		Failures()++;
+		std::fprintf(stderr, "  %s:%d: failed: %s\n", a_file, a_line, a_expression);
+	}
+
+	inline bool Near(double a_value, double a_expected, double a_tolerance)
+	{
+		return std::abs(a_value - a_expected) <= a_tolerance;
+	}
+}
+
+#define TEST_CAT_IMPL(a, b) a##b
+#define TEST_CAT(a, b) TEST_CAT_IMPL(a, b)
+
+#define TEST_CASE_IMPL(a_suite, a_name, a_id)                                              \
+	static void a_id();                                                                    \
+	static const Test::Registrar TEST_CAT(a_id, Registrar)(a_suite, a_name, &a_id);        \
+	static void a_id()
+
+#define TEST_CASE(a_suite, a_name) TEST_CASE_IMPL(a_suite, a_name, TEST_CAT(TestCase, __LINE__))
+
+#define CHECK(a_expression)                                     \
+	do {                                                        \
+		if (!(a_expression))                                    \
+			Test::Fail(__FILE__, __LINE__, #a_expression);      \
+	} while (false)
+
+#define REQUIRE(a_expression)                                   \
+	do {                                                        \
+		if (!(a_expression)) {                                  \
+			Test::Fail(__FILE__, __LINE__, #a_expression);      \
+			throw Test::RequireFailed{};                        \
+		}                                                       \
+	} while (false)
+
+#define CHECK_NEAR(a_value, a_expected, a_tolerance) \
+	CHECK(Test::Near((double)(a_value), (double)(a_expected), (double)(a_tolerance)))
@@ -0,0 +1,147 @@
+#include "Test.h"
+
+#include "Core/VramBudget.h"
+
+#include <vector>
+
+namespace
+{
+	constexpr uint64_t kMB = 1024ull * 1024;
+
+	// Scripted stand-in for QueryVideoMemoryInfo
+	class FakeProvider : public VramBudget::Provider
+	{
+	public:
+		bool Query(VramBudget::Sample& a_sample) override
+		{
+			a_sample = sample;
+			return available;
+		}
+
+		VramBudget::Sample sample{ 1000 * kMB, 0 };
+		bool available = true;
+	};
+
+	using Level = VramBudget::Level;
+
+	VramBudget::Config TestConfig()
+	{
+		VramBudget::Config config;
+		config.escalateSamples = 2;
+		config.recoverSamples = 3;
+		return config;
+	}
+}
+
+TEST_CASE("VramBudget", "allocation accounting by key and category")
+{
+	VramBudget budget;
+	int a = 0, b = 0, c = 0;
+	budget.Track(&a, "Shared", 100);
+	budget.Track(&b, "Shared", 50);
+	budget.Track(&c, "FFX", 25);
+	budget.Track(nullptr, "Ignored", 1000);
+	CHECK(budget.PluginBytes() == 175);
+	CHECK(budget.CategoryBytes("Shared") == 150);
+
+	// Tracking a key again replaces its size
+	budget.Track(&a, "Shared", 10);
+	CHECK(budget.PluginBytes() == 85);
+	budget.Untrack(&b);
+	budget.Untrack(&b);
+	CHECK(budget.PluginBytes() == 35);
+	CHECK(budget.CategoryBytes("Shared") == 10);
+}
+
+TEST_CASE("VramBudget", "no provider or no sample leaves the level alone")
+{
+	VramBudget budget;
+	CHECK(!budget.Update());
+	CHECK(!budget.GetReport().valid);
+
+	FakeProvider provider;
+	provider.available = false;
+	budget.SetProvider(&provider);
+	CHECK(!budget.Update());
+	CHECK(budget.GetLevel() == Level::kNormal);
+}
+
+TEST_CASE("VramBudget", "sustained pressure steps down one level at a time")
+{
+	FakeProvider provider;
+	VramBudget budget(TestConfig());
+	budget.SetProvider(&provider);
+	std::vector<Level> levels;
+	budget.onLevelChange = [&](Level, Level a_to, const VramBudget::Report&) { levels.push_back(a_to); };
+
+	provider.sample.usage = 960 * kMB;
+	CHECK(!budget.Update());
+	CHECK(budget.Update());
+	CHECK(budget.GetLevel() == Level::kCompactFormats);
+
+	// A single relaxed sample resets the escalation count
+	provider.sample.usage = 900 * kMB;
+	budget.Update();
+	provider.sample.usage = 960 * kMB;
+	CHECK(!budget.Update());
+	CHECK(budget.Update());
+	CHECK(budget.Update() == false);
+	CHECK(budget.Update());
+	CHECK(budget.GetLevel() == Level::kNoFrameGeneration);
+
+	// Nothing below the last level
+	for (int i = 0; i < 10; i++)
+		CHECK(!budget.Update());
+	CHECK((levels == std::vector<Level>{ Level::kCompactFormats, Level::kNoUpscaledBuffer, Level::kNoFrameGeneration }));
+	CHECK(budget.GetReport().level == Level::kNoFrameGeneration);
+}
+
+TEST_CASE("VramBudget", "recovery counts what stepping back would allocate again")
+{
+	FakeProvider provider;
+	VramBudget budget(TestConfig());
+	budget.SetProvider(&provider);
+	int context = 0;
+
+	budget.Track(&context, "FFX Upscale", 200 * kMB);
+	provider.sample.usage = 960 * kMB;
+	budget.Update();
+	budget.Update();
+	budget.Update();
+	budget.Update();
+	REQUIRE(budget.GetLevel() == Level::kNoUpscaledBuffer);
+
+	// The level released the upscale context: usage drops, but adding the 200 MB back would not fit
+	budget.Untrack(&context);
+	provider.sample.usage = 700 * kMB;
+	for (int i = 0; i < 10; i++)
+		CHECK(!budget.Update());
+	CHECK(budget.GetLevel() == Level::kNoUpscaledBuffer);
+
+	// Fits below exitPressure with the 200 MB restored, after recoverSamples relaxed samples
+	provider.sample.usage = 600 * kMB;
+	CHECK(!budget.Update());
+	CHECK(!budget.Update());
+	CHECK(budget.Update());
+	CHECK(budget.GetLevel() == Level::kCompactFormats);
+}
+
+TEST_CASE("VramBudget", "usage between the thresholds holds the level")
+{
+	FakeProvider provider;
+	VramBudget budget(TestConfig());
+	budget.SetProvider(&provider);
+	provider.sample.usage = 960 * kMB;
+	budget.Update();
+	budget.Update();
+	REQUIRE(budget.GetLevel() == Level::kCompactFormats);
+
+	// 0.90 is neither pressure (0.95) nor relaxed (0.85): no oscillation in either direction
+	provider.sample.usage = 900 * kMB;
+	for (int i = 0; i < 100; i++)
+		CHECK(!budget.Update());
+	CHECK(budget.GetLevel() == Level::kCompactFormats);
+
+	budget.Reset();
+	CHECK(budget.GetLevel() == Level::kNormal);
+}
@@ -0,0 +1,74 @@
+#include "Core/ImageMetrics.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	constexpr int kPassed = 0;
+	constexpr int kFailed = 1;
+	constexpr int kError = 2;
+
+	int Usage()
+	{
+		std::fprintf(stderr,
+			"Usage: FSR4_CompareCaptures <test.fsrcap> <reference.fsrcap> [options]\n"
+			"  --plane color|depth|motion  Plane to compare (color)\n"
+			"  --min-psnr <dB>             Per-frame limits, 0 disables one\n"
+			"  --min-ssim <value>\n"
+			"  --max-flicker <value>\n"
+			"  --max-flip <value>\n");
+		return kError;
+	}
+
+	bool ParseNumber(const char* a_text, double& a_value)
+	{
+		char* end = nullptr;
+		a_value = std::strtod(a_text, &end);
+		return end != a_text && *end == '\0' && a_value >= 0.0;
+	}
+}
+
+// Compares a capture against a reference and prints the summary. The exit code is what CI gates on:
+// 0 when every frame is within the limits, 1 when one is not, 2 when the captures cannot be compared.
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+		return Usage();
+
+	ImageMetrics::Thresholds thresholds;
+	Capture::Plane plane = Capture::Plane::kColor;
+	for (int i = 3; i < argc; i += 2) {
+		if (i + 1 >= argc)
+			return Usage();
+		const char* option = argv[i];
+		const char* value = argv[i + 1];
+
+		if (std::strcmp(option, "--plane") == 0) {
+			if (std::strcmp(value, "color") == 0)
+				plane = Capture::Plane::kColor;
+			else if (std::strcmp(value, "depth") == 0)
+				plane = Capture::Plane::kDepth;
+			else if (std::strcmp(value, "motion") == 0)
+				plane = Capture::Plane::kMotionVectors;
+			else
+				return Usage();
+			continue;
+		}
+
+		double* limit = std::strcmp(option, "--min-psnr") == 0    ? &thresholds.minPsnr :
+		                std::strcmp(option, "--min-ssim") == 0    ? &thresholds.minSsim :
+		                std::strcmp(option, "--max-flicker") == 0 ? &thresholds.maxFlicker :
+		                std::strcmp(option, "--max-flip") == 0    ? &thresholds.maxFlip :
+		                                                            nullptr;
+		if (!limit || !ParseNumber(value, *limit))
+			return Usage();
+	}
+
+	auto report = ImageMetrics::CompareCaptures(argv[1], argv[2], thresholds, plane);
+	std::fputs(ImageMetrics::Summarize(report).c_str(), report.passed ? stdout : stderr);
+	if (!report.error.empty())
+		return kError;
+	return report.passed ? kPassed : kFailed;
+}
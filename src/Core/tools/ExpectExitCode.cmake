@@ -0,0 +1,6 @@
+# cmake -DCOMMAND=<program;args> -DEXPECTED=<code> -P ExpectExitCode.cmake
+# CTest only tells zero from non-zero; this checks the exact exit code a CI script would branch on.
+execute_process(COMMAND ${COMMAND} RESULT_VARIABLE RESULT)
+if(NOT RESULT EQUAL EXPECTED)
+	message(FATAL_ERROR "${COMMAND} exited with ${RESULT}, expected ${EXPECTED}")
+endif()
@@ -6,20 +6,59 @@
 #include <ffx_framegeneration.hpp>
 #include <dxgi1_6.h>
 
+#include "Core/ResizePlanner.h"
 #include "FidelityFX.h"
+#include "FrameCapture.h"
 #include "Upscaling.h"
 
-DX12SwapChain::DX12SwapChain()
+namespace
+{
+	// The previous frame's present list, then this frame's AA behind the D3D11 wait on it. AA runs on the
+	// direct queue; it is placed on the compute queue here only to predict what moving it there would gain.
+	constexpr QueuePass kTimedPasses[] = {
+		{ "present", GpuQueue::kGraphics, 0.0 },
+		{ "anti-aliasing", GpuQueue::kCompute, 0.0, 0 },
+	};
+}
+
+DX12SwapChain::DX12SwapChain() :
+	queueTimings(kTimedPasses)
 {
 	frameCounter = 0;
 	enbReady = false;
 	QueryPerformanceFrequency(&qpf);
+
+	vramBudget.SetProvider(&budgetProvider);
+	vramBudget.onLevelChange = [](VramBudget::Level a_from, VramBudget::Level a_to, const VramBudget::Report& a_report) {
+		constexpr double MB = 1024.0 * 1024.0;
+		logger::warn("[DX12SwapChain] VRAM {}: {} -> {} (usage {:.0f} / {:.0f} MB, plugin {:.0f} MB)",
+			a_to > a_from ? "pressure" : "recovered", VramBudget::LevelName(a_from), VramBudget::LevelName(a_to),
+			double(a_report.sample.usage) / MB, double(a_report.sample.budget) / MB, double(a_report.pluginBytes) / MB);
+	};
+}
+
+bool DXGIBudgetProvider::Query(VramBudget::Sample& a_sample)
+{
+	if (!adapter)
+		return false;
+
+	DXGI_QUERY_VIDEO_MEMORY_INFO info{};
+	if (FAILED(adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+		return false;
+
+	a_sample.budget = info.Budget;
+	a_sample.usage = info.CurrentUsage;
+	return true;
 }
 
 void DX12SwapChain::CreateD3D12Device(IDXGIAdapter* a_adapter)
 {
 	DX::ThrowIfFailed(D3D12CreateDevice(a_adapter, D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&d3d12Device)));
 
+	// Budget queries need DXGI 1.4; without it the plugin never downgrades
+	if (FAILED(a_adapter->QueryInterface(IID_PPV_ARGS(&budgetProvider.adapter))))
+		logger::warn("[DX12SwapChain] IDXGIAdapter3 not available, VRAM budget tracking disabled");
+
 	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
 	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
 	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
@@ -34,12 +73,40 @@ void DX12SwapChain::CreateD3D12Device(IDXGIAdapter* a_adapter)
 		commandLists[i]->Close();
 	}
 
+	for (int i = 0; i < 3; i++) {
+		DX::ThrowIfFailed(d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&aaAllocators[i])));
+		DX::ThrowIfFailed(d3d12Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, aaAllocators[i].get(), nullptr, IID_PPV_ARGS(&aaLists[i])));
+		aaLists[i]->Close();
+	}
+
+	CreateTimestampQueries();
+
 	fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 }
 
+void DX12SwapChain::CreateTimestampQueries()
+{
+	D3D12_QUERY_HEAP_DESC heapDesc{};
+	heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	heapDesc.Count = static_cast<UINT>(std::size(timestampFrames)) * kTimestampSlots;
+
+	auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+	auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(heapDesc.Count * sizeof(uint64_t));
+
+	// Timing is diagnostics only, the frame does not depend on it
+	if (FAILED(commandQueue->GetTimestampFrequency(&timestampFrequency)) ||
+		FAILED(d3d12Device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&timestampHeap))) ||
+		FAILED(d3d12Device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&timestampReadback)))) {
+		logger::warn("[DX12SwapChain] Timestamp queries not available, queue timings disabled");
+		timestampHeap = nullptr;
+		timestampReadback = nullptr;
+	}
+}
+
 void DX12SwapChain::CreateSwapChain(IDXGIFactory4* a_dxgiFactory, DXGI_SWAP_CHAIN_DESC a_swapChainDesc)
 {
 	logger::info("[DX12SwapChain] Creating D3D12 SwapChain...");
+	auto startupBegin = std::chrono::steady_clock::now();
 	swapChainDesc = {};
 	swapChainDesc.Width = a_swapChainDesc.BufferDesc.Width;
 	swapChainDesc.Height = a_swapChainDesc.BufferDesc.Height;
@@ -96,6 +163,13 @@ void DX12SwapChain::CreateSwapChain(IDXGIFactory4* a_dxgiFactory, DXGI_SWAP_CHAI
 	} else {
 		logger::info("[FSR4SkyrimHandler] Successfully created swap chain context.");
 		fidelityFX->swapChainContextInitialized = true;
+		// Reported by the SDK, the process-wide usage also moves with whatever the game allocates
+		FfxApiEffectMemoryUsage memoryUsage{};
+		ffxQueryFrameGenerationSwapChainGetGPUMemoryUsageDX12 memoryQuery{};
+		memoryQuery.header.type = FFX_API_QUERY_DESC_TYPE_FRAMEGENERATIONSWAPCHAIN_GPU_MEMORY_USAGE_DX12;
+		memoryQuery.gpuMemoryUsageFrameGenerationSwapchain = &memoryUsage;
+		if (ffxQuery(&fidelityFX->swapChainContext, &memoryQuery.header) == FFX_API_RETURN_OK)
+			vramBudget.Track(&fidelityFX->swapChainContext, "FFX Swap Chain", memoryUsage.totalUsageInBytes);
 	}
 
 	if (swapChain) {
@@ -143,6 +217,9 @@ void DX12SwapChain::CreateSwapChain(IDXGIFactory4* a_dxgiFactory, DXGI_SWAP_CHAI
 		fidelityFX->SetupFrameGeneration();
 
 		swapChainProxy = new DXGISwapChainProxy(swapChain);
+
+		// FG and upscale contexts are still being created on the init worker
+		fidelityFX->startupTiming.mainThreadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
 	} else {
 		logger::error("[DX12SwapChain] SwapChain pointer is NULL after ffxCreateContext!");
 	}
@@ -172,6 +249,7 @@ void DX12SwapChain::CreateInterop()
 			}
 			fenceValue = 1; // Start from 1 for safety
 			for (int i = 0; i < 3; i++) frameFenceValues[i] = 0;
+			releaseQueue.GetFence().fence = d3d12Fence.get();
 		}
 
 		D3D11_TEXTURE2D_DESC texDesc11{};
@@ -183,12 +261,12 @@ void DX12SwapChain::CreateInterop()
 		texDesc11.SampleDesc.Count = 1;
 		texDesc11.SampleDesc.Quality = 0;
 		texDesc11.Usage = D3D11_USAGE_DEFAULT;
-		texDesc11.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
 		texDesc11.CPUAccessFlags = 0;
-		texDesc11.MiscFlags = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
 
+		// The game renders into and samples the fake back buffer, D3D12 copies it to the real one
 		logger::info("[DX12SwapChain] Creating Wrapped Backbuffer...");
-		swapChainBufferWrapped = new WrappedResource(texDesc11, d3d11Device.get(), d3d12Device.get());
+		swapChainBufferWrapped = new WrappedResource(texDesc11, ResourceUsage::kRenderTarget11 | ResourceUsage::kShaderRead11 | ResourceUsage::kCopy12, d3d11Device.get(), d3d12Device.get());
+		TrackAllocation(swapChainBufferWrapped, "Interop");
 		logger::info("[DX12SwapChain] Interop resources created successfully.");
 	} catch (const std::exception& e) {
 		logger::critical("[DX12SwapChain] CreateInterop: Exception occurred: {}", e.what());
@@ -197,6 +275,130 @@ void DX12SwapChain::CreateInterop()
 	}
 }
 
+void DX12SwapChain::DeferRelease(WrappedResource* a_resource)
+{
+	if (!a_resource)
+		return;
+
+	// Stays in the VRAM accounting until it is actually freed
+	releaseQueue.Enqueue(GetReleaseFenceValue(), [this, a_resource]() {
+		vramBudget.Untrack(a_resource);
+		delete a_resource;
+	}, GetAllocationSize(a_resource));
+}
+
+void DX12SwapChain::DrainReleaseQueue()
+{
+	auto released = releaseQueue.Drain();
+	if (released) {
+		const auto& metrics = releaseQueue.GetMetrics();
+		logger::info("[DX12SwapChain] Freed {} deferred objects, {} pending ({:.1f} MB)", released, metrics.depth, double(metrics.bytesPending) / (1024.0 * 1024.0));
+	}
+}
+
+uint64_t DX12SwapChain::GetAllocationSize(WrappedResource* a_resource) const
+{
+	if (!a_resource || !a_resource->resource || !d3d12Device)
+		return 0;
+	auto desc = a_resource->resource->GetDesc();
+	return d3d12Device->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+}
+
+void DX12SwapChain::TrackAllocation(WrappedResource* a_resource, const char* a_category)
+{
+	vramBudget.Track(a_resource, a_category, GetAllocationSize(a_resource));
+}
+
+void DX12SwapChain::EndFrameCost()
+{
+	const auto& report = frameCost.EndFrame();
+	if (report.overBudget)
+		LOG_RATE_LIMITED(warn, 3, 30s, "[DX12SwapChain] Frame {} over its command budget: {}", report.frame, frameCost.Describe(report));
+}
+
+void DX12SwapChain::WriteTimestamp(ID3D12GraphicsCommandList* a_commandList, TimestampSlot a_slot)
+{
+	// A slot still waiting for its fence is skipped rather than overwritten
+	auto& frame = timestampFrames[timestampFrame];
+	if (!timestampHeap || frame.pending)
+		return;
+
+	UINT index = timestampFrame * kTimestampSlots + a_slot;
+	a_commandList->EndQuery(timestampHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, index);
+
+	// Each end resolves its pair in the list that wrote it
+	if (a_slot == kAntiAliasingEnd || a_slot == kPresentEnd) {
+		a_commandList->ResolveQueryData(timestampHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, index - 1, 2, timestampReadback.get(), (index - 1) * sizeof(uint64_t));
+		(a_slot == kAntiAliasingEnd ? frame.antiAliasing : frame.present) = true;
+	}
+}
+
+void DX12SwapChain::CollectQueueTimings()
+{
+	if (!timestampReadback)
+		return;
+
+	uint64_t completed = d3d12Fence->GetCompletedValue();
+	for (uint32_t i = 0; i < std::size(timestampFrames); i++) {
+		auto& frame = timestampFrames[i];
+		if (!frame.pending || frame.fenceValue > completed)
+			continue;
+
+		D3D12_RANGE range{ i * kTimestampSlots * sizeof(uint64_t), (i + 1) * kTimestampSlots * sizeof(uint64_t) };
+		uint64_t* mapped = nullptr;
+		if (SUCCEEDED(timestampReadback->Map(0, &range, reinterpret_cast<void**>(&mapped)))) {
+			// NaN for a pass that did not run, QueueTimingWindow leaves it out of the average
+			const uint64_t* stamps = mapped + i * kTimestampSlots;
+			auto ms = [&](TimestampSlot a_begin, bool a_timed) {
+				if (!a_timed || !timestampFrequency || stamps[a_begin + 1] < stamps[a_begin])
+					return std::numeric_limits<double>::quiet_NaN();
+				return double(stamps[a_begin + 1] - stamps[a_begin]) * 1000.0 / double(timestampFrequency);
+			};
+			double timings[] = { ms(kPresentBegin, frame.present), ms(kAntiAliasingBegin, frame.antiAliasing) };
+			D3D12_RANGE written{ 0, 0 };
+			timestampReadback->Unmap(0, &written);
+
+			if (queueTimings.Add(timings)) {
+				auto averages = queueTimings.GetAverages();
+				auto submitted = SimulateQueueOverlap(averages);
+				std::vector<QueuePass> unchained(averages.begin(), averages.end());
+				unchained[1].waitFor = -1;
+				auto unchainedResult = SimulateQueueOverlap(unchained);
+				logger::info("[DX12SwapChain] GPU time over {} frames: present {:.2f} ms, AA {:.2f} ms; AA on a compute queue would save {:.2f} ms as submitted, at most {:.2f} ms without the wait on D3D11",
+					queueTimings.GetFrames(), averages[0].ms, averages[1].ms, submitted.GainMs(), unchainedResult.GainMs());
+			}
+		}
+		frame = {};
+	}
+}
+
+void DX12SwapChain::UpdateVramBudget()
+{
+	if (frameCounter % kVramSampleInterval)
+		return;
+
+	if (Upscaling::GetSingleton()->GetSettings().adaptiveVram)
+		vramBudget.Update();
+	else
+		vramBudget.Reset();
+}
+
+void DX12SwapChain::LogVramBudget()
+{
+	constexpr double MB = 1024.0 * 1024.0;
+	auto report = vramBudget.GetReport();
+	if (!report.valid) {
+		VramBudget::Sample sample;
+		if (!budgetProvider.Query(sample))
+			return;
+		report.sample = sample;
+		report.pluginBytes = vramBudget.PluginBytes();
+	}
+	logger::info("[DX12SwapChain] VRAM: plugin {:.1f} MB (shared textures {:.1f} MB), process {:.0f} / {:.0f} MB budget, level {}",
+		double(report.pluginBytes) / MB, double(vramBudget.CategoryBytes("Shared Resources")) / MB,
+		double(report.sample.usage) / MB, double(report.sample.budget) / MB, VramBudget::LevelName(vramBudget.GetLevel()));
+}
+
 DXGISwapChainProxy* DX12SwapChain::GetSwapChainProxy()
 {
 	return swapChainProxy;
@@ -255,7 +457,6 @@ HRESULT DX12SwapChain::Present(UINT SyncInterval, UINT Flags)
 	}
 
 	auto upscaling_ptr = Upscaling::GetSingleton();
-	(void)upscaling_ptr; // May be unused
 	frameCounter++;
 
 	// Core interop check - this is a hard requirement
@@ -271,11 +472,13 @@ HRESULT DX12SwapChain::Present(UINT SyncInterval, UINT Flags)
 	// D3D11 Signal -> D3D12 Wait
 	DX::ThrowIfFailed(d3d11Context->Signal(d3d11Fence.get(), fenceValue));
 	DX::ThrowIfFailed(commandQueue->Wait(d3d12Fence.get(), fenceValue));
+	CountCost(FrameCostRecorder::Counter::kQueueWait);
 	fenceValue++;
 
 	// Reset command list
 	DX::ThrowIfFailed(commandAllocators[frameIndex]->Reset());
 	DX::ThrowIfFailed(commandLists[frameIndex]->Reset(commandAllocators[frameIndex].get(), nullptr));
+	WriteTimestamp(commandLists[frameIndex].get(), kPresentBegin);
 
 	// Copy shared texture to swap chain buffer
 	{
@@ -287,13 +490,16 @@ HRESULT DX12SwapChain::Present(UINT SyncInterval, UINT Flags)
 			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(fakeSwapChain, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_SOURCE));
 			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(realSwapChain, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_COPY_DEST));
 			commandLists[frameIndex]->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			CountCost(FrameCostRecorder::Counter::kBarrier12);
 
 			commandLists[frameIndex]->CopyResource(realSwapChain, fakeSwapChain);
+			CountCost(FrameCostRecorder::Counter::kCopy12);
 
 			barriers.clear();
 			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(fakeSwapChain, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COMMON));
 			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(realSwapChain, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PRESENT));
 			commandLists[frameIndex]->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			CountCost(FrameCostRecorder::Counter::kBarrier12);
 		}
 	}
 
@@ -301,16 +507,30 @@ HRESULT DX12SwapChain::Present(UINT SyncInterval, UINT Flags)
 	// Our resources are created with D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS
 	// which allows D3D11 and D3D12 to access them without explicit state transitions
 
+	// Paused behind a menu: no frame generation, and the next frame reset once the game resumes. In auto
+	// mode frame generation also follows the base frame rate, which picks the ratio as well.
+	auto powerSave = upscaling_ptr->UpdatePowerSave();
+
 	// Call FSR Present
 	auto handler = FSR4SkyrimHandler::GetSingleton();
 	if (handler) {
-		handler->Present(upscaling_ptr->settings.frameGenerationMode, false);
+		if (powerSave.reset && handler->frameGenerationEnabled)
+			handler->needsReset = true;
+		bool frameGeneration = handler->frameGenerationEnabled && !powerSave.bypassFrameGeneration;
+		if (frameGeneration)
+			frameGeneration = handler->UpdateFrameGenerationPolicy();
+		handler->Present(frameGeneration, false);
 	}
 
+	// Copies this frame's inputs to a readback buffer while a capture runs; fenceValue is signalled below
+	FrameCapture::GetSingleton()->Record(d3d12Device.get(), commandLists[frameIndex].get(), fenceValue);
+
+	WriteTimestamp(commandLists[frameIndex].get(), kPresentEnd);
 	DX::ThrowIfFailed(commandLists[frameIndex]->Close());
 
 	ID3D12CommandList* commandListsToExecute[] = { commandLists[frameIndex].get() };
 	commandQueue->ExecuteCommandLists(1, commandListsToExecute);
+	CountCost(FrameCostRecorder::Counter::kExecute12);
 
 	// Present the frame
 	HRESULT hr = swapChain->Present(0, Flags);
@@ -318,11 +538,42 @@ HRESULT DX12SwapChain::Present(UINT SyncInterval, UINT Flags)
 	// D3D12 Signal -> D3D11 Wait
 	DX::ThrowIfFailed(commandQueue->Signal(d3d12Fence.get(), fenceValue));
 	DX::ThrowIfFailed(d3d11Context->Wait(d3d11Fence.get(), fenceValue));
+	CountCost(FrameCostRecorder::Counter::kQueueWait);
+
+	// This frame's timestamps are resolved by the signal above; AA ran before it, behind the D3D11 waits
+	if (auto& timestamps = timestampFrames[timestampFrame]; timestamps.present) {
+		timestamps.fenceValue = fenceValue;
+		timestamps.pending = true;
+	}
+	timestampFrame = (timestampFrame + 1) % static_cast<uint32_t>(std::size(timestampFrames));
+	if (!timestampFrames[timestampFrame].pending)
+		timestampFrames[timestampFrame] = {};
 	fenceValue++;
 
 	// Update the frame index
 	frameIndex = swapChain->GetCurrentBackBufferIndex();
 
+	EndFrameCost();
+
+	CollectQueueTimings();
+
+	UpdateVramBudget();
+
+	// Apply runtime feature toggles and VRAM downgrades; fenceValue - 1 was just signalled after all of this frame's D3D11 and D3D12 work
+	if (handler) {
+		handler->UpdateLifecycle(fenceValue - 1, d3d12Fence->GetCompletedValue());
+	}
+
+	DrainReleaseQueue();
+
+	FrameCapture::GetSingleton()->Collect(d3d12Fence->GetCompletedValue());
+
+	// End of frame on the render thread: no settings snapshot is referenced past this point
+	upscaling_ptr->settings.Quiesce();
+
+	// Menu frame rate cap; not counted as a CPU wait, nothing is waiting on the GPU
+	upscaling_ptr->ThrottlePowerSave();
+
 	return hr;
 }
 
@@ -372,7 +623,10 @@ ULONG STDMETHODCALLTYPE DXGISwapChainProxy::AddRef()
 
 ULONG STDMETHODCALLTYPE DXGISwapChainProxy::Release()
 {
-	return swapChain->Release();
+	ULONG refs = swapChain->Release();
+	if (refs == 0)
+		DX12SwapChain::GetSingleton()->Teardown();
+	return refs;
 }
 
 /****IDXGIObject****/
@@ -435,45 +689,47 @@ HRESULT STDMETHODCALLTYPE DXGISwapChainProxy::ResizeBuffers(UINT BufferCount, UI
 
 	auto dx12SwapChain = DX12SwapChain::GetSingleton();
 	auto upscaling_ptr = Upscaling::GetSingleton();
+	auto fidelityFX = FSR4SkyrimHandler::GetSingleton();
 
-	// 1. Flush D3D11 and D3D12 to ensure GPU is done with resources
-	if (dx12SwapChain->d3d11Context) {
-		dx12SwapChain->d3d11Context->Flush();
-		// Wait for all GPU work to finish
-		if (dx12SwapChain->d3d11Fence) {
-			dx12SwapChain->d3d11Context->Signal(dx12SwapChain->d3d11Fence.get(), dx12SwapChain->fenceValue);
-			while (dx12SwapChain->d3d12Fence->GetCompletedValue() < dx12SwapChain->fenceValue) {
-				SwitchToThread();
-			}
-			dx12SwapChain->fenceValue++;
-		}
+	// 1. DXGI requires every back buffer reference to be released, so the GPU must be idle
+	dx12SwapChain->WaitForGPUIdle();
+
+	// Remember what the live objects were created for, to only rebuild what no longer fits
+	ResizePlanner::Current current;
+	if (auto wrapped = dx12SwapChain->swapChainBufferWrapped) {
+		auto desc = wrapped->resource->GetDesc();
+		current.interop = { (uint32_t)desc.Width, desc.Height };
+		current.interopFormat = dx12SwapChain->swapChainDesc.Format;
+	}
+	if (upscaling_ptr->HUDLessBufferShared) {
+		auto desc = upscaling_ptr->HUDLessBufferShared->resource->GetDesc();
+		current.sharedResources = { (uint32_t)desc.Width, desc.Height };
 	}
+	current.upscaleMaxRender = { fidelityFX->upscaleMaxRenderWidth, fidelityFX->upscaleMaxRenderHeight };
+	current.frameGenDisplay = { fidelityFX->frameGenDisplayWidth, fidelityFX->frameGenDisplayHeight };
+	current.frameGenFormat = fidelityFX->frameGenBackBufferFormat;
+	// Contexts still being created on the init worker were sized for the old swap chain as well
+	if (fidelityFX->lifecycle.IsCreating(fidelityFX->upscaleFeature))
+		current.upscaleMaxRender = { fidelityFX->upscaleCreation.width, fidelityFX->upscaleCreation.height };
+	if (fidelityFX->lifecycle.IsCreating(fidelityFX->frameGenFeature)) {
+		current.frameGenDisplay = { fidelityFX->frameGenCreation.width, fidelityFX->frameGenCreation.height };
+		current.frameGenFormat = fidelityFX->frameGenCreation.format;
+	}
+	current.upscaleMaxOutput = current.upscaleMaxRender;  // Native AA
 
-	// 2. Release internal buffers that depend on SwapChain size
+	// 2. Release the real back buffers
 	for (int i = 0; i < 3; i++) {
 		dx12SwapChain->swapChainBuffers[i] = nullptr;
 	}
-	if (dx12SwapChain->swapChainBufferWrapped) {
-		delete dx12SwapChain->swapChainBufferWrapped;
-		dx12SwapChain->swapChainBufferWrapped = nullptr;
-	}
-
-	// 3. Inform Upscaling to release its resources
-	// CRITICAL: We MUST null out the shared resources so FSR doesn't try to use them with new resolution
-	upscaling_ptr->setupBuffers = false;
-	if (upscaling_ptr->HUDLessBufferShared) { delete upscaling_ptr->HUDLessBufferShared; upscaling_ptr->HUDLessBufferShared = nullptr; }
-	if (upscaling_ptr->upscaledBufferShared) { delete upscaling_ptr->upscaledBufferShared; upscaling_ptr->upscaledBufferShared = nullptr; }
-	if (upscaling_ptr->depthBufferShared) { delete upscaling_ptr->depthBufferShared; upscaling_ptr->depthBufferShared = nullptr; }
-	if (upscaling_ptr->motionVectorBufferShared) { delete upscaling_ptr->motionVectorBufferShared; upscaling_ptr->motionVectorBufferShared = nullptr; }
 
-	// 4. Call original ResizeBuffers
+	// 3. Call original ResizeBuffers
 	HRESULT hr = swapChain->ResizeBuffers(BufferCount, Width, Height, NewFormat, SwapChainFlags);
 	
 	if (SUCCEEDED(hr)) {
-		// 5. Update internal desc
+		// 4. Update internal desc
 		swapChain->GetDesc1(&dx12SwapChain->swapChainDesc);
 		
-		// 6. Re-acquire backbuffers
+		// 5. Re-acquire backbuffers
 		// BufferCount can be 0 (meaning no change), so we should use the actual count from the swapchain
 		UINT actualBufferCount = dx12SwapChain->swapChainDesc.BufferCount;
 		for (UINT i = 0; i < actualBufferCount && i < 3; i++) {
@@ -482,8 +738,33 @@ HRESULT STDMETHODCALLTYPE DXGISwapChainProxy::ResizeBuffers(UINT BufferCount, UI
 		}
 		dx12SwapChain->frameIndex = swapChain->GetCurrentBackBufferIndex();
 
-		// 7. Re-create Interop
-		dx12SwapChain->CreateInterop();
+		// 6. Rebuild only what depends on a dimension that changed
+		ResizePlanner::Target target;
+		target.display = { dx12SwapChain->swapChainDesc.Width, dx12SwapChain->swapChainDesc.Height };
+		target.format = dx12SwapChain->swapChainDesc.Format;
+		target.render = target.display;
+
+		auto plan = ResizePlanner{}.Build(current, target);
+		logger::info("[DXGISwapChainProxy] Resize to {}x{} rebuilds: {}", target.display.width, target.display.height, plan.Describe());
+
+		// The GPU is still idle, so the old contexts can be destroyed right away. The new ones are
+		// created on the init worker and used once ready. Textures go through the release queue.
+		if (plan.recreateInterop) {
+			dx12SwapChain->DeferRelease(dx12SwapChain->swapChainBufferWrapped);
+			dx12SwapChain->swapChainBufferWrapped = nullptr;
+			dx12SwapChain->CreateInterop();
+		}
+		if (plan.recreateSharedResources)
+			fidelityFX->lifecycle.RecreateNow(fidelityFX->sharedResourcesFeature);
+		if (plan.recreateUpscale)
+			fidelityFX->lifecycle.RecreateNow(fidelityFX->upscaleFeature);
+		if (plan.recreateFrameGeneration)
+			fidelityFX->lifecycle.RecreateNow(fidelityFX->frameGenFeature);
+
+		// The game sees a new image size, history from before the resize is useless
+		fidelityFX->RequestReset();
+
+		dx12SwapChain->DrainReleaseQueue();
 
 		logger::info("[DXGISwapChainProxy] ResizeBuffers successfully handled.");
 		LOG_FLUSH();
@@ -520,6 +801,36 @@ HRESULT STDMETHODCALLTYPE DXGISwapChainProxy::GetLastPresentCount(_Out_ UINT* pL
 // Used by ReplaceTAA() for synchronous AA execution
 // ============================================================================
 
+void DX12SwapChain::Teardown()
+{
+	logger::info("[DX12SwapChain] Swap chain released, freeing pooled textures");
+	swapChain = nullptr;
+
+	// Idle pooled textures go through the release queue while both devices are still alive
+	Upscaling::GetSingleton()->sharedResourcePool.Clear();
+	WaitForGPUIdle();
+	DrainReleaseQueue();
+}
+
+void DX12SwapChain::WaitForGPUIdle()
+{
+	if (!d3d11Fence || !d3d12Fence || !d3d11Context || !commandQueue)
+		return;
+
+	// D3D11 work is ordered before the D3D12 signal through the queue wait, so one value covers both
+	DX::ThrowIfFailed(d3d11Context->Signal(d3d11Fence.get(), fenceValue));
+	d3d11Context->Flush();
+	DX::ThrowIfFailed(commandQueue->Wait(d3d12Fence.get(), fenceValue));
+	fenceValue++;
+	DX::ThrowIfFailed(commandQueue->Signal(d3d12Fence.get(), fenceValue));
+
+	if (d3d12Fence->GetCompletedValue() < fenceValue) {
+		DX::ThrowIfFailed(d3d12Fence->SetEventOnCompletion(fenceValue, fenceEvent));
+		WaitForSingleObject(fenceEvent, INFINITE);
+	}
+	fenceValue++;
+}
+
 void DX12SwapChain::SignalD3D11ToD3D12()
 {
 	// D3D11 signals fence, then D3D12 waits on same fence
@@ -531,6 +842,7 @@ void DX12SwapChain::SignalD3D11ToD3D12()
 	
 	DX::ThrowIfFailed(d3d11Context->Signal(d3d11Fence.get(), fenceValue));
 	DX::ThrowIfFailed(commandQueue->Wait(d3d12Fence.get(), fenceValue));
+	CountCost(FrameCostRecorder::Counter::kQueueWait);
 	fenceValue++;
 }
 
@@ -556,5 +868,6 @@ void DX12SwapChain::WaitForD3D12Completion()
 	}
 	
 	DX::ThrowIfFailed(d3d11Context->Wait(d3d11Fence.get(), fenceValue));
+	CountCost(FrameCostRecorder::Counter::kQueueWait);
 	fenceValue++;
 }
@@ -2,10 +2,32 @@
 
 #include <d3d11_4.h>
 #include <d3d12.h>
+#include <dxgi1_4.h>
 
 #include <d3dx12.h>
+#include "Core/DeferredReleaseQueue.h"
+#include "Core/FrameCostRecorder.h"
+#include "Core/QueueOverlap.h"
+#include "Core/VramBudget.h"
 #include "WrappedResource.h"
 
+// Completed value of the fence shared between D3D11 and D3D12
+struct D3D12FenceQuery
+{
+	ID3D12Fence* fence = nullptr;
+
+	// Nothing can be in flight before the fence exists
+	uint64_t CompletedValue() const { return fence ? fence->GetCompletedValue() : UINT64_MAX; }
+};
+
+// Local (dedicated) video memory budget of the adapter the D3D12 device was created on
+struct DXGIBudgetProvider : VramBudget::Provider
+{
+	winrt::com_ptr<IDXGIAdapter3> adapter;
+
+	bool Query(VramBudget::Sample& a_sample) override;
+};
+
 struct DXGISwapChainProxy : IDXGISwapChain
 {
 public:
@@ -56,6 +78,11 @@ public:
 	winrt::com_ptr<ID3D12CommandAllocator> commandAllocators[3];
 	winrt::com_ptr<ID3D12GraphicsCommandList4> commandLists[3];
 
+	// Native AA is recorded here and runs on the direct queue. Its own allocators keep Present from
+	// resetting the allocator of an AA list the GPU may still be running.
+	winrt::com_ptr<ID3D12CommandAllocator> aaAllocators[3];
+	winrt::com_ptr<ID3D12GraphicsCommandList4> aaLists[3];
+
 	IDXGISwapChain4* swapChain;
 
 	DXGI_SWAP_CHAIN_DESC1 swapChainDesc;
@@ -84,6 +111,62 @@ public:
 
 	DXGISwapChainProxy* swapChainProxy = nullptr;
 
+	// Objects released while D3D11 or D3D12 may still use them, freed from Present once the fence passed
+	DeferredReleaseQueue<D3D12FenceQuery> releaseQueue;
+
+	// Fence value that, once completed, covers all D3D11 and D3D12 work recorded so far: the next D3D12
+	// signal is always queued behind a wait on the next D3D11 signal (fenceValue)
+	uint64_t GetReleaseFenceValue() const { return fenceValue + 1; }
+	void DeferRelease(WrappedResource* a_resource);
+	void DrainReleaseQueue();
+
+	// Plugin allocations against the adapter budget, sampled every kVramSampleInterval frames.
+	// Under pressure the level it reports downgrades the shared textures, AA and frame generation.
+	DXGIBudgetProvider budgetProvider;
+	VramBudget vramBudget;
+	static constexpr uint64_t kVramSampleInterval = 30;
+
+	uint64_t GetAllocationSize(WrappedResource* a_resource) const;
+	void TrackAllocation(WrappedResource* a_resource, const char* a_category);
+	void UpdateVramBudget();
+	void LogVramBudget();
+
+	// Copies, barriers and waits recorded per presented frame, checked against budgets once the frame
+	// is presented. Frames with AA off or while loading stay below the budgets.
+	FrameCostRecorder frameCost;
+	static void CountCost(FrameCostRecorder::Counter a_counter, uint32_t a_amount = 1) { GetSingleton()->frameCost.Add(a_counter, a_amount); }
+	void EndFrameCost();
+
+	// GPU time of the AA and present command lists from timestamp queries, read back once their frame's
+	// fence completed. Every window of frames the averages go through SimulateQueueOverlap and are logged:
+	// what moving AA to a compute queue would gain. AA waits on D3D11, which waits on the previous
+	// present, so that is nothing as submitted; the second figure is the most dropping the wait allows.
+	enum TimestampSlot : uint32_t
+	{
+		kAntiAliasingBegin,
+		kAntiAliasingEnd,
+		kPresentBegin,
+		kPresentEnd,
+		kTimestampSlots
+	};
+	struct TimestampFrame
+	{
+		uint64_t fenceValue = 0;
+		bool pending = false;       // Resolved and waiting for the fence
+		bool antiAliasing = false;  // AA was timed this frame
+		bool present = false;
+	};
+	winrt::com_ptr<ID3D12QueryHeap> timestampHeap;
+	winrt::com_ptr<ID3D12Resource> timestampReadback;
+	TimestampFrame timestampFrames[3];
+	uint32_t timestampFrame = 0;
+	uint64_t timestampFrequency = 0;
+	QueueTimingWindow queueTimings;
+
+	void CreateTimestampQueries();
+	void WriteTimestamp(ID3D12GraphicsCommandList* a_commandList, TimestampSlot a_slot);
+	void CollectQueueTimings();
+
 	void CreateD3D12Device(IDXGIAdapter* a_adapter);
 	void CreateSwapChain(IDXGIFactory4* a_dxgiFactory, DXGI_SWAP_CHAIN_DESC swapChainDesc);
 
@@ -102,4 +185,10 @@ public:
 	void SignalD3D11ToD3D12();  // D3D11 signals fence, D3D12 waits
 	void WaitForD3D12Completion();  // D3D11 waits for D3D12 fence signal
 	void SignalD3D12ToD3D11();  // D3D12 signals fence (for D3D11 wait)
+
+	// Blocks until all D3D11 and D3D12 work submitted so far has finished, sleeping on fenceEvent
+	void WaitForGPUIdle();
+
+	// The game released the last reference to the swap chain: frees what the texture pool still holds
+	void Teardown();
 };
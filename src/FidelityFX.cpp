@@ -3,8 +3,6 @@
 #include "Upscaling.h"
 #include "DX12SwapChain.h"
 #include <dx12/ffx_api_framegeneration_dx12.h>
-#include <RE/P/PlayerCamera.h>
-#include <RE/N/NiNode.h>
 
 #define LOG_FLUSH() spdlog::default_logger()->flush()
 
@@ -70,84 +68,347 @@ void FSR4SkyrimHandler::LoadFFX()
 
 void FSR4SkyrimHandler::SetupFrameGeneration()
 {
-	// Only skip if ALL contexts are already initialized
-	if (frameGenInitialized && upscaleInitialized && swapChainContextInitialized) {
-		logger::info("[FSR4SkyrimHandler] SetupFrameGeneration: All contexts already initialized, skipping.");
+	// 1. SwapChain Context is ALREADY created in DX12SwapChain::CreateSwapChain() using ForHwnd
+	// DO NOT attempt to wrap again here - it would fail with Error 0x3
+	// The swapChainContextInitialized flag is already set by DX12SwapChain
+	if (!swapChainContextInitialized) {
+		logger::warn("[FSR4SkyrimHandler] SwapChain context was not initialized by DX12SwapChain! This should not happen.");
+	}
+
+	if (!lifecycleRegistered) {
+		RegisterLifecycle();
+
+		// 2. Initialize Anti-Lag 2.0 (AMD only, will gracefully fail on non-AMD)
+		InitAntiLag(DX12SwapChain::GetSingleton()->d3d12Device.get());
+	}
+
+	// 3. Frame generation and upscale (Native AA) contexts, as enabled in the settings.
+	// Creation starts on the init worker; CreateSwapChain returns without waiting for it.
+	UpdateLifecycle(0, 0);
+}
+
+void FSR4SkyrimHandler::RegisterLifecycle()
+{
+	auto upscaling = Upscaling::GetSingleton();
+
+	frameGenFeature = lifecycle.Register("Frame Generation", {
+		[this]() { return StartFrameGenerationContext(Upscaling::GetSingleton()->GetSettings().allowAsyncWorkloads != 0); },
+		[this]() { RetireFrameGenerationContext(); },
+		[this]() { DestroyFrameGenerationContext(); },
+		[this](bool a_wait) { return FinishFrameGenerationContext(a_wait); } });
+
+	upscaleFeature = lifecycle.Register("Native AA", {
+		[this]() { return StartUpscaleContext(); },
+		[this]() { upscaleInitialized = false; },
+		[this]() { DestroyUpscaleContext(); },
+		[this](bool a_wait) { return FinishUpscaleContext(a_wait); } });
+
+	sharedResourcesFeature = lifecycle.Register("Shared Resources", {
+		[upscaling]() { upscaling->sharedResourcesEnabled = true; return true; },
+		[upscaling]() { upscaling->RetireSharedResources(); },
+		nullptr });  // Retired textures are freed by the swap chain's release queue
+
+	lifecycle.onTransition = [this](LifecycleManager::FeatureID a_id, LifecycleManager::State a_from, LifecycleManager::State a_to) {
+		logger::info("[FSR4SkyrimHandler] {}: {} -> {}", lifecycle.GetName(a_id), LifecycleManager::StateName(a_from), LifecycleManager::StateName(a_to));
+	};
+
+	lifecycleRegistered = true;
+}
+
+void FSR4SkyrimHandler::UpdateLifecycle(uint64_t a_submittedFence, uint64_t a_completedFence)
+{
+	if (!lifecycleRegistered)
+		return;
+
+	auto upscaling = Upscaling::GetSingleton();
+	const auto& settings = upscaling->GetSettings();
+
+	// Under VRAM pressure features are dropped in order: compact formats, AA output, frame generation
+	auto level = DX12SwapChain::GetSingleton()->vramBudget.GetLevel();
+	bool compactFormats = level >= VramBudget::Level::kCompactFormats;
+	bool antiAliasing = settings.antiAliasing != 0 && level < VramBudget::Level::kNoUpscaledBuffer;
+	// Auto mode keeps the context alive and switches per frame in UpdateFrameGenerationPolicy
+	bool frameGeneration = settings.frameGenerationMode != 0 && level < VramBudget::Level::kNoFrameGeneration;
+	frameGenerationEnabled = frameGeneration;
+	antiAliasingEnabled = antiAliasing;
+
+	// Both off is the memory saving state: only the swap chain context and the proxy remain
+	lifecycle.SetDesired(frameGenFeature, frameGeneration);
+	lifecycle.SetDesired(upscaleFeature, antiAliasing);
+	lifecycle.SetDesired(sharedResourcesFeature, frameGeneration || antiAliasing);
+
+	// The async workload flag is fixed at context creation
+	if (frameGenInitialized && frameGenAsyncWorkloads != (settings.allowAsyncWorkloads != 0))
+		lifecycle.RequestRecreate(frameGenFeature);
+
+	lifecycle.Tick(a_submittedFence, a_completedFence);
+
+	upscaling->UpdateSharedResourceLayout(antiAliasing, compactFormats);
+
+	// Keep the game's TAA until the FSR AA context is live again
+	upscaling->skipTaaEnabled = antiAliasing && upscaleInitialized;
+
+	UpdateStartupTiming();
+}
+
+void FSR4SkyrimHandler::UpdateStartupTiming()
+{
+	// Starts counting once CreateSwapChain returned to the game
+	if (startupTiming.reported || startupTiming.mainThreadMs == 0.0)
+		return;
+
+	if (lifecycle.IsCreating(frameGenFeature) || lifecycle.IsCreating(upscaleFeature)) {
+		startupTiming.passthroughFrames++;
 		return;
 	}
 
+	startupTiming.reported = true;
+	logger::info("[FSR4SkyrimHandler] Startup: CreateSwapChain blocked the game for {:.1f} ms, {:.1f} ms of context creation ran off-thread, {} frames passed through meanwhile",
+		startupTiming.mainThreadMs, startupTiming.offThreadMs, startupTiming.passthroughFrames);
+}
+
+bool FSR4SkyrimHandler::UpdateFrameGenerationPolicy()
+{
+	auto upscaling = Upscaling::GetSingleton();
+	const auto& settings = upscaling->GetSettings();
+
+	LARGE_INTEGER qpf, now;
+	QueryPerformanceFrequency(&qpf);
+	QueryPerformanceCounter(&now);
+	double time = double(now.QuadPart) / double(qpf.QuadPart);
+	float refreshRate = float(upscaling->refreshRate);
+
+	// Real frames only: a gap (menus, VRAM downgrade) makes the first interval a hitch, which is ignored
+	float frameMs = lastBaseFrameQPC ? float(double(now.QuadPart - lastBaseFrameQPC) * 1000.0 / double(qpf.QuadPart)) : 0.0f;
+	lastBaseFrameQPC = now.QuadPart;
+
+	// Auto mode starts from frame generation off, whatever the policy measured before
+	bool automatic = settings.frameGenerationMode == 2;
+	if (automatic && !adaptiveActive)
+		adaptiveFrameGeneration.Reset();
+	adaptiveActive = automatic;
+
+	bool previous = adaptiveFrameGeneration.GetLast().enabled;
+	auto decision = adaptiveFrameGeneration.Update(frameMs, refreshRate, time);
+	if (automatic && decision.changed)
+		logger::info("[FSR4SkyrimHandler] Adaptive frame generation: {} -> {} ({}, {:.1f} fps base)", previous ? "on" : "off", decision.enabled ? "on" : "off",
+			AdaptiveFrameGeneration::ReasonName(decision.reason), decision.baseFps);
+
+	// The interpolation history is from before frame generation stopped
+	if (automatic && decision.reset)
+		needsReset = true;
+
+	if (settings.frameGenerationRatio > kSupportedGeneratedFrames && !ratioClampLogged) {
+		logger::info("[FSR4SkyrimHandler] Frame generation ratio {}x is not supported by the FidelityFX SDK, using {}x", settings.frameGenerationRatio + 1, kSupportedGeneratedFrames + 1);
+		ratioClampLogged = true;
+	}
+
+	uint32_t previousRatio = frameGenerationRatio.GetGeneratedFrames();
+	uint32_t ratio = frameGenerationRatio.Update(settings.frameGenerationRatio, kSupportedGeneratedFrames, decision.baseFps, refreshRate, time);
+	if (ratio != previousRatio)
+		logger::info("[FSR4SkyrimHandler] Frame generation ratio: {}x -> {}x ({:.1f} fps base, {:.0f} Hz)", previousRatio + 1, ratio + 1, decision.baseFps, refreshRate);
+
+	return !automatic || decision.enabled;
+}
+
+LifecycleManager::Progress FSR4SkyrimHandler::PollContextCreation(ContextCreation& a_creation, bool a_wait)
+{
+	if (!a_creation.job)
+		return LifecycleManager::Progress::kFailed;
+	if (a_wait && !a_creation.job->IsFinished()) {
+		DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCpuWait);
+		a_creation.job->Wait();
+	}
+	if (!a_creation.job->IsFinished())
+		return LifecycleManager::Progress::kPending;
+
+	auto job = std::move(a_creation.job);
+	logger::info("[FSR4SkyrimHandler] {} context: {:.1f} ms on the init worker (queued {:.1f} ms)", job->GetName(), job->RunMs(), job->QueuedMs());
+	if (!startupTiming.reported)
+		startupTiming.offThreadMs += job->RunMs();
+
+	return job->GetStatus() == BackgroundWorker::Status::kSucceeded ? LifecycleManager::Progress::kDone : LifecycleManager::Progress::kFailed;
+}
+
+bool FSR4SkyrimHandler::StartFrameGenerationContext(bool a_allowAsyncWorkloads)
+{
+	auto swapChain = DX12SwapChain::GetSingleton();
+
+	// The swap chain may be resized while the worker runs, so it only sees this copy
+	frameGenCreation.context = nullptr;
+	frameGenCreation.width = swapChain->swapChainDesc.Width;
+	frameGenCreation.height = swapChain->swapChainDesc.Height;
+	frameGenCreation.format = swapChain->swapChainDesc.Format;
+	frameGenCreation.asyncWorkloads = a_allowAsyncWorkloads;
+	frameGenCreation.job = initWorker.Submit("Frame generation", [this]() { return CreateFrameGenerationContext(frameGenCreation); });
+	return true;
+}
+
+bool FSR4SkyrimHandler::CreateFrameGenerationContext(ContextCreation& a_creation)
+{
 	auto swapChain = DX12SwapChain::GetSingleton();
 
-	// 1. Create Backend
 	ffxCreateBackendDX12Desc backendDesc{};
 	backendDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_BACKEND_DX12;
 	backendDesc.device = swapChain->d3d12Device.get();
 
-	// 2. SwapChain Context is ALREADY created in DX12SwapChain::CreateSwapChain() using ForHwnd
-	// DO NOT attempt to wrap again here - it would fail with Error 0x3
-	// The swapChainContextInitialized flag is already set by DX12SwapChain
-	if (!swapChainContextInitialized) {
-		logger::warn("[FSR4SkyrimHandler] SwapChain context was not initialized by DX12SwapChain! This should not happen.");
+	ffx::CreateContextDescFrameGeneration createFg{};
+	createFg.displaySize = { a_creation.width, a_creation.height };
+	createFg.maxRenderSize = createFg.displaySize;
+	// Following ENBFrameGeneration: Only use ASYNC_WORKLOAD_SUPPORT
+	// Other flags may cause issues with FSR 4.0
+	createFg.flags = a_creation.asyncWorkloads ? FFX_FRAMEGENERATION_ENABLE_ASYNC_WORKLOAD_SUPPORT : 0;
+	createFg.backBufferFormat = ffxApiGetSurfaceFormatDX12(a_creation.format);
+
+	// FSR 4.0 Version Descriptor
+	ffxCreateContextDescFrameGenerationVersion versionDesc{};
+	versionDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_FRAMEGENERATION_VERSION;
+	versionDesc.version = FFX_FRAMEGENERATION_VERSION;
+
+	// Link headers manually
+	createFg.header.pNext = &versionDesc.header;
+	versionDesc.header.pNext = &backendDesc.header;
+
+	logger::info("[FSR4SkyrimHandler] Attempting to create frame generation context (async workloads: {})...", a_creation.asyncWorkloads);
+	auto ret = ffxCreateContext(&a_creation.context, &createFg.header, nullptr);
+	if (ret != FFX_API_RETURN_OK) {
+		logger::critical("[FSR4SkyrimHandler] Failed to create frame generation context! Error code: 0x{:X}", (uint32_t)ret);
+		a_creation.context = nullptr;
+		return false;
 	}
 
-	// 3. Setup Frame Generation Context
-	{
-		ffx::CreateContextDescFrameGeneration createFg{};
-		createFg.displaySize = { swapChain->swapChainDesc.Width, swapChain->swapChainDesc.Height };
-		createFg.maxRenderSize = createFg.displaySize;
-		// Following ENBFrameGeneration: Only use ASYNC_WORKLOAD_SUPPORT
-		// Other flags may cause issues with FSR 4.0
-		createFg.flags = FFX_FRAMEGENERATION_ENABLE_ASYNC_WORKLOAD_SUPPORT;
-		createFg.backBufferFormat = ffxApiGetSurfaceFormatDX12(swapChain->swapChainDesc.Format);
-
-		// FSR 4.0 Version Descriptor
-		ffxCreateContextDescFrameGenerationVersion versionDesc{};
-		versionDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_FRAMEGENERATION_VERSION;
-		versionDesc.version = FFX_FRAMEGENERATION_VERSION;
-
-		// Link headers manually
-		createFg.header.pNext = &versionDesc.header;
-		versionDesc.header.pNext = &backendDesc.header;
-
-		logger::info("[FSR4SkyrimHandler] Attempting to create frame generation context...");
-		auto ret = ffxCreateContext(&frameGenContext, &createFg.header, nullptr);
-		if (ret != FFX_API_RETURN_OK) {
-			logger::critical("[FSR4SkyrimHandler] Failed to create frame generation context! Error code: 0x{:X}", (uint32_t)ret);
-		} else {
-			logger::info("[FSR4SkyrimHandler] Successfully created frame generation context.");
-			frameGenInitialized = true;
-		}
+	// Reported by the SDK; the game keeps allocating while the worker runs, so a process-wide delta is noise
+	FfxApiEffectMemoryUsage memoryUsage{};
+	ffxQueryDescFrameGenerationGetGPUMemoryUsage memoryQuery{};
+	memoryQuery.header.type = FFX_API_QUERY_DESC_TYPE_FRAMEGENERATION_GET_GPU_MEMORY_USAGE;
+	memoryQuery.gpuMemoryUsageFrameGeneration = &memoryUsage;
+	a_creation.bytes = ffxQuery(&a_creation.context, &memoryQuery.header) == FFX_API_RETURN_OK ? memoryUsage.totalUsageInBytes : 0;
+	logger::info("[FSR4SkyrimHandler] Successfully created frame generation context ({:.1f} MB).", double(a_creation.bytes) / (1024.0 * 1024.0));
+	return true;
+}
+
+LifecycleManager::Progress FSR4SkyrimHandler::FinishFrameGenerationContext(bool a_wait)
+{
+	auto progress = PollContextCreation(frameGenCreation, a_wait);
+	if (progress != LifecycleManager::Progress::kDone)
+		return progress;
+
+	// Publish on the render thread
+	frameGenContext = frameGenCreation.context;
+	frameGenCreation.context = nullptr;
+	DX12SwapChain::GetSingleton()->vramBudget.Track(&frameGenContext, "FFX Frame Generation", frameGenCreation.bytes);
+	frameGenAsyncWorkloads = frameGenCreation.asyncWorkloads;
+	frameGenDisplayWidth = frameGenCreation.width;
+	frameGenDisplayHeight = frameGenCreation.height;
+	frameGenBackBufferFormat = frameGenCreation.format;
+	frameGenInitialized = true;
+	// New context has no history
+	needsReset = true;
+	return progress;
+}
+
+void FSR4SkyrimHandler::RetireFrameGenerationContext()
+{
+	// Stop the swap chain from interpolating; frames already queued may still call back into the
+	// context, so it is only destroyed once the lifecycle manager saw the GPU pass this point
+	if (frameGenContext) {
+		ffxConfigureDescFrameGeneration configParameters{};
+		configParameters.header.type = FFX_API_CONFIGURE_DESC_TYPE_FRAMEGENERATION;
+		configParameters.swapChain = DX12SwapChain::GetSingleton()->swapChain;
+		configParameters.frameGenerationEnabled = false;
+		configParameters.frameID = currentFSRFrameID;
+		ffxConfigure(&frameGenContext, &configParameters.header);
 	}
-	
-	// 4. Initialize Anti-Lag 2.0 (AMD only, will gracefully fail on non-AMD)
-	InitAntiLag(swapChain->d3d12Device.get());
-
-	// 4. Setup Upscale Context for Native AA
-	{
-		ffx::CreateContextDescUpscale createUpscale{};
-		createUpscale.flags = FFX_UPSCALE_ENABLE_HIGH_DYNAMIC_RANGE | 
-							  FFX_UPSCALE_ENABLE_DISPLAY_RESOLUTION_MOTION_VECTORS |
-							  FFX_UPSCALE_ENABLE_MOTION_VECTORS_JITTER_CANCELLATION |
-							  FFX_UPSCALE_ENABLE_DEPTH_INVERTED |
-							  FFX_UPSCALE_ENABLE_DEPTH_INFINITE;
-		createUpscale.maxRenderSize = { swapChain->swapChainDesc.Width, swapChain->swapChainDesc.Height };
-		createUpscale.maxUpscaleSize = createUpscale.maxRenderSize;
-
-		ffxCreateContextDescUpscaleVersion upscaleVersionDesc{};
-		upscaleVersionDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_UPSCALE_VERSION;
-		upscaleVersionDesc.version = FFX_UPSCALER_VERSION;
-
-		createUpscale.header.pNext = &upscaleVersionDesc.header;
-		upscaleVersionDesc.header.pNext = &backendDesc.header;
-
-		logger::info("[FSR4SkyrimHandler] Attempting to create upscale context (Native AA)...");
-		auto ret = ffxCreateContext(&upscaleContext, &createUpscale.header, nullptr);
-		if (ret != FFX_API_RETURN_OK) {
-			logger::critical("[FSR4SkyrimHandler] Failed to create upscale context! Error code: 0x{:X}", (uint32_t)ret);
-		} else {
-			logger::info("[FSR4SkyrimHandler] Successfully created upscale context.");
-			upscaleInitialized = true;
-		}
+	frameGenInitialized = false;
+}
+
+void FSR4SkyrimHandler::DestroyFrameGenerationContext()
+{
+	if (frameGenContext) {
+		ffxDestroyContext(&frameGenContext, nullptr);
+		frameGenContext = nullptr;
+		DX12SwapChain::GetSingleton()->vramBudget.Untrack(&frameGenContext);
+		frameGenDisplayWidth = frameGenDisplayHeight = 0;
+		logger::info("[FSR4SkyrimHandler] Frame generation context destroyed.");
+	}
+}
+
+bool FSR4SkyrimHandler::StartUpscaleContext()
+{
+	auto swapChain = DX12SwapChain::GetSingleton();
+
+	upscaleCreation.context = nullptr;
+	upscaleCreation.width = swapChain->swapChainDesc.Width;
+	upscaleCreation.height = swapChain->swapChainDesc.Height;
+	upscaleCreation.job = initWorker.Submit("Upscale", [this]() { return CreateUpscaleContext(upscaleCreation); });
+	return true;
+}
+
+bool FSR4SkyrimHandler::CreateUpscaleContext(ContextCreation& a_creation)
+{
+	auto swapChain = DX12SwapChain::GetSingleton();
+
+	ffxCreateBackendDX12Desc backendDesc{};
+	backendDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_BACKEND_DX12;
+	backendDesc.device = swapChain->d3d12Device.get();
+
+	ffx::CreateContextDescUpscale createUpscale{};
+	createUpscale.flags = FFX_UPSCALE_ENABLE_HIGH_DYNAMIC_RANGE | 
+						  FFX_UPSCALE_ENABLE_DISPLAY_RESOLUTION_MOTION_VECTORS |
+						  FFX_UPSCALE_ENABLE_MOTION_VECTORS_JITTER_CANCELLATION |
+						  FFX_UPSCALE_ENABLE_DEPTH_INVERTED |
+						  FFX_UPSCALE_ENABLE_DEPTH_INFINITE;
+	createUpscale.maxRenderSize = { a_creation.width, a_creation.height };
+	createUpscale.maxUpscaleSize = createUpscale.maxRenderSize;
+
+	ffxCreateContextDescUpscaleVersion upscaleVersionDesc{};
+	upscaleVersionDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_UPSCALE_VERSION;
+	upscaleVersionDesc.version = FFX_UPSCALER_VERSION;
+
+	createUpscale.header.pNext = &upscaleVersionDesc.header;
+	upscaleVersionDesc.header.pNext = &backendDesc.header;
+
+	logger::info("[FSR4SkyrimHandler] Attempting to create upscale context (Native AA)...");
+	auto ret = ffxCreateContext(&a_creation.context, &createUpscale.header, nullptr);
+	if (ret != FFX_API_RETURN_OK) {
+		logger::critical("[FSR4SkyrimHandler] Failed to create upscale context! Error code: 0x{:X}", (uint32_t)ret);
+		a_creation.context = nullptr;
+		return false;
+	}
+
+	FfxApiEffectMemoryUsage memoryUsage{};
+	ffxQueryDescUpscaleGetGPUMemoryUsage memoryQuery{};
+	memoryQuery.header.type = FFX_API_QUERY_DESC_TYPE_UPSCALE_GPU_MEMORY_USAGE;
+	memoryQuery.gpuMemoryUsageUpscaler = &memoryUsage;
+	a_creation.bytes = ffxQuery(&a_creation.context, &memoryQuery.header) == FFX_API_RETURN_OK ? memoryUsage.totalUsageInBytes : 0;
+	logger::info("[FSR4SkyrimHandler] Successfully created upscale context ({:.1f} MB).", double(a_creation.bytes) / (1024.0 * 1024.0));
+	return true;
+}
+
+LifecycleManager::Progress FSR4SkyrimHandler::FinishUpscaleContext(bool a_wait)
+{
+	auto progress = PollContextCreation(upscaleCreation, a_wait);
+	if (progress != LifecycleManager::Progress::kDone)
+		return progress;
+
+	upscaleContext = upscaleCreation.context;
+	upscaleCreation.context = nullptr;
+	DX12SwapChain::GetSingleton()->vramBudget.Track(&upscaleContext, "FFX Upscale", upscaleCreation.bytes);
+	upscaleMaxRenderWidth = upscaleCreation.width;
+	upscaleMaxRenderHeight = upscaleCreation.height;
+	upscaleInitialized = true;
+	needsReset = true;
+	return progress;
+}
+
+void FSR4SkyrimHandler::DestroyUpscaleContext()
+{
+	if (upscaleContext) {
+		ffxDestroyContext(&upscaleContext, nullptr);
+		upscaleContext = nullptr;
+		DX12SwapChain::GetSingleton()->vramBudget.Untrack(&upscaleContext);
+		upscaleMaxRenderWidth = upscaleMaxRenderHeight = 0;
+		logger::info("[FSR4SkyrimHandler] Upscale context destroyed.");
 	}
 }
 
@@ -216,9 +477,6 @@ float GetVerticalFOVRad()
 
 static ffxReturnCode_t FrameGenerationCallback(ffxDispatchDescFrameGeneration* params, void* pUserCtx)
 {
-	static uint64_t callCount = 0;
-	callCount++;
-	
 	uint32_t numGenBefore = params->numGeneratedFrames;
 	
 	// Check if callback context is valid
@@ -228,9 +486,11 @@ static ffxReturnCode_t FrameGenerationCallback(ffxDispatchDescFrameGeneration* p
 	}
 	
 	// Anti-Lag 2.0: Indicate if this is an interpolated frame BEFORE Present
-	// numGeneratedFrames > 0 means FSR is generating interpolated frames
+	// numGeneratedFrames > 0 means FSR is generating interpolated frames, one or several per real frame
+	auto handler = FSR4SkyrimHandler::GetSingleton();
 	bool isInterpolatedFrame = (params->numGeneratedFrames > 0);
-	FSR4SkyrimHandler::GetSingleton()->SetFrameType(isInterpolatedFrame);
+	handler->SetFrameType(isInterpolatedFrame);
+	handler->presentedGeneratedFrames.store(params->numGeneratedFrames, std::memory_order_relaxed);
 	
 	// FSR 4.0: Match ENBFrameGeneration's minimal callback - let FSR handle pacing internally
 	// DO NOT modify params->numGeneratedFrames - it breaks FSR's frame pacing!
@@ -238,17 +498,11 @@ static ffxReturnCode_t FrameGenerationCallback(ffxDispatchDescFrameGeneration* p
 	
 	uint32_t numGenAfter = params->numGeneratedFrames;
 	// Only warn if interpolation fails repeatedly
-	if (numGenAfter == 0 && numGenBefore > 0) {
-		static uint64_t zeroGenCount = 0;
-		zeroGenCount++;
-		if (zeroGenCount <= 5 || zeroGenCount % 300 == 0) {
-			logger::warn("[FG_Callback] Frame NOT interpolated! (count={})", zeroGenCount);
-		}
-	}
+	if (numGenAfter == 0 && numGenBefore > 0)
+		LOG_RATE_LIMITED(warn, 5, 10s, "[FG_Callback] Frame NOT interpolated!");
 	
-	if (result != FFX_API_RETURN_OK && callCount % 100 == 0) {
-		logger::error("[FG_Callback] ffxDispatch failed! Error: 0x{:X}", (uint32_t)result);
-	}
+	if (result != FFX_API_RETURN_OK)
+		LOG_RATE_LIMITED(err, 1, 5s, "[FG_Callback] ffxDispatch failed! Error: 0x{:X}", (uint32_t)result);
 	return result;
 }
 
@@ -267,29 +521,18 @@ void FSR4SkyrimHandler::Present(bool a_useFrameGeneration, bool a_bypass)
 	auto commandList = swapChain->commandLists[swapChain->frameIndex].get();
 
 	bool shouldLog = false; // Release: Only log errors
-	static uint64_t lastLoggedFrameID = 0;
-	lastLoggedFrameID = frameID;
 
-	// Get StateEx for reading projectionPosScaleX/Y (jitter)
-	auto state = RE::BSGraphics::State::GetSingleton();
-	auto stateEx = state ? reinterpret_cast<StateEx*>(state) : nullptr;
-
-	// Use game's deltaTime like ENBFrameGeneration for consistency
-	static auto s_deltaTime = (float*)REL::RelocationID(523660, 410199).address();
-	float manualDeltaTime = s_deltaTime ? (*s_deltaTime * 1000.0f) : 16.6f;
-	
-	// ENBFrameGeneration does NOT clamp deltaTime - follow the same approach
-	// Invalid deltaTime (<=0 or extremely large) indicates game pause/loading
-	// In these states, FG should still run but FSR will handle it gracefully
-	// Only apply minimal sanity check to prevent division by zero issues
-	if (manualDeltaTime <= 0.0f) manualDeltaTime = 16.6f; // Default to 60fps if invalid
+	// deltaTime, near/far, FOV, jitter and size were captured once for this frame in UpdateJitter
+	auto frame = upscaling->GetFrameContext();
+	float manualDeltaTime = frame.deltaTimeMs;
 
 	auto HUDLessColor = (upscaling->HUDLessBufferShared) ? upscaling->HUDLessBufferShared->resource.get() : nullptr;
 	auto depth = (upscaling->depthBufferShared) ? upscaling->depthBufferShared->resource.get() : nullptr;
 	auto motionVectors = (upscaling->motionVectorBufferShared) ? upscaling->motionVectorBufferShared->resource.get() : nullptr;
 	auto upscaledColor = (upscaling->upscaledBufferShared) ? upscaling->upscaledBufferShared->resource.get() : nullptr;
 
-	bool resourcesReady = HUDLessColor && depth && motionVectors && upscaledColor;
+	// upscaledColor only exists while AA is enabled, FG falls back to HUDLess without it
+	bool resourcesReady = HUDLessColor && depth && motionVectors;
 
 	if (!commandList) {
 		currentFSRFrameID++;
@@ -306,11 +549,16 @@ void FSR4SkyrimHandler::Present(bool a_useFrameGeneration, bool a_bypass)
 		logger::info("[FSR4] Frame {}: FG={}, dt={:.1f}ms", frameID, a_useFrameGeneration, manualDeltaTime);
 	}
 
+	bool generating = a_useFrameGeneration && !frame.staticFrame && frameGenInitialized;
+	generatedFrames = generating ? frameGenerationRatio.GetGeneratedFrames() : 0;
+
 	// 1. Configure Pacing
 	if (swapChainContextInitialized) {
 		// varianceFactor: 0.1 (default) is tight, 0.3-0.5 is more forgiving for unstable frame times
 		// Skyrim with mods has highly variable frame times (22-52ms observed), so use higher variance
-		FfxApiSwapchainFramePacingTuning framePacingTuning{ 0.1f, 0.3f, true, 2, false };
+		// With several generated frames the presents are closer together, so spin for a shorter time
+		uint32_t hybridSpinTime = generatedFrames > 1 ? 1 : 2;
+		FfxApiSwapchainFramePacingTuning framePacingTuning{ 0.1f, 0.3f, true, hybridSpinTime, false };
 		ffxConfigureDescFrameGenerationSwapChainKeyValueDX12 tuning{};
 		tuning.header.type = FFX_API_CONFIGURE_DESC_TYPE_FRAMEGENERATIONSWAPCHAIN_KEYVALUE_DX12;
 		tuning.key = FFX_API_CONFIGURE_FG_SWAPCHAIN_KEY_FRAMEPACINGTUNING;
@@ -319,7 +567,11 @@ void FSR4SkyrimHandler::Present(bool a_useFrameGeneration, bool a_bypass)
 	}
 
 	// Handle FG disabled case - must still configure to disable FG
-	if (!a_useFrameGeneration && frameGenInitialized) {
+	// Static frames do the same: interpolating between identical frames only costs the prepare
+	if ((!a_useFrameGeneration || frame.staticFrame) && frameGenInitialized) {
+		if (a_useFrameGeneration)
+			resumeAfterStaticFrames = true;
+		presentedGeneratedFrames.store(0, std::memory_order_relaxed);  // The present callback stops running
 		ffxConfigureDescFrameGeneration configParameters{};
 		memset(&configParameters, 0, sizeof(configParameters));
 		configParameters.header.type = FFX_API_CONFIGURE_DESC_TYPE_FRAMEGENERATION;
@@ -337,25 +589,12 @@ void FSR4SkyrimHandler::Present(bool a_useFrameGeneration, bool a_bypass)
 	// Following ENBFrameGeneration: Dispatch PrepareV2 when user enables FG, regardless of resource availability
 	// FSR handles null resources gracefully
 	if (a_useFrameGeneration && frameGenInitialized) {
-		// Use static memory addresses like ENBFrameGeneration for stability during loading
-		static auto s_cameraNear = (float*)(REL::RelocationID(517032, 403540).address() + 0x40);
-		static auto s_cameraFar = (float*)(REL::RelocationID(517032, 403540).address() + 0x44);
-		float cameraNearVal = s_cameraNear ? *s_cameraNear : 0.1f;
-		float cameraFarVal = s_cameraFar ? *s_cameraFar : 100000.0f;
-		
-		// Safety clamp
-		if (cameraNearVal <= 0.0f) cameraNearVal = 0.1f;
-		if (cameraFarVal <= cameraNearVal) cameraFarVal = 100000.0f;
-
 		// NOTE: AA is now executed synchronously in ReplaceTAA() via DispatchAASync()
 		// The upscaledColor buffer already contains the AA result when we reach here.
 		// skipTaaEnabled controls whether AA runs in ReplaceTAA.
 		bool aaWasExecutedInTAA = upscaling->skipTaaEnabled && upscaleInitialized && 
 		                          upscaledColor && resourcesReady;
 		
-		static uint64_t aaLogCounter = 0;
-		(void)aaLogCounter++; // Keep counter for potential debugging
-		
 		// ========================================================================
 		// STEP 2: AA is now executed in ReplaceTAA() - NO AA dispatch here!
 		// This ensures AA result is available BEFORE FG Configure
@@ -384,28 +623,24 @@ void FSR4SkyrimHandler::Present(bool a_useFrameGeneration, bool a_bypass)
 			
 			configParameters.frameID = frameID;
 			configParameters.onlyPresentGenerated = false;
-			configParameters.allowAsyncWorkloads = true;
+			configParameters.allowAsyncWorkloads = frameGenAsyncWorkloads;
 			configParameters.flags = 0;
 			configParameters.generationRect.left = 0;
 			configParameters.generationRect.top = 0;
-			configParameters.generationRect.width = swapChain->swapChainDesc.Width;
-			configParameters.generationRect.height = swapChain->swapChainDesc.Height;
+			configParameters.generationRect.width = frame.width;
+			configParameters.generationRect.height = frame.height;
 			
 			auto configResult = ffxConfigure(&frameGenContext, &configParameters.header);
 			if (configResult != FFX_API_RETURN_OK) {
 				logger::error("[FidelityFX] Failed to configure frame generation! Error: 0x{:X}", (uint32_t)configResult);
 			}
 			
-			// DIAGNOSTIC: Log Configure details every 300 frames
-			static uint64_t lastConfigLogFrame = 0;
-			if (frameID - lastConfigLogFrame >= 300) {
-				lastConfigLogFrame = frameID;
-				logger::info("[FidelityFX] Configure: swapChain={:p}, enabled={}, HUDLess={:p}, aaWasExecutedInTAA={}",
-					(void*)configParameters.swapChain,
-					configParameters.frameGenerationEnabled,
-					configParameters.HUDLessColor.resource,
-					aaWasExecutedInTAA);
-			}
+			// DIAGNOSTIC: Log Configure details whenever they change
+			LOG_DEDUPLICATED(info, "[FidelityFX] Configure: swapChain={:p}, enabled={}, HUDLess={:p}, aaWasExecutedInTAA={}",
+				(void*)configParameters.swapChain,
+				configParameters.frameGenerationEnabled,
+				configParameters.HUDLessColor.resource,
+				aaWasExecutedInTAA);
 		}
 
 		// ========================================================================
@@ -415,79 +650,46 @@ void FSR4SkyrimHandler::Present(bool a_useFrameGeneration, bool a_bypass)
 		memset(&prepare, 0, sizeof(prepare));
 		prepare.header.type = FFX_API_DISPATCH_DESC_TYPE_FRAMEGENERATION_PREPARE_V2;
 		prepare.commandList = commandList;
-		prepare.renderSize.width = swapChain->swapChainDesc.Width;
-		prepare.renderSize.height = swapChain->swapChainDesc.Height;
-		// Read jitter from projectionPosScaleX/Y like ENBFrameGeneration does
-		// This is the value that was written by UpdateJitter at frame start
-		if (stateEx) {
-			prepare.jitterOffset.x = stateEx->projectionPosScaleX * (float)swapChain->swapChainDesc.Width / 2.0f;
-			prepare.jitterOffset.y = stateEx->projectionPosScaleY * (float)swapChain->swapChainDesc.Height / 2.0f;
-		} else {
-			prepare.jitterOffset.x = 0.0f;
-			prepare.jitterOffset.y = 0.0f;
-		}
-		prepare.frameTimeDelta = manualDeltaTime;
+		prepare.renderSize.width = frame.width;
+		prepare.renderSize.height = frame.height;
+		prepare.jitterOffset.x = frame.jitterX;
+		prepare.jitterOffset.y = frame.jitterY;
+		prepare.frameTimeDelta = frame.deltaTimeMs;
 		prepare.frameID = frameID;
 		// Match ENBFrameGeneration: flags = 0 for production
 		prepare.flags = 0;
 		prepare.depth = ffxApiGetResourceDX12(depth);
 		prepare.motionVectors = ffxApiGetResourceDX12(motionVectors);
-		prepare.motionVectorScale.x = (float)swapChain->swapChainDesc.Width;
-		prepare.motionVectorScale.y = (float)swapChain->swapChainDesc.Height;
-		prepare.cameraNear = cameraNearVal;
-		prepare.cameraFar = cameraFarVal;
-		prepare.cameraFovAngleVertical = GetVerticalFOVRad();
+		prepare.motionVectorScale.x = (float)frame.width;
+		prepare.motionVectorScale.y = (float)frame.height;
+		prepare.cameraNear = frame.cameraNear;
+		prepare.cameraFar = frame.cameraFar;
+		prepare.cameraFovAngleVertical = frame.fovVerticalRad;
 		prepare.viewSpaceToMetersFactor = 0.01428222656f;
 		
-		// Reset flag: true on first few frames OR when RequestReset() was called (scene transitions)
-		prepare.reset = needsReset || (frameID < 5);
+		// Reset flag: true on first few frames, when RequestReset() was called or when the
+		// SceneCutDetector flagged this frame (fast travel, kill-cams, cell loads, camera snaps),
+		// and on the first prepare after static frames, whose history is several frames old
+		prepare.reset = needsReset || frame.sceneCut || resumeAfterStaticFrames || (frameID < 5);
 		if (needsReset) {
 			logger::info("[FSR4SkyrimHandler] Reset triggered at frame {}", frameID);
 			needsReset = false;  // Clear after use
 		}
-
-		// FSR 4.0 requires camera vectors - provide safe defaults if camera unavailable
-		// Default: Identity orientation looking forward (+Y in Skyrim), positioned at origin
-		prepare.cameraPosition[0] = 0.0f; prepare.cameraPosition[1] = 0.0f; prepare.cameraPosition[2] = 0.0f;
-		prepare.cameraRight[0] = 1.0f; prepare.cameraRight[1] = 0.0f; prepare.cameraRight[2] = 0.0f;
-		prepare.cameraForward[0] = 0.0f; prepare.cameraForward[1] = 1.0f; prepare.cameraForward[2] = 0.0f;
-		prepare.cameraUp[0] = 0.0f; prepare.cameraUp[1] = 0.0f; prepare.cameraUp[2] = 1.0f;
-
-		// Try to get actual camera data if available
-		// Using multiple null checks to avoid accessing invalid memory during loading
-		// Also detect large camera jumps to auto-trigger reset (fast travel, load game, etc.)
-		static float lastCameraPos[3] = {0.0f, 0.0f, 0.0f};
-		auto camera = RE::PlayerCamera::GetSingleton();
-		if (camera) {
-			auto cameraRoot = camera->cameraRoot.get();
-			if (cameraRoot) {
-				auto& world = cameraRoot->world;
-				prepare.cameraPosition[0] = world.translate.x;
-				prepare.cameraPosition[1] = world.translate.y;
-				prepare.cameraPosition[2] = world.translate.z;
-				prepare.cameraRight[0] = world.rotate.entry[0][0]; prepare.cameraRight[1] = world.rotate.entry[1][0]; prepare.cameraRight[2] = world.rotate.entry[2][0];
-				prepare.cameraForward[0] = world.rotate.entry[0][1]; prepare.cameraForward[1] = world.rotate.entry[1][1]; prepare.cameraForward[2] = world.rotate.entry[2][1];
-				prepare.cameraUp[0] = world.rotate.entry[0][2]; prepare.cameraUp[1] = world.rotate.entry[1][2]; prepare.cameraUp[2] = world.rotate.entry[2][2];
-				
-				// Auto-detect large camera jumps (>1000 units = ~14 meters) as scene transitions
-				float dx = prepare.cameraPosition[0] - lastCameraPos[0];
-				float dy = prepare.cameraPosition[1] - lastCameraPos[1];
-				float dz = prepare.cameraPosition[2] - lastCameraPos[2];
-				float distSq = dx*dx + dy*dy + dz*dz;
-				if (distSq > 1000000.0f) { // 1000^2 = 1000000
-					prepare.reset = true;
-					logger::info("[FSR4SkyrimHandler] Camera jump detected (dist^2={:.0f}), reset triggered", distSq);
-				}
-				lastCameraPos[0] = prepare.cameraPosition[0];
-				lastCameraPos[1] = prepare.cameraPosition[1];
-				lastCameraPos[2] = prepare.cameraPosition[2];
-			}
+		resumeAfterStaticFrames = false;
+
+		// FSR 4.0 requires camera vectors - FrameContext provides safe defaults if camera unavailable
+		for (int i = 0; i < 3; i++) {
+			prepare.cameraPosition[i] = frame.cameraPosition[i];
+			prepare.cameraRight[i] = frame.cameraRight[i];
+			prepare.cameraForward[i] = frame.cameraForward[i];
+			prepare.cameraUp[i] = frame.cameraUp[i];
 		}
 
 		// Diagnostic logging disabled in release build
 		// Enable shouldLog above for debugging if needed
 
 		auto dispatchResult = ffxDispatch(&frameGenContext, &prepare.header);
+		DX12SwapChain::CountCost(FrameCostRecorder::Counter::kFfxDispatch);
 		if (dispatchResult != FFX_API_RETURN_OK) {
 			logger::error("[FSR4] PrepareV2 failed! Error: 0x{:X}", (uint32_t)dispatchResult);
 		}
@@ -519,31 +721,17 @@ bool FSR4SkyrimHandler::DispatchAASync(
 	
 	if (!swapChain || !upscaling) return false;
 	
-	// Get current command list
-	auto commandList = swapChain->commandLists[swapChain->frameIndex].get();
-	auto commandAllocator = swapChain->commandAllocators[swapChain->frameIndex].get();
+	// Get current command list, with its own allocator so Present can reset the other one
+	auto commandList = swapChain->aaLists[swapChain->frameIndex].get();
+	auto commandAllocator = swapChain->aaAllocators[swapChain->frameIndex].get();
 	
 	if (!commandList || !commandAllocator) {
 		logger::warn("[FidelityFX] DispatchAASync: Missing command list or allocator");
 		return false;
 	}
 	
-	// Get state for jitter
-	auto state = RE::BSGraphics::State::GetSingleton();
-	auto stateEx = state ? reinterpret_cast<StateEx*>(state) : nullptr;
-	
-	// Use game's deltaTime
-	static auto s_deltaTime = (float*)REL::RelocationID(523660, 410199).address();
-	float manualDeltaTime = s_deltaTime ? (*s_deltaTime * 1000.0f) : 16.6f;
-	if (manualDeltaTime <= 0.0f) manualDeltaTime = 16.6f;
-	
-	// Camera near/far
-	static auto s_cameraNear = (float*)(REL::RelocationID(517032, 403540).address() + 0x40);
-	static auto s_cameraFar = (float*)(REL::RelocationID(517032, 403540).address() + 0x44);
-	float cameraNearVal = s_cameraNear ? *s_cameraNear : 0.1f;
-	float cameraFarVal = s_cameraFar ? *s_cameraFar : 100000.0f;
-	if (cameraNearVal <= 0.0f) cameraNearVal = 0.1f;
-	if (cameraFarVal <= cameraNearVal) cameraFarVal = 100000.0f;
+	// Same snapshot Present() will use for FG prepare later this frame
+	auto frame = upscaling->GetFrameContext();
 	
 	bool shouldLog = false; // Release: Only log errors
 	
@@ -551,6 +739,7 @@ bool FSR4SkyrimHandler::DispatchAASync(
 		// Reset command allocator and list for AA work
 		DX::ThrowIfFailed(commandAllocator->Reset());
 		DX::ThrowIfFailed(commandList->Reset(commandAllocator, nullptr));
+		swapChain->WriteTimestamp(commandList, DX12SwapChain::kAntiAliasingBegin);
 		
 		// Build AA dispatch descriptor
 		ffxDispatchDescUpscale upscaleDispatch{};
@@ -562,29 +751,23 @@ bool FSR4SkyrimHandler::DispatchAASync(
 		upscaleDispatch.motionVectors = ffxApiGetResourceDX12(motionVectors);
 		upscaleDispatch.output = ffxApiGetResourceDX12(outputColor, FFX_API_RESOURCE_STATE_UNORDERED_ACCESS);
 		
-		// Read jitter from game state
-		if (stateEx) {
-			upscaleDispatch.jitterOffset.x = stateEx->projectionPosScaleX * (float)swapChain->swapChainDesc.Width / 2.0f;
-			upscaleDispatch.jitterOffset.y = stateEx->projectionPosScaleY * (float)swapChain->swapChainDesc.Height / 2.0f;
-		} else {
-			upscaleDispatch.jitterOffset.x = 0.0f;
-			upscaleDispatch.jitterOffset.y = 0.0f;
-		}
+		upscaleDispatch.jitterOffset.x = frame.jitterX;
+		upscaleDispatch.jitterOffset.y = frame.jitterY;
 		
-		upscaleDispatch.motionVectorScale.x = (float)swapChain->swapChainDesc.Width;
-		upscaleDispatch.motionVectorScale.y = (float)swapChain->swapChainDesc.Height;
-		upscaleDispatch.renderSize.width = swapChain->swapChainDesc.Width;
-		upscaleDispatch.renderSize.height = swapChain->swapChainDesc.Height;
+		upscaleDispatch.motionVectorScale.x = (float)frame.width;
+		upscaleDispatch.motionVectorScale.y = (float)frame.height;
+		upscaleDispatch.renderSize.width = frame.width;
+		upscaleDispatch.renderSize.height = frame.height;
 		upscaleDispatch.upscaleSize = upscaleDispatch.renderSize;  // Native res AA
-		upscaleDispatch.frameTimeDelta = manualDeltaTime;
-		upscaleDispatch.cameraNear = cameraNearVal;
-		upscaleDispatch.cameraFar = cameraFarVal;
-		upscaleDispatch.cameraFovAngleVertical = GetVerticalFOVRad();
+		upscaleDispatch.frameTimeDelta = frame.deltaTimeMs;
+		upscaleDispatch.cameraNear = frame.cameraNear;
+		upscaleDispatch.cameraFar = frame.cameraFar;
+		upscaleDispatch.cameraFovAngleVertical = frame.fovVerticalRad;
 		upscaleDispatch.viewSpaceToMetersFactor = 0.01428222656f;
 		upscaleDispatch.preExposure = 1.0f;
-		upscaleDispatch.reset = needsReset || (currentFSRFrameID < 10);
+		upscaleDispatch.reset = needsReset || frame.sceneCut || (currentFSRFrameID < 10);
 		upscaleDispatch.enableSharpening = true;
-		upscaleDispatch.sharpness = upscaling->settings.sharpness;
+		upscaleDispatch.sharpness = upscaling->GetSettings().sharpness;
 		upscaleDispatch.flags = FFX_UPSCALE_FLAG_NON_LINEAR_COLOR_SRGB;
 		
 		if (shouldLog) {
@@ -593,6 +776,7 @@ bool FSR4SkyrimHandler::DispatchAASync(
 		
 		// Execute AA dispatch
 		auto aaResult = ffxDispatch(&upscaleContext, &upscaleDispatch.header);
+		DX12SwapChain::CountCost(FrameCostRecorder::Counter::kFfxDispatch);
 		if (aaResult != FFX_API_RETURN_OK) {
 			logger::error("[FidelityFX] DispatchAASync: ffxDispatch failed! Error: 0x{:X}", (uint32_t)aaResult);
 			return false;
@@ -605,12 +789,15 @@ bool FSR4SkyrimHandler::DispatchAASync(
 			D3D12_RESOURCE_STATE_COMMON  // COMMON allows D3D11 to read via shared handle
 		);
 		commandList->ResourceBarrier(1, &barrier);
+		DX12SwapChain::CountCost(FrameCostRecorder::Counter::kBarrier12);
+		swapChain->WriteTimestamp(commandList, DX12SwapChain::kAntiAliasingEnd);
 		
 		// Close and execute command list
 		DX::ThrowIfFailed(commandList->Close());
 		
 		ID3D12CommandList* commandListsToExecute[] = { commandList };
 		swapChain->commandQueue->ExecuteCommandLists(1, commandListsToExecute);
+		DX12SwapChain::CountCost(FrameCostRecorder::Counter::kExecute12);
 		
 		// Signal D3D12 completion (D3D11 will wait on this)
 		swapChain->SignalD3D12ToD3D11();
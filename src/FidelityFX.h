@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <d3d11_4.h>
 #include <d3d12.h>
 #include <ffx_api.h>
@@ -16,6 +17,13 @@
 // AMD Anti-Lag 2.0 SDK
 #include <amd/antilag2/ffx_antilag2_dx12.h>
 
+#include "Core/AdaptiveFrameGeneration.h"
+#include "Core/BackgroundWorker.h"
+#include "Core/FrameGenerationRatio.h"
+#include "Core/LifecycleManager.h"
+
+float GetVerticalFOVRad();
+
 class FSR4SkyrimHandler
 {
 public:
@@ -35,20 +43,96 @@ public:
 	bool upscaleInitialized = false;
 	bool frameGenInitialized = false;
 	bool swapChainContextInitialized = false;
+	bool frameGenAsyncWorkloads = false;  // Creation flag of the live FG context
+
+	// Settings as limited by the VRAM downgrade level, updated by UpdateLifecycle
+	bool frameGenerationEnabled = false;
+	bool antiAliasingEnabled = false;
+
+	// Dimensions the live contexts were created with, zero when destroyed. Used to plan resizes.
+	uint32_t frameGenDisplayWidth = 0;
+	uint32_t frameGenDisplayHeight = 0;
+	DXGI_FORMAT frameGenBackBufferFormat = DXGI_FORMAT_UNKNOWN;
+	uint32_t upscaleMaxRenderWidth = 0;
+	uint32_t upscaleMaxRenderHeight = 0;
 	uint64_t currentFSRFrameID = 1;
 	
 	// Reset flag for scene transitions (load game, fast travel, etc.)
 	bool needsReset = true;  // Start with reset to handle initial frames
+	bool resumeAfterStaticFrames = false;  // FG prepare was skipped on static frames
+
+	// FrameGenerationMode 2: frame generation follows the base frame rate, decided once per real frame.
+	// The smoothed base frame rate also picks the ratio in every mode.
+	AdaptiveFrameGeneration adaptiveFrameGeneration;
+	int64_t lastBaseFrameQPC = 0;
+	bool adaptiveActive = false;
+
+	// The FFX frame generation swap chain presents one generated frame per real frame; the menu only
+	// offers ratios up to this, and a higher one from the INI is clamped (logged once)
+	static constexpr uint32_t kSupportedGeneratedFrames = 1;
+	FrameGenerationRatio frameGenerationRatio;
+	bool ratioClampLogged = false;
+	uint32_t generatedFrames = 0;                      // Requested this frame, 0 while FG is off
+	std::atomic<uint32_t> presentedGeneratedFrames{ 0 };  // As reported to the present callback
 	
 	// Anti-Lag 2.0
 	AMD::AntiLag2DX12::Context antiLagContext = {};
 	bool antiLagAvailable = false;
-	bool antiLagEnabled = true;  // User setting
+	std::atomic<bool> antiLagEnabled{ true };  // User setting, mirrored from Upscaling::Settings
 	
 	void RequestReset() { needsReset = true; }
 
+	// Runtime creation/teardown of the FG and upscale contexts and the shared resources.
+	// The swap chain context and proxy stay alive, everything else follows the settings.
+	LifecycleManager lifecycle;
+	LifecycleManager::FeatureID frameGenFeature = 0;
+	LifecycleManager::FeatureID upscaleFeature = 0;
+	LifecycleManager::FeatureID sharedResourcesFeature = 0;
+	bool lifecycleRegistered = false;
+
+	// FG and upscale contexts are created on initWorker while the game keeps running. The lifecycle
+	// keeps them kCreating, and frames pass through untouched, until the render thread publishes the
+	// finished context.
+	struct ContextCreation
+	{
+		BackgroundWorker::JobPtr job;
+		ffxContext context = nullptr;  // Written by the worker, read once the job finished
+		uint32_t width = 0;            // Parameters captured on the render thread
+		uint32_t height = 0;
+		DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+		bool asyncWorkloads = false;
+		uint64_t bytes = 0;  // GPU memory the SDK reports for the context, for the budget
+	};
+	BackgroundWorker initWorker;
+	ContextCreation frameGenCreation;
+	ContextCreation upscaleCreation;
+
+	// How long the game's CreateSwapChain call was blocked and how much ran off-thread instead
+	struct StartupTiming
+	{
+		double mainThreadMs = 0.0;
+		double offThreadMs = 0.0;
+		uint32_t passthroughFrames = 0;  // Presented before every wanted context was live
+		bool reported = false;
+	};
+	StartupTiming startupTiming;
+
 	void LoadFFX();
 	void SetupFrameGeneration();
+	void RegisterLifecycle();
+	void UpdateLifecycle(uint64_t a_submittedFence, uint64_t a_completedFence);  // Once per frame after Present
+	bool StartFrameGenerationContext(bool a_allowAsyncWorkloads);
+	bool CreateFrameGenerationContext(ContextCreation& a_creation);  // On initWorker
+	LifecycleManager::Progress FinishFrameGenerationContext(bool a_wait);
+	bool StartUpscaleContext();
+	bool CreateUpscaleContext(ContextCreation& a_creation);  // On initWorker
+	LifecycleManager::Progress FinishUpscaleContext(bool a_wait);
+	LifecycleManager::Progress PollContextCreation(ContextCreation& a_creation, bool a_wait);
+	void UpdateStartupTiming();
+	bool UpdateFrameGenerationPolicy();  // Once per real frame that could use frame generation
+	void RetireFrameGenerationContext();
+	void DestroyFrameGenerationContext();
+	void DestroyUpscaleContext();
 	void InitAntiLag(ID3D12Device* device);
 	void UpdateAntiLag();  // Call before input polling
 	void MarkEndOfRendering();  // Call after PrepareV2
@@ -0,0 +1,250 @@
+#include "PCH.h"
+#include "FrameCapture.h"
+
+#include <ctime>
+#include <filesystem>
+
+#include <d3dx12.h>
+
+#include "Core/HeapPlanner.h"
+#include "DX12SwapChain.h"
+#include "Upscaling.h"
+
+void FrameCapture::Request(uint32_t a_frames)
+{
+	requested.store(a_frames);
+}
+
+FrameCapture::Slot* FrameCapture::AcquireSlot()
+{
+	for (auto& slot : slots) {
+		if (slot.state == SlotState::kFree)
+			return &slot;
+	}
+	return nullptr;
+}
+
+void FrameCapture::Begin(uint32_t a_frames)
+{
+	char stamp[32];
+	std::time_t now = std::time(nullptr);
+	std::tm local{};
+	localtime_s(&local, &now);
+	std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+	auto path = std::filesystem::path(kCaptureDir) / std::format("capture_{}.fsrcap", stamp);
+
+	remaining = a_frames;
+	idle = false;
+	skipped = 0;
+	logger::info("[Capture] Capturing {} frames to {}", a_frames, path.string());
+
+	writerThread.Submit("Open capture", [this, path]() {
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+		if (!writer.Open(path)) {
+			logger::error("[Capture] Failed to create {}", path.string());
+			return false;
+		}
+		return true;
+	});
+}
+
+void FrameCapture::End()
+{
+	writerThread.Submit("Close capture", [this]() {
+		if (writer.IsOpen()) {
+			logger::info("[Capture] Wrote {} frames, {:.1f} MB ({:.1f} MB uncompressed)", writer.FramesWritten(),
+				double(writer.BytesWritten()) / (1024.0 * 1024.0), double(writer.RawBytes()) / (1024.0 * 1024.0));
+		}
+		writer.Close();
+		return true;
+	});
+	if (skipped)
+		logger::info("[Capture] {} frames skipped while all readback slots were busy", skipped);
+
+	// Every slot is free: its copy completed and the writer unmapped it
+	ReleaseReadback();
+	idle = true;
+}
+
+bool FrameCapture::AllocateReadback(ID3D12Device* a_device, uint64_t a_slotBytes)
+{
+	// All slots can be in flight at once, so they never alias; the planner packs them at placement
+	// alignment into as few heaps as its size cap allows
+	HeapPlanner::Request requests[kSlotCount];
+	for (auto& request : requests) {
+		request.name = "capture slot";
+		request.size = a_slotBytes;
+	}
+	auto plan = HeapPlanner{}.Build(requests);
+
+	for (uint64_t heapSize : plan.heapSizes) {
+		auto heapDesc = CD3DX12_HEAP_DESC(heapSize, D3D12_HEAP_TYPE_READBACK, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+		if (FAILED(a_device->CreateHeap(&heapDesc, IID_PPV_ARGS(heaps.emplace_back().put()))))
+			return false;
+	}
+
+	auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(a_slotBytes);
+	for (uint32_t i = 0; i < kSlotCount; i++) {
+		auto& placement = plan.placements[i];
+		if (FAILED(a_device->CreatePlacedResource(heaps[placement.heap].get(), placement.offset, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(slots[i].readback.put()))))
+			return false;
+	}
+
+	slotBytes = a_slotBytes;
+	logger::info("[Capture] {} readback slots of {:.1f} MB in {} heap(s)", kSlotCount, double(a_slotBytes) / (1024.0 * 1024.0), plan.heapSizes.size());
+	return true;
+}
+
+void FrameCapture::ReleaseReadback()
+{
+	// Placed buffers go before the heaps they live in
+	for (auto& slot : slots)
+		slot.readback = nullptr;
+	heaps.clear();
+	slotBytes = 0;
+}
+
+void FrameCapture::Record(ID3D12Device* a_device, ID3D12GraphicsCommandList* a_commandList, uint64_t a_fenceValue)
+{
+	if (remaining == 0) {
+		// A new request waits until the previous capture is written and closed
+		if (!idle)
+			return;
+		auto frames = requested.exchange(0);
+		if (frames == 0)
+			return;
+		Begin(frames);
+	}
+
+	auto upscaling = Upscaling::GetSingleton();
+	std::pair<Capture::Plane, WrappedResource*> sources[] = {
+		{ Capture::Plane::kColor, upscaling->HUDLessBufferShared },
+		{ Capture::Plane::kDepth, upscaling->depthBufferShared },
+		{ Capture::Plane::kMotionVectors, upscaling->motionVectorBufferShared },
+	};
+
+	auto slot = AcquireSlot();
+	if (!slot) {
+		skipped++;
+		return;
+	}
+
+	slot->planes.clear();
+	uint64_t size = 0;
+	for (auto& [plane, source] : sources) {
+		if (!source || !source->resource)
+			continue;
+		auto desc = source->resource->GetDesc();
+		PlaneCopy copy{ plane, desc.Format };
+		UINT rows = 0;
+		UINT64 rowBytes = 0;
+		UINT64 bytes = 0;
+		a_device->GetCopyableFootprints(&desc, 0, 1, size, &copy.footprint, &rows, &rowBytes, &bytes);
+		copy.rows = rows;
+		copy.rowBytes = rowBytes;
+		size = (copy.footprint.Offset + bytes + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~uint64_t(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+		slot->planes.push_back(copy);
+	}
+
+	// Frame generation and AA both off: the shared textures do not exist
+	if (slot->planes.empty()) {
+		logger::warn("[Capture] Nothing to capture, frame generation and anti-aliasing are off");
+		remaining = 0;
+		return;
+	}
+
+	// The first frame sizes every slot; other slots may be in flight later, so a larger frame ends the capture
+	if (!slotBytes && !AllocateReadback(a_device, size)) {
+		logger::error("[Capture] Failed to place {} readback buffers of {} bytes, capture stopped", kSlotCount, size);
+		ReleaseReadback();
+		remaining = 0;
+		return;
+	}
+	if (size > slotBytes) {
+		logger::warn("[Capture] Frame size changed during the capture, capture stopped");
+		remaining = 0;
+		return;
+	}
+
+	// The shared textures allow simultaneous access and are promoted to copy source implicitly
+	size_t index = 0;
+	for (auto& [plane, source] : sources) {
+		if (!source || !source->resource)
+			continue;
+		CD3DX12_TEXTURE_COPY_LOCATION dst(slot->readback.get(), slot->planes[index++].footprint);
+		CD3DX12_TEXTURE_COPY_LOCATION src(source->resource.get(), 0);
+		a_commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+		DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy12);
+	}
+
+	auto frame = upscaling->GetFrameContext();
+	auto& info = slot->info;
+	info = {};
+	info.frameID = frame.frameID;
+	info.width = frame.width;
+	info.height = frame.height;
+	info.deltaTimeMs = frame.deltaTimeMs;
+	info.cameraNear = frame.cameraNear;
+	info.cameraFar = frame.cameraFar;
+	info.fovVerticalRad = frame.fovVerticalRad;
+	info.jitterX = frame.jitterX;
+	info.jitterY = frame.jitterY;
+	std::copy_n(frame.cameraPosition, 3, info.cameraPosition);
+	std::copy_n(frame.cameraRight, 3, info.cameraRight);
+	std::copy_n(frame.cameraForward, 3, info.cameraForward);
+	std::copy_n(frame.cameraUp, 3, info.cameraUp);
+	info.flags = frame.sceneCut ? Capture::kSceneCut : 0;
+
+	slot->fenceValue = a_fenceValue;
+	slot->state = SlotState::kRecorded;
+	remaining--;
+}
+
+void FrameCapture::Collect(uint64_t a_completedValue)
+{
+	if (idle)
+		return;
+
+	bool busy = false;
+	for (auto& slot : slots) {
+		if (slot.state == SlotState::kWriting && slot.job->IsFinished()) {
+			if (slot.job->GetStatus() != BackgroundWorker::Status::kSucceeded && remaining) {
+				logger::error("[Capture] Writing a frame failed, capture stopped");
+				remaining = 0;
+			}
+			slot.job = nullptr;
+			slot.state = SlotState::kFree;
+		}
+
+		if (slot.state == SlotState::kRecorded && slot.fenceValue <= a_completedValue) {
+			void* data = nullptr;
+			if (FAILED(slot.readback->Map(0, nullptr, &data))) {
+				logger::error("[Capture] Failed to map a readback buffer");
+				slot.state = SlotState::kFree;
+				continue;
+			}
+
+			// The render thread leaves the slot alone until the job finished
+			slot.state = SlotState::kWriting;
+			slot.job = writerThread.Submit("Capture frame", [this, &slot, data]() {
+				std::vector<Capture::PlaneInput> planes;
+				for (auto& copy : slot.planes) {
+					auto& footprint = copy.footprint.Footprint;
+					planes.push_back({ copy.plane, uint32_t(copy.format), footprint.Width, copy.rows, uint32_t(copy.rowBytes), footprint.RowPitch,
+						static_cast<const uint8_t*>(data) + copy.footprint.Offset });
+				}
+				bool written = writer.WriteFrame(slot.info, planes);
+
+				D3D12_RANGE nothingWritten{ 0, 0 };
+				slot.readback->Unmap(0, &nothingWritten);
+				return written;
+			});
+		}
+
+		busy |= slot.state != SlotState::kFree;
+	}
+
+	if (remaining == 0 && !busy)
+		End();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <d3d12.h>
+
+#include "Core/BackgroundWorker.h"
+#include "Core/CaptureFile.h"
+
+// Records the color, depth and motion vector inputs and the camera of a run of frames to a capture
+// file. The shared textures are copied into readback buffers at the end of Present; once the fence
+// passes, the mapped buffers are compressed and written by a background thread. A slot is reused
+// only after its frame was written, and a frame is skipped rather than waited for when all are busy.
+// The slots' buffers are placed in readback heaps laid out by HeapPlanner when a capture starts.
+class FrameCapture
+{
+public:
+	static FrameCapture* GetSingleton()
+	{
+		static FrameCapture singleton;
+		return &singleton;
+	}
+
+	static constexpr uint32_t kSlotCount = 3;
+	static constexpr const char* kCaptureDir = "Data/SKSE/Plugins/FSR4_Skyrim/Captures";
+
+	// Any thread; starts with the next presented frame once a running capture is closed
+	void Request(uint32_t a_frames);
+
+	// Render thread, Present. a_fenceValue is signalled on the D3D12 queue after a_commandList.
+	void Record(ID3D12Device* a_device, ID3D12GraphicsCommandList* a_commandList, uint64_t a_fenceValue);
+	void Collect(uint64_t a_completedValue);
+
+private:
+	enum class SlotState : uint8_t
+	{
+		kFree,
+		kRecorded,  // Copy queued on the GPU
+		kWriting    // Mapped, owned by the writer thread
+	};
+
+	struct PlaneCopy
+	{
+		Capture::Plane plane;
+		DXGI_FORMAT format;
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+		uint32_t rows;
+		uint64_t rowBytes;
+	};
+
+	struct Slot
+	{
+		winrt::com_ptr<ID3D12Resource> readback;
+		std::vector<PlaneCopy> planes;
+		Capture::FrameInfo info{};
+		uint64_t fenceValue = 0;
+		SlotState state = SlotState::kFree;
+		BackgroundWorker::JobPtr job;
+	};
+
+	void Begin(uint32_t a_frames);
+	void End();
+	Slot* AcquireSlot();
+	bool AllocateReadback(ID3D12Device* a_device, uint64_t a_slotBytes);
+	void ReleaseReadback();
+
+	std::atomic<uint32_t> requested{ 0 };
+	uint32_t remaining = 0;
+	bool idle = true;  // No file open and no slot in use
+	uint64_t skipped = 0;
+
+	Slot slots[kSlotCount];
+	std::vector<winrt::com_ptr<ID3D12Heap>> heaps;
+	uint64_t slotBytes = 0;  // Size of every slot's buffer, 0 while none exist
+	BackgroundWorker writerThread;
+	Capture::Writer writer;  // Only used from writerThread jobs
+};
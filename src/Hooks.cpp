@@ -91,10 +91,11 @@ HRESULT WINAPI hk_D3D11CreateDeviceAndSwapChain(
 		shouldProxy = pSwapChainDesc->Windowed;
 
 		if (shouldProxy) {
-			if (upscaling->settings.frameGenerationMode)
+			const auto& settings = upscaling->GetSettings();
+			if (settings.frameGenerationMode)
 				if (refreshRate >= 119)
 					shouldProxy = true;
-				else if (upscaling->settings.frameGenerationForceEnable)
+				else if (settings.frameGenerationForceEnable)
 					shouldProxy = true;
 				else
 					shouldProxy = false;
@@ -0,0 +1,66 @@
+// Per 32x32 tile: a hash of the color bits and the largest motion vector in pixels, for static frame
+// detection. StaticFrameDetector::HashTiles is the CPU reference and must hash the same way.
+Texture2D<float4> Color : register(t0);
+Texture2D<float2> MotionVectors : register(t1);  // Unbound while paused, reads as zero
+RWStructuredBuffer<uint2> Tiles : register(u0);
+
+cbuffer Constants : register(b0)
+{
+	uint2 Size;
+	float2 MotionScale;
+	uint TilesX;
+	uint3 Padding;
+};
+
+groupshared uint tileHash;
+groupshared uint tileMotion;
+
+uint Mix(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+uint HashTexel(uint2 position, float3 color)
+{
+	uint hash = Mix(position.x | (position.y << 16));
+	hash = Mix(hash ^ asuint(color.r));
+	hash = Mix(hash ^ asuint(color.g));
+	hash = Mix(hash ^ asuint(color.b));
+	return hash;
+}
+
+// 16x16 threads, 2x2 texels each
+[numthreads(16, 16, 1)] void main(uint3 GroupID
+								  : SV_GroupID, uint3 GroupThreadID
+								  : SV_GroupThreadID, uint GroupIndex
+								  : SV_GroupIndex) {
+	if (GroupIndex == 0) {
+		tileHash = 0;
+		tileMotion = 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	// Summed, so the order threads add in does not change the result
+	uint hash = 0;
+	float motion = 0;
+	[unroll] for (uint i = 0; i < 4; i++)
+	{
+		uint2 position = GroupID.xy * 32 + GroupThreadID.xy * 2 + uint2(i & 1, i >> 1);
+		if (all(position < Size)) {
+			hash += HashTexel(position, Color[position].rgb);
+			motion = max(motion, length(MotionVectors[position] * MotionScale));
+		}
+	}
+
+	InterlockedAdd(tileHash, hash);
+	InterlockedMax(tileMotion, asuint(motion));
+	GroupMemoryBarrierWithGroupSync();
+
+	if (GroupIndex == 0)
+		Tiles[GroupID.y * TilesX + GroupID.x] = uint2(tileHash, tileMotion);
+}
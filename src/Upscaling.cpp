@@ -3,14 +3,27 @@
 
 #include <d3dcompiler.h>
 #include <filesystem>
+#include <fstream>
 #include <cmath>
+#include <thread>
 
+#include <RE/P/PlayerCamera.h>
+#include <RE/N/NiNode.h>
+
+#include "Buffer.h"
+#include "Core/ShaderCache.h"
 #include "DX12SwapChain.h"
 #include "FidelityFX.h"
+#include "FrameCapture.h"
 #include "Hooks.h"
 
 #include <ClibUtil/simpleINI.hpp>
 
+#ifndef FSR4_NO_EMBEDDED_SHADERS
+#include "CopyDepthToSharedBufferCS.h"
+#include "TileHashCS.h"
+#endif
+
 static void SetDirtyStates(bool a_computeShader)
 {
 	using func_t = void (*)(bool);
@@ -18,42 +31,144 @@ static void SetDirtyStates(bool a_computeShader)
 	func(a_computeShader);
 }
 
+static constexpr const char* kINIPath = "enbseries/enbframegeneration.ini";
+
 void Upscaling::LoadINI()
 {
-	std::lock_guard<std::shared_mutex> lk(fileLock);
+	std::lock_guard<std::mutex> lk(fileLock);
 	CSimpleIniA ini;
 	if (!std::filesystem::exists("enbseries")) {
 		std::filesystem::create_directory("enbseries");
 	}
-	ini.LoadFile("enbseries/enbframegeneration.ini");
-	settings.frameGenerationMode = clib_util::ini::get_value<uint32_t>(ini, settings.frameGenerationMode, "FRAME GENERATION", "FrameGenerationMode", "# Default: 1");
-	settings.frameLimitMode = clib_util::ini::get_value<uint32_t>(ini, settings.frameLimitMode, "FRAME GENERATION", "FrameLimitMode", "# Default: 0 (Disabled by default for smoothness)");
-	settings.frameGenerationForceEnable = clib_util::ini::get_value<uint32_t>(ini, settings.frameGenerationForceEnable, "FRAME GENERATION", "ForceEnable", "# Default: 0");
-	settings.sharpness = clib_util::ini::get_value<float>(ini, settings.sharpness, "FRAME GENERATION", "Sharpness", "# RCAS sharpening, range of 0.0 to 1.0\n# Default: 0.5");
-	settings.allowAsyncWorkloads = clib_util::ini::get_value<uint32_t>(ini, settings.allowAsyncWorkloads, "FRAME GENERATION", "AllowAsyncWorkloads", "# Default: 1 (Enabled for performance)");
-	settings.antiLagEnabled = clib_util::ini::get_value<uint32_t>(ini, settings.antiLagEnabled, "FRAME GENERATION", "AntiLagEnabled", "# AMD Anti-Lag 2.0 (AMD GPUs only)\n# Default: 1");
-	
-	// Sync Anti-Lag setting to FidelityFX handler
-	auto fidelityFX = FSR4SkyrimHandler::GetSingleton();
-	if (fidelityFX) {
-		fidelityFX->antiLagEnabled = (settings.antiLagEnabled != 0);
-	}
+	ini.LoadFile(kINIPath);
+	UpdateSettings([&](Settings& settings) {
+		settings.frameGenerationMode = clib_util::ini::get_value<uint32_t>(ini, settings.frameGenerationMode, "FRAME GENERATION", "FrameGenerationMode", "# 0 = off, 1 = on, 2 = auto (on while the base frame rate is between 40 fps and half the refresh rate)\n# Default: 1");
+		settings.frameGenerationRatio = clib_util::ini::get_value<uint32_t>(ini, settings.frameGenerationRatio, "FRAME GENERATION", "FrameGenerationRatio", "# Generated frames per real frame: 0 = auto from refresh rate and base frame rate, 1 = 2x, 2 = 3x, 3 = 4x\n# Limited to what the FidelityFX SDK can present (currently 2x)\n# Default: 0");
+		settings.frameLimitMode = clib_util::ini::get_value<uint32_t>(ini, settings.frameLimitMode, "FRAME GENERATION", "FrameLimitMode", "# Default: 0 (Disabled by default for smoothness)");
+		settings.frameGenerationForceEnable = clib_util::ini::get_value<uint32_t>(ini, settings.frameGenerationForceEnable, "FRAME GENERATION", "ForceEnable", "# Default: 0");
+		settings.sharpness = clib_util::ini::get_value<float>(ini, settings.sharpness, "FRAME GENERATION", "Sharpness", "# RCAS sharpening, range of 0.0 to 1.0\n# Default: 0.5");
+		settings.allowAsyncWorkloads = clib_util::ini::get_value<uint32_t>(ini, settings.allowAsyncWorkloads, "FRAME GENERATION", "AllowAsyncWorkloads", "# Frame generation async workloads, AA stays on the direct queue\n# Default: 1");
+		settings.antiLagEnabled = clib_util::ini::get_value<uint32_t>(ini, settings.antiLagEnabled, "FRAME GENERATION", "AntiLagEnabled", "# AMD Anti-Lag 2.0 (AMD GPUs only)\n# Default: 1");
+		settings.antiAliasing = clib_util::ini::get_value<uint32_t>(ini, settings.antiAliasing, "FRAME GENERATION", "AntiAliasing", "# FSR 4 native AA in place of the game's TAA\n# Default: 1");
+		settings.adaptiveVram = clib_util::ini::get_value<uint32_t>(ini, settings.adaptiveVram, "FRAME GENERATION", "AdaptiveVRAM", "# Downgrade formats, then AA, then frame generation when VRAM runs out\n# Default: 1");
+		settings.captureFrameCount = clib_util::ini::get_value<uint32_t>(ini, settings.captureFrameCount, "FRAME GENERATION", "CaptureFrameCount", "# Frames written by the Capture Frames button\n# Default: 60");
+		settings.staticFrameDetection = clib_util::ini::get_value<uint32_t>(ini, settings.staticFrameDetection, "FRAME GENERATION", "StaticFrameDetection", "# Reuse the previous AA output and skip the frame generation prepare while the image does not change\n# A change in a static image shows a few frames late\n# Default: 1");
+		settings.powerSaving = clib_util::ini::get_value<uint32_t>(ini, settings.powerSaving, "FRAME GENERATION", "PowerSaving", "# No frame generation while a menu pauses the game\n# Default: 1");
+		settings.menuFrameRateCap = clib_util::ini::get_value<uint32_t>(ini, settings.menuFrameRateCap, "FRAME GENERATION", "MenuFrameRateCap", "# Frame rate cap while a menu pauses the game, 0 for none\n# Default: 60");
+	});
 }
 
 void Upscaling::SaveINI()
 {
-	std::lock_guard<std::shared_mutex> lk(fileLock);
+	std::lock_guard<std::mutex> lk(fileLock);
 	CSimpleIniA ini;
 	if (!std::filesystem::exists("enbseries")) {
 		std::filesystem::create_directory("enbseries");
 	}
-	ini.SetValue("FRAME GENERATION", "FrameGenerationMode", std::to_string(settings.frameGenerationMode).c_str(), "# Default: 1");
+	auto settings = this->settings.Copy();
+	ini.SetValue("FRAME GENERATION", "FrameGenerationMode", std::to_string(settings.frameGenerationMode).c_str(), "# 0 = off, 1 = on, 2 = auto (on while the base frame rate is between 40 fps and half the refresh rate)\n# Default: 1");
+	ini.SetValue("FRAME GENERATION", "FrameGenerationRatio", std::to_string(settings.frameGenerationRatio).c_str(), "# Generated frames per real frame: 0 = auto from refresh rate and base frame rate, 1 = 2x, 2 = 3x, 3 = 4x\n# Limited to what the FidelityFX SDK can present (currently 2x)\n# Default: 0");
 	ini.SetValue("FRAME GENERATION", "FrameLimitMode", std::to_string(settings.frameLimitMode).c_str(), "# Default: 0");
 	ini.SetValue("FRAME GENERATION", "ForceEnable", std::to_string(settings.frameGenerationForceEnable).c_str(), "# Default: 0");
 	ini.SetValue("FRAME GENERATION", "Sharpness", std::to_string(settings.sharpness).c_str(), "# RCAS sharpening, range of 0.0 to 1.0\n# Default: 0.5");
-	ini.SetValue("FRAME GENERATION", "AllowAsyncWorkloads", std::to_string(settings.allowAsyncWorkloads).c_str(), "# Default: 1");
+	ini.SetValue("FRAME GENERATION", "AllowAsyncWorkloads", std::to_string(settings.allowAsyncWorkloads).c_str(), "# Frame generation async workloads, AA stays on the direct queue\n# Default: 1");
 	ini.SetValue("FRAME GENERATION", "AntiLagEnabled", std::to_string(settings.antiLagEnabled).c_str(), "# AMD Anti-Lag 2.0 (AMD GPUs only)\n# Default: 1");
-	ini.SaveFile("enbseries/enbframegeneration.ini");
+	ini.SetValue("FRAME GENERATION", "AntiAliasing", std::to_string(settings.antiAliasing).c_str(), "# FSR 4 native AA in place of the game's TAA\n# Default: 1");
+	ini.SetValue("FRAME GENERATION", "AdaptiveVRAM", std::to_string(settings.adaptiveVram).c_str(), "# Downgrade formats, then AA, then frame generation when VRAM runs out\n# Default: 1");
+	ini.SetValue("FRAME GENERATION", "CaptureFrameCount", std::to_string(settings.captureFrameCount).c_str(), "# Frames written by the Capture Frames button\n# Default: 60");
+	ini.SetValue("FRAME GENERATION", "StaticFrameDetection", std::to_string(settings.staticFrameDetection).c_str(), "# Reuse the previous AA output and skip the frame generation prepare while the image does not change\n# A change in a static image shows a few frames late\n# Default: 1");
+	ini.SetValue("FRAME GENERATION", "PowerSaving", std::to_string(settings.powerSaving).c_str(), "# No frame generation while a menu pauses the game\n# Default: 1");
+	ini.SetValue("FRAME GENERATION", "MenuFrameRateCap", std::to_string(settings.menuFrameRateCap).c_str(), "# Frame rate cap while a menu pauses the game, 0 for none\n# Default: 60");
+	ini.SaveFile(kINIPath);
+
+	// Our own write must not come back as a hot reload
+	iniWatcher.IgnoreCurrentState();
+}
+
+void Upscaling::StartINIWatcher()
+{
+	bool started = iniWatcher.Start(kINIPath, []() {
+		logger::info("[Upscaling] {} changed on disk, reloading settings", kINIPath);
+		GetSingleton()->LoadINI();
+	});
+	if (started)
+		logger::info("[Upscaling] Watching {} for changes", kINIPath);
+}
+
+void Upscaling::ApplySettings(const Settings& a_settings)
+{
+	// Mirror settings that are read outside the render thread (Anti-Lag frame typing runs in the FG callback)
+	FSR4SkyrimHandler::GetSingleton()->antiLagEnabled = (a_settings.antiLagEnabled != 0);
+
+	// Sharpness and the like change the AA output of an unchanged image
+	staticFrameInvalidated.store(true);
+}
+
+// AntTweakBar accessors: the UI edits a copy and publishes it instead of writing the live settings in place
+template <auto Member>
+static void TW_CALL SetSettingCallback(const void* a_value, void*)
+{
+	Upscaling::GetSingleton()->UpdateSettings([a_value](Upscaling::Settings& a_settings) {
+		using Value = std::remove_reference_t<decltype(a_settings.*Member)>;
+		a_settings.*Member = *static_cast<const Value*>(a_value);
+	});
+}
+
+template <auto Member>
+static void TW_CALL GetSettingCallback(void* a_value, void*)
+{
+	auto settings = Upscaling::GetSingleton()->settings.Copy();
+	using Value = std::remove_reference_t<decltype(settings.*Member)>;
+	*static_cast<Value*>(a_value) = settings.*Member;
+}
+
+template <auto Member>
+static void AddSettingVar(TwBar* a_bar, const char* a_name, TwType a_type, const char* a_def)
+{
+	g_ENB->TwAddVarCB(a_bar, a_name, a_type, SetSettingCallback<Member>, GetSettingCallback<Member>, nullptr, a_def);
+}
+
+// Read-only views of the last VRAM budget sample
+static float BytesToMB(uint64_t a_bytes)
+{
+	return float(double(a_bytes) / (1024.0 * 1024.0));
+}
+
+static void TW_CALL GetPluginVramCallback(void* a_value, void*)
+{
+	*static_cast<float*>(a_value) = BytesToMB(DX12SwapChain::GetSingleton()->vramBudget.GetReport().pluginBytes);
+}
+
+static void TW_CALL GetProcessVramCallback(void* a_value, void*)
+{
+	*static_cast<float*>(a_value) = BytesToMB(DX12SwapChain::GetSingleton()->vramBudget.GetReport().sample.usage);
+}
+
+static void TW_CALL GetVramBudgetCallback(void* a_value, void*)
+{
+	*static_cast<float*>(a_value) = BytesToMB(DX12SwapChain::GetSingleton()->vramBudget.GetReport().sample.budget);
+}
+
+static void TW_CALL GetVramLevelCallback(void* a_value, void*)
+{
+	*static_cast<uint32_t*>(a_value) = uint32_t(DX12SwapChain::GetSingleton()->vramBudget.GetLevel());
+}
+
+// Smoothed base frame rate the auto frame generation mode decides on
+static void TW_CALL GetAdaptiveBaseFpsCallback(void* a_value, void*)
+{
+	*static_cast<float*>(a_value) = FSR4SkyrimHandler::GetSingleton()->adaptiveFrameGeneration.GetLast().baseFps;
+}
+
+// Output frames per real frame as last presented, 1 while frame generation is off
+static void TW_CALL GetActiveRatioCallback(void* a_value, void*)
+{
+	*static_cast<uint32_t*>(a_value) = FSR4SkyrimHandler::GetSingleton()->presentedGeneratedFrames.load(std::memory_order_relaxed) + 1;
+}
+
+static void TW_CALL CaptureFramesCallback(void*)
+{
+	FrameCapture::GetSingleton()->Request(Upscaling::GetSingleton()->settings.Copy().captureFrameCount);
 }
 
 void Upscaling::RefreshUI()
@@ -63,6 +178,7 @@ void Upscaling::RefreshUI()
 
 	auto generalBar = g_ENB->TwGetBarByEnum(ENB_API::ENBWindowType::EditorBarButtons);
 	auto fidelityFX = FSR4SkyrimHandler::GetSingleton();
+	auto settings = this->settings.Copy();
 
 	// === FSR 4.0 FRAME GENERATION ===
 	g_ENB->TwAddButton(generalBar, "--- FSR 4.0 Frame Generation ---", NULL, NULL, "group='FSR4 FRAME GENERATION'");
@@ -83,77 +199,268 @@ void Upscaling::RefreshUI()
 	if (fidelityFXMissing)
 		g_ENB->TwAddButton(generalBar, "[!] FSR 4.0 DLLs Not Loaded", NULL, NULL, "group='FSR4 FRAME GENERATION'");
 
-	g_ENB->TwAddVarRW(generalBar, "Enable Frame Generation", TW_TYPE_BOOL32, &settings.frameGenerationMode, "group='FSR4 FRAME GENERATION'");
+	static const TwEnumVal kFrameGenerationModes[] = { { 0, "Off" }, { 1, "On" }, { 2, "Auto" } };
+	auto frameGenerationModeType = g_ENB->TwDefineEnum("FrameGenerationMode", kFrameGenerationModes, 3);
+	AddSettingVar<&Settings::frameGenerationMode>(generalBar, "Frame Generation", frameGenerationModeType, "group='FSR4 FRAME GENERATION'");
+	if (d3d12Interop) {
+		g_ENB->TwAddVarCB(generalBar, "Auto FG Base FPS", TW_TYPE_FLOAT, nullptr, GetAdaptiveBaseFpsCallback, nullptr, "group='FSR4 FRAME GENERATION' precision=1");
+
+		// Only the ratios the frame generation swap chain can present
+		static const TwEnumVal kFrameGenerationRatios[] = { { 0, "Auto" }, { 1, "2x" }, { 2, "3x" }, { 3, "4x" } };
+		static_assert(std::size(kFrameGenerationRatios) == FrameGenerationRatio::kMaxGeneratedFrames + 1);
+		auto frameGenerationRatioType = g_ENB->TwDefineEnum("FrameGenerationRatio", kFrameGenerationRatios, FSR4SkyrimHandler::kSupportedGeneratedFrames + 1);
+		AddSettingVar<&Settings::frameGenerationRatio>(generalBar, "FG Ratio", frameGenerationRatioType, "group='FSR4 FRAME GENERATION'");
+		g_ENB->TwAddVarCB(generalBar, "Active FG Ratio", TW_TYPE_UINT32, nullptr, GetActiveRatioCallback, nullptr, "group='FSR4 FRAME GENERATION'");
+	}
 
 	if (d3d12Interop) {
-		g_ENB->TwAddVarRW(generalBar, "VRR Frame Pacing", TW_TYPE_BOOL32, &settings.frameLimitMode, "group='FSR4 FRAME GENERATION'");
-		g_ENB->TwAddVarRW(generalBar, "Async Compute", TW_TYPE_BOOL32, &settings.allowAsyncWorkloads, "group='FSR4 FRAME GENERATION'");
+		AddSettingVar<&Settings::frameLimitMode>(generalBar, "VRR Frame Pacing", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
+		AddSettingVar<&Settings::allowAsyncWorkloads>(generalBar, "Async Compute", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
 	}
 
-	g_ENB->TwAddVarRW(generalBar, "Sharpness", TW_TYPE_FLOAT, &settings.sharpness, "group='FSR4 FRAME GENERATION' min=0.0 max=1.0 step=0.05");
-	g_ENB->TwAddVarRW(generalBar, "Force Enable (Low Hz)", TW_TYPE_BOOL32, &settings.frameGenerationForceEnable, "group='FSR4 FRAME GENERATION'");
+	AddSettingVar<&Settings::antiAliasing>(generalBar, "FSR 4 Anti-Aliasing", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
+	AddSettingVar<&Settings::sharpness>(generalBar, "Sharpness", TW_TYPE_FLOAT, "group='FSR4 FRAME GENERATION' min=0.0 max=1.0 step=0.05");
+	AddSettingVar<&Settings::frameGenerationForceEnable>(generalBar, "Force Enable (Low Hz)", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
+	if (d3d12Interop) {
+		AddSettingVar<&Settings::staticFrameDetection>(generalBar, "Static Frame Detection", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
+		AddSettingVar<&Settings::powerSaving>(generalBar, "Menu Power Saving", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
+		AddSettingVar<&Settings::menuFrameRateCap>(generalBar, "Menu FPS Cap", TW_TYPE_UINT32, "group='FSR4 FRAME GENERATION' min=0 max=360");
+	}
 
 	// === ANTI-LAG 2.0 ===
 	g_ENB->TwAddButton(generalBar, "--- AMD Anti-Lag 2.0 ---", NULL, NULL, "group='FSR4 FRAME GENERATION'");
 	
 	if (fidelityFX && fidelityFX->antiLagAvailable) {
 		g_ENB->TwAddButton(generalBar, "Anti-Lag: Available", NULL, NULL, "group='FSR4 FRAME GENERATION'");
-		g_ENB->TwAddVarRW(generalBar, "Enable Anti-Lag 2.0", TW_TYPE_BOOL32, &settings.antiLagEnabled, "group='FSR4 FRAME GENERATION'");
-		// Sync setting to FidelityFX handler
-		fidelityFX->antiLagEnabled = (settings.antiLagEnabled != 0);
+		AddSettingVar<&Settings::antiLagEnabled>(generalBar, "Enable Anti-Lag 2.0", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
 	} else {
 		g_ENB->TwAddButton(generalBar, "Anti-Lag: Not Available", NULL, NULL, "group='FSR4 FRAME GENERATION'");
 		g_ENB->TwAddButton(generalBar, "(Requires AMD GPU + Driver)", NULL, NULL, "group='FSR4 FRAME GENERATION'");
 	}
 
-	g_ENB->TwAddButton(generalBar, "Restart game to apply changes", NULL, NULL, "group='FSR4 FRAME GENERATION'");
+	// === VRAM BUDGET ===
+	if (d3d12Interop) {
+		g_ENB->TwAddButton(generalBar, "--- VRAM Budget ---", NULL, NULL, "group='FSR4 FRAME GENERATION'");
+		AddSettingVar<&Settings::adaptiveVram>(generalBar, "Adaptive VRAM", TW_TYPE_BOOL32, "group='FSR4 FRAME GENERATION'");
+		g_ENB->TwAddVarCB(generalBar, "Plugin VRAM (MB)", TW_TYPE_FLOAT, nullptr, GetPluginVramCallback, nullptr, "group='FSR4 FRAME GENERATION' precision=0");
+		g_ENB->TwAddVarCB(generalBar, "Process VRAM (MB)", TW_TYPE_FLOAT, nullptr, GetProcessVramCallback, nullptr, "group='FSR4 FRAME GENERATION' precision=0");
+		g_ENB->TwAddVarCB(generalBar, "VRAM Budget (MB)", TW_TYPE_FLOAT, nullptr, GetVramBudgetCallback, nullptr, "group='FSR4 FRAME GENERATION' precision=0");
+		g_ENB->TwAddVarCB(generalBar, "VRAM Downgrade Level", TW_TYPE_UINT32, nullptr, GetVramLevelCallback, nullptr, "group='FSR4 FRAME GENERATION'");
+	}
+
+	// === FRAME CAPTURE ===
+	if (d3d12Interop) {
+		g_ENB->TwAddButton(generalBar, "--- Frame Capture ---", NULL, NULL, "group='FSR4 FRAME GENERATION'");
+		AddSettingVar<&Settings::captureFrameCount>(generalBar, "Capture Frame Count", TW_TYPE_UINT32, "group='FSR4 FRAME GENERATION' min=1 max=600");
+		g_ENB->TwAddButton(generalBar, "Capture Frames", CaptureFramesCallback, nullptr, "group='FSR4 FRAME GENERATION'");
+	}
+
+	// Everything except installing the D3D12 proxy itself is applied at runtime
+	if (!d3d12Interop)
+		g_ENB->TwAddButton(generalBar, "Restart game to apply changes", NULL, NULL, "group='FSR4 FRAME GENERATION'");
 }
 
-ID3D11DeviceChild* CompileShader(const wchar_t* FilePath, const char* ProgramType, const char* Program = "main")
+namespace
 {
-	auto device = DX::GetDevice();
-	if (!device)
-		return nullptr;
+	constexpr const char* kShaderCacheDir = "Data/SKSE/Plugins/FSR4_Skyrim/ShaderCache";
+	constexpr uint32_t kShaderCompileFlags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
 
-	// Compiler setup
-	uint32_t flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+	// Loose .hlsl files override the embedded bytecode, searched in the same places as before
+	std::filesystem::path FindShaderOverride(const std::string& a_fileName)
+	{
+		for (auto directory : { "Data/SKSE/Plugins/", "Data/SKSE/Plugins/FSR4_Skyrim/", "" }) {
+			std::filesystem::path path = directory + a_fileName;
+			if (std::filesystem::exists(path))
+				return path;
+		}
+		return {};
+	}
 
-	ID3DBlob* shaderBlob;
-	ID3DBlob* shaderErrors;
+	bool CompileShaderOverride(const std::filesystem::path& a_path, const char* a_entry, const char* a_profile, std::vector<uint8_t>& a_bytecode)
+	{
+		std::ifstream stream(a_path, std::ios::binary);
+		std::string source((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		if (source.empty()) {
+			logger::error("[Shaders] Failed to read {}", a_path.string());
+			return false;
+		}
 
-	std::string str;
-	std::wstring path{ FilePath };
-	std::transform(path.begin(), path.end(), std::back_inserter(str), [](wchar_t c) {
-		return (char)c;
-	});
-	if (!std::filesystem::exists(FilePath)) {
-		logger::error("Failed to compile shader; {} does not exist", str);
-		return nullptr;
+		// Includes are not part of the key; overrides are expected to be self-contained
+		auto key = ShaderCache::ComputeKey({ source, a_entry, a_profile, kShaderCompileFlags, D3D_COMPILER_VERSION });
+		auto cachePath = std::filesystem::path(kShaderCacheDir) / a_path.filename().replace_extension(".bin");
+		if (ShaderCache::Load(cachePath, key, a_bytecode)) {
+			logger::info("[Shaders] {} loaded from cache", a_path.string());
+			return true;
+		}
+
+		winrt::com_ptr<ID3DBlob> shaderBlob;
+		winrt::com_ptr<ID3DBlob> shaderErrors;
+		auto sourceName = a_path.string();
+		if (FAILED(D3DCompile(source.data(), source.size(), sourceName.c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, a_entry, a_profile, kShaderCompileFlags, 0, shaderBlob.put(), shaderErrors.put()))) {
+			logger::warn("[Shaders] Compilation of {} failed:\n\n{}", sourceName, shaderErrors ? static_cast<char*>(shaderErrors->GetBufferPointer()) : "Unknown error");
+			return false;
+		}
+		if (shaderErrors)
+			logger::debug("[Shaders] Shader logs:\n{}", static_cast<char*>(shaderErrors->GetBufferPointer()));
+
+		auto bytes = static_cast<const uint8_t*>(shaderBlob->GetBufferPointer());
+		a_bytecode.assign(bytes, bytes + shaderBlob->GetBufferSize());
+		if (!ShaderCache::Store(cachePath, key, a_bytecode))
+			logger::warn("[Shaders] Failed to write {}", cachePath.string());
+		logger::info("[Shaders] {} compiled", sourceName);
+		return true;
 	}
-	if (FAILED(D3DCompileFromFile(FilePath, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, Program, ProgramType, flags, 0, &shaderBlob, &shaderErrors))) {
-		logger::warn("Shader compilation failed:\n\n{}", shaderErrors ? static_cast<char*>(shaderErrors->GetBufferPointer()) : "Unknown error");
-		if (shaderErrors) shaderErrors->Release();
-		return nullptr;
+
+	// Prefers a loose override, falls back to the bytecode compiled into the DLL
+	ID3D11ComputeShader* LoadComputeShader(const std::string& a_name, std::span<const uint8_t> a_embedded)
+	{
+		auto device = DX::GetDevice();
+		if (!device)
+			return nullptr;
+
+		std::vector<uint8_t> bytecode;
+		auto overridePath = FindShaderOverride(a_name + ".hlsl");
+		if (overridePath.empty() || !CompileShaderOverride(overridePath, "main", "cs_5_0", bytecode)) {
+			if (a_embedded.empty()) {
+				logger::error("[Shaders] {} has no embedded bytecode and no usable .hlsl", a_name);
+				return nullptr;
+			}
+			bytecode.assign(a_embedded.begin(), a_embedded.end());
+		}
+
+		ID3D11ComputeShader* shader = nullptr;
+		HRESULT hr = device->CreateComputeShader(bytecode.data(), bytecode.size(), nullptr, &shader);
+		if (FAILED(hr)) {
+			logger::error("[Shaders] Failed to create {} (HRESULT: {:08X})", a_name, (uint32_t)hr);
+			return nullptr;
+		}
+		return shader;
 	}
-	if (shaderErrors) {
-		logger::debug("Shader logs:\n{}", static_cast<char*>(shaderErrors->GetBufferPointer()));
-		shaderErrors->Release();
+
+	ID3D11ComputeShader* LoadCopyDepthShader()
+	{
+#ifndef FSR4_NO_EMBEDDED_SHADERS
+		return LoadComputeShader("CopyDepthToSharedBufferCS", g_CopyDepthToSharedBufferCS);
+#else
+		return LoadComputeShader("CopyDepthToSharedBufferCS", {});
+#endif
 	}
 
-	if (!shaderBlob) {
-		return nullptr;
+	ID3D11ComputeShader* LoadTileHashShader()
+	{
+#ifndef FSR4_NO_EMBEDDED_SHADERS
+		return LoadComputeShader("TileHashCS", g_TileHashCS);
+#else
+		return LoadComputeShader("TileHashCS", {});
+#endif
 	}
 
-	ID3D11ComputeShader* regShader = nullptr;
-	HRESULT hr = device->CreateComputeShader(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize(), nullptr, &regShader);
-	shaderBlob->Release();
+	// Matches the cbuffer in TileHashCS.hlsl
+	struct TileHashConstants
+	{
+		uint32_t width;
+		uint32_t height;
+		float motionScaleX;
+		float motionScaleY;
+		uint32_t tilesX;
+		uint32_t padding[3];
+	};
+}
 
-	if (FAILED(hr)) {
-		logger::error("Failed to create compute shader (HRESULT: {:08X})", (uint32_t)hr);
-		return nullptr;
+#ifndef NDEBUG
+void Upscaling::StartShaderWatcher()
+{
+	constexpr const char* kOverrideShaders[] = { "CopyDepthToSharedBufferCS", "TileHashCS" };
+	static_assert(std::size(kOverrideShaders) == std::extent_v<decltype(shaderWatchers)>);
+
+	for (size_t i = 0; i < std::size(kOverrideShaders); i++) {
+		// Watch the first search location when there is no override yet, so creating one also reloads
+		auto fileName = std::string(kOverrideShaders[i]) + ".hlsl";
+		auto path = FindShaderOverride(fileName);
+		if (path.empty())
+			path = "Data/SKSE/Plugins/" + fileName;
+
+		bool started = shaderWatchers[i].Start(path, [this]() { shaderReloadRequested.store(true); });
+		if (started)
+			logger::info("[Shaders] Watching {} for changes", path.string());
 	}
+}
 
-	return regShader;
+void Upscaling::ReloadShadersIfRequested()
+{
+	if (!shaderReloadRequested.exchange(false))
+		return;
+
+	// Both are reloaded, the unchanged one comes from the cache. Keep the old shader if none loads.
+	auto swap = [](ID3D11ComputeShader*& a_current, ID3D11ComputeShader* a_shader, const char* a_name) {
+		if (!a_shader)
+			return;
+		if (a_current)
+			a_current->Release();
+		a_current = a_shader;
+		logger::info("[Shaders] Reloaded {}", a_name);
+	};
+	swap(copyDepthToSharedBufferCS, LoadCopyDepthShader(), "CopyDepthToSharedBufferCS");
+	swap(tileHashCS, LoadTileHashShader(), "TileHashCS");
+}
+#endif
+
+FrameContext Upscaling::CaptureFrameContext() const
+{
+	FrameContext::Inputs inputs{};
+
+	auto dx12SwapChain = DX12SwapChain::GetSingleton();
+	inputs.width = dx12SwapChain->swapChainDesc.Width;
+	inputs.height = dx12SwapChain->swapChainDesc.Height;
+	inputs.frameID = FSR4SkyrimHandler::GetSingleton()->currentFSRFrameID;
+
+	// Use game's deltaTime like ENBFrameGeneration for consistency
+	static auto s_deltaTime = (float*)REL::RelocationID(523660, 410199).address();
+	inputs.deltaTimeSeconds = s_deltaTime ? *s_deltaTime : 0.0f;
+
+	// Use static memory addresses like ENBFrameGeneration for stability during loading
+	static auto s_cameraNear = (float*)(REL::RelocationID(517032, 403540).address() + 0x40);
+	static auto s_cameraFar = (float*)(REL::RelocationID(517032, 403540).address() + 0x44);
+	inputs.cameraNear = s_cameraNear ? *s_cameraNear : 0.0f;
+	inputs.cameraFar = s_cameraFar ? *s_cameraFar : 0.0f;
+
+	if (inputs.width && inputs.height)
+		inputs.fovVerticalRad = GetVerticalFOVRad();
+
+	// Jitter is read back from projectionPosScaleX/Y like ENBFrameGeneration does
+	if (auto state = RE::BSGraphics::State::GetSingleton()) {
+		auto gameViewport = reinterpret_cast<StateEx*>(state);
+		inputs.projectionPosScaleX = gameViewport->projectionPosScaleX;
+		inputs.projectionPosScaleY = gameViewport->projectionPosScaleY;
+	}
+
+	// Using multiple null checks to avoid accessing invalid memory during loading
+	auto camera = RE::PlayerCamera::GetSingleton();
+	auto cameraRoot = camera ? camera->cameraRoot.get() : nullptr;
+	if (cameraRoot) {
+		auto& world = cameraRoot->world;
+		inputs.hasCamera = true;
+		inputs.cameraPosition[0] = world.translate.x;
+		inputs.cameraPosition[1] = world.translate.y;
+		inputs.cameraPosition[2] = world.translate.z;
+		for (int i = 0; i < 3; i++) {
+			inputs.cameraRight[i] = world.rotate.entry[i][0];
+			inputs.cameraForward[i] = world.rotate.entry[i][1];
+			inputs.cameraUp[i] = world.rotate.entry[i][2];
+		}
+	}
+
+	return FrameContext::Make(inputs);
+}
+
+FrameContext Upscaling::GetFrameContext() const
+{
+	// Normally the snapshot published by UpdateJitter for the current frame.
+	// Only re-capture if UpdateJitter did not run for this frame (e.g. during loading).
+	auto ctx = frameContext.Read();
+	if (ctx.frameID != FSR4SkyrimHandler::GetSingleton()->currentFSRFrameID)
+		ctx = CaptureFrameContext();
+	return ctx;
 }
 
 void Upscaling::UpdateJitter()
@@ -165,6 +472,10 @@ void Upscaling::UpdateJitter()
 	// Reset earlyCopy flag at the start of jitter update (frame start)
 	earlyCopy = false;
 
+#ifndef NDEBUG
+	ReloadShadersIfRequested();
+#endif
+
 	try {
 		auto state = RE::BSGraphics::State::GetSingleton();
 		if (!state) {
@@ -174,33 +485,61 @@ void Upscaling::UpdateJitter()
 		auto gameViewport = reinterpret_cast<StateEx*>(state);
 
 		auto ffx = FSR4SkyrimHandler::GetSingleton();
-		if (!ffx->upscaleInitialized) {
-			return;
-		}
-
-		ffxQueryDescUpscaleGetJitterOffset queryDesc = {};
-		queryDesc.header.type = FFX_API_QUERY_DESC_TYPE_UPSCALE_GETJITTEROFFSET;
-		// Now using CORRECT frameCount offset (0x4C) from ArranzCNL/CommonLibSSE-NG
-		queryDesc.index = gameViewport->frameCount; 
-		queryDesc.phaseCount = 8;
-		queryDesc.pOutX = &jitter.x;
-		queryDesc.pOutY = &jitter.y;
-
-		auto queryResult = ffx::Query(ffx->upscaleContext, queryDesc);
-		if (queryResult != ffx::ReturnCode::Ok) {
-			return;
-		}
-
 		auto dx12SwapChain = DX12SwapChain::GetSingleton();
 		uint32_t screenWidth = dx12SwapChain->swapChainDesc.Width;
 		uint32_t screenHeight = dx12SwapChain->swapChainDesc.Height;
 
-		if (screenWidth == 0 || screenHeight == 0)
-			return;
+		if (ffx->upscaleInitialized && screenWidth != 0 && screenHeight != 0) {
+			// Native AA: render and display size are the same. The static frame detector compares frames
+			// one jitter cycle apart, so it follows the same count.
+			int32_t phaseCount = 0;
+			ffxQueryDescUpscaleGetJitterPhaseCount phaseDesc = {};
+			phaseDesc.header.type = FFX_API_QUERY_DESC_TYPE_UPSCALE_GETJITTERPHASECOUNT;
+			phaseDesc.renderWidth = screenWidth;
+			phaseDesc.displayWidth = screenWidth;
+			phaseDesc.pOutPhaseCount = &phaseCount;
+			if (ffx::Query(ffx->upscaleContext, phaseDesc) == ffx::ReturnCode::Ok && phaseCount > 0)
+				jitterPhaseCount = uint32_t(phaseCount);
+			staticFrameDetector.SetJitterPhases(jitterPhaseCount);
+
+			ffxQueryDescUpscaleGetJitterOffset queryDesc = {};
+			queryDesc.header.type = FFX_API_QUERY_DESC_TYPE_UPSCALE_GETJITTEROFFSET;
+			// Now using CORRECT frameCount offset (0x4C) from ArranzCNL/CommonLibSSE-NG
+			queryDesc.index = gameViewport->frameCount;
+			queryDesc.phaseCount = int32_t(jitterPhaseCount);
+			queryDesc.pOutX = &jitter.x;
+			queryDesc.pOutY = &jitter.y;
+
+			auto queryResult = ffx::Query(ffx->upscaleContext, queryDesc);
+			if (queryResult == ffx::ReturnCode::Ok) {
+				// Now writing to CORRECT offsets (0x44, 0x48)
+				gameViewport->projectionPosScaleX = -2.0f * jitter.x / (float)screenWidth;
+				gameViewport->projectionPosScaleY = 2.0f * jitter.y / (float)screenHeight;
+			}
+		}
 
-		// Now writing to CORRECT offsets (0x44, 0x48)
-		gameViewport->projectionPosScaleX = -2.0f * jitter.x / (float)screenWidth;
-		gameViewport->projectionPosScaleY = 2.0f * jitter.y / (float)screenHeight;
+		// Snapshot everything later stages of this frame need, after the jitter has been written
+		auto ctx = CaptureFrameContext();
+
+		SceneCutDetector::Sample sample{};
+		sample.hasCamera = ctx.hasCamera;
+		std::copy_n(ctx.cameraPosition, 3, sample.position);
+		std::copy_n(ctx.cameraRight, 3, sample.right);
+		std::copy_n(ctx.cameraForward, 3, sample.forward);
+		std::copy_n(ctx.cameraUp, 3, sample.up);
+		sample.fovVerticalRad = ctx.fovVerticalRad;
+		sample.deltaTimeMs = ctx.deltaTimeMs;
+
+		auto decision = sceneCutDetector.Update(sample);
+		if (decision.cut) {
+			ctx.sceneCut = true;
+			logger::info("[Upscaling] Scene cut detected at frame {} (score={:.2f}, reasons=0x{:X}), reset triggered", ctx.frameID, decision.score, decision.reasons);
+		}
+
+		ctx.jitterPhase = gameViewport->frameCount % jitterPhaseCount;
+		ctx.staticFrame = UpdateStaticFrame(ctx);
+
+		frameContext.Publish(ctx);
 	} catch (const std::exception& e) {
 		logger::critical("[Upscaling] UpdateJitter Exception: {}", e.what());
 		LOG_FLUSH();
@@ -210,6 +549,145 @@ void Upscaling::UpdateJitter()
 	}
 }
 
+bool Upscaling::UpdateStaticFrame(const FrameContext& a_frame)
+{
+	// Never waits: a change in a static image shows once its hashes arrive, a few frames later
+	if (auto context = DX::GetContext())
+		CollectTileHashes(context);
+
+	StaticFrameDetector::Camera camera;
+	camera.hasCamera = a_frame.hasCamera;
+	std::copy_n(a_frame.cameraPosition, 3, camera.position);
+	std::copy_n(a_frame.cameraRight, 3, camera.right);
+	std::copy_n(a_frame.cameraForward, 3, camera.forward);
+	std::copy_n(a_frame.cameraUp, 3, camera.up);
+
+	// Changes known right now; the tile hashes would only report them a few frames later
+	auto ui = RE::UI::GetSingleton();
+	bool paused = ui && ui->GameIsPaused();
+	bool invalidate = staticFrameInvalidated.exchange(false) || a_frame.sceneCut || paused != lastGamePaused ||
+	                  !setupBuffers || !tileHashCS || !GetSettings().staticFrameDetection;
+	lastGamePaused = paused;
+
+	bool isStatic = staticFrameDetector.BeginFrame(a_frame.frameID, camera, invalidate);
+	if (isStatic != lastStaticFrame) {
+		logger::debug("[Upscaling] {} static frames at frame {}", isStatic ? "Entering" : "Leaving", a_frame.frameID);
+		lastStaticFrame = isStatic;
+	}
+	return isStatic;
+}
+
+void Upscaling::DispatchTileHash(ID3D11DeviceContext* a_context, ID3D11ShaderResourceView* a_color, ID3D11ShaderResourceView* a_motionVectors, const FrameContext& a_frame)
+{
+	if (!tileHashCS || !a_color || !a_frame.width || !a_frame.height || !GetSettings().staticFrameDetection)
+		return;
+
+	uint32_t tilesX = StaticFrameDetector::TileCount(a_frame.width);
+	uint32_t tilesY = StaticFrameDetector::TileCount(a_frame.height);
+	if (a_frame.width != tileHashWidth || a_frame.height != tileHashHeight) {
+		auto device = DX::GetDevice();
+		if (!device)
+			return;
+
+		delete tileHashBuffer;
+		tileHashBuffer = new StructuredBuffer(StructuredBufferDesc<StaticFrameDetector::Tile>(uint64_t(tilesX) * tilesY), tilesX * tilesY);
+		tileHashBuffer->CreateUAV();
+
+		D3D11_BUFFER_DESC desc{};
+		desc.ByteWidth = UINT(sizeof(StaticFrameDetector::Tile) * tilesX * tilesY);
+		desc.Usage = D3D11_USAGE_STAGING;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		for (auto& readback : tileHashReadbacks) {
+			readback = {};
+			DX::ThrowIfFailed(device->CreateBuffer(&desc, nullptr, readback.buffer.put()));
+		}
+
+		tileHashWidth = a_frame.width;
+		tileHashHeight = a_frame.height;
+		staticFrameDetector.Reset();
+	}
+
+	auto& readback = tileHashReadbacks[nextTileHashReadback];
+	if (readback.pending)
+		return;
+
+	if (!constantRing)
+		constantRing = new ConstantBufferRing();
+	TileHashConstants constants{ a_frame.width, a_frame.height, float(a_frame.width), float(a_frame.height), tilesX, {} };
+	auto binding = constantRing->Push(constants);
+	if (!binding.buffer)
+		return;
+
+	ID3D11ShaderResourceView* views[2] = { a_color, a_motionVectors };
+	a_context->CSSetShaderResources(0, ARRAYSIZE(views), views);
+	ID3D11UnorderedAccessView* uavs[1] = { tileHashBuffer->UAV() };
+	a_context->CSSetUnorderedAccessViews(0, ARRAYSIZE(uavs), uavs, nullptr);
+	constantRing->BindCS(0, binding);
+	a_context->CSSetShader(tileHashCS, nullptr, 0);
+	a_context->Dispatch(tilesX, tilesY, 1);
+	DX12SwapChain::CountCost(FrameCostRecorder::Counter::kDispatch11);
+
+	ID3D11ShaderResourceView* nullViews[2] = { nullptr, nullptr };
+	a_context->CSSetShaderResources(0, ARRAYSIZE(nullViews), nullViews);
+	ID3D11UnorderedAccessView* nullUavs[1] = { nullptr };
+	a_context->CSSetUnorderedAccessViews(0, ARRAYSIZE(nullUavs), nullUavs, nullptr);
+	ID3D11Buffer* nullBuffers[1] = { nullptr };
+	a_context->CSSetConstantBuffers(0, ARRAYSIZE(nullBuffers), nullBuffers);
+	a_context->CSSetShader(nullptr, nullptr, 0);
+
+	a_context->CopyResource(readback.buffer.get(), tileHashBuffer->Resource());
+	DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
+	readback.frameID = a_frame.frameID;
+	readback.jitterPhase = a_frame.jitterPhase;
+	readback.pending = true;
+	nextTileHashReadback = (nextTileHashReadback + 1) % kTileHashReadbacks;
+}
+
+void Upscaling::CollectTileHashes(ID3D11DeviceContext* a_context)
+{
+	// Oldest first; once one is still in flight the newer ones are too
+	uint32_t tilesX = StaticFrameDetector::TileCount(tileHashWidth);
+	uint32_t tilesY = StaticFrameDetector::TileCount(tileHashHeight);
+	for (uint32_t i = 0; i < kTileHashReadbacks; i++) {
+		auto& readback = tileHashReadbacks[(nextTileHashReadback + i) % kTileHashReadbacks];
+		if (!readback.pending)
+			continue;
+
+		D3D11_MAPPED_SUBRESOURCE mapped{};
+		HRESULT hr = a_context->Map(readback.buffer.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+		if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+			break;
+
+		readback.pending = false;
+		if (FAILED(hr))
+			continue;
+		auto tiles = static_cast<const StaticFrameDetector::Tile*>(mapped.pData);
+		staticFrameDetector.AddTiles(readback.frameID, readback.jitterPhase, tilesX, tilesY, { tiles, size_t(tilesX) * tilesY });
+		a_context->Unmap(readback.buffer.get(), 0);
+	}
+}
+
+void Upscaling::CopyMotionVectors(ID3D11DeviceContext* a_context)
+{
+	auto renderer = RE::BSGraphics::Renderer::GetSingleton();
+	auto ui = RE::UI::GetSingleton();
+	if (ui && ui->GameIsPaused()) {
+		// Clear MV when paused, once: nothing else writes the buffer until the next copy
+		float clearColor[4] = { 0, 0, 0, 0 };
+		if (motionVectorBufferShared && motionVectorBufferShared->GetRTV() && clearedMotionVectors != motionVectorBufferShared) {
+			a_context->ClearRenderTargetView(motionVectorBufferShared->GetRTV(), clearColor);
+			clearedMotionVectors = motionVectorBufferShared;
+		}
+	} else {
+		auto& motionVector = renderer->data.renderTargets[RE::RENDER_TARGETS::kMOTION_VECTOR];
+		if (motionVector.texture && motionVectorBufferShared && motionVectorBufferShared->resource11) {
+			a_context->CopyResource(motionVectorBufferShared->resource11, (ID3D11Resource*)motionVector.texture);
+			DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
+			clearedMotionVectors = nullptr;
+		}
+	}
+}
+
 void Upscaling::InvalidateResources()
 {
 	logger::info("[Upscaling] InvalidateResources: Releasing shared resources...");
@@ -219,33 +697,96 @@ void Upscaling::InvalidateResources()
 	setupBuffers = false;
 	
 	// Release all shared resources to prevent stale pointer access
-	// These will be recreated in CreateFrameGenerationResources on next valid frame
-	if (HUDLessBufferShared) {
-		delete HUDLessBufferShared;
-		HUDLessBufferShared = nullptr;
-	}
-	if (upscaledBufferShared) {
-		delete upscaledBufferShared;
-		upscaledBufferShared = nullptr;
-	}
-	if (depthBufferShared) {
-		delete depthBufferShared;
-		depthBufferShared = nullptr;
-	}
-	if (motionVectorBufferShared) {
-		delete motionVectorBufferShared;
-		motionVectorBufferShared = nullptr;
-	}
+	// These will be recreated in CreateFrameGenerationResources on next valid frame, from the pool
+	// when nothing changed. Whatever the pool evicts is freed by the release queue once the fence passed
+	for (auto resource : { &HUDLessBufferShared, &upscaledBufferShared, &depthBufferShared, &motionVectorBufferShared })
+		ReleaseSharedResource(*resource);
 	
 	// Reset early copy flag
 	earlyCopy = false;
+
+	// Nothing the new buffers hold can be reused
+	aaOutputCurrent = false;
+	clearedMotionVectors = nullptr;
+	staticFrameInvalidated.store(true);
 	
 	logger::info("[Upscaling] InvalidateResources: All shared resources released.");
 	LOG_FLUSH();
 }
 
+void Upscaling::RetireSharedResources()
+{
+	// Switched off by the lifecycle manager; keeps the TAA hooks from creating them again
+	sharedResourcesEnabled = false;
+	InvalidateResources();
+	sharedResourcePool.Clear();
+}
+
+void Upscaling::UpdateSharedResourceLayout(bool a_antiAliasing, bool a_compactFormats)
+{
+	layoutAntiAliasing = a_antiAliasing;
+	layoutCompactFormats = a_compactFormats;
+
+	if (!sharedResourcesEnabled)
+		return;
+
+	// Under VRAM pressure idle textures are the first thing to go
+	if (a_compactFormats)
+		sharedResourcePool.Clear();
+
+	if (!a_antiAliasing && upscaledBufferShared)
+		ReleaseSharedResource(upscaledBufferShared);
+
+	// Depth in the wrong format is dropped and copied again next frame
+	if (depthBufferShared && depthBufferShared->resource->GetDesc().Format != GetSharedDepthFormat()) {
+		ReleaseSharedResource(depthBufferShared);
+		setupBuffers = false;
+	}
+
+	// Lazy creation in the TAA hooks adds the missing AA output
+	if (a_antiAliasing && !upscaledBufferShared)
+		setupBuffers = false;
+}
+
+WrappedResource* Upscaling::CreateSharedResource(const D3D11_TEXTURE2D_DESC& a_desc, uint32_t a_usage)
+{
+	auto dx12SwapChain = DX12SwapChain::GetSingleton();
+	WrappedResource* resource = nullptr;
+	if (auto pooled = sharedResourcePool.Acquire(MakeTextureKey(a_desc, a_usage, true))) {
+		resource = *pooled;
+		logger::debug("[FSR4] Reused pooled {}x{} texture, {} pooled hits", a_desc.Width, a_desc.Height, sharedResourcePool.GetStats().hits);
+	} else {
+		resource = new WrappedResource(a_desc, a_usage, dx12SwapChain->d3d11Device.get(), dx12SwapChain->d3d12Device.get());
+	}
+	dx12SwapChain->TrackAllocation(resource, "Shared Resources");
+	return resource;
+}
+
+void Upscaling::ReleaseSharedResource(WrappedResource*& a_resource)
+{
+	if (!a_resource)
+		return;
+
+	D3D11_TEXTURE2D_DESC desc{};
+	a_resource->resource11->GetDesc(&desc);
+	auto dx12SwapChain = DX12SwapChain::GetSingleton();
+	auto bytes = dx12SwapChain->GetAllocationSize(a_resource);
+	dx12SwapChain->TrackAllocation(a_resource, "Pooled");
+	sharedResourcePool.Release(MakeTextureKey(desc, a_resource->usage, true), a_resource, bytes);
+	a_resource = nullptr;
+}
+
+void Upscaling::EvictSharedResource(WrappedResource* a_resource)
+{
+	DX12SwapChain::GetSingleton()->DeferRelease(a_resource);
+}
+
 void Upscaling::CreateFrameGenerationResources()
 {
+	// Switched off at runtime (frame generation and AA both disabled) or old set still retiring
+	if (!sharedResourcesEnabled)
+		return;
+
 	logger::info("[Upscaling] CreateFrameGenerationResources Entry");
 	LOG_FLUSH();
 	try {
@@ -277,20 +818,25 @@ void Upscaling::CreateFrameGenerationResources()
 		D3D11_TEXTURE2D_DESC texDesc{};
 		main.texture->GetDesc(&texDesc);
 
-		// Common flags for shared resources
-		texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET | D3D11_BIND_UNORDERED_ACCESS;
-		texDesc.MiscFlags = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
+		// Bind flags follow from the usage passed to CreateSharedResource
 		texDesc.Usage = D3D11_USAGE_DEFAULT;
 		texDesc.CPUAccessFlags = 0;
 
+		// Only buffers that are missing are created, e.g. the AA output after AA was switched back on
+
 		// HUDLess & Upscaled (R8G8B8A8_UNORM)
+		// Without AA the upscaled buffer would only mirror HUDLess, FG reads HUDLess directly instead
 		texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		HUDLessBufferShared = new WrappedResource(texDesc, dx12SwapChain->d3d11Device.get(), dx12SwapChain->d3d12Device.get());
-		upscaledBufferShared = new WrappedResource(texDesc, dx12SwapChain->d3d11Device.get(), dx12SwapChain->d3d12Device.get());
+		// Without AA the tile hash reads HUDLess in D3D11
+		if (!HUDLessBufferShared)
+			HUDLessBufferShared = CreateSharedResource(texDesc, ResourceUsage::kCopy11 | ResourceUsage::kShaderRead11 | ResourceUsage::kShaderRead12);
+		if (!upscaledBufferShared && layoutAntiAliasing)
+			upscaledBufferShared = CreateSharedResource(texDesc, ResourceUsage::kShaderWrite12 | ResourceUsage::kShaderRead12 | ResourceUsage::kCopy11);
 
-		// Depth (R32_FLOAT)
-		texDesc.Format = DXGI_FORMAT_R32_FLOAT;
-		depthBufferShared = new WrappedResource(texDesc, dx12SwapChain->d3d11Device.get(), dx12SwapChain->d3d12Device.get());
+		// Depth (R32_FLOAT, R16_FLOAT under VRAM pressure)
+		texDesc.Format = GetSharedDepthFormat();
+		if (!depthBufferShared)
+			depthBufferShared = CreateSharedResource(texDesc, ResourceUsage::kShaderWrite11 | ResourceUsage::kShaderRead12);
 
 		// Motion Vectors (Original Format)
 		auto& motionVectorRT = renderer->data.renderTargets[RE::RENDER_TARGETS::kMOTION_VECTOR];
@@ -302,30 +848,27 @@ void Upscaling::CreateFrameGenerationResources()
 		D3D11_TEXTURE2D_DESC texDescMV{};
 		motionVectorRT.texture->GetDesc(&texDescMV);
 		texDesc.Format = texDescMV.Format;
-		motionVectorBufferShared = new WrappedResource(texDesc, dx12SwapChain->d3d11Device.get(), dx12SwapChain->d3d12Device.get());
+		if (!motionVectorBufferShared)
+			motionVectorBufferShared = CreateSharedResource(texDesc, ResourceUsage::kRenderTarget11 | ResourceUsage::kCopy11 | ResourceUsage::kShaderRead12);
 
-		// Find and compile depth copy shader
-		std::wstring shaderPath = L"Data/SKSE/Plugins/CopyDepthToSharedBufferCS.hlsl";
-		if (!std::filesystem::exists(shaderPath)) {
-			shaderPath = L"Data/SKSE/Plugins/FSR4_Skyrim/CopyDepthToSharedBufferCS.hlsl";
-		}
-		if (!std::filesystem::exists(shaderPath)) {
-			shaderPath = L"CopyDepthToSharedBufferCS.hlsl";
-		}
-
-		if (!std::filesystem::exists(shaderPath)) {
-			logger::error("[FSR4] CopyDepthToSharedBufferCS.hlsl not found!");
-			LOG_FLUSH();
-		}
+		const auto& poolStats = sharedResourcePool.GetStats();
+		logger::info("[FSR4] Texture pool: {} idle ({:.1f} MB), {} reused, {} created, {} evicted",
+			sharedResourcePool.IdleCount(), double(sharedResourcePool.IdleBytes()) / (1024.0 * 1024.0), poolStats.hits, poolStats.misses, poolStats.evictions);
+		dx12SwapChain->LogVramBudget();
 
-		copyDepthToSharedBufferCS = (ID3D11ComputeShader*)CompileShader(shaderPath.c_str(), "cs_5_0");
+		if (!copyDepthToSharedBufferCS)
+			copyDepthToSharedBufferCS = LoadCopyDepthShader();
+		// Optional, without it frames are simply never static
+		if (!tileHashCS)
+			tileHashCS = LoadTileHashShader();
+		staticFrameInvalidated.store(true);
 
 		if (copyDepthToSharedBufferCS) {
 			logger::info("[FSR4] Resources initialized successfully.");
 			LOG_FLUSH();
 			setupBuffers = true;
 		} else {
-			logger::error("[FSR4] Depth shader compilation failed.");
+			logger::error("[FSR4] Depth copy shader could not be loaded.");
 			LOG_FLUSH();
 		}
 	} catch (const std::exception& e) {
@@ -360,7 +903,7 @@ void Upscaling::EarlyCopyBuffersToSharedResources()
 	auto context = reinterpret_cast<ID3D11DeviceContext*>(renderer->data.context);
 	if (!context) return;
 	
-	auto dx12SwapChain = DX12SwapChain::GetSingleton();
+	auto frame = GetFrameContext();
 
 	// NOTE: Do NOT copy MV here! MV is only valid after TAA pass renders it.
 	// EarlyCopy happens BEFORE TAA, so MV would be stale/zero.
@@ -369,20 +912,22 @@ void Upscaling::EarlyCopyBuffersToSharedResources()
 	// Only copy Depth in EarlyCopy (Depth is valid at this point)
 	{
 		// Use kPOST_ZPREPASS_COPY (index 8) for stability as it is a dedicated copy for shader sampling
+		// Static frames reuse what is already in the shared buffers
 		auto& depth = renderer->data.depthStencils[RE::RENDER_TARGETS_DEPTHSTENCIL::kPOST_ZPREPASS_COPY];
-		if (depth.depthSRV && copyDepthToSharedBufferCS && depthBufferShared && depthBufferShared->uav) {
-			uint32_t dispatchX = (uint32_t)std::ceil(float(dx12SwapChain->swapChainDesc.Width) / 8.0f);
-			uint32_t dispatchY = (uint32_t)std::ceil(float(dx12SwapChain->swapChainDesc.Height) / 8.0f);
+		if (!frame.staticFrame && depth.depthSRV && copyDepthToSharedBufferCS && depthBufferShared && depthBufferShared->GetUAV()) {
+			uint32_t dispatchX = (uint32_t)std::ceil(float(frame.width) / 8.0f);
+			uint32_t dispatchY = (uint32_t)std::ceil(float(frame.height) / 8.0f);
 
 			ID3D11ShaderResourceView* views[1] = { depth.depthSRV };
 			context->CSSetShaderResources(0, ARRAYSIZE(views), views);
 
-			ID3D11UnorderedAccessView* uavs[1] = { depthBufferShared->uav };
+			ID3D11UnorderedAccessView* uavs[1] = { depthBufferShared->GetUAV() };
 			context->CSSetUnorderedAccessViews(0, ARRAYSIZE(uavs), uavs, nullptr);
 
 			context->CSSetShader(copyDepthToSharedBufferCS, nullptr, 0);
 
 			context->Dispatch(dispatchX, dispatchY, 1);
+			DX12SwapChain::CountCost(FrameCostRecorder::Counter::kDispatch11);
 
 			// Explicitly clear states instead of potentially crashing SetDirtyStates during loading
 			ID3D11ShaderResourceView* nullViews[1] = { nullptr };
@@ -410,6 +955,7 @@ void Upscaling::ReplaceTAA()
 	if (!state) return;
 
 	auto dx12SwapChain = DX12SwapChain::GetSingleton();
+	auto frame = GetFrameContext();
 
 	try {
 		auto renderer = RE::BSGraphics::Renderer::GetSingleton();
@@ -462,6 +1008,27 @@ void Upscaling::ReplaceTAA()
 		inputTextureSRV->GetResource(&inputTextureResource);
 		outputTextureRTV->GetResource(&outputTextureResource);
 
+		// Hashed on every frame, static ones included: the hashes are what ends a static run.
+		// Motion vectors are unbound while paused, like the cleared copy FSR sees.
+		{
+			auto ui = RE::UI::GetSingleton();
+			bool paused = ui && ui->GameIsPaused();
+			auto& motionVector = renderer->data.renderTargets[RE::RENDER_TARGETS::kMOTION_VECTOR];
+			DispatchTileHash(context, inputTextureSRV, paused ? nullptr : motionVector.SRV, frame);
+		}
+
+		// Static frame: the AA output of an earlier frame is still current, no copies and no AA roundtrip
+		if (frame.staticFrame && aaOutputCurrent && upscaledBufferShared && upscaledBufferShared->resource11 && outputTextureResource) {
+			context->CopyResource(outputTextureResource, upscaledBufferShared->resource11);
+			DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
+
+			if (inputTextureResource) inputTextureResource->Release();
+			outputTextureResource->Release();
+			SetDirtyStates(true);
+			earlyCopy = false;
+			return;
+		}
+
 		// ========================================================================
 		// Copy resources to shared buffers for FSR4 (D3D12)
 		// ========================================================================
@@ -470,36 +1037,26 @@ void Upscaling::ReplaceTAA()
 		// This is the KEY CHANGE: we use the TAA INPUT, not post-TAA framebuffer!
 		if (inputTextureResource && HUDLessBufferShared && HUDLessBufferShared->resource11) {
 			context->CopyResource(HUDLessBufferShared->resource11, inputTextureResource);
+			DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
 		}
 		
 		// 2. Copy Motion Vectors
-		{
-			auto ui = RE::UI::GetSingleton();
-			if (ui && ui->GameIsPaused()) {
-				float clearColor[4] = { 0, 0, 0, 0 };
-				if (motionVectorBufferShared && motionVectorBufferShared->rtv)
-					context->ClearRenderTargetView(motionVectorBufferShared->rtv, clearColor);
-			} else {
-				auto& motionVector = renderer->data.renderTargets[RE::RENDER_TARGETS::kMOTION_VECTOR];
-				if (motionVector.texture && motionVectorBufferShared && motionVectorBufferShared->resource11) {
-					context->CopyResource(motionVectorBufferShared->resource11, (ID3D11Resource*)motionVector.texture);
-				}
-			}
-		}
+		CopyMotionVectors(context);
 		
 		// 3. Copy Depth (if not done by EarlyCopy)
 		if (!earlyCopy) {
 			auto& depth = renderer->data.depthStencils[RE::RENDER_TARGETS_DEPTHSTENCIL::kPOST_ZPREPASS_COPY];
-			if (depth.depthSRV && copyDepthToSharedBufferCS && depthBufferShared && depthBufferShared->uav) {
-				uint32_t dispatchX = (uint32_t)std::ceil(float(dx12SwapChain->swapChainDesc.Width) / 8.0f);
-				uint32_t dispatchY = (uint32_t)std::ceil(float(dx12SwapChain->swapChainDesc.Height) / 8.0f);
+			if (depth.depthSRV && copyDepthToSharedBufferCS && depthBufferShared && depthBufferShared->GetUAV()) {
+				uint32_t dispatchX = (uint32_t)std::ceil(float(frame.width) / 8.0f);
+				uint32_t dispatchY = (uint32_t)std::ceil(float(frame.height) / 8.0f);
 
 				ID3D11ShaderResourceView* views[1] = { depth.depthSRV };
 				context->CSSetShaderResources(0, ARRAYSIZE(views), views);
-				ID3D11UnorderedAccessView* uavs[1] = { depthBufferShared->uav };
+				ID3D11UnorderedAccessView* uavs[1] = { depthBufferShared->GetUAV() };
 				context->CSSetUnorderedAccessViews(0, ARRAYSIZE(uavs), uavs, nullptr);
 				context->CSSetShader(copyDepthToSharedBufferCS, nullptr, 0);
 				context->Dispatch(dispatchX, dispatchY, 1);
+				DX12SwapChain::CountCost(FrameCostRecorder::Counter::kDispatch11);
 
 				// Clear compute shader state
 				ID3D11ShaderResourceView* nullViews[1] = { nullptr };
@@ -551,16 +1108,20 @@ void Upscaling::ReplaceTAA()
 				// upscaledBufferShared->resource11 contains the AA result
 				if (upscaledBufferShared->resource11 && outputTextureResource) {
 					context->CopyResource(outputTextureResource, upscaledBufferShared->resource11);
+					DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
 				}
 			} else {
 				logger::warn("[FSR4] AA dispatch failed");
 			}
 		}
 		
+		aaOutputCurrent = aaExecuted;
+
 		// Fallback: If AA didn't run, copy input to output directly (no AA)
 		if (!aaExecuted) {
 			if (inputTextureResource && outputTextureResource) {
 				context->CopyResource(outputTextureResource, inputTextureResource);
+				DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
 			}
 		}
 		
@@ -594,8 +1155,7 @@ void Upscaling::CopyBuffersToSharedResources()
 	if (!state) return;
 
 	auto gameViewport = reinterpret_cast<StateEx*>(state);
-	auto dx12SwapChain = DX12SwapChain::GetSingleton();
-	(void)dx12SwapChain; // May be unused
+	auto frame = GetFrameContext();
 
 	try {
 		// Following ENBFrameGeneration: Use renderer's context directly
@@ -621,39 +1181,29 @@ void Upscaling::CopyBuffersToSharedResources()
 		ID3D11DeviceContext* context = reinterpret_cast<ID3D11DeviceContext*>(renderer->data.context);
 		if (!context) return;
 
+		// Static frames skip the FG prepare: only HUDLess is copied, for the tile hash
 		// 1. Motion Vectors - ALWAYS copy at TAA_End (MV is only valid after TAA pass renders it)
-		{
-			auto ui = RE::UI::GetSingleton();
-			if (ui && ui->GameIsPaused()) {
-				// Clear MV when paused
-				float clearColor[4] = { 0, 0, 0, 0 };
-				if (motionVectorBufferShared && motionVectorBufferShared->rtv)
-					context->ClearRenderTargetView(motionVectorBufferShared->rtv, clearColor);
-			} else {
-				auto& motionVector = renderer->data.renderTargets[RE::RENDER_TARGETS::kMOTION_VECTOR];
-				if (motionVector.texture && motionVectorBufferShared && motionVectorBufferShared->resource11) {
-					context->CopyResource(motionVectorBufferShared->resource11, (ID3D11Resource*)motionVector.texture);
-				}
-			}
-		}
+		if (!frame.staticFrame)
+			CopyMotionVectors(context);
 
 		// 2. Depth (Only copy if not already done by EarlyCopy)
-		if (!earlyCopy) {
+		if (!earlyCopy && !frame.staticFrame) {
 			// Use kPOST_ZPREPASS_COPY as it's the depth copy intended for shader reading
 			// Index 8 in SE 1.5.97
 			auto& depth = renderer->data.depthStencils[RE::RENDER_TARGETS_DEPTHSTENCIL::kPOST_ZPREPASS_COPY];
 			
 			// FSR 4.0: Extra safety check for depth SRV
-			if (depth.depthSRV && copyDepthToSharedBufferCS && depthBufferShared && depthBufferShared->uav) {
-				uint32_t dispatchX = (uint32_t)std::ceil(float(dx12SwapChain->swapChainDesc.Width) / 8.0f);
-				uint32_t dispatchY = (uint32_t)std::ceil(float(dx12SwapChain->swapChainDesc.Height) / 8.0f);
+			if (depth.depthSRV && copyDepthToSharedBufferCS && depthBufferShared && depthBufferShared->GetUAV()) {
+				uint32_t dispatchX = (uint32_t)std::ceil(float(frame.width) / 8.0f);
+				uint32_t dispatchY = (uint32_t)std::ceil(float(frame.height) / 8.0f);
 
 				ID3D11ShaderResourceView* views[1] = { depth.depthSRV };
 				context->CSSetShaderResources(0, ARRAYSIZE(views), views);
-				ID3D11UnorderedAccessView* uavs[1] = { depthBufferShared->uav };
+				ID3D11UnorderedAccessView* uavs[1] = { depthBufferShared->GetUAV() };
 				context->CSSetUnorderedAccessViews(0, ARRAYSIZE(uavs), uavs, nullptr);
 				context->CSSetShader(copyDepthToSharedBufferCS, nullptr, 0);
 				context->Dispatch(dispatchX, dispatchY, 1);
+				DX12SwapChain::CountCost(FrameCostRecorder::Counter::kDispatch11);
 
 				ID3D11ShaderResourceView* nullViews[1] = { nullptr };
 				context->CSSetShaderResources(0, ARRAYSIZE(nullViews), nullViews);
@@ -672,11 +1222,20 @@ void Upscaling::CopyBuffersToSharedResources()
 				framebuffer.SRV->GetResource(&framebufferResource);
 				if (framebufferResource) {
 					context->CopyResource(HUDLessBufferShared->resource11, framebufferResource);
+					DX12SwapChain::CountCost(FrameCostRecorder::Counter::kCopy11);
 					framebufferResource->Release(); // GetResource adds a reference
 				}
 			}
 		}
 
+		// 4. Tile hash of the copy; the framebuffer itself may still be bound as a render target
+		{
+			auto ui = RE::UI::GetSingleton();
+			bool paused = ui && ui->GameIsPaused();
+			auto& motionVector = renderer->data.renderTargets[RE::RENDER_TARGETS::kMOTION_VECTOR];
+			DispatchTileHash(context, HUDLessBufferShared ? HUDLessBufferShared->GetSRV() : nullptr, paused ? nullptr : motionVector.SRV, frame);
+		}
+
 		// Following ENBFrameGeneration: Reset earlyCopy at the END of CopyBuffersToSharedResources
 		earlyCopy = false;
 	} catch (const std::exception& e) {
@@ -701,21 +1260,62 @@ void Upscaling::TimerSleepQPC(int64_t targetQPC)
 	} while (currentQPC.QuadPart < targetQPC);
 }
 
+PowerSaveController::Decision Upscaling::UpdatePowerSave()
+{
+	const auto& settings = GetSettings();
+	auto config = powerSave.GetConfig();
+	config.frameRateCap = float(settings.menuFrameRateCap);
+	powerSave.SetConfig(config);
+
+	LARGE_INTEGER qpf, now;
+	QueryPerformanceFrequency(&qpf);
+	QueryPerformanceCounter(&now);
+
+	auto ui = RE::UI::GetSingleton();
+	PowerSaveController::Sample sample;
+	sample.enabled = settings.powerSaving != 0;
+	sample.paused = ui && ui->GameIsPaused();
+	sample.loading = ui && ui->IsMenuOpen(RE::LoadingMenu::MENU_NAME);
+	sample.timeSeconds = double(now.QuadPart) / double(qpf.QuadPart);
+
+	auto previous = powerSave.GetState();
+	auto decision = powerSave.Update(sample);
+	if (decision.state != previous)
+		logger::info("[Upscaling] Power saving: {} -> {}", PowerSaveController::StateName(previous), PowerSaveController::StateName(decision.state));
+	return decision;
+}
+
+void Upscaling::ThrottlePowerSave()
+{
+	LARGE_INTEGER qpf, now;
+	QueryPerformanceFrequency(&qpf);
+	QueryPerformanceCounter(&now);
+
+	double wait = powerSave.Throttle(double(now.QuadPart) / double(qpf.QuadPart));
+	if (wait <= 0.0)
+		return;
+
+	// Sleep through most of the wait, the scheduler is only accurate to a millisecond or two
+	constexpr double kSpinSeconds = 0.002;
+	int64_t target = now.QuadPart + int64_t(wait * double(qpf.QuadPart));
+	if (wait > kSpinSeconds)
+		std::this_thread::sleep_for(std::chrono::duration<double>(wait - kSpinSeconds));
+	TimerSleepQPC(target);
+}
+
 void Upscaling::FrameLimiter()
 {
+	const auto& settings = GetSettings();
 	if (d3d12Interop && settings.frameLimitMode) {
-		static uint64_t frameCount = 0;
-		if (frameCount % 60 == 0) {
-			logger::info("[Upscaling] FrameLimiter active. Target Refresh Rate: {}", refreshRate);
-		}
-		frameCount++;
+		LOG_DEDUPLICATED(info, "[Upscaling] FrameLimiter active. Target Refresh Rate: {}", refreshRate);
 
 		double bestRefreshRate = refreshRate - (refreshRate * refreshRate) / 3600.0;
 
 		LARGE_INTEGER qpf;
 		QueryPerformanceFrequency(&qpf);
 
-		int64_t targetFrameTicks = int64_t(double(qpf.QuadPart) / (bestRefreshRate * (settings.frameGenerationMode ? 0.5 : 1.0)));
+		// Real frames are capped so that they plus the generated frames fill the refresh rate
+		int64_t targetFrameTicks = int64_t(double(qpf.QuadPart) / FrameGenerationRatio::LimiterFrameRate(bestRefreshRate, FSR4SkyrimHandler::GetSingleton()->generatedFrames));
 
 		static LARGE_INTEGER lastFrame = {};
 		LARGE_INTEGER timeNow;
@@ -1,7 +1,14 @@
 #pragma once
 
-#include <shared_mutex>
 #include <atomic>
+#include <mutex>
+#include "Core/FileWatcher.h"
+#include "Core/FrameContext.h"
+#include "Core/PowerSaveController.h"
+#include "Core/ResourcePool.h"
+#include "Core/RcuSnapshot.h"
+#include "Core/SceneCutDetector.h"
+#include "Core/StaticFrameDetector.h"
 #include "FidelityFX.h"
 #include "WrappedResource.h"
 
@@ -24,6 +31,9 @@ namespace RE
 	class BSImagespaceShaderISTemporalAA;
 }
 
+class ConstantBufferRing;
+class StructuredBuffer;
+
 class Upscaling
 {
 public:
@@ -33,22 +43,46 @@ public:
 		return &singleton;
 	}
 
-	std::shared_mutex fileLock;
+	std::mutex fileLock;
 	void LoadINI();
 	void SaveINI();
 	void RefreshUI();
 
+	// Hot reload of enbseries/enbframegeneration.ini while the game is running
+	FileWatcher iniWatcher;
+	void StartINIWatcher();
+
 	struct Settings
 	{
-		uint32_t frameGenerationMode = 1;
+		uint32_t frameGenerationMode = 1;  // 0 off, 1 on, 2 auto (AdaptiveFrameGeneration)
+		uint32_t frameGenerationRatio = 0;  // Generated frames per real frame, 0 auto (FrameGenerationRatio)
 		uint32_t frameLimitMode = 0;
 		uint32_t frameGenerationForceEnable = 0;
 		float sharpness = 0.5f;
 		uint32_t allowAsyncWorkloads = 1;
 		uint32_t antiLagEnabled = 1;  // AMD Anti-Lag 2.0
+		uint32_t antiAliasing = 1;    // FSR 4 native AA in place of the game's TAA
+		uint32_t adaptiveVram = 1;    // Downgrade plugin features when the VRAM budget runs out
+		uint32_t captureFrameCount = 60;  // Frames written by the Capture Frames button
+		uint32_t staticFrameDetection = 1;  // Reuse the previous output while the image does not change
+		uint32_t powerSaving = 1;           // No frame generation while a menu pauses the game
+		uint32_t menuFrameRateCap = 60;     // Frame rate cap while power saving, 0 for none
 	};
 
-	Settings settings;
+	// Immutable snapshots swapped atomically. The UI, INI loading and the file watcher publish new
+	// snapshots; the render thread reads wait-free via GetSettings() and quiesces at frame start
+	// (Main_UpdateJitter) and after Present.
+	RcuSnapshot<Settings> settings;
+
+	const Settings& GetSettings() const { return *settings.Read(); }
+	template <class F>
+	void UpdateSettings(F&& a_mutator)
+	{
+		settings.Update(std::forward<F>(a_mutator));
+		ApplySettings(settings.Copy());
+	}
+	void ApplySettings(const Settings& a_settings);
+
 	bool isWindowed = false;
 	bool lowRefreshRate = false;
 
@@ -66,19 +100,49 @@ public:
 	// TAA pre-pass Color buffer (color before TAA processing)
 	WrappedResource* preTaaColorShared = nullptr;
 
-	ID3D11ComputeShader* copyDepthToSharedBufferCS;
+	// Embedded at build time; a loose .hlsl found by FindShaderOverride replaces it and is cached as bytecode
+	ID3D11ComputeShader* copyDepthToSharedBufferCS = nullptr;
+	ID3D11ComputeShader* tileHashCS = nullptr;
+
+#ifndef NDEBUG
+	// Debug builds recompile the overrides when one is saved, swapped in at the start of the next frame.
+	// One watcher per override-capable shader: CopyDepthToSharedBufferCS, TileHashCS
+	FileWatcher shaderWatchers[2];
+	std::atomic<bool> shaderReloadRequested{ false };
+	void StartShaderWatcher();
+	void ReloadShadersIfRequested();
+#endif
 
 	bool useHUDLess = false;
 	bool earlyCopy = false;
 
 	bool setupBuffers = false;
+
+	// Owned by the lifecycle manager: false while the shared resources are switched off or retiring,
+	// which keeps the lazy creation in the TAA hooks from allocating them again
+	bool sharedResourcesEnabled = false;
+	void RetireSharedResources();
+	// Adds or drops the AA output buffer and switches the depth copy between R32 and R16
+	void UpdateSharedResourceLayout(bool a_antiAliasing, bool a_compactFormats);
+	bool layoutAntiAliasing = false;
+	bool layoutCompactFormats = false;
+	DXGI_FORMAT GetSharedDepthFormat() const { return layoutCompactFormats ? DXGI_FORMAT_R16_FLOAT : DXGI_FORMAT_R32_FLOAT; }
+	WrappedResource* CreateSharedResource(const D3D11_TEXTURE2D_DESC& a_desc, uint32_t a_usage);  // Created and counted against the VRAM budget
+	void ReleaseSharedResource(WrappedResource*& a_resource);
+
+	// Shared textures released by InvalidateResources and layout changes wait here, so recreating them
+	// with the same size, format and usage is free. Evicted ones go through the release queue.
+	static constexpr uint64_t kSharedResourcePoolBytes = 256ull * 1024 * 1024;
+	static void EvictSharedResource(WrappedResource* a_resource);
+	ResourcePool<TextureKey, WrappedResource*, TextureKey::Hash> sharedResourcePool{ kSharedResourcePoolBytes, EvictSharedResource };
 	
 	// Thread-safe flag for resource invalidation during game state changes (Load/New/DataLoaded)
 	std::atomic<bool> resourcesInvalidated{ false };
 	
 	// TAA Replacement Mode: true = skip native TAA and use FSR4 AA
 	// When enabled, ReplaceTAA() will execute FSR4 AA on D3D12 and copy result back
-	bool skipTaaEnabled = true;  // ENABLED: Use FSR4 AA to replace native TAA
+	// Set every frame by FSR4SkyrimHandler::UpdateLifecycle from the AntiAliasing setting and the upscale context state
+	bool skipTaaEnabled = false;
 
 	struct Jitter
 	{
@@ -88,6 +152,50 @@ public:
 
 	Jitter jitter;
 
+	// Published once per frame by UpdateJitter, consumed by ReplaceTAA, DispatchAASync and Present
+	FrameContextSlot frameContext;
+
+	// Drives FSR history reset together with FSR4SkyrimHandler::needsReset
+	SceneCutDetector sceneCutDetector;
+
+	// Tile hashes of the pre-AA color are read back without waiting, a few frames after the dispatch.
+	// A readback still in flight when its slot comes round again skips that frame's hash. Static frames
+	// last only while a result at most kTileHashReadbacks frames old confirms them.
+	struct TileHashReadback
+	{
+		winrt::com_ptr<ID3D11Buffer> buffer;
+		uint64_t frameID = 0;
+		uint32_t jitterPhase = 0;
+		bool pending = false;
+	};
+	static constexpr uint32_t kTileHashReadbacks = 3;
+	static_assert(kTileHashReadbacks == StaticFrameDetector::Config{}.maxResultLatency);
+
+	StaticFrameDetector staticFrameDetector;
+	uint32_t jitterPhaseCount = 8;  // From the upscaler's phase count query
+	StructuredBuffer* tileHashBuffer = nullptr;
+	// Constants of the plugin's own per-frame compute passes; CopyDepthToSharedBufferCS needs none
+	ConstantBufferRing* constantRing = nullptr;
+	TileHashReadback tileHashReadbacks[kTileHashReadbacks];
+	uint32_t tileHashWidth = 0;
+	uint32_t tileHashHeight = 0;
+	uint32_t nextTileHashReadback = 0;
+	// Settings and resources changed: the previous output is stale even if the image is not
+	std::atomic<bool> staticFrameInvalidated{ true };
+	bool lastGamePaused = false;
+	bool lastStaticFrame = false;
+	bool aaOutputCurrent = false;  // upscaledBufferShared holds the AA output of the last non-static frame
+	// Paused frames clear the motion vectors; the buffer stays zero until the next copy
+	WrappedResource* clearedMotionVectors = nullptr;
+
+	bool UpdateStaticFrame(const FrameContext& a_frame);
+	void DispatchTileHash(ID3D11DeviceContext* a_context, ID3D11ShaderResourceView* a_color, ID3D11ShaderResourceView* a_motionVectors, const FrameContext& a_frame);
+	void CollectTileHashes(ID3D11DeviceContext* a_context);
+	void CopyMotionVectors(ID3D11DeviceContext* a_context);
+
+	FrameContext CaptureFrameContext() const;
+	FrameContext GetFrameContext() const;
+
 	void UpdateJitter();
 	void CreateFrameGenerationResources();
 	void InvalidateResources();
@@ -98,6 +206,11 @@ public:
 
 	static void TimerSleepQPC(int64_t targetQPC);
 
+	// Paused behind a menu: frame generation is bypassed and frames are capped after Present
+	PowerSaveController powerSave;
+	PowerSaveController::Decision UpdatePowerSave();
+	void ThrottlePowerSave();
+
 	void FrameLimiter();
 
 	static double GetRefreshRate(HWND a_window);
@@ -106,6 +219,9 @@ public:
 	{
 		static void thunk(RE::BSGraphics::State* a_state)
 		{
+			// Frame start on the render thread, runs with or without the D3D12 proxy: no settings
+			// snapshot is held here, so retired ones are freed even when Present is never proxied
+			GetSingleton()->settings.Quiesce();
 			func(a_state);
 			GetSingleton()->UpdateJitter();
 		}
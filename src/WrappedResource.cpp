@@ -1,25 +1,32 @@
 #include "PCH.h"
 #include "WrappedResource.h"
 
-WrappedResource::WrappedResource(D3D11_TEXTURE2D_DESC a_texDesc, ID3D11Device5* a_d3d11Device, ID3D12Device* a_d3d12Device)
+static_assert(ResourceUsage::kBindShaderResource11 == D3D11_BIND_SHADER_RESOURCE);
+static_assert(ResourceUsage::kBindRenderTarget11 == D3D11_BIND_RENDER_TARGET);
+static_assert(ResourceUsage::kBindUnorderedAccess11 == D3D11_BIND_UNORDERED_ACCESS);
+static_assert(ResourceUsage::kAllowRenderTarget12 == D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+static_assert(ResourceUsage::kAllowUnorderedAccess12 == D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+static_assert(ResourceUsage::kAllowSimultaneousAccess12 == D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS);
+
+WrappedResource::WrappedResource(D3D11_TEXTURE2D_DESC a_texDesc, uint32_t a_usage, ID3D11Device5* a_d3d11Device, ID3D12Device* a_d3d12Device) :
+	usage(a_usage)
 {
-	// FSR 4.0 requires UAV for most buffers. Ensure format compatibility.
 	// D3D12 does not allow UAV on SRGB formats.
-	if (a_texDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) {
+	if (ResourceUsage::WritesFromShader(a_usage) && a_texDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) {
 		logger::warn("[WrappedResource] SRGB format detected with UAV request. Converting to UNORM for D3D12 compatibility.");
 		a_texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
 	}
 
-	logger::info("[WrappedResource] Creating resource: {}x{}, Format: {}, BindFlags: 0x{:X}", a_texDesc.Width, a_texDesc.Height, (int)a_texDesc.Format, a_texDesc.BindFlags);
+	// Only what the declared usage needs: every extra flag costs creation time and can rule out compression
+	auto flags = ResourceUsage::Derive(a_usage);
+	format = a_texDesc.Format;
+	bindFlags = flags.bind11;
+	device11.copy_from(a_d3d11Device);
+
+	logger::info("[WrappedResource] Creating resource: {}x{}, Format: {}, Usage: {}", a_texDesc.Width, a_texDesc.Height, (int)a_texDesc.Format, ResourceUsage::Describe(a_usage));
 	LOG_FLUSH();
 
-	D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS;
-	if (a_texDesc.BindFlags & D3D11_BIND_DEPTH_STENCIL)
-		flags |= D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
-	if (a_texDesc.BindFlags & D3D11_BIND_UNORDERED_ACCESS)
-		flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	
-	D3D12_RESOURCE_DESC desc12{ D3D12_RESOURCE_DIMENSION_TEXTURE2D, 0, a_texDesc.Width, a_texDesc.Height, (UINT16)a_texDesc.ArraySize, (UINT16)a_texDesc.MipLevels, a_texDesc.Format, { a_texDesc.SampleDesc.Count, a_texDesc.SampleDesc.Quality }, D3D12_TEXTURE_LAYOUT_UNKNOWN, flags };
+	D3D12_RESOURCE_DESC desc12{ D3D12_RESOURCE_DIMENSION_TEXTURE2D, 0, a_texDesc.Width, a_texDesc.Height, (UINT16)a_texDesc.ArraySize, (UINT16)a_texDesc.MipLevels, a_texDesc.Format, { a_texDesc.SampleDesc.Count, a_texDesc.SampleDesc.Quality }, D3D12_TEXTURE_LAYOUT_UNKNOWN, (D3D12_RESOURCE_FLAGS)flags.resource12 };
 	D3D12_HEAP_PROPERTIES heapProp = { D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1, 1 };
 
 	logger::info("[WrappedResource] Calling CreateCommittedResource...");
@@ -36,39 +43,71 @@ WrappedResource::WrappedResource(D3D11_TEXTURE2D_DESC a_texDesc, ID3D11Device5*
 	DX::ThrowIfFailed(a_d3d11Device->OpenSharedResource1(sharedHandle, IID_PPV_ARGS(&resource11)));
 	CloseHandle(sharedHandle);
 
-	if (a_texDesc.BindFlags & D3D11_BIND_SHADER_RESOURCE) {
+	logger::info("[WrappedResource] Resource created successfully.");
+	LOG_FLUSH();
+}
+
+WrappedResource::~WrappedResource()
+{
+	srvs.clear();
+	uavs.clear();
+	rtvs.clear();
+	if (resource11) { resource11->Release(); resource11 = nullptr; }
+	resource = nullptr;
+}
+
+namespace
+{
+	// Returns the cached view for a_format or creates it with a_create(format, view)
+	template <class View, class Create>
+	View* GetOrCreateView(std::vector<std::pair<DXGI_FORMAT, winrt::com_ptr<View>>>& a_cache, DXGI_FORMAT a_format, Create&& a_create)
+	{
+		for (auto& [format, view] : a_cache) {
+			if (format == a_format)
+				return view.get();
+		}
+		winrt::com_ptr<View> view;
+		DX::ThrowIfFailed(a_create(a_format, view.put()));
+		return a_cache.emplace_back(a_format, std::move(view)).second.get();
+	}
+}
+
+ID3D11ShaderResourceView* WrappedResource::GetSRV(DXGI_FORMAT a_format)
+{
+	if (!(bindFlags & D3D11_BIND_SHADER_RESOURCE) || !resource11)
+		return nullptr;
+	return GetOrCreateView(srvs, a_format == DXGI_FORMAT_UNKNOWN ? format : a_format, [this](DXGI_FORMAT a_viewFormat, ID3D11ShaderResourceView** a_view) {
 		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Format = a_texDesc.Format;
+		srvDesc.Format = a_viewFormat;
 		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
 		srvDesc.Texture2D.MostDetailedMip = 0;
 		srvDesc.Texture2D.MipLevels = 1;
-		DX::ThrowIfFailed(a_d3d11Device->CreateShaderResourceView(resource11, &srvDesc, &srv));
-	}
+		return device11->CreateShaderResourceView(resource11, &srvDesc, a_view);
+	});
+}
 
-	if (a_texDesc.BindFlags & D3D11_BIND_UNORDERED_ACCESS) {
+ID3D11UnorderedAccessView* WrappedResource::GetUAV(DXGI_FORMAT a_format)
+{
+	if (!(bindFlags & D3D11_BIND_UNORDERED_ACCESS) || !resource11)
+		return nullptr;
+	return GetOrCreateView(uavs, a_format == DXGI_FORMAT_UNKNOWN ? format : a_format, [this](DXGI_FORMAT a_viewFormat, ID3D11UnorderedAccessView** a_view) {
 		D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-		uavDesc.Format = a_texDesc.Format;
+		uavDesc.Format = a_viewFormat;
 		uavDesc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
 		uavDesc.Texture2D.MipSlice = 0;
-		DX::ThrowIfFailed(a_d3d11Device->CreateUnorderedAccessView(resource11, &uavDesc, &uav));
-	}
+		return device11->CreateUnorderedAccessView(resource11, &uavDesc, a_view);
+	});
+}
 
-	if (a_texDesc.BindFlags & D3D11_BIND_RENDER_TARGET) {
+ID3D11RenderTargetView* WrappedResource::GetRTV(DXGI_FORMAT a_format)
+{
+	if (!(bindFlags & D3D11_BIND_RENDER_TARGET) || !resource11)
+		return nullptr;
+	return GetOrCreateView(rtvs, a_format == DXGI_FORMAT_UNKNOWN ? format : a_format, [this](DXGI_FORMAT a_viewFormat, ID3D11RenderTargetView** a_view) {
 		D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
-		rtvDesc.Format = a_texDesc.Format;
+		rtvDesc.Format = a_viewFormat;
 		rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
 		rtvDesc.Texture2D.MipSlice = 0;
-		DX::ThrowIfFailed(a_d3d11Device->CreateRenderTargetView(resource11, &rtvDesc, &rtv));
-	}
-	logger::info("[WrappedResource] Resource created successfully.");
-	LOG_FLUSH();
-}
-
-WrappedResource::~WrappedResource()
-{
-	if (srv) { srv->Release(); srv = nullptr; }
-	if (uav) { uav->Release(); uav = nullptr; }
-	if (rtv) { rtv->Release(); rtv = nullptr; }
-	if (resource11) { resource11->Release(); resource11 = nullptr; }
-	resource = nullptr;
+		return device11->CreateRenderTargetView(resource11, &rtvDesc, a_view);
+	});
 }
@@ -2,17 +2,37 @@
 
 #include <d3d11_4.h>
 #include <d3d12.h>
+#include <utility>
+#include <vector>
 #include <winrt/base.h>
 
+#include "Core/ResourceUsage.h"
+
+// Texture created in D3D12 and opened in D3D11 through an NT handle. Creation flags follow the
+// declared ResourceUsage; D3D11 views are created on first use and cached per format.
 class WrappedResource
 {
 public:
-	WrappedResource(D3D11_TEXTURE2D_DESC a_texDesc, ID3D11Device5* a_d3d11Device, ID3D12Device* a_d3d12Device);
+	WrappedResource(D3D11_TEXTURE2D_DESC a_texDesc, uint32_t a_usage, ID3D11Device5* a_d3d11Device, ID3D12Device* a_d3d12Device);
 	~WrappedResource();
 
+	// DXGI_FORMAT_UNKNOWN is the texture's own format. Null when the usage does not allow the view.
+	ID3D11ShaderResourceView* GetSRV(DXGI_FORMAT a_format = DXGI_FORMAT_UNKNOWN);
+	ID3D11UnorderedAccessView* GetUAV(DXGI_FORMAT a_format = DXGI_FORMAT_UNKNOWN);
+	ID3D11RenderTargetView* GetRTV(DXGI_FORMAT a_format = DXGI_FORMAT_UNKNOWN);
+
 	ID3D11Texture2D* resource11 = nullptr;
-	ID3D11ShaderResourceView* srv = nullptr;
-	ID3D11UnorderedAccessView* uav = nullptr;
-	ID3D11RenderTargetView* rtv = nullptr;
 	winrt::com_ptr<ID3D12Resource> resource;
+	uint32_t usage = ResourceUsage::kNone;
+
+private:
+	template <class View>
+	using ViewCache = std::vector<std::pair<DXGI_FORMAT, winrt::com_ptr<View>>>;
+
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+	uint32_t bindFlags = 0;
+	winrt::com_ptr<ID3D11Device5> device11;
+	ViewCache<ID3D11ShaderResourceView> srvs;
+	ViewCache<ID3D11UnorderedAccessView> uavs;
+	ViewCache<ID3D11RenderTargetView> rtvs;
 };
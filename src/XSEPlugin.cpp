@@ -64,6 +64,10 @@ bool Load()
 	Hooks::Install();
 	Upscaling::InstallHooks();
 	Upscaling::GetSingleton()->LoadINI();
+	Upscaling::GetSingleton()->StartINIWatcher();
+#ifndef NDEBUG
+	Upscaling::GetSingleton()->StartShaderWatcher();
+#endif
 
 	return true;
 }